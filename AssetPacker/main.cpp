@@ -0,0 +1,210 @@
+// Command line packer for asset packages (see Engine/Content/AssetPackage.h).
+//
+// Usage: AssetPacker <input directory> <output package> [--store]
+//
+// Every file under the input directory becomes an asset whose id is the hash of its path relative
+// to that directory. --store writes all blocks uncompressed.
+#include "Content/AssetPackage.h"
+#include "Content/LZCodec.h"
+
+#include <iostream>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+using namespace Zetta;
+using namespace Zetta::Content;
+namespace fs = std::filesystem;
+
+namespace {
+	// NOTE: std::vector, since util::vector relocates its elements with realloc and that breaks std::string.
+	struct Asset {
+		std::string path;
+		Package::AssetID id;
+		u64 offset;
+		u64 size;
+	};
+
+	struct CompressedBlock {
+		util::vector<u8> data;	// empty if the block is stored uncompressed
+	};
+
+	[[nodiscard]] bool CollectAssets(const fs::path& directory, std::vector<Asset>& assets) {
+		std::error_code error;
+		for (const auto& entry : fs::recursive_directory_iterator{ directory, error }) {
+			if (!entry.is_regular_file(error)) continue;
+			Asset asset{};
+			asset.path = entry.path().lexically_relative(directory).generic_string();
+			asset.size = entry.file_size(error);
+			asset.id = Package::AssetIDFromPath(asset.path.c_str());
+			assets.emplace_back(std::move(asset));
+		}
+
+		if (error) {
+			std::cerr << "Failed to read " << directory << ": " << error.message() << "\n";
+			return false;
+		}
+
+		// NOTE: sorted by path so the same input always produces the same package.
+		std::sort(assets.begin(), assets.end(), [](const Asset& a, const Asset& b) { return a.path < b.path; });
+		return true;
+	}
+
+	[[nodiscard]] bool ReadAssets(const fs::path& directory, std::vector<Asset>& assets, util::vector<u8>& data) {
+		u64 data_size{ 0 };
+		for (Asset& asset : assets) {
+			asset.offset = data_size;
+			data_size += asset.size;
+		}
+
+		data.resize(data_size);
+		for (const Asset& asset : assets) {
+			std::ifstream file{ directory / asset.path, std::ios::in | std::ios::binary };
+			if (!file || !file.read((char*)data.data() + asset.offset, asset.size)) {
+				std::cerr << "Failed to read " << asset.path << "\n";
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	[[nodiscard]] bool BuildTOC(const std::vector<Asset>& assets, util::vector<Package::TOCEntry>& toc) {
+		// Keep the table at most half full, so lookups rarely probe more than one or two slots.
+		u32 slot_count{ 1 };
+		while (slot_count < assets.size() * 2) slot_count <<= 1;
+		toc.resize(slot_count);
+		memset(toc.data(), 0, sizeof(Package::TOCEntry) * slot_count);
+
+		const u32 mask{ slot_count - 1 };
+		for (const Asset& asset : assets) {
+			u32 slot{ (u32)asset.id & mask };
+			for (; toc[slot].id; slot = (slot + 1) & mask) {
+				if (toc[slot].id == asset.id) {
+					std::cerr << "Asset id collision: " << asset.path << " (paths are case-insensitive)\n";
+					return false;
+				}
+			}
+			toc[slot] = { asset.id, asset.offset, asset.size };
+		}
+
+		return true;
+	}
+
+	void CompressBlocks(const util::vector<u8>& data, util::vector<CompressedBlock>& blocks, bool store) {
+		const u32 block_count{ (u32)((data.size() + Package::block_size - 1) / Package::block_size) };
+		blocks.resize(block_count);
+		if (store) return;
+
+		std::atomic<u32> next_block{ 0 };
+		const auto compress{ [&]() {
+			util::vector<u8> buffer(LZ::CompressBound(Package::block_size));
+			for (u32 i{ next_block++ }; i < block_count; i = next_block++) {
+				const u64 offset{ (u64)i * Package::block_size };
+				const u64 size{ std::min<u64>(Package::block_size, data.size() - offset) };
+				const u64 compressed_size{ LZ::Compress(buffer.data(), buffer.size(), data.data() + offset, size) };
+				if (!compressed_size) continue;
+				blocks[i].data.resize(compressed_size);
+				memcpy(blocks[i].data.data(), buffer.data(), compressed_size);
+			}
+		} };
+
+		const u32 thread_count{ std::max(1u, std::thread::hardware_concurrency()) };
+		util::vector<std::thread> threads{};
+		threads.reserve(thread_count);
+		for (u32 i{ 0 }; i < thread_count; i++) threads.emplace_back(compress);
+		for (std::thread& thread : threads) thread.join();
+	}
+
+	void Pad(std::ofstream& file, u64& position) {
+		static const u8 zeros[Package::package_alignment]{};
+		const u64 aligned{ Math::AlignSizeUp<Package::package_alignment>(position) };
+		file.write((const char*)zeros, aligned - position);
+		position = aligned;
+	}
+
+	[[nodiscard]] bool WritePackage(const fs::path& path, const util::vector<u8>& data, const util::vector<CompressedBlock>& blocks,
+		const util::vector<Package::TOCEntry>& toc, u32 asset_count, u64& package_size) {
+		using namespace Package;
+		PackageHeader header{};
+		header.magic = package_magic;
+		header.version = package_version;
+		header.block_size = block_size;
+		header.block_count = (u32)blocks.size();
+		header.asset_count = asset_count;
+		header.toc_slot_count = (u32)toc.size();
+		header.block_table_offset = Math::AlignSizeUp<package_alignment>(sizeof(PackageHeader));
+		header.toc_offset = Math::AlignSizeUp<package_alignment>(header.block_table_offset + sizeof(BlockEntry) * blocks.size());
+		header.data_size = data.size();
+
+		util::vector<BlockEntry> block_table(blocks.size());
+		u64 offset{ Math::AlignSizeUp<package_alignment>(header.toc_offset + sizeof(TOCEntry) * toc.size()) };
+		for (u32 i{ 0 }; i < blocks.size(); i++) {
+			const u32 size{ (u32)std::min<u64>(block_size, data.size() - (u64)i * block_size) };
+			block_table[i].offset = offset;
+			block_table[i].size = size;
+			block_table[i].compressed_size = blocks[i].data.empty() ? size : (u32)blocks[i].data.size();
+			offset = Math::AlignSizeUp<package_alignment>(offset + block_table[i].compressed_size);
+		}
+
+		std::ofstream file{ path, std::ios::out | std::ios::binary | std::ios::trunc };
+		if (!file) return false;
+
+		u64 position{ 0 };
+		file.write((const char*)&header, sizeof(PackageHeader));
+		position += sizeof(PackageHeader);
+		Pad(file, position);
+		file.write((const char*)block_table.data(), sizeof(BlockEntry) * block_table.size());
+		position += sizeof(BlockEntry) * block_table.size();
+		Pad(file, position);
+		file.write((const char*)toc.data(), sizeof(TOCEntry) * toc.size());
+		position += sizeof(TOCEntry) * toc.size();
+		Pad(file, position);
+
+		for (u32 i{ 0 }; i < blocks.size(); i++) {
+			assert(position == block_table[i].offset);
+			const u8* const block{ blocks[i].data.empty() ? data.data() + (u64)i * block_size : blocks[i].data.data() };
+			file.write((const char*)block, block_table[i].compressed_size);
+			position += block_table[i].compressed_size;
+			Pad(file, position);
+		}
+
+		package_size = position;
+		return (bool)file;
+	}
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		std::cerr << "Usage: AssetPacker <input directory> <output package> [--store]\n";
+		return 1;
+	}
+
+	const fs::path input{ argv[1] };
+	const fs::path output{ argv[2] };
+	const bool store{ argc > 3 && !strcmp(argv[3], "--store") };
+	const auto start{ std::chrono::high_resolution_clock::now() };
+
+	std::vector<Asset> assets{};
+	util::vector<u8> data{};
+	util::vector<Package::TOCEntry> toc{};
+	util::vector<CompressedBlock> blocks{};
+	if (!CollectAssets(input, assets) || !ReadAssets(input, assets, data) || !BuildTOC(assets, toc)) return 1;
+
+	CompressBlocks(data, blocks, store);
+
+	u64 package_size{ 0 };
+	if (!WritePackage(output, data, blocks, toc, (u32)assets.size(), package_size)) {
+		std::cerr << "Failed to write " << output << "\n";
+		return 1;
+	}
+
+	const double seconds{ std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count() };
+	std::cout << "Packed " << assets.size() << " assets in " << blocks.size() << " blocks: "
+		<< data.size() << " -> " << package_size << " bytes in " << seconds << " s\n";
+	return 0;
+}
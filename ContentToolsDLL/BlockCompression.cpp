@@ -0,0 +1,750 @@
+#include "BlockCompressionCommon.h"
+#include <type_traits>
+
+namespace Zetta::Tools::BC {
+	namespace {
+		using namespace Detail;
+
+		// One block with its channels split out for SIMD. Pixels with weight 0 don't count toward the
+		// endpoints or the error (transparent pixels in BC1).
+		struct ColorBlock {
+			alignas(32) f32 r[block_pixel_count];
+			alignas(32) f32 g[block_pixel_count];
+			alignas(32) f32 b[block_pixel_count];
+			alignas(32) f32 weight[block_pixel_count];
+			u32 count;	// pixels with weight 1
+		};
+
+		struct ColorEndpoints {
+			u16 c0;
+			u16 c1;
+		};
+
+		struct ColorFit {
+			ColorEndpoints endpoints;
+			u8 indices[block_pixel_count];
+			f32 error;
+		};
+
+		struct AlphaFit {
+			u8 a0;
+			u8 a1;
+			u8 indices[block_pixel_count];
+			u32 error;
+		};
+
+		// Per quality: power iterations for the principal axis, least-squares refinements and endpoint search passes.
+		constexpr u32 axis_iterations[Quality::count]{ 0, 4, 8 };
+		constexpr u32 refinements[Quality::count]{ 0, 1, 3 };
+		constexpr u32 search_passes[Quality::count]{ 0, 0, 2 };
+
+		[[nodiscard]] u16 PackRGB565(f32 r, f32 g, f32 b) {
+			const u32 r5{ (u32)std::clamp(r * (31.f / 255.f) + 0.5f, 0.f, 31.f) };
+			const u32 g6{ (u32)std::clamp(g * (63.f / 255.f) + 0.5f, 0.f, 63.f) };
+			const u32 b5{ (u32)std::clamp(b * (31.f / 255.f) + 0.5f, 0.f, 31.f) };
+			return (u16)((r5 << 11) | (g6 << 5) | b5);
+		}
+
+		void UnpackRGB565(u16 color, f32* const rgb) {
+			const u32 r5{ (u32)(color >> 11) & 0x1f };
+			const u32 g6{ (u32)(color >> 5) & 0x3f };
+			const u32 b5{ (u32)color & 0x1f };
+			rgb[0] = (f32)((r5 << 3) | (r5 >> 2));
+			rgb[1] = (f32)((g6 << 2) | (g6 >> 4));
+			rgb[2] = (f32)((b5 << 3) | (b5 >> 2));
+		}
+
+		// Returns the number of palette entries that can be picked. In 3-color mode the 4th entry is
+		// transparent black, which only transparent pixels use.
+		u32 BuildColorPalette(ColorEndpoints endpoints, bool is_four_color, f32 (&palette)[4][3]) {
+			UnpackRGB565(endpoints.c0, palette[0]);
+			UnpackRGB565(endpoints.c1, palette[1]);
+			for (u32 i{ 0 }; i < 3; i++) {
+				if (is_four_color) {
+					palette[2][i] = (2.f * palette[0][i] + palette[1][i]) * (1.f / 3.f);
+					palette[3][i] = (palette[0][i] + 2.f * palette[1][i]) * (1.f / 3.f);
+				}
+				else {
+					palette[2][i] = (palette[0][i] + palette[1][i]) * 0.5f;
+					palette[3][i] = 0.f;
+				}
+			}
+
+			return is_four_color ? 4 : 3;
+		}
+
+		// Picks the closest palette entry for every pixel and returns the weighted squared error.
+		f32 FitColorIndices(const ColorBlock& block, const f32 (&palette)[4][3], u32 palette_size, u8 (&indices)[block_pixel_count]) {
+#if defined(__AVX2__)
+			__m256 total{ _mm256_setzero_ps() };
+			for (u32 i{ 0 }; i < block_pixel_count; i += 8) {
+				const __m256 r{ _mm256_load_ps(&block.r[i]) };
+				const __m256 g{ _mm256_load_ps(&block.g[i]) };
+				const __m256 b{ _mm256_load_ps(&block.b[i]) };
+				__m256 best{ _mm256_set1_ps(FLT_MAX) };
+				__m256i best_index{ _mm256_setzero_si256() };
+				for (u32 p{ 0 }; p < palette_size; p++) {
+					const __m256 dr{ _mm256_sub_ps(r, _mm256_set1_ps(palette[p][0])) };
+					const __m256 dg{ _mm256_sub_ps(g, _mm256_set1_ps(palette[p][1])) };
+					const __m256 db{ _mm256_sub_ps(b, _mm256_set1_ps(palette[p][2])) };
+					const __m256 distance{ _mm256_fmadd_ps(db, db, _mm256_fmadd_ps(dg, dg, _mm256_mul_ps(dr, dr))) };
+					const __m256 is_closer{ _mm256_cmp_ps(distance, best, _CMP_LT_OQ) };
+					best = _mm256_min_ps(distance, best);
+					best_index = _mm256_blendv_epi8(best_index, _mm256_set1_epi32((s32)p), _mm256_castps_si256(is_closer));
+				}
+
+				total = _mm256_fmadd_ps(best, _mm256_load_ps(&block.weight[i]), total);
+				alignas(32) s32 result[8];
+				_mm256_store_si256((__m256i*)result, best_index);
+				for (u32 j{ 0 }; j < 8; j++) indices[i + j] = (u8)result[j];
+			}
+
+			const __m128 sum4{ _mm_add_ps(_mm256_castps256_ps128(total), _mm256_extractf128_ps(total, 1)) };
+#else
+			__m128 sum4{ _mm_setzero_ps() };
+			for (u32 i{ 0 }; i < block_pixel_count; i += 4) {
+				const __m128 r{ _mm_load_ps(&block.r[i]) };
+				const __m128 g{ _mm_load_ps(&block.g[i]) };
+				const __m128 b{ _mm_load_ps(&block.b[i]) };
+				__m128 best{ _mm_set1_ps(FLT_MAX) };
+				__m128i best_index{ _mm_setzero_si128() };
+				for (u32 p{ 0 }; p < palette_size; p++) {
+					const __m128 dr{ _mm_sub_ps(r, _mm_set1_ps(palette[p][0])) };
+					const __m128 dg{ _mm_sub_ps(g, _mm_set1_ps(palette[p][1])) };
+					const __m128 db{ _mm_sub_ps(b, _mm_set1_ps(palette[p][2])) };
+					const __m128 distance{ _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db)) };
+					const __m128i is_closer{ _mm_castps_si128(_mm_cmplt_ps(distance, best)) };
+					best = _mm_min_ps(distance, best);
+					best_index = _mm_or_si128(_mm_and_si128(is_closer, _mm_set1_epi32((s32)p)), _mm_andnot_si128(is_closer, best_index));
+				}
+
+				sum4 = _mm_add_ps(sum4, _mm_mul_ps(best, _mm_load_ps(&block.weight[i])));
+				alignas(16) s32 result[4];
+				_mm_store_si128((__m128i*)result, best_index);
+				for (u32 j{ 0 }; j < 4; j++) indices[i + j] = (u8)result[j];
+			}
+#endif
+			const __m128 sum2{ _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4)) };
+			return _mm_cvtss_f32(_mm_add_ss(sum2, _mm_shuffle_ps(sum2, sum2, 1)));
+		}
+
+		// Puts the endpoints in the order that selects the mode and fits the indices for it.
+		void EvaluateColorEndpoints(const ColorBlock& block, ColorEndpoints endpoints, bool is_four_color, ColorFit& fit) {
+			// 4-color mode needs c0 > c1 and 3-color mode c0 <= c1. With c0 == c1 every pixel uses index 0 in either mode.
+			if ((endpoints.c0 < endpoints.c1) == is_four_color) std::swap(endpoints.c0, endpoints.c1);
+			if (endpoints.c0 == endpoints.c1) is_four_color = false;
+
+			f32 palette[4][3];
+			const u32 palette_size{ BuildColorPalette(endpoints, is_four_color, palette) };
+			fit.endpoints = endpoints;
+			fit.error = FitColorIndices(block, palette, palette_size, fit.indices);
+		}
+
+		// Least-squares endpoints for the current indices. Returns false if the indices don't constrain both endpoints.
+		bool RefineColorEndpoints(const ColorBlock& block, const ColorFit& fit, bool is_four_color, ColorEndpoints& endpoints) {
+			// How much of c0 each index contributes. Index 3 in 3-color mode is black and doesn't count.
+			constexpr f32 four_color_weights[4]{ 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+			constexpr f32 three_color_weights[4]{ 1.f, 0.f, 0.5f, 0.f };
+			f32 aa{ 0.f }, bb{ 0.f }, ab{ 0.f };
+			f32 ax[3]{}, bx[3]{};
+			for (u32 i{ 0 }; i < block_pixel_count; i++) {
+				const u8 index{ fit.indices[i] };
+				const f32 weight{ (!is_four_color && index == 3) ? 0.f : block.weight[i] };
+				const f32 a{ is_four_color ? four_color_weights[index] : three_color_weights[index] };
+				const f32 b{ 1.f - a };
+				aa += weight * a * a;
+				bb += weight * b * b;
+				ab += weight * a * b;
+				const f32 pixel[3]{ block.r[i], block.g[i], block.b[i] };
+				for (u32 c{ 0 }; c < 3; c++) {
+					ax[c] += weight * a * pixel[c];
+					bx[c] += weight * b * pixel[c];
+				}
+			}
+
+			const f32 determinant{ aa * bb - ab * ab };
+			if (std::abs(determinant) < 1e-6f) return false;
+
+			const f32 inv_determinant{ 1.f / determinant };
+			f32 e0[3], e1[3];
+			for (u32 c{ 0 }; c < 3; c++) {
+				e0[c] = (bb * ax[c] - ab * bx[c]) * inv_determinant;
+				e1[c] = (aa * bx[c] - ab * ax[c]) * inv_determinant;
+			}
+
+			endpoints.c0 = PackRGB565(e0[0], e0[1], e0[2]);
+			endpoints.c1 = PackRGB565(e1[0], e1[1], e1[2]);
+			return true;
+		}
+
+		// Nudges each 565 channel of both endpoints by one step and keeps every change that lowers the error.
+		void SearchColorEndpoints(const ColorBlock& block, bool is_four_color, ColorFit& best) {
+			constexpr u16 channel_masks[3]{ 0xf800, 0x07e0, 0x001f };
+			constexpr u16 channel_steps[3]{ 0x0800, 0x0020, 0x0001 };
+			for (u32 endpoint{ 0 }; endpoint < 2; endpoint++) {
+				for (u32 c{ 0 }; c < 3; c++) {
+					for (const s32 direction : { -1, 1 }) {
+						ColorEndpoints endpoints{ best.endpoints };
+						u16& color{ endpoint ? endpoints.c1 : endpoints.c0 };
+						const u16 channel{ (u16)(color & channel_masks[c]) };
+						if ((direction < 0 && !channel) || (direction > 0 && channel == channel_masks[c])) continue;
+						color = (u16)((color & ~channel_masks[c]) | (u16)(channel + direction * channel_steps[c]));
+
+						ColorFit fit;
+						EvaluateColorEndpoints(block, endpoints, is_four_color, fit);
+						if (fit.error < best.error) best = fit;
+					}
+				}
+			}
+		}
+
+		void FitColorBlock(const ColorBlock& block, const ColorEndpoints& start, bool is_four_color, Quality::Level quality, ColorFit& best) {
+			EvaluateColorEndpoints(block, start, is_four_color, best);
+			for (u32 i{ 0 }; i < refinements[quality]; i++) {
+				ColorEndpoints endpoints;
+				if (!RefineColorEndpoints(block, best, is_four_color, endpoints)) break;
+				ColorFit fit;
+				EvaluateColorEndpoints(block, endpoints, is_four_color, fit);
+				if (fit.error >= best.error) break;
+				best = fit;
+			}
+
+			for (u32 i{ 0 }; i < search_passes[quality]; i++) {
+				const f32 error{ best.error };
+				SearchColorEndpoints(block, is_four_color, best);
+				if (best.error >= error) break;
+			}
+		}
+
+		// Endpoints at the ends of the block's color distribution: the bounding box diagonal for Fast and the
+		// principal axis for higher qualities.
+		ColorEndpoints InitialColorEndpoints(const ColorBlock& block, Quality::Level quality) {
+			f32 mean[3]{}, min[3]{ FLT_MAX, FLT_MAX, FLT_MAX }, max[3]{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+			for (u32 i{ 0 }; i < block_pixel_count; i++) {
+				if (!block.weight[i]) continue;
+				const f32 pixel[3]{ block.r[i], block.g[i], block.b[i] };
+				for (u32 c{ 0 }; c < 3; c++) {
+					mean[c] += pixel[c];
+					min[c] = std::min(min[c], pixel[c]);
+					max[c] = std::max(max[c], pixel[c]);
+				}
+			}
+
+			for (f32& m : mean) m /= (f32)block.count;
+
+			// covariance: rr, rg, rb, gg, gb, bb
+			f32 covariance[6]{};
+			for (u32 i{ 0 }; i < block_pixel_count; i++) {
+				if (!block.weight[i]) continue;
+				const f32 r{ block.r[i] - mean[0] }, g{ block.g[i] - mean[1] }, b{ block.b[i] - mean[2] };
+				covariance[0] += r * r; covariance[1] += r * g; covariance[2] += r * b;
+				covariance[3] += g * g; covariance[4] += g * b; covariance[5] += b * b;
+			}
+
+			// Start with the bounding box diagonal, flipped to follow how the channels correlate.
+			f32 axis[3]{ max[0] - min[0], max[1] - min[1], max[2] - min[2] };
+			if (covariance[1] < 0.f) axis[1] = -axis[1];
+			if (covariance[2] < 0.f) axis[2] = -axis[2];
+
+			for (u32 i{ 0 }; i < axis_iterations[quality]; i++) {
+				const f32 x{ covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2] };
+				const f32 y{ covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2] };
+				const f32 z{ covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2] };
+				const f32 length{ std::max({ std::abs(x), std::abs(y), std::abs(z) }) };
+				if (length < 1e-6f) break;
+				axis[0] = x / length; axis[1] = y / length; axis[2] = z / length;
+			}
+
+			const f32 length_sq{ axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] };
+			if (length_sq < 1e-6f) {
+				const u16 color{ PackRGB565(mean[0], mean[1], mean[2]) };
+				return { color, color };
+			}
+
+			f32 t_min{ FLT_MAX }, t_max{ -FLT_MAX };
+			for (u32 i{ 0 }; i < block_pixel_count; i++) {
+				if (!block.weight[i]) continue;
+				const f32 t{ ((block.r[i] - mean[0]) * axis[0] + (block.g[i] - mean[1]) * axis[1] + (block.b[i] - mean[2]) * axis[2]) / length_sq };
+				t_min = std::min(t_min, t);
+				t_max = std::max(t_max, t);
+			}
+
+			return {
+				PackRGB565(mean[0] + t_max * axis[0], mean[1] + t_max * axis[1], mean[2] + t_max * axis[2]),
+				PackRGB565(mean[0] + t_min * axis[0], mean[1] + t_min * axis[1], mean[2] + t_min * axis[2])
+			};
+		}
+
+		void WriteColorBlock(const ColorFit& fit, u8* const output) {
+			u32 indices{ 0 };
+			for (u32 i{ 0 }; i < block_pixel_count; i++) indices |= (u32)fit.indices[i] << (i * 2);
+			memcpy(&output[0], &fit.endpoints.c0, sizeof(u16));
+			memcpy(&output[2], &fit.endpoints.c1, sizeof(u16));
+			memcpy(&output[4], &indices, sizeof(u32));
+		}
+
+		// Color part of BC1 and BC3. BC3 always decodes in 4-color mode, so only BC1 may use 3-color mode.
+		void EncodeColorBlock(const u8 (&pixels)[block_pixel_count][4], Quality::Level quality, bool is_bc1, u32 alpha_cutoff, u8* const output) {
+			ColorBlock block;
+			block.count = 0;
+			for (u32 i{ 0 }; i < block_pixel_count; i++) {
+				block.r[i] = pixels[i][0];
+				block.g[i] = pixels[i][1];
+				block.b[i] = pixels[i][2];
+				block.weight[i] = (is_bc1 && pixels[i][3] < alpha_cutoff) ? 0.f : 1.f;
+				block.count += (u32)block.weight[i];
+			}
+
+			ColorFit best;
+			if (!block.count) {
+				best.endpoints = { 0, 0 };
+				memset(best.indices, 3, sizeof(best.indices));
+				WriteColorBlock(best, output);
+				return;
+			}
+
+			const bool has_transparency{ block.count < block_pixel_count };
+			const ColorEndpoints endpoints{ InitialColorEndpoints(block, quality) };
+			FitColorBlock(block, endpoints, !has_transparency, quality, best);
+
+			// 3-color mode interpolates a half-way color instead of two thirds, which sometimes fits better.
+			if (is_bc1 && !has_transparency && quality == Quality::High) {
+				ColorFit fit;
+				FitColorBlock(block, endpoints, false, quality, fit);
+				if (fit.error < best.error) best = fit;
+			}
+
+			if (has_transparency) {
+				for (u32 i{ 0 }; i < block_pixel_count; i++) {
+					if (!block.weight[i]) best.indices[i] = 3;
+				}
+			}
+
+			WriteColorBlock(best, output);
+		}
+
+		// Builds the 8-entry palette of a BC4 style block. a0 > a1 interpolates 6 values, otherwise 4 plus 0 and 255.
+		void BuildAlphaPalette(u8 a0, u8 a1, u8 (&palette)[8]) {
+			palette[0] = a0;
+			palette[1] = a1;
+			if (a0 > a1) {
+				for (u32 i{ 1 }; i < 7; i++) palette[i + 1] = (u8)((2 * ((7 - i) * a0 + i * a1) + 7) / 14);
+			}
+			else {
+				for (u32 i{ 1 }; i < 5; i++) palette[i + 1] = (u8)((2 * ((5 - i) * a0 + i * a1) + 5) / 10);
+				palette[6] = 0;
+				palette[7] = 255;
+			}
+		}
+
+		// All 16 values are fitted at once in one SSE register.
+		void FitAlphaIndices(const __m128i values, u8 a0, u8 a1, AlphaFit& fit) {
+			u8 palette[8];
+			BuildAlphaPalette(a0, a1, palette);
+			__m128i best{ _mm_set1_epi8((char)0xff) };
+			__m128i best_index{ _mm_setzero_si128() };
+			for (u32 p{ 0 }; p < 8; p++) {
+				const __m128i entry{ _mm_set1_epi8((char)palette[p]) };
+				const __m128i distance{ _mm_or_si128(_mm_subs_epu8(values, entry), _mm_subs_epu8(entry, values)) };
+				const __m128i min{ _mm_min_epu8(distance, best) };
+				// closer where the minimum changed
+				const __m128i is_closer{ _mm_andnot_si128(_mm_cmpeq_epi8(min, best), _mm_set1_epi8((char)0xff)) };
+				best = min;
+				best_index = _mm_or_si128(_mm_and_si128(is_closer, _mm_set1_epi8((char)p)), _mm_andnot_si128(is_closer, best_index));
+			}
+
+			const __m128i low{ _mm_unpacklo_epi8(best, _mm_setzero_si128()) };
+			const __m128i high{ _mm_unpackhi_epi8(best, _mm_setzero_si128()) };
+			__m128i sum{ _mm_add_epi32(_mm_madd_epi16(low, low), _mm_madd_epi16(high, high)) };
+			sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+			sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+
+			fit.a0 = a0;
+			fit.a1 = a1;
+			fit.error = (u32)_mm_cvtsi128_si32(sum);
+			_mm_storeu_si128((__m128i*)fit.indices, best_index);
+		}
+
+		// Single channel block of BC3 (alpha), BC4 and BC5.
+		void EncodeAlphaBlock(const u8 (&values)[block_pixel_count], Quality::Level quality, u8* const output) {
+			const __m128i packed{ _mm_loadu_si128((const __m128i*)values) };
+			u8 min{ 255 }, max{ 0 }, min6{ 255 }, max6{ 0 };
+			for (const u8 value : values) {
+				min = std::min(min, value);
+				max = std::max(max, value);
+				if (value && value != 255) {
+					min6 = std::min(min6, value);
+					max6 = std::max(max6, value);
+				}
+			}
+
+			AlphaFit best;
+			FitAlphaIndices(packed, max, min, best);
+
+			if (quality != Quality::Fast && best.error) {
+				// 6 interpolated values between the extremes that aren't 0 or 255, which are in the palette anyway.
+				AlphaFit fit;
+				if (min6 > max6) min6 = max6 = min;
+				FitAlphaIndices(packed, min6, max6, fit);
+				if (fit.error < best.error) best = fit;
+			}
+
+			if (quality == Quality::High && best.error && max > min) {
+				// Pulling the endpoints in spends more of the palette on the bulk of the values.
+				const u32 range{ std::min(4u, (u32)(max - min) / 4) };
+				for (u32 i{ 0 }; i <= range; i++) {
+					for (u32 j{ 0 }; j <= range; j++) {
+						const u8 a0{ (u8)(max - i) }, a1{ (u8)(min + j) };
+						if (a0 <= a1 || (!i && !j)) continue;
+						AlphaFit fit;
+						FitAlphaIndices(packed, a0, a1, fit);
+						if (fit.error < best.error) best = fit;
+					}
+				}
+			}
+
+			u64 indices{ 0 };
+			for (u32 i{ 0 }; i < block_pixel_count; i++) indices |= (u64)best.indices[i] << (i * 3);
+			output[0] = best.a0;
+			output[1] = best.a1;
+			memcpy(&output[2], &indices, 6);
+		}
+
+		void EncodeBlock(const u8 (&pixels)[block_pixel_count][4], Format::Type format, Quality::Level quality, u32 alpha_cutoff, u8* const output) {
+			u8 channel[block_pixel_count];
+			switch (format) {
+			case Format::BC1:
+				EncodeColorBlock(pixels, quality, true, alpha_cutoff, output);
+				break;
+			case Format::BC3:
+				for (u32 i{ 0 }; i < block_pixel_count; i++) channel[i] = pixels[i][3];
+				EncodeAlphaBlock(channel, quality, output);
+				EncodeColorBlock(pixels, quality, false, 0, output + 8);
+				break;
+			case Format::BC4:
+			case Format::BC5:
+				for (u32 c{ 0 }; c < (format == Format::BC4 ? 1u : 2u); c++) {
+					for (u32 i{ 0 }; i < block_pixel_count; i++) channel[i] = pixels[i][c];
+					EncodeAlphaBlock(channel, quality, output + c * 8);
+				}
+				break;
+			case Format::BC7:
+				EncodeBC7Block(pixels, quality, output);
+				break;
+			default:
+				assert(false);
+			}
+		}
+
+		// Shuffles that pick the palette entries of a row of 4 pixels from the byte of their 2-bit indices.
+		struct ColorShuffles {
+			u8 masks[256][16];
+		};
+
+		[[nodiscard]] constexpr ColorShuffles MakeColorShuffles() {
+			ColorShuffles result{};
+			for (u32 i{ 0 }; i < 256; i++) {
+				for (u32 x{ 0 }; x < 4; x++) {
+					for (u32 c{ 0 }; c < 4; c++) result.masks[i][x * 4 + c] = (u8)(((i >> (x * 2)) & 3) * 4 + c);
+				}
+			}
+			return result;
+		}
+
+		constexpr ColorShuffles color_shuffles{ MakeColorShuffles() };
+
+		// Shuffles that move the values of row y of a single channel block to channel c of the RGBA pixels.
+		struct ChannelShuffles {
+			u8 masks[4][4][16];		// [c][y]
+		};
+
+		[[nodiscard]] constexpr ChannelShuffles MakeChannelShuffles() {
+			ChannelShuffles result{};
+			for (u32 c{ 0 }; c < 4; c++) {
+				for (u32 y{ 0 }; y < 4; y++) {
+					for (u32 i{ 0 }; i < 16; i++) result.masks[c][y][i] = (i & 3) == c ? (u8)(y * 4 + (i >> 2)) : 0x80;
+				}
+			}
+			return result;
+		}
+
+		constexpr ChannelShuffles channel_shuffles{ MakeChannelShuffles() };
+
+		// Rows of 4 pixels are 16 bytes, so each row is one shuffle of the 4 palette colors.
+		void DecodeColorBlock(const u8* const block, bool is_bc1, u8 (&pixels)[block_pixel_count][4]) {
+			u16 c0, c1;
+			u32 indices;
+			memcpy(&c0, &block[0], sizeof(u16));
+			memcpy(&c1, &block[2], sizeof(u16));
+			memcpy(&indices, &block[4], sizeof(u32));
+
+			// Same rounding as BuildColorPalette().
+			const u32 shifts[3]{ 11, 5, 0 };
+			const u32 bits[3]{ 5, 6, 5 };
+			const bool is_four_color{ !is_bc1 || c0 > c1 };
+			alignas(16) u8 palette[4][4];
+			for (u32 c{ 0 }; c < 3; c++) {
+				const u32 v0{ ((u32)c0 >> shifts[c]) & ((1u << bits[c]) - 1) };
+				const u32 v1{ ((u32)c1 >> shifts[c]) & ((1u << bits[c]) - 1) };
+				const u32 p0{ (v0 << (8 - bits[c])) | (v0 >> (2 * bits[c] - 8)) };
+				const u32 p1{ (v1 << (8 - bits[c])) | (v1 >> (2 * bits[c] - 8)) };
+				palette[0][c] = (u8)p0;
+				palette[1][c] = (u8)p1;
+				palette[2][c] = (u8)(is_four_color ? (2 * p0 + p1 + 1) / 3 : (p0 + p1 + 1) / 2);
+				palette[3][c] = (u8)(is_four_color ? (p0 + 2 * p1 + 1) / 3 : 0);
+			}
+			palette[0][3] = palette[1][3] = palette[2][3] = 255;
+			palette[3][3] = is_four_color ? 255 : 0;
+
+			const __m128i colors{ _mm_load_si128((const __m128i*)palette) };
+			for (u32 y{ 0 }; y < 4; y++) {
+				const __m128i shuffle{ _mm_loadu_si128((const __m128i*)color_shuffles.masks[(indices >> (y * 8)) & 0xff]) };
+				_mm_storeu_si128((__m128i*)pixels[y * 4], _mm_shuffle_epi8(colors, shuffle));
+			}
+		}
+
+		// Returns the 16 values of a BC4 style block, looked up in the palette with one shuffle.
+		[[nodiscard]] __m128i DecodeAlphaBlock(const u8* const block) {
+			u8 palette[8];
+			BuildAlphaPalette(block[0], block[1], palette);
+			u64 bits{ 0 };
+			memcpy(&bits, &block[2], 6);
+			alignas(16) u8 indices[block_pixel_count];
+			for (u32 i{ 0 }; i < block_pixel_count; i++) indices[i] = (u8)((bits >> (i * 3)) & 7);
+			return _mm_shuffle_epi8(_mm_loadl_epi64((const __m128i*)palette), _mm_load_si128((const __m128i*)indices));
+		}
+
+		void InsertChannel(__m128i values, u32 channel, u8 (&pixels)[block_pixel_count][4]) {
+			const __m128i channel_mask{ _mm_set1_epi32((s32)(0xffu << (channel * 8))) };
+			for (u32 y{ 0 }; y < 4; y++) {
+				const __m128i row{ _mm_loadu_si128((const __m128i*)pixels[y * 4]) };
+				const __m128i moved{ _mm_shuffle_epi8(values, _mm_loadu_si128((const __m128i*)channel_shuffles.masks[channel][y])) };
+				_mm_storeu_si128((__m128i*)pixels[y * 4], _mm_blendv_epi8(row, moved, channel_mask));
+			}
+		}
+
+		void FillBlock(__m128i pixel, u8 (&pixels)[block_pixel_count][4]) {
+			for (u32 y{ 0 }; y < 4; y++) _mm_storeu_si128((__m128i*)pixels[y * 4], pixel);
+		}
+
+		// Channels outside the mask become 0, or 255 for alpha.
+		void MaskChannels(u32 channel_mask, u8 (&pixels)[block_pixel_count][4]) {
+			u32 keep{ 0 };
+			for (u32 c{ 0 }; c < 4; c++) {
+				if (channel_mask & (1u << c)) keep |= 0xffu << (c * 8);
+			}
+			const __m128i keep_mask{ _mm_set1_epi32((s32)keep) };
+			const __m128i fill{ _mm_set1_epi32((channel_mask & Channel::A) ? 0 : (s32)0xff000000) };
+			for (u32 y{ 0 }; y < 4; y++) {
+				const __m128i row{ _mm_loadu_si128((const __m128i*)pixels[y * 4]) };
+				_mm_storeu_si128((__m128i*)pixels[y * 4], _mm_or_si128(_mm_and_si128(row, keep_mask), fill));
+			}
+		}
+
+		// Decodes the parts of a block that hold channels in channel_mask.
+		void DecodeBlock(const u8* const block, Format::Type format, u32 channel_mask, u8 (&pixels)[block_pixel_count][4]) {
+			const __m128i opaque_black{ _mm_set1_epi32((s32)0xff000000) };
+			switch (format) {
+			case Format::BC1:
+				DecodeColorBlock(block, true, pixels);
+				break;
+			case Format::BC3:
+				if (channel_mask & Channel::RGB) DecodeColorBlock(block + 8, false, pixels);
+				else FillBlock(opaque_black, pixels);
+				if (channel_mask & Channel::A) InsertChannel(DecodeAlphaBlock(block), 3, pixels);
+				break;
+			case Format::BC4:
+			case Format::BC5:
+				FillBlock(opaque_black, pixels);
+				for (u32 c{ 0 }; c < (format == Format::BC4 ? 1u : 2u); c++) {
+					if (channel_mask & (1u << c)) InsertChannel(DecodeAlphaBlock(block + c * 8), c, pixels);
+				}
+				break;
+			case Format::BC7:
+				DecodeBC7Block(block, pixels);
+				break;
+			default:
+				assert(false);
+			}
+
+			if ((channel_mask & Channel::RGBA) != Channel::RGBA) MaskChannels(channel_mask, pixels);
+		}
+
+		// Half to float in 4 lanes, each half in the low 16 bits of its lane, with denormals, infinity and NaN.
+		[[nodiscard]] __m128 HalfToFloat(__m128i half) {
+			const __m128i infinity{ _mm_set1_epi32(0x7c00 << 13) };
+			const __m128i magnitude{ _mm_slli_epi32(_mm_and_si128(half, _mm_set1_epi32(0x7fff)), 13) };
+			const __m128i exponent{ _mm_and_si128(magnitude, infinity) };
+			__m128i bits{ _mm_add_epi32(magnitude, _mm_set1_epi32((127 - 15) << 23)) };
+			bits = _mm_add_epi32(bits, _mm_and_si128(_mm_cmpeq_epi32(exponent, infinity), _mm_set1_epi32((128 - 16) << 23)));
+			// Denormals get the smallest normal exponent, which a subtraction takes away again.
+			const __m128 denormal{ _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(bits, _mm_set1_epi32(1 << 23))), _mm_castsi128_ps(_mm_set1_epi32(113 << 23))) };
+			const __m128 is_denormal{ _mm_castsi128_ps(_mm_cmpeq_epi32(exponent, _mm_setzero_si128())) };
+			const __m128 value{ _mm_blendv_ps(_mm_castsi128_ps(bits), denormal, is_denormal) };
+			return _mm_or_ps(value, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(half, _mm_set1_epi32(0x8000)), 16)));
+		}
+
+		void DecodeBC6HBlockToFloat(const u8* const block, bool is_signed, u32 channel_mask, f32 (&pixels)[block_pixel_count][4]) {
+			u16 halfs[block_pixel_count][4];
+			DecodeBC6HBlock(block, is_signed, halfs);
+			const __m128 keep_mask{ _mm_castsi128_ps(_mm_setr_epi32(channel_mask & Channel::R ? -1 : 0, channel_mask & Channel::G ? -1 : 0,
+				channel_mask & Channel::B ? -1 : 0, channel_mask & Channel::A ? -1 : 0)) };
+			const __m128 fill{ _mm_setr_ps(0.f, 0.f, 0.f, channel_mask & Channel::A ? 0.f : 1.f) };
+			for (u32 i{ 0 }; i < block_pixel_count; i++) {
+				const __m128 pixel{ HalfToFloat(_mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i*)halfs[i]))) };
+				_mm_storeu_ps(pixels[i], _mm_or_ps(_mm_and_ps(pixel, keep_mask), fill));
+			}
+		}
+
+		// Adds one pixel to the sums of its preview pixel.
+		void Accumulate(u32* const sum, const u8 (&pixel)[4]) {
+			u32 value;
+			memcpy(&value, pixel, 4);
+			_mm_storeu_si128((__m128i*)sum, _mm_add_epi32(_mm_loadu_si128((const __m128i*)sum), _mm_cvtepu8_epi32(_mm_cvtsi32_si128((s32)value))));
+		}
+
+		void Accumulate(f32* const sum, const f32 (&pixel)[4]) {
+			_mm_storeu_ps(sum, _mm_add_ps(_mm_loadu_ps(sum), _mm_loadu_ps(pixel)));
+		}
+
+		// Calls decode(block_x, block_y, pixels) for every block and writes the pixels to the image, or adds them up
+		// into a preview 2^scale_shift times smaller. Preview rows are made by bands of whole block rows and whole
+		// preview rows, so every band has its own sums.
+		template<typename T, typename F>
+		void DecodeImage(u32 width, u32 height, u32 scale_shift, u8* const output, u32 row_pitch, F&& decode) {
+			constexpr u32 pixel_size{ 4 * sizeof(T) };
+			if (!scale_shift) {
+				ForEachBlock(width, height, [&](u32 block_x, u32 block_y) {
+					alignas(16) T pixels[block_pixel_count][4];
+					decode(block_x, block_y, pixels);
+					const u32 columns{ std::min(width - block_x * 4, 4u) };
+					for (u32 y{ 0 }; y < 4 && block_y * 4 + y < height; y++) {
+						memcpy(output + (u64)(block_y * 4 + y) * row_pitch + (u64)block_x * 4 * pixel_size, pixels[y * 4], columns * pixel_size);
+					}
+				});
+				return;
+			}
+
+			// 255 * 4^12 still fits in a u32 sum.
+			assert(scale_shift <= 12);
+			using Sum = std::conditional_t<std::is_same_v<T, f32>, f32, u32>;
+			const u32 blocks_x{ (width + 3) / 4 };
+			const u32 blocks_y{ (height + 3) / 4 };
+			const u32 preview_width{ PreviewSize(width, scale_shift) };
+			const u32 preview_height{ PreviewSize(height, scale_shift) };
+			const u32 band_height{ std::max(4u, 1u << scale_shift) };
+			const u32 band_rows{ band_height >> scale_shift };
+			ParallelFor((height + band_height - 1) / band_height, [&](u32 band) {
+				util::vector<Sum> sums((u64)band_rows * preview_width * 4);
+				const u32 first_row{ band * band_rows };
+				const u32 last_block_row{ std::min((band + 1) * band_height / 4, blocks_y) };
+				for (u32 block_y{ band * band_height / 4 }; block_y < last_block_row; block_y++) {
+					for (u32 block_x{ 0 }; block_x < blocks_x; block_x++) {
+						alignas(16) T pixels[block_pixel_count][4];
+						decode(block_x, block_y, pixels);
+						for (u32 y{ 0 }; y < 4 && block_y * 4 + y < height; y++) {
+							Sum* const row{ &sums[(u64)(((block_y * 4 + y) >> scale_shift) - first_row) * preview_width * 4] };
+							for (u32 x{ 0 }; x < 4 && block_x * 4 + x < width; x++) {
+								Accumulate(&row[((block_x * 4 + x) >> scale_shift) * 4], pixels[y * 4 + x]);
+							}
+						}
+					}
+				}
+
+				// Preview pixels at the right and bottom edges can cover fewer pixels.
+				const u32 last_row{ std::min(first_row + band_rows, preview_height) };
+				for (u32 y{ first_row }; y < last_row; y++) {
+					const u32 rows_covered{ std::min(height, (y + 1) << scale_shift) - (y << scale_shift) };
+					const Sum* const row{ &sums[(u64)(y - first_row) * preview_width * 4] };
+					T* const out{ (T*)(output + (u64)y * row_pitch) };
+					for (u32 x{ 0 }; x < preview_width; x++) {
+						const u32 count{ (std::min(width, (x + 1) << scale_shift) - (x << scale_shift)) * rows_covered };
+						for (u32 c{ 0 }; c < 4; c++) {
+							if constexpr (std::is_same_v<T, f32>) out[x * 4 + c] = row[x * 4 + c] / (f32)count;
+							else out[x * 4 + c] = (T)((row[x * 4 + c] + count / 2) / count);
+						}
+					}
+				}
+			});
+		}
+	} // anonymous namespace
+
+	void Compress(const u8* const rgba, u32 width, u32 height, u32 row_pitch, Format::Type format,
+		Quality::Level quality, f32 alpha_threshold, u8* const blocks, u32 block_row_pitch) {
+		assert(rgba && width && height && blocks && format < Format::count && quality < Quality::count);
+		// a pixel is transparent if alpha / 255 < alpha_threshold
+		const u32 alpha_cutoff{ (u32)std::ceil(std::clamp(alpha_threshold, 0.f, 1.f) * 255.f) };
+		const u32 block_size{ BlockSize(format) };
+
+		ForEachBlock(width, height, [&](u32 block_x, u32 block_y) {
+			u8 pixels[block_pixel_count][4];
+			for (u32 y{ 0 }; y < 4; y++) {
+				const u8* const row{ rgba + (u64)std::min(block_y * 4 + y, height - 1) * row_pitch };
+				for (u32 x{ 0 }; x < 4; x++) {
+					memcpy(pixels[y * 4 + x], row + std::min(block_x * 4 + x, width - 1) * 4, 4);
+				}
+			}
+
+			EncodeBlock(pixels, format, quality, alpha_cutoff, blocks + (u64)block_y * block_row_pitch + block_x * block_size);
+		});
+	}
+
+	void Decompress(const u8* const blocks, u32 block_row_pitch, u32 width, u32 height, Format::Type format,
+		u8* const rgba, u32 row_pitch) {
+		DecompressPreview(blocks, block_row_pitch, width, height, format, Channel::RGBA, 0, rgba, row_pitch);
+	}
+
+	void DecompressPreview(const u8* const blocks, u32 block_row_pitch, u32 width, u32 height, Format::Type format,
+		u32 channel_mask, u32 scale_shift, u8* const rgba, u32 row_pitch) {
+		assert(blocks && width && height && rgba && format < Format::count && scale_shift < 16);
+		const u32 block_size{ BlockSize(format) };
+
+		DecodeImage<u8>(width, height, scale_shift, rgba, row_pitch, [&](u32 block_x, u32 block_y, u8 (&pixels)[block_pixel_count][4]) {
+			DecodeBlock(blocks + (u64)block_y * block_row_pitch + block_x * block_size, format, channel_mask, pixels);
+		});
+	}
+
+	void CompressBC6H(const u16* const rgba, u32 width, u32 height, u32 row_pitch, bool is_signed,
+		Quality::Level quality, u8* const blocks, u32 block_row_pitch) {
+		assert(rgba && width && height && blocks && quality < Quality::count);
+		const u8* const bytes{ (const u8*)rgba };
+
+		ForEachBlock(width, height, [&](u32 block_x, u32 block_y) {
+			u16 pixels[block_pixel_count][4];
+			for (u32 y{ 0 }; y < 4; y++) {
+				const u8* const row{ bytes + (u64)std::min(block_y * 4 + y, height - 1) * row_pitch };
+				for (u32 x{ 0 }; x < 4; x++) {
+					memcpy(pixels[y * 4 + x], row + std::min(block_x * 4 + x, width - 1) * sizeof(pixels[0]), sizeof(pixels[0]));
+				}
+			}
+
+			EncodeBC6HBlock(pixels, is_signed, quality, blocks + (u64)block_y * block_row_pitch + block_x * 16);
+		});
+	}
+
+	void DecompressBC6H(const u8* const blocks, u32 block_row_pitch, u32 width, u32 height, bool is_signed,
+		u16* const rgba, u32 row_pitch) {
+		assert(blocks && width && height && rgba);
+		u8* const bytes{ (u8*)rgba };
+
+		ForEachBlock(width, height, [&](u32 block_x, u32 block_y) {
+			u16 pixels[block_pixel_count][4];
+			DecodeBC6HBlock(blocks + (u64)block_y * block_row_pitch + block_x * 16, is_signed, pixels);
+			for (u32 y{ 0 }; y < 4 && block_y * 4 + y < height; y++) {
+				u8* const row{ bytes + (u64)(block_y * 4 + y) * row_pitch };
+				for (u32 x{ 0 }; x < 4 && block_x * 4 + x < width; x++) {
+					memcpy(row + (block_x * 4 + x) * sizeof(pixels[0]), pixels[y * 4 + x], sizeof(pixels[0]));
+				}
+			}
+		});
+	}
+
+	void DecompressBC6HPreview(const u8* const blocks, u32 block_row_pitch, u32 width, u32 height, bool is_signed,
+		u32 channel_mask, u32 scale_shift, f32* const rgba, u32 row_pitch) {
+		assert(blocks && width && height && rgba && scale_shift < 16);
+
+		DecodeImage<f32>(width, height, scale_shift, (u8*)rgba, row_pitch, [&](u32 block_x, u32 block_y, f32 (&pixels)[block_pixel_count][4]) {
+			DecodeBC6HBlockToFloat(blocks + (u64)block_y * block_row_pitch + block_x * 16, is_signed, channel_mask, pixels);
+		});
+	}
+}
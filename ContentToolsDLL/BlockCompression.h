@@ -0,0 +1,78 @@
+#pragma once
+#include "CommonHeaders.h"
+#include "WorkerPool.h"
+
+// CPU block compression for every BC format the importer produces.
+// Works on 8-bit RGBA pixels, or half precision ones for BC6H, and doesn't depend on DirectXTex, D3D or any
+// Windows header, so it also builds and runs on machines without them.
+namespace Zetta::Tools::BC {
+	struct Format {
+		enum Type : u32 {
+			BC1,	// RGB + 1-bit alpha
+			BC3,	// RGB + interpolated alpha
+			BC4,	// red channel only
+			BC5,	// red and green channels
+			BC7,	// RGB or RGBA with up to 3 subsets per block
+
+			count
+		};
+	};
+
+	struct Quality {
+		enum Level : u32 {
+			Fast,		// bounding box endpoints, no refinement. BC6H and BC7 try few modes and partitions.
+			Normal,		// principal axis endpoints with one least-squares refinement
+			High,		// more refinement, endpoint search, BC1's 3-color mode and more BC6H and BC7 partitions
+
+			count
+		};
+	};
+
+	struct Channel {
+		enum Mask : u32 {
+			R = 1,
+			G = 2,
+			B = 4,
+			A = 8,
+			RGB = R | G | B,
+			RGBA = RGB | A,
+		};
+	};
+
+	[[nodiscard]] constexpr u32 BlockSize(Format::Type format) {
+		return (format == Format::BC1 || format == Format::BC4) ? 8 : 16;
+	}
+
+	// Width or height of a preview 2^scale_shift times smaller than the image, rounded up.
+	[[nodiscard]] constexpr u32 PreviewSize(u32 size, u32 scale_shift) {
+		return (u32)(((u64)size + (1ull << scale_shift) - 1) >> scale_shift);
+	}
+
+	// Compresses a whole image. Edge blocks of images that aren't a multiple of 4 in size repeat the last
+	// row and column. In BC1, pixels with alpha below alpha_threshold (0-1) become transparent black.
+	void Compress(const u8* const rgba, u32 width, u32 height, u32 row_pitch, Format::Type format,
+		Quality::Level quality, f32 alpha_threshold, u8* const blocks, u32 block_row_pitch);
+
+	// Decodes back to RGBA. Channels a format doesn't store are written as 0, and alpha as 255, like a texture sample.
+	void Decompress(const u8* const blocks, u32 block_row_pitch, u32 width, u32 height, Format::Type format,
+		u8* const rgba, u32 row_pitch);
+
+	// Decodes a PreviewSize(width, scale_shift) by PreviewSize(height, scale_shift) image to RGBA, each pixel the average
+	// of the pixels it covers, without converting sRGB to linear. Channels outside channel_mask are written as if the
+	// format didn't store them, and blocks that only hold such channels, like the alpha half of BC3, aren't decoded.
+	// Block rows are decoded in parallel. scale_shift is at most 12.
+	void DecompressPreview(const u8* const blocks, u32 block_row_pitch, u32 width, u32 height, Format::Type format,
+		u32 channel_mask, u32 scale_shift, u8* const rgba, u32 row_pitch);
+
+	// BC6H from half precision RGBA pixels. Alpha is ignored and unsigned BC6H clamps negative values to 0.
+	void CompressBC6H(const u16* const rgba, u32 width, u32 height, u32 row_pitch, bool is_signed,
+		Quality::Level quality, u8* const blocks, u32 block_row_pitch);
+
+	// Decodes BC6H to half precision RGBA with alpha 1.
+	void DecompressBC6H(const u8* const blocks, u32 block_row_pitch, u32 width, u32 height, bool is_signed,
+		u16* const rgba, u32 row_pitch);
+
+	// Like DecompressPreview(), for BC6H to f32 RGBA with alpha 1.
+	void DecompressBC6HPreview(const u8* const blocks, u32 block_row_pitch, u32 width, u32 height, bool is_signed,
+		u32 channel_mask, u32 scale_shift, f32* const rgba, u32 row_pitch);
+}
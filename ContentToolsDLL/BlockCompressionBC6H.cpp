@@ -0,0 +1,402 @@
+#include "BlockCompressionCommon.h"
+
+// BC6H encoder. Pixels are compared as half precision bit patterns, which spaces the error roughly like
+// relative error in the values. The one region modes are always tried and the two region modes encode the
+// best ranked partitions, as many as the quality level allows.
+namespace Zetta::Tools::BC::Detail {
+	namespace {
+		struct ModeInfo {
+			u32 region_count;
+			bool is_transformed;	// the endpoints after the first are stored as deltas from it
+			u32 endpoint_bits;
+			u32 delta_bits[3];		// per channel, the same as endpoint_bits in modes that aren't transformed
+			u32 mode_value;
+			u32 mode_bits;
+		};
+
+		constexpr ModeInfo modes[14]{
+			{ 2, true,  10, { 5, 5, 5 },     0, 2 },
+			{ 2, true,   7, { 6, 6, 6 },     1, 2 },
+			{ 2, true,  11, { 5, 4, 4 },     2, 5 },
+			{ 2, true,  11, { 4, 5, 4 },     6, 5 },
+			{ 2, true,  11, { 4, 4, 5 },    10, 5 },
+			{ 2, true,   9, { 5, 5, 5 },    14, 5 },
+			{ 2, true,   8, { 6, 5, 5 },    18, 5 },
+			{ 2, true,   8, { 5, 6, 5 },    22, 5 },
+			{ 2, true,   8, { 5, 5, 6 },    26, 5 },
+			{ 2, false,  6, { 6, 6, 6 },    30, 5 },
+			{ 1, false, 10, { 10, 10, 10 },  3, 5 },
+			{ 1, true,  11, { 9, 9, 9 },     7, 5 },
+			{ 1, true,  12, { 8, 8, 8 },    11, 5 },
+			{ 1, true,  16, { 4, 4, 4 },    15, 5 },
+		};
+
+		// Where every header bit after the mode bits comes from, as field * 16 + bit. The fields are the red,
+		// green and blue of w, x, y and z: both endpoints of region 0, then both of region 1.
+		constexpr u8 header_layout[14][75]{
+			{ 116, 132, 180, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 32, 33,
+			  34, 35, 36, 37, 38, 39, 40, 41, 48, 49, 50, 51, 52, 164, 112, 113, 114, 115, 64, 65, 66, 67, 68, 176, 160,
+			  161, 162, 163, 80, 81, 82, 83, 84, 177, 128, 129, 130, 131, 96, 97, 98, 99, 100, 178, 144, 145, 146, 147, 148, 179 },
+			{ 117, 164, 165, 0, 1, 2, 3, 4, 5, 6, 176, 177, 132, 16, 17, 18, 19, 20, 21, 22, 133, 178, 116, 32, 33,
+			  34, 35, 36, 37, 38, 179, 181, 180, 48, 49, 50, 51, 52, 53, 112, 113, 114, 115, 64, 65, 66, 67, 68, 69, 160,
+			  161, 162, 163, 80, 81, 82, 83, 84, 85, 128, 129, 130, 131, 96, 97, 98, 99, 100, 101, 144, 145, 146, 147, 148, 149 },
+			{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 32, 33, 34, 35, 36,
+			  37, 38, 39, 40, 41, 48, 49, 50, 51, 52, 10, 112, 113, 114, 115, 64, 65, 66, 67, 26, 176, 160, 161, 162, 163,
+			  80, 81, 82, 83, 42, 177, 128, 129, 130, 131, 96, 97, 98, 99, 100, 178, 144, 145, 146, 147, 148, 179 },
+			{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 32, 33, 34, 35, 36,
+			  37, 38, 39, 40, 41, 48, 49, 50, 51, 10, 164, 112, 113, 114, 115, 64, 65, 66, 67, 68, 26, 160, 161, 162, 163,
+			  80, 81, 82, 83, 42, 177, 128, 129, 130, 131, 96, 97, 98, 99, 176, 178, 144, 145, 146, 147, 116, 179 },
+			{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 32, 33, 34, 35, 36,
+			  37, 38, 39, 40, 41, 48, 49, 50, 51, 10, 132, 112, 113, 114, 115, 64, 65, 66, 67, 26, 176, 160, 161, 162, 163,
+			  80, 81, 82, 83, 84, 42, 128, 129, 130, 131, 96, 97, 98, 99, 177, 178, 144, 145, 146, 147, 180, 179 },
+			{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 132, 16, 17, 18, 19, 20, 21, 22, 23, 24, 116, 32, 33, 34, 35, 36,
+			  37, 38, 39, 40, 180, 48, 49, 50, 51, 52, 164, 112, 113, 114, 115, 64, 65, 66, 67, 68, 176, 160, 161, 162, 163,
+			  80, 81, 82, 83, 84, 177, 128, 129, 130, 131, 96, 97, 98, 99, 100, 178, 144, 145, 146, 147, 148, 179 },
+			{ 0, 1, 2, 3, 4, 5, 6, 7, 164, 132, 16, 17, 18, 19, 20, 21, 22, 23, 178, 116, 32, 33, 34, 35, 36,
+			  37, 38, 39, 179, 180, 48, 49, 50, 51, 52, 53, 112, 113, 114, 115, 64, 65, 66, 67, 68, 176, 160, 161, 162, 163,
+			  80, 81, 82, 83, 84, 177, 128, 129, 130, 131, 96, 97, 98, 99, 100, 101, 144, 145, 146, 147, 148, 149 },
+			{ 0, 1, 2, 3, 4, 5, 6, 7, 176, 132, 16, 17, 18, 19, 20, 21, 22, 23, 117, 116, 32, 33, 34, 35, 36,
+			  37, 38, 39, 165, 180, 48, 49, 50, 51, 52, 164, 112, 113, 114, 115, 64, 65, 66, 67, 68, 69, 160, 161, 162, 163,
+			  80, 81, 82, 83, 84, 177, 128, 129, 130, 131, 96, 97, 98, 99, 100, 178, 144, 145, 146, 147, 148, 179 },
+			{ 0, 1, 2, 3, 4, 5, 6, 7, 177, 132, 16, 17, 18, 19, 20, 21, 22, 23, 133, 116, 32, 33, 34, 35, 36,
+			  37, 38, 39, 181, 180, 48, 49, 50, 51, 52, 164, 112, 113, 114, 115, 64, 65, 66, 67, 68, 176, 160, 161, 162, 163,
+			  80, 81, 82, 83, 84, 85, 128, 129, 130, 131, 96, 97, 98, 99, 100, 178, 144, 145, 146, 147, 148, 179 },
+			{ 0, 1, 2, 3, 4, 5, 164, 176, 177, 132, 16, 17, 18, 19, 20, 21, 117, 133, 178, 116, 32, 33, 34, 35, 36,
+			  37, 165, 179, 181, 180, 48, 49, 50, 51, 52, 53, 112, 113, 114, 115, 64, 65, 66, 67, 68, 69, 160, 161, 162, 163,
+			  80, 81, 82, 83, 84, 85, 128, 129, 130, 131, 96, 97, 98, 99, 100, 101, 144, 145, 146, 147, 148, 149 },
+			{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 32, 33, 34, 35, 36,
+			  37, 38, 39, 40, 41, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 64, 65, 66, 67, 68, 69, 70, 71, 72, 73,
+			  80, 81, 82, 83, 84, 85, 86, 87, 88, 89 },
+			{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 32, 33, 34, 35, 36,
+			  37, 38, 39, 40, 41, 48, 49, 50, 51, 52, 53, 54, 55, 56, 10, 64, 65, 66, 67, 68, 69, 70, 71, 72, 26,
+			  80, 81, 82, 83, 84, 85, 86, 87, 88, 42 },
+			{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 32, 33, 34, 35, 36,
+			  37, 38, 39, 40, 41, 48, 49, 50, 51, 52, 53, 54, 55, 11, 10, 64, 65, 66, 67, 68, 69, 70, 71, 27, 26,
+			  80, 81, 82, 83, 84, 85, 86, 87, 43, 42 },
+			{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 32, 33, 34, 35, 36,
+			  37, 38, 39, 40, 41, 48, 49, 50, 51, 15, 14, 13, 12, 11, 10, 64, 65, 66, 67, 31, 30, 29, 28, 27, 26,
+			  80, 81, 82, 83, 47, 46, 45, 44, 43, 42 },
+		};
+
+		struct SearchSettings {
+			u32 partitions;		// best ranked partitions that are encoded with the two region modes
+			u32 axis_iterations;
+			u32 refinements;
+		};
+
+		constexpr SearchSettings search_settings[Quality::count]{
+			{ 0, 0, 1 },
+			{ 2, 3, 1 },
+			{ 8, 6, 2 },
+		};
+
+		// Quantized endpoints of one region and the indices that go with them.
+		struct RegionFit {
+			s32 endpoints[2][3];
+			u8 indices[block_pixel_count];
+			f32 error;
+		};
+
+		struct EncodedBlock {
+			u32 mode;
+			u32 partition;
+			u32 fields[12];		// w, x, y and z as stored
+			u8 indices[block_pixel_count];
+			f32 error;
+		};
+
+		[[nodiscard]] constexpr u32 HeaderBitCount(const ModeInfo& info) {
+			return (info.region_count == 2 ? 77 : 65) - info.mode_bits;
+		}
+
+		[[nodiscard]] constexpr u32 IndexBits(const ModeInfo& info) {
+			return info.region_count == 2 ? 3 : 4;
+		}
+
+		[[nodiscard]] constexpr s32 SignExtend(u32 value, u32 bits) {
+			const u32 shift{ 32 - bits };
+			return (s32)(value << shift) >> shift;
+		}
+
+		// A half as an integer that orders like the value it stands for. Infinity and NaN become the largest
+		// finite value and unsigned BC6H clamps negative values to 0.
+		[[nodiscard]] constexpr s32 HalfToOrdered(u16 half, bool is_signed) {
+			const s32 magnitude{ std::min((s32)(half & 0x7fff), 0x7bff) };
+			if (!(half & 0x8000)) return magnitude;
+			return is_signed ? -magnitude : 0;
+		}
+
+		[[nodiscard]] constexpr u16 OrderedToHalf(s32 value) {
+			return value < 0 ? (u16)(0x8000 | -value) : (u16)value;
+		}
+
+		// Stored endpoint to the 16-bit range that the decoder interpolates in.
+		[[nodiscard]] constexpr s32 Unquantize(s32 value, u32 bits, bool is_signed) {
+			if (!is_signed) {
+				if (bits >= 15 || !value) return value;
+				if (value == (1 << bits) - 1) return 0xffff;
+				return ((value << 15) + 0x4000) >> (bits - 1);
+			}
+
+			if (bits >= 16) return value;
+			const s32 magnitude{ value < 0 ? -value : value };
+			s32 result{ 0 };
+			if (magnitude >= (1 << (bits - 1)) - 1) result = 0x7fff;
+			else if (magnitude) result = ((magnitude << 15) + 0x4000) >> (bits - 1);
+			return value < 0 ? -result : result;
+		}
+
+		// Interpolated value to the ordered half it decodes as.
+		[[nodiscard]] constexpr s32 FinishUnquantize(s32 value, bool is_signed) {
+			if (!is_signed) return (value * 31) >> 6;
+			return value < 0 ? -((-value * 31) >> 5) : (value * 31) >> 5;
+		}
+
+		// The stored endpoint that unquantizes closest to an ordered half.
+		s32 QuantizeEndpoint(f32 value, u32 bits, bool is_signed) {
+			// finishing scales by 31/64 for unsigned and 31/32 for signed, so undo that first
+			const f32 target{ value * (is_signed ? 32.f / 31.f : 64.f / 31.f) };
+			const s32 max{ is_signed ? (1 << (bits - 1)) - 1 : (1 << bits) - 1 };
+			const s32 min{ is_signed ? -max : 0 };
+			const s32 guess{ std::clamp((s32)std::lround(std::ldexp(target, (s32)bits - 16)), min, max) };
+			s32 best{ guess };
+			f32 best_error{ FLT_MAX };
+			for (s32 q{ std::max(guess - 1, min) }; q <= std::min(guess + 1, max); q++) {
+				const f32 d{ (f32)Unquantize(q, bits, is_signed) - target };
+				if (d * d < best_error) {
+					best_error = d * d;
+					best = q;
+				}
+			}
+			return best;
+		}
+
+		// Picks the indices for the region's endpoints. The most significant index bit of the anchor pixel isn't
+		// stored, so if it comes out as 1 either the endpoints are swapped or the anchor is limited to the first
+		// half of the palette when the endpoints can't change anymore.
+		void EvaluateRegion(const Block& block, const f32 (&weights)[block_pixel_count], const ModeInfo& info, bool is_signed,
+			u32 anchor, bool can_swap, RegionFit& fit) {
+			const u32 index_bits{ IndexBits(info) };
+			const u32* const interpolation{ InterpolationWeights(index_bits) };
+			const u32 palette_size{ 1u << index_bits };
+			s32 unquantized[2][3];
+			for (u32 e{ 0 }; e < 2; e++) {
+				for (u32 c{ 0 }; c < 3; c++) unquantized[e][c] = Unquantize(fit.endpoints[e][c], info.endpoint_bits, is_signed);
+			}
+
+			f32 palette[16][4];
+			for (u32 p{ 0 }; p < palette_size; p++) {
+				const s32 w{ (s32)interpolation[p] };
+				for (u32 c{ 0 }; c < 3; c++) {
+					palette[p][c] = (f32)FinishUnquantize(((64 - w) * unquantized[0][c] + w * unquantized[1][c] + 32) >> 6, is_signed);
+				}
+				palette[p][3] = 0.f;
+			}
+
+			fit.error = FitIndices(block, weights, palette, palette_size, fit.indices);
+			if (fit.indices[anchor] < palette_size / 2) return;
+
+			if (can_swap) {
+				std::swap(fit.endpoints[0], fit.endpoints[1]);
+				for (u8& index : fit.indices) index = (u8)(palette_size - 1 - index);
+				return;
+			}
+
+			const auto distance = [&](u32 p) {
+				f32 total{ 0.f };
+				for (u32 c{ 0 }; c < 3; c++) {
+					const f32 d{ block.channels[c][anchor] - palette[p][c] };
+					total += d * d;
+				}
+				return total;
+			};
+
+			u32 best{ 0 };
+			for (u32 p{ 1 }; p < palette_size / 2; p++) {
+				if (distance(p) < distance(best)) best = p;
+			}
+			fit.error += distance(best) - distance(fit.indices[anchor]);
+			fit.indices[anchor] = (u8)best;
+		}
+
+		void FitRegion(const Block& block, const f32 (&weights)[block_pixel_count], const f32 (&initial)[2][4], const ModeInfo& info,
+			bool is_signed, u32 anchor, const SearchSettings& settings, RegionFit& fit) {
+			for (u32 e{ 0 }; e < 2; e++) {
+				for (u32 c{ 0 }; c < 3; c++) fit.endpoints[e][c] = QuantizeEndpoint(initial[e][c], info.endpoint_bits, is_signed);
+			}
+			EvaluateRegion(block, weights, info, is_signed, anchor, true, fit);
+
+			f32 endpoints[2][4];
+			for (u32 i{ 0 }; i < settings.refinements && fit.error > 0.f; i++) {
+				if (!FitEndpoints(block, weights, fit.indices, IndexBits(info), endpoints)) break;
+				RegionFit refined;
+				for (u32 e{ 0 }; e < 2; e++) {
+					for (u32 c{ 0 }; c < 3; c++) refined.endpoints[e][c] = QuantizeEndpoint(endpoints[e][c], info.endpoint_bits, is_signed);
+				}
+				EvaluateRegion(block, weights, info, is_signed, anchor, true, refined);
+				if (refined.error >= fit.error) break;
+				fit = refined;
+			}
+		}
+
+		// 'initial' has the unquantized endpoints of every region of the partition.
+		void EncodeMode(const Block& block, u32 mode, u32 partition, const f32 (&initial)[2][2][4], bool is_signed,
+			const SearchSettings& settings, EncodedBlock& best) {
+			const ModeInfo& info{ modes[mode] };
+			f32 weights[2][block_pixel_count];
+			RegionFit fits[2];
+			f32 error{ 0.f };
+			for (u32 s{ 0 }; s < info.region_count; s++) {
+				for (u32 i{ 0 }; i < block_pixel_count; i++) weights[s][i] = Subset(info.region_count, partition, i) == s ? 1.f : 0.f;
+				FitRegion(block, weights[s], initial[s], info, is_signed, Anchor(info.region_count, partition, s), settings, fits[s]);
+				error += fits[s].error;
+				if (error >= best.error) return;
+			}
+
+			// Deltas that don't fit are clamped, which moves the endpoint toward w, and the region is refit.
+			const u32 endpoint_count{ info.region_count * 2 };
+			if (info.is_transformed) {
+				bool is_clamped[2]{};
+				for (u32 k{ 1 }; k < endpoint_count; k++) {
+					for (u32 c{ 0 }; c < 3; c++) {
+						const s32 base{ fits[0].endpoints[0][c] };
+						const s32 limit{ 1 << (info.delta_bits[c] - 1) };
+						s32& value{ fits[k / 2].endpoints[k % 2][c] };
+						const s32 delta{ std::clamp(value - base, -limit, limit - 1) };
+						is_clamped[k / 2] |= value != base + delta;
+						value = base + delta;
+					}
+				}
+
+				error = 0.f;
+				for (u32 s{ 0 }; s < info.region_count; s++) {
+					if (is_clamped[s]) EvaluateRegion(block, weights[s], info, is_signed, Anchor(info.region_count, partition, s), false, fits[s]);
+					error += fits[s].error;
+				}
+				if (error >= best.error) return;
+			}
+
+			best.mode = mode;
+			best.partition = partition;
+			best.error = error;
+			for (u32 k{ 0 }; k < endpoint_count; k++) {
+				for (u32 c{ 0 }; c < 3; c++) {
+					const s32 value{ fits[k / 2].endpoints[k % 2][c] };
+					const bool is_delta{ k && info.is_transformed };
+					const u32 bits{ k ? info.delta_bits[c] : info.endpoint_bits };
+					best.fields[k * 3 + c] = (u32)(is_delta ? value - fits[0].endpoints[0][c] : value) & ((1u << bits) - 1);
+				}
+			}
+			for (u32 k{ endpoint_count }; k < 4; k++) {
+				for (u32 c{ 0 }; c < 3; c++) best.fields[k * 3 + c] = 0;
+			}
+			for (u32 i{ 0 }; i < block_pixel_count; i++) best.indices[i] = fits[Subset(info.region_count, partition, i)].indices[i];
+		}
+
+		void WriteBlock(const EncodedBlock& encoded, u8* const output) {
+			const ModeInfo& info{ modes[encoded.mode] };
+			BitWriter writer;
+			writer.Write(info.mode_value, info.mode_bits);
+			for (u32 i{ 0 }; i < HeaderBitCount(info); i++) {
+				const u8 entry{ header_layout[encoded.mode][i] };
+				writer.Write(encoded.fields[entry >> 4] >> (entry & 15), 1);
+			}
+			if (info.region_count == 2) writer.Write(encoded.partition, 5);
+
+			for (u32 i{ 0 }; i < block_pixel_count; i++) {
+				writer.Write(encoded.indices[i], IndexBits(info) - (IsAnchor(info.region_count, encoded.partition, i) ? 1 : 0));
+			}
+
+			writer.Store(output);
+		}
+	} // anonymous namespace
+
+	void EncodeBC6HBlock(const u16 (&pixels)[block_pixel_count][4], bool is_signed, Quality::Level quality, u8* const output) {
+		const SearchSettings& settings{ search_settings[quality] };
+		Block block;
+		for (u32 i{ 0 }; i < block_pixel_count; i++) {
+			for (u32 c{ 0 }; c < 3; c++) block.channels[c][i] = (f32)HalfToOrdered(pixels[i][c], is_signed);
+			block.channels[3][i] = 0.f;
+		}
+
+		EncodedBlock best{};
+		best.error = FLT_MAX;
+		f32 weights[block_pixel_count];
+		f32 initial[2][2][4];
+		for (f32& weight : weights) weight = 1.f;
+		PrincipalAxisEndpoints(block, weights, settings.axis_iterations, initial[0]);
+		for (u32 mode{ 10 }; mode < 14 && best.error > 0.f; mode++) EncodeMode(block, mode, 0, initial, is_signed, settings, best);
+
+		if (best.error > 0.f && settings.partitions) {
+			f32 errors[64];
+			u8 ranked[64];
+			EstimatePartitionErrors<3>(block, 2, 32, errors);
+			const u32 count{ RankPartitions(errors, 32, settings.partitions, ranked) };
+			for (u32 i{ 0 }; i < count; i++) {
+				for (u32 s{ 0 }; s < 2; s++) {
+					for (u32 p{ 0 }; p < block_pixel_count; p++) weights[p] = Subset(2, ranked[i], p) == s ? 1.f : 0.f;
+					PrincipalAxisEndpoints(block, weights, settings.axis_iterations, initial[s]);
+				}
+				for (u32 mode{ 0 }; mode < 10 && best.error > 0.f; mode++) EncodeMode(block, mode, ranked[i], initial, is_signed, settings, best);
+			}
+		}
+
+		WriteBlock(best, output);
+	}
+
+	void DecodeBC6HBlock(const u8* const block, bool is_signed, u16 (&pixels)[block_pixel_count][4]) {
+		BitReader reader{ block };
+		u32 mode_value{ reader.Read(2) };
+		if (mode_value > 1) mode_value |= reader.Read(3) << 2;
+		u32 mode{ 0 };
+		while (mode < 14 && modes[mode].mode_value != mode_value) mode++;
+		if (mode == 14) {
+			// reserved mode, decodes as black
+			for (u32 i{ 0 }; i < block_pixel_count; i++) {
+				pixels[i][0] = pixels[i][1] = pixels[i][2] = 0;
+				pixels[i][3] = 0x3c00;
+			}
+			return;
+		}
+
+		const ModeInfo& info{ modes[mode] };
+		u32 fields[12]{};
+		for (u32 i{ 0 }; i < HeaderBitCount(info); i++) {
+			const u8 entry{ header_layout[mode][i] };
+			fields[entry >> 4] |= reader.Read(1) << (entry & 15);
+		}
+		const u32 partition{ info.region_count == 2 ? reader.Read(5) : 0 };
+
+		const u32 endpoint_count{ info.region_count * 2 };
+		s32 endpoints[4][3];
+		for (u32 c{ 0 }; c < 3; c++) {
+			const s32 mask{ (1 << info.endpoint_bits) - 1 };
+			endpoints[0][c] = is_signed ? SignExtend(fields[c], info.endpoint_bits) : (s32)fields[c];
+			for (u32 k{ 1 }; k < endpoint_count; k++) {
+				const u32 field{ fields[k * 3 + c] };
+				s32 value{ info.is_transformed || is_signed ? SignExtend(field, info.delta_bits[c]) : (s32)field };
+				if (info.is_transformed) {
+					value = (endpoints[0][c] + value) & mask;
+					if (is_signed) value = SignExtend((u32)value, info.endpoint_bits);
+				}
+				endpoints[k][c] = value;
+			}
+		}
+		for (u32 k{ 0 }; k < endpoint_count; k++) {
+			for (u32 c{ 0 }; c < 3; c++) endpoints[k][c] = Unquantize(endpoints[k][c], info.endpoint_bits, is_signed);
+		}
+
+		const u32 index_bits{ IndexBits(info) };
+		const u32* const interpolation{ InterpolationWeights(index_bits) };
+		for (u32 i{ 0 }; i < block_pixel_count; i++) {
+			const u32 index{ reader.Read(index_bits - (IsAnchor(info.region_count, partition, i) ? 1 : 0)) };
+			const u32 s{ Subset(info.region_count, partition, i) };
+			const s32 w{ (s32)interpolation[index] };
+			for (u32 c{ 0 }; c < 3; c++) {
+				const s32 value{ ((64 - w) * endpoints[s * 2][c] + w * endpoints[s * 2 + 1][c] + 32) >> 6 };
+				pixels[i][c] = OrderedToHalf(FinishUnquantize(value, is_signed));
+			}
+			pixels[i][3] = 0x3c00;
+		}
+	}
+}
@@ -0,0 +1,442 @@
+#include "BlockCompressionCommon.h"
+
+// BC7 encoder. Every block tries the modes that suit it: modes 0-3 and 6 for opaque blocks and modes 4-7 for
+// blocks with alpha. Partitions are ranked by how well a line fits each of their subsets and only the best
+// ones, as many as the quality level allows, are encoded.
+namespace Zetta::Tools::BC::Detail {
+	namespace {
+		struct ModeInfo {
+			u32 subset_count;
+			u32 partition_bits;
+			u32 rotation_bits;
+			u32 index_selection_bits;
+			u32 color_bits;
+			u32 alpha_bits;
+			u32 endpoint_pbits;		// one p-bit per endpoint
+			u32 shared_pbits;		// one p-bit per subset
+			u32 index_bits;
+			u32 index2_bits;		// second index set of modes 4 and 5
+		};
+
+		constexpr ModeInfo modes[8]{
+			{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+			{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+			{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+			{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+			{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+			{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+			{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+			{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+		};
+
+		struct SearchSettings {
+			u32 partitions2;		// best ranked partitions that are encoded with 2 subsets
+			u32 partitions3;		// and with 3 subsets
+			u32 axis_iterations;
+			u32 refinements;
+			bool all_modes;			// modes 3 and 4, which rarely beat modes 1 and 5
+			bool all_rotations;		// modes 4 and 5 also try giving red, green or blue their own indices
+			bool exhaustive_pbits;	// evaluate every p-bit combination instead of picking them per endpoint
+			f32 good_enough_error;	// squared error per pixel below which a single subset block skips the partition search
+		};
+
+		constexpr SearchSettings search_settings[Quality::count]{
+			{  1, 0, 0, 1, false, false, false, 1.f },
+			{  4, 2, 3, 1, true,  true,  false, .5f },
+			{ 16, 8, 6, 2, true,  true,  true,  0.f },
+		};
+
+		// How the endpoints of a subset are stored.
+		struct EndpointFormat {
+			u32 bits[4];		// per channel. Channels with 0 bits aren't stored and decode as 255.
+			u32 pbits;			// 0, 1 shared by both endpoints or 2, one per endpoint
+			u32 index_bits;
+		};
+
+		struct SubsetFit {
+			u8 endpoints[2][4];	// without p-bits
+			u8 pbits[2];
+			u8 indices[block_pixel_count];
+			f32 error;
+		};
+
+		struct EncodedBlock {
+			u32 mode;
+			u32 partition;
+			u32 rotation;
+			u32 index_selection;
+			u8 endpoints[3][2][4];
+			u8 pbits[3][2];
+			u8 indices[block_pixel_count];
+			u8 indices2[block_pixel_count];
+			f32 error;
+		};
+
+		// Expands an n-bit value to 8 bits by repeating its high bits.
+		[[nodiscard]] constexpr u32 Expand(u32 value, u32 bits) {
+			value <<= 8 - bits;
+			return value | (value >> bits);
+		}
+
+		[[nodiscard]] constexpr u32 Dequantize(u32 value, u32 bits, u32 pbits, u32 pbit) {
+			if (!bits) return 255;
+			return pbits ? Expand((value << 1) | pbit, bits + 1) : Expand(value, bits);
+		}
+
+		// The stored value that decodes closest to 'value' with the given p-bit.
+		u32 QuantizeChannel(f32 value, u32 bits, u32 pbits, u32 pbit, f32& error) {
+			const s32 max{ (s32)(1u << bits) - 1 };
+			const u32 total_bits{ bits + (pbits ? 1 : 0) };
+			const f32 scaled{ std::clamp(value, 0.f, 255.f) * (f32)((1u << total_bits) - 1) * (1.f / 255.f) };
+			const s32 guess{ (s32)(pbits ? (scaled - (f32)pbit) * 0.5f + 0.5f : scaled + 0.5f) };
+			u32 best{ 0 };
+			error = FLT_MAX;
+			for (s32 q{ std::max(guess - 1, 0) }; q <= std::min(guess + 1, max); q++) {
+				const f32 d{ (f32)Dequantize((u32)q, bits, pbits, pbit) - value };
+				if (d * d < error) {
+					error = d * d;
+					best = (u32)q;
+				}
+			}
+			return best;
+		}
+
+		f32 QuantizeEndpoint(const f32 (&endpoint)[4], const EndpointFormat& format, u32 pbit, u8 (&quantized)[4]) {
+			f32 total{ 0.f };
+			for (u32 c{ 0 }; c < 4; c++) {
+				quantized[c] = 0;
+				if (!format.bits[c]) continue;
+				f32 error;
+				quantized[c] = (u8)QuantizeChannel(endpoint[c], format.bits[c], format.pbits, pbit, error);
+				total += error;
+			}
+			return total;
+		}
+
+		void EvaluateSubset(const Block& block, const f32 (&weights)[block_pixel_count], const EndpointFormat& format, SubsetFit& fit) {
+			u32 decoded[2][4];
+			for (u32 e{ 0 }; e < 2; e++) {
+				for (u32 c{ 0 }; c < 4; c++) decoded[e][c] = Dequantize(fit.endpoints[e][c], format.bits[c], format.pbits, fit.pbits[e]);
+			}
+
+			const u32* const interpolation{ InterpolationWeights(format.index_bits) };
+			const u32 palette_size{ 1u << format.index_bits };
+			f32 palette[16][4];
+			for (u32 p{ 0 }; p < palette_size; p++) {
+				const u32 w{ interpolation[p] };
+				for (u32 c{ 0 }; c < 4; c++) palette[p][c] = (f32)(((64 - w) * decoded[0][c] + w * decoded[1][c] + 32) >> 6);
+			}
+
+			fit.error = FitIndices(block, weights, palette, palette_size, fit.indices);
+		}
+
+		void QuantizeSubset(const Block& block, const f32 (&weights)[block_pixel_count], const EndpointFormat& format,
+			const f32 (&endpoints)[2][4], bool exhaustive_pbits, SubsetFit& fit) {
+			if (!format.pbits) {
+				fit.pbits[0] = fit.pbits[1] = 0;
+				for (u32 e{ 0 }; e < 2; e++) QuantizeEndpoint(endpoints[e], format, 0, fit.endpoints[e]);
+			}
+			else if (exhaustive_pbits) {
+				const u32 combinations{ format.pbits == 1 ? 2u : 4u };
+				fit.error = FLT_MAX;
+				for (u32 i{ 0 }; i < combinations; i++) {
+					SubsetFit candidate;
+					candidate.pbits[0] = (u8)(i & 1);
+					candidate.pbits[1] = (u8)(format.pbits == 1 ? i & 1 : i >> 1);
+					for (u32 e{ 0 }; e < 2; e++) QuantizeEndpoint(endpoints[e], format, candidate.pbits[e], candidate.endpoints[e]);
+					EvaluateSubset(block, weights, format, candidate);
+					if (candidate.error < fit.error) fit = candidate;
+				}
+				return;
+			}
+			else if (format.pbits == 2) {
+				// The p-bit of each endpoint that quantizes it best.
+				for (u32 e{ 0 }; e < 2; e++) {
+					u8 quantized[4];
+					const f32 error0{ QuantizeEndpoint(endpoints[e], format, 0, fit.endpoints[e]) };
+					const f32 error1{ QuantizeEndpoint(endpoints[e], format, 1, quantized) };
+					fit.pbits[e] = error1 < error0;
+					if (fit.pbits[e]) memcpy(fit.endpoints[e], quantized, sizeof(quantized));
+				}
+			}
+			else {
+				SubsetFit odd;
+				const f32 error0{ QuantizeEndpoint(endpoints[0], format, 0, fit.endpoints[0]) + QuantizeEndpoint(endpoints[1], format, 0, fit.endpoints[1]) };
+				const f32 error1{ QuantizeEndpoint(endpoints[0], format, 1, odd.endpoints[0]) + QuantizeEndpoint(endpoints[1], format, 1, odd.endpoints[1]) };
+				fit.pbits[0] = fit.pbits[1] = error1 < error0;
+				if (fit.pbits[0]) memcpy(fit.endpoints, odd.endpoints, sizeof(odd.endpoints));
+			}
+
+			EvaluateSubset(block, weights, format, fit);
+		}
+
+		void FitSubset(const Block& block, const f32 (&weights)[block_pixel_count], const EndpointFormat& format,
+			const SearchSettings& settings, SubsetFit& fit) {
+			f32 endpoints[2][4];
+			PrincipalAxisEndpoints(block, weights, settings.axis_iterations, endpoints);
+			QuantizeSubset(block, weights, format, endpoints, settings.exhaustive_pbits, fit);
+			for (u32 i{ 0 }; i < settings.refinements && fit.error > 0.f; i++) {
+				if (!FitEndpoints(block, weights, fit.indices, format.index_bits, endpoints)) break;
+				SubsetFit refined;
+				QuantizeSubset(block, weights, format, endpoints, settings.exhaustive_pbits, refined);
+				if (refined.error >= fit.error) break;
+				fit = refined;
+			}
+		}
+
+		// The most significant index bit of an anchor pixel isn't stored and has to be 0. Swapping the endpoints
+		// and inverting the indices gives the same colors.
+		void MakeAnchorImplicit(SubsetFit& fit, u32 index_bits, u32 anchor) {
+			if (fit.indices[anchor] < (1u << (index_bits - 1))) return;
+			std::swap(fit.endpoints[0], fit.endpoints[1]);
+			std::swap(fit.pbits[0], fit.pbits[1]);
+			const u8 max{ (u8)((1u << index_bits) - 1) };
+			for (u8& index : fit.indices) index = max - index;
+		}
+
+		// Modes where all channels share the indices: 0-3, 6 and 7.
+		void EncodeMode(const Block& block, u32 mode, u32 partition, const SearchSettings& settings, EncodedBlock& best) {
+			const ModeInfo& info{ modes[mode] };
+			const EndpointFormat format{ { info.color_bits, info.color_bits, info.color_bits, info.alpha_bits },
+				info.endpoint_pbits ? 2u : info.shared_pbits, info.index_bits };
+
+			EncodedBlock encoded{};
+			encoded.mode = mode;
+			encoded.partition = partition;
+			for (u32 s{ 0 }; s < info.subset_count; s++) {
+				f32 weights[block_pixel_count];
+				for (u32 i{ 0 }; i < block_pixel_count; i++) weights[i] = Subset(info.subset_count, partition, i) == s ? 1.f : 0.f;
+
+				SubsetFit fit;
+				FitSubset(block, weights, format, settings, fit);
+				encoded.error += fit.error;
+				if (encoded.error >= best.error) return;
+
+				MakeAnchorImplicit(fit, info.index_bits, Anchor(info.subset_count, partition, s));
+				memcpy(encoded.endpoints[s], fit.endpoints, sizeof(fit.endpoints));
+				memcpy(encoded.pbits[s], fit.pbits, sizeof(fit.pbits));
+				for (u32 i{ 0 }; i < block_pixel_count; i++) {
+					if (weights[i]) encoded.indices[i] = fit.indices[i];
+				}
+			}
+
+			best = encoded;
+		}
+
+		// Modes 4 and 5 give one channel its own endpoints and indices. The rotation swaps alpha with red,
+		// green or blue, so that channel becomes the separate one.
+		void EncodeSeparateAlphaMode(const Block& block, u32 mode, u32 rotation, u32 index_selection, const SearchSettings& settings, EncodedBlock& best) {
+			const ModeInfo& info{ modes[mode] };
+			Block color, scalar;
+			for (u32 c{ 0 }; c < 4; c++) {
+				const u32 source{ rotation && (c == 3 || c == rotation - 1) ? (c == 3 ? rotation - 1 : 3) : c };
+				for (u32 i{ 0 }; i < block_pixel_count; i++) {
+					color.channels[c][i] = c < 3 ? block.channels[source][i] : 255.f;
+					scalar.channels[c][i] = c < 3 ? 255.f : block.channels[source][i];
+				}
+			}
+
+			// With index selection 1, mode 4 uses the 3-bit indices for color and the 2-bit ones for alpha.
+			const u32 color_index_bits{ index_selection ? info.index2_bits : info.index_bits };
+			const u32 scalar_index_bits{ index_selection ? info.index_bits : info.index2_bits };
+			const EndpointFormat color_format{ { info.color_bits, info.color_bits, info.color_bits, 0 }, 0, color_index_bits };
+			const EndpointFormat scalar_format{ { 0, 0, 0, info.alpha_bits }, 0, scalar_index_bits };
+			f32 weights[block_pixel_count];
+			for (f32& weight : weights) weight = 1.f;
+
+			SubsetFit color_fit, scalar_fit;
+			FitSubset(color, weights, color_format, settings, color_fit);
+			if (color_fit.error >= best.error) return;
+			FitSubset(scalar, weights, scalar_format, settings, scalar_fit);
+			if (color_fit.error + scalar_fit.error >= best.error) return;
+
+			MakeAnchorImplicit(color_fit, color_index_bits, 0);
+			MakeAnchorImplicit(scalar_fit, scalar_index_bits, 0);
+
+			EncodedBlock encoded{};
+			encoded.mode = mode;
+			encoded.rotation = rotation;
+			encoded.index_selection = index_selection;
+			for (u32 e{ 0 }; e < 2; e++) {
+				for (u32 c{ 0 }; c < 3; c++) encoded.endpoints[0][e][c] = color_fit.endpoints[e][c];
+				encoded.endpoints[0][e][3] = scalar_fit.endpoints[e][3];
+			}
+			memcpy(encoded.indices, index_selection ? scalar_fit.indices : color_fit.indices, sizeof(encoded.indices));
+			memcpy(encoded.indices2, index_selection ? color_fit.indices : scalar_fit.indices, sizeof(encoded.indices2));
+			encoded.error = color_fit.error + scalar_fit.error;
+			best = encoded;
+		}
+
+		void WriteBlock(const EncodedBlock& encoded, u8* const output) {
+			const ModeInfo& info{ modes[encoded.mode] };
+			BitWriter writer;
+			writer.Write(1u << encoded.mode, encoded.mode + 1);
+			writer.Write(encoded.partition, info.partition_bits);
+			writer.Write(encoded.rotation, info.rotation_bits);
+			writer.Write(encoded.index_selection, info.index_selection_bits);
+			for (u32 c{ 0 }; c < 4; c++) {
+				const u32 bits{ c < 3 ? info.color_bits : info.alpha_bits };
+				for (u32 s{ 0 }; s < info.subset_count; s++) {
+					for (u32 e{ 0 }; e < 2; e++) writer.Write(encoded.endpoints[s][e][c], bits);
+				}
+			}
+
+			for (u32 s{ 0 }; s < info.subset_count; s++) {
+				if (info.endpoint_pbits) {
+					writer.Write(encoded.pbits[s][0], 1);
+					writer.Write(encoded.pbits[s][1], 1);
+				}
+				else if (info.shared_pbits) writer.Write(encoded.pbits[s][0], 1);
+			}
+
+			for (u32 i{ 0 }; i < block_pixel_count; i++) {
+				writer.Write(encoded.indices[i], info.index_bits - (IsAnchor(info.subset_count, encoded.partition, i) ? 1 : 0));
+			}
+			if (info.index2_bits) {
+				for (u32 i{ 0 }; i < block_pixel_count; i++) writer.Write(encoded.indices2[i], info.index2_bits - (i ? 0 : 1));
+			}
+
+			writer.Store(output);
+		}
+	} // anonymous namespace
+
+	void EncodeBC7Block(const u8 (&pixels)[block_pixel_count][4], Quality::Level quality, u8* const output) {
+		const SearchSettings& settings{ search_settings[quality] };
+		Block block;
+		bool is_opaque{ true };
+		for (u32 i{ 0 }; i < block_pixel_count; i++) {
+			for (u32 c{ 0 }; c < 4; c++) block.channels[c][i] = pixels[i][c];
+			is_opaque &= pixels[i][3] == 255;
+		}
+
+		EncodedBlock best{};
+		best.error = FLT_MAX;
+		EncodeMode(block, 6, 0, settings, best);
+		if (best.error <= settings.good_enough_error * block_pixel_count) {
+			WriteBlock(best, output);
+			return;
+		}
+
+		f32 errors[64];
+		u8 ranked[64];
+		if (is_opaque) {
+			if (best.error > 0.f && settings.partitions2) {
+				EstimatePartitionErrors<3>(block, 2, 64, errors);
+				const u32 count{ RankPartitions(errors, 64, settings.partitions2, ranked) };
+				for (u32 i{ 0 }; i < count; i++) {
+					EncodeMode(block, 1, ranked[i], settings, best);
+					if (settings.all_modes) EncodeMode(block, 3, ranked[i], settings, best);
+				}
+			}
+
+			if (best.error > 0.f && settings.partitions3) {
+				EstimatePartitionErrors<3>(block, 3, 64, errors);
+				u32 count{ RankPartitions(errors, 64, settings.partitions3, ranked) };
+				for (u32 i{ 0 }; i < count; i++) EncodeMode(block, 2, ranked[i], settings, best);
+				// mode 0 only has the first 16 partitions
+				count = RankPartitions(errors, 16, settings.partitions3, ranked);
+				for (u32 i{ 0 }; i < count; i++) EncodeMode(block, 0, ranked[i], settings, best);
+			}
+		}
+		else {
+			const u32 rotations{ settings.all_rotations ? 4u : 1u };
+			for (u32 rotation{ 0 }; rotation < rotations && best.error > 0.f; rotation++) {
+				EncodeSeparateAlphaMode(block, 5, rotation, 0, settings, best);
+				if (settings.all_modes) {
+					EncodeSeparateAlphaMode(block, 4, rotation, 0, settings, best);
+					EncodeSeparateAlphaMode(block, 4, rotation, 1, settings, best);
+				}
+			}
+
+			if (best.error > 0.f && settings.all_modes) {
+				EstimatePartitionErrors<4>(block, 2, 64, errors);
+				const u32 count{ RankPartitions(errors, 64, settings.partitions2, ranked) };
+				for (u32 i{ 0 }; i < count; i++) EncodeMode(block, 7, ranked[i], settings, best);
+			}
+		}
+
+		WriteBlock(best, output);
+	}
+
+	void DecodeBC7Block(const u8* const block, u8 (&pixels)[block_pixel_count][4]) {
+		BitReader reader{ block };
+		u32 mode{ 0 };
+		while (mode < 8 && !reader.Read(1)) mode++;
+		if (mode == 8) {
+			// reserved mode, decodes as transparent black
+			memset(pixels, 0, sizeof(pixels));
+			return;
+		}
+
+		const ModeInfo& info{ modes[mode] };
+		const u32 partition{ reader.Read(info.partition_bits) };
+		const u32 rotation{ reader.Read(info.rotation_bits) };
+		const u32 index_selection{ reader.Read(info.index_selection_bits) };
+		const u32 bits[4]{ info.color_bits, info.color_bits, info.color_bits, info.alpha_bits };
+		u32 endpoints[3][2][4]{};
+		for (u32 c{ 0 }; c < 4; c++) {
+			for (u32 s{ 0 }; s < info.subset_count; s++) {
+				for (u32 e{ 0 }; e < 2; e++) endpoints[s][e][c] = reader.Read(bits[c]);
+			}
+		}
+
+		u32 pbits[3][2]{};
+		for (u32 s{ 0 }; s < info.subset_count; s++) {
+			if (info.endpoint_pbits) {
+				pbits[s][0] = reader.Read(1);
+				pbits[s][1] = reader.Read(1);
+			}
+			else if (info.shared_pbits) pbits[s][0] = pbits[s][1] = reader.Read(1);
+		}
+
+		u32 indices[block_pixel_count]{}, indices2[block_pixel_count]{};
+		for (u32 i{ 0 }; i < block_pixel_count; i++) indices[i] = reader.Read(info.index_bits - (IsAnchor(info.subset_count, partition, i) ? 1 : 0));
+		if (info.index2_bits) {
+			for (u32 i{ 0 }; i < block_pixel_count; i++) indices2[i] = reader.Read(info.index2_bits - (i ? 0 : 1));
+		}
+
+		const u32 pbit_count{ info.endpoint_pbits ? 2u : info.shared_pbits };
+		for (u32 s{ 0 }; s < info.subset_count; s++) {
+			for (u32 e{ 0 }; e < 2; e++) {
+				for (u32 c{ 0 }; c < 4; c++) endpoints[s][e][c] = Dequantize(endpoints[s][e][c], bits[c], pbit_count, pbits[s][e]);
+			}
+		}
+
+		// Endpoints as 16-bit lanes, so 2 pixels are interpolated at once.
+		alignas(16) u16 endpoint_lanes[3][2][4];
+		for (u32 s{ 0 }; s < info.subset_count; s++) {
+			for (u32 e{ 0 }; e < 2; e++) {
+				for (u32 c{ 0 }; c < 4; c++) endpoint_lanes[s][e][c] = (u16)endpoints[s][e][c];
+			}
+		}
+
+		const u32* const color_weights{ InterpolationWeights(index_selection ? info.index2_bits : info.index_bits) };
+		const u32* const alpha_weights{ info.index2_bits ? InterpolationWeights(index_selection ? info.index_bits : info.index2_bits) : color_weights };
+		const __m128i sixty_four{ _mm_set1_epi16(64) };
+		for (u32 i{ 0 }; i < block_pixel_count; i += 2) {
+			u16 weights[2][2];
+			__m128i lanes[2][2];
+			for (u32 p{ 0 }; p < 2; p++) {
+				const u32 s{ Subset(info.subset_count, partition, i + p) };
+				const u32 color_index{ index_selection ? indices2[i + p] : indices[i + p] };
+				const u32 alpha_index{ info.index2_bits && !index_selection ? indices2[i + p] : indices[i + p] };
+				weights[p][0] = (u16)color_weights[color_index];
+				weights[p][1] = (u16)alpha_weights[alpha_index];
+				lanes[p][0] = _mm_loadl_epi64((const __m128i*)endpoint_lanes[s][0]);
+				lanes[p][1] = _mm_loadl_epi64((const __m128i*)endpoint_lanes[s][1]);
+			}
+
+			const __m128i w{ _mm_setr_epi16((s16)weights[0][0], (s16)weights[0][0], (s16)weights[0][0], (s16)weights[0][1],
+				(s16)weights[1][0], (s16)weights[1][0], (s16)weights[1][0], (s16)weights[1][1]) };
+			const __m128i e0{ _mm_unpacklo_epi64(lanes[0][0], lanes[1][0]) };
+			const __m128i e1{ _mm_unpacklo_epi64(lanes[0][1], lanes[1][1]) };
+			const __m128i sum{ _mm_add_epi16(_mm_mullo_epi16(e0, _mm_sub_epi16(sixty_four, w)), _mm_mullo_epi16(e1, w)) };
+			const __m128i values{ _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(32)), 6) };
+			_mm_storel_epi64((__m128i*)pixels[i], _mm_packus_epi16(values, values));
+		}
+
+		if (rotation) {
+			for (u32 i{ 0 }; i < block_pixel_count; i++) std::swap(pixels[i][3], pixels[i][rotation - 1]);
+		}
+	}
+}
@@ -0,0 +1,443 @@
+#pragma once
+#include "BlockCompression.h"
+#include <immintrin.h>
+#include <cfloat>
+#include <cmath>
+#include <algorithm>
+
+// Internals shared by the block encoders. Not part of the BlockCompression.h interface.
+// NOTE: neither this nor the encoder sources include ToolsCommon.h, so the BC6H and BC7 CPU paths build without Windows headers.
+namespace Zetta::Tools::BC::Detail {
+	constexpr u32 block_pixel_count{ 16 };
+	// Blocks encoded per ParallelFor item. Small mips go in one item instead of a thread per row.
+	constexpr u32 blocks_per_tile{ 256 };
+
+	// Interpolation weights of BC6H and BC7, in 64ths, for 2, 3 and 4 bit indices.
+	constexpr u32 weights2[4]{ 0, 21, 43, 64 };
+	constexpr u32 weights3[8]{ 0, 9, 18, 27, 37, 46, 55, 64 };
+	constexpr u32 weights4[16]{ 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	[[nodiscard]] constexpr const u32* InterpolationWeights(u32 index_bits) {
+		return index_bits == 2 ? weights2 : index_bits == 3 ? weights3 : weights4;
+	}
+
+	// BC7 partitions, of which BC6H uses the first 32 with 2 subsets. The subset of every pixel is 1 bit for
+	// 2 subsets and 2 bits for 3 subsets.
+	constexpr u16 partitions2[64]{
+		0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80, 0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+		0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce, 0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+		0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a, 0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+		0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c, 0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22,
+	};
+
+	constexpr u32 partitions3[64]{
+		0xaa685050, 0x6a5a5040, 0x5a5a4200, 0x5450a0a8, 0xa5a50000, 0xa0a05050, 0x5555a0a0, 0x5a5a5050,
+		0xaa550000, 0xaa555500, 0xaaaa5500, 0x90909090, 0x94949494, 0xa4a4a4a4, 0xa9a59450, 0x2a0a4250,
+		0xa5945040, 0x0a425054, 0xa5a5a500, 0x55a0a0a0, 0xa8a85454, 0x6a6a4040, 0xa4a45000, 0x1a1a0500,
+		0x0050a4a4, 0xaaa59090, 0x14696914, 0x69691400, 0xa08585a0, 0xaa821414, 0x50a4a450, 0x6a5a0200,
+		0xa9a58000, 0x5090a0a8, 0xa8a09050, 0x24242424, 0x00aa5500, 0x24924924, 0x24499224, 0x50a50a50,
+		0x500aa550, 0xaaaa4444, 0x66660000, 0xa5a0a5a0, 0x50a050a0, 0x69286928, 0x44aaaa44, 0x66666600,
+		0xaa444444, 0x54a854a8, 0x95809580, 0x96969600, 0xa85454a8, 0x80959580, 0xaa141414, 0x96960000,
+		0xaaaa1414, 0xa05050a0, 0xa0a5a5a0, 0x96000000, 0x40804080, 0xa9a8a9a8, 0xaaaaaa44, 0x2a4a5254,
+	};
+
+	// Anchor pixels of the subsets after the first, whose anchor is always pixel 0.
+	constexpr u8 anchors2[64]{
+		15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+		15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+		15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+		 6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15,
+	};
+
+	constexpr u8 anchors3_second[64]{
+		 3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+		 3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+		 8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+		 3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3,
+	};
+
+	constexpr u8 anchors3_third[64]{
+		15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+		15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+		15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+		15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8,
+	};
+
+	[[nodiscard]] constexpr u32 Subset(u32 subset_count, u32 partition, u32 pixel) {
+		if (subset_count == 2) return (partitions2[partition] >> pixel) & 1;
+		if (subset_count == 3) return (partitions3[partition] >> (pixel * 2)) & 3;
+		return 0;
+	}
+
+	[[nodiscard]] constexpr u32 Anchor(u32 subset_count, u32 partition, u32 subset) {
+		if (!subset) return 0;
+		if (subset_count == 2) return anchors2[partition];
+		return subset == 1 ? anchors3_second[partition] : anchors3_third[partition];
+	}
+
+	[[nodiscard]] constexpr bool IsAnchor(u32 subset_count, u32 partition, u32 pixel) {
+		for (u32 s{ 0 }; s < subset_count; s++) {
+			if (Anchor(subset_count, partition, s) == pixel) return true;
+		}
+		return false;
+	}
+
+	// One block with its 4 channels split out for SIMD.
+	struct Block {
+		alignas(32) f32 channels[4][block_pixel_count];
+	};
+
+	// Picks the closest of up to 16 palette entries for every pixel and returns the weighted squared error.
+	// Pixels with weight 0 get an index but don't count toward the error.
+	inline f32 FitIndices(const Block& block, const f32 (&weights)[block_pixel_count], const f32 (*const palette)[4], u32 palette_size, u8 (&indices)[block_pixel_count]) {
+#if defined(__AVX2__)
+		__m256 total{ _mm256_setzero_ps() };
+		for (u32 i{ 0 }; i < block_pixel_count; i += 8) {
+			__m256 pixel[4];
+			for (u32 c{ 0 }; c < 4; c++) pixel[c] = _mm256_load_ps(&block.channels[c][i]);
+			__m256 best{ _mm256_set1_ps(FLT_MAX) };
+			__m256i best_index{ _mm256_setzero_si256() };
+			for (u32 p{ 0 }; p < palette_size; p++) {
+				__m256 distance{ _mm256_setzero_ps() };
+				for (u32 c{ 0 }; c < 4; c++) {
+					const __m256 d{ _mm256_sub_ps(pixel[c], _mm256_set1_ps(palette[p][c])) };
+					distance = _mm256_fmadd_ps(d, d, distance);
+				}
+				const __m256 is_closer{ _mm256_cmp_ps(distance, best, _CMP_LT_OQ) };
+				best = _mm256_min_ps(distance, best);
+				best_index = _mm256_blendv_epi8(best_index, _mm256_set1_epi32((s32)p), _mm256_castps_si256(is_closer));
+			}
+
+			total = _mm256_fmadd_ps(best, _mm256_loadu_ps(&weights[i]), total);
+			alignas(32) s32 result[8];
+			_mm256_store_si256((__m256i*)result, best_index);
+			for (u32 j{ 0 }; j < 8; j++) indices[i + j] = (u8)result[j];
+		}
+
+		const __m128 sum4{ _mm_add_ps(_mm256_castps256_ps128(total), _mm256_extractf128_ps(total, 1)) };
+#else
+		__m128 sum4{ _mm_setzero_ps() };
+		for (u32 i{ 0 }; i < block_pixel_count; i += 4) {
+			__m128 pixel[4];
+			for (u32 c{ 0 }; c < 4; c++) pixel[c] = _mm_load_ps(&block.channels[c][i]);
+			__m128 best{ _mm_set1_ps(FLT_MAX) };
+			__m128i best_index{ _mm_setzero_si128() };
+			for (u32 p{ 0 }; p < palette_size; p++) {
+				__m128 distance{ _mm_setzero_ps() };
+				for (u32 c{ 0 }; c < 4; c++) {
+					const __m128 d{ _mm_sub_ps(pixel[c], _mm_set1_ps(palette[p][c])) };
+					distance = _mm_add_ps(distance, _mm_mul_ps(d, d));
+				}
+				const __m128i is_closer{ _mm_castps_si128(_mm_cmplt_ps(distance, best)) };
+				best = _mm_min_ps(distance, best);
+				best_index = _mm_or_si128(_mm_and_si128(is_closer, _mm_set1_epi32((s32)p)), _mm_andnot_si128(is_closer, best_index));
+			}
+
+			sum4 = _mm_add_ps(sum4, _mm_mul_ps(best, _mm_loadu_ps(&weights[i])));
+			alignas(16) s32 result[4];
+			_mm_store_si128((__m128i*)result, best_index);
+			for (u32 j{ 0 }; j < 4; j++) indices[i + j] = (u8)result[j];
+		}
+#endif
+		const __m128 sum2{ _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4)) };
+		return _mm_cvtss_f32(_mm_add_ss(sum2, _mm_shuffle_ps(sum2, sum2, 1)));
+	}
+
+	// Least-squares endpoints for the given indices, in all 4 channels. Returns false if the indices
+	// don't constrain both endpoints.
+	inline bool FitEndpoints(const Block& block, const f32 (&weights)[block_pixel_count], const u8 (&indices)[block_pixel_count], u32 index_bits, f32 (&endpoints)[2][4]) {
+		const u32* const interpolation{ InterpolationWeights(index_bits) };
+		f32 aa{ 0.f }, bb{ 0.f }, ab{ 0.f };
+		f32 ax[4]{}, bx[4]{};
+		for (u32 i{ 0 }; i < block_pixel_count; i++) {
+			if (!weights[i]) continue;
+			const f32 b{ (f32)interpolation[indices[i]] * (1.f / 64.f) };
+			const f32 a{ 1.f - b };
+			aa += weights[i] * a * a;
+			bb += weights[i] * b * b;
+			ab += weights[i] * a * b;
+			for (u32 c{ 0 }; c < 4; c++) {
+				ax[c] += weights[i] * a * block.channels[c][i];
+				bx[c] += weights[i] * b * block.channels[c][i];
+			}
+		}
+
+		const f32 determinant{ aa * bb - ab * ab };
+		if (std::abs(determinant) < 1e-6f) return false;
+
+		const f32 inv_determinant{ 1.f / determinant };
+		for (u32 c{ 0 }; c < 4; c++) {
+			endpoints[0][c] = (bb * ax[c] - ab * bx[c]) * inv_determinant;
+			endpoints[1][c] = (aa * bx[c] - ab * ax[c]) * inv_determinant;
+		}
+
+		return true;
+	}
+
+	// Endpoints at the ends of the principal axis of the weighted pixels. With no iterations it's the
+	// bounding box diagonal, flipped to follow how the channels correlate.
+	inline void PrincipalAxisEndpoints(const Block& block, const f32 (&weights)[block_pixel_count], u32 iterations, f32 (&endpoints)[2][4]) {
+		f32 mean[4]{}, min[4]{ FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX }, max[4]{ -FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		f32 count{ 0.f };
+		for (u32 i{ 0 }; i < block_pixel_count; i++) {
+			if (!weights[i]) continue;
+			for (u32 c{ 0 }; c < 4; c++) {
+				const f32 value{ block.channels[c][i] };
+				mean[c] += value;
+				min[c] = std::min(min[c], value);
+				max[c] = std::max(max[c], value);
+			}
+			count += 1.f;
+		}
+
+		assert(count > 0.f);
+		for (f32& m : mean) m /= count;
+
+		f32 covariance[4][4]{};
+		for (u32 i{ 0 }; i < block_pixel_count; i++) {
+			if (!weights[i]) continue;
+			f32 d[4];
+			for (u32 c{ 0 }; c < 4; c++) d[c] = block.channels[c][i] - mean[c];
+			for (u32 c{ 0 }; c < 4; c++) {
+				for (u32 k{ c }; k < 4; k++) covariance[c][k] += d[c] * d[k];
+			}
+		}
+		for (u32 c{ 0 }; c < 4; c++) {
+			for (u32 k{ 0 }; k < c; k++) covariance[c][k] = covariance[k][c];
+		}
+
+		u32 widest{ 0 };
+		f32 axis[4];
+		for (u32 c{ 0 }; c < 4; c++) {
+			axis[c] = max[c] - min[c];
+			if (axis[c] > axis[widest]) widest = c;
+		}
+		for (u32 c{ 0 }; c < 4; c++) {
+			if (covariance[widest][c] < 0.f) axis[c] = -axis[c];
+		}
+
+		for (u32 i{ 0 }; i < iterations; i++) {
+			f32 next[4]{};
+			f32 length{ 0.f };
+			for (u32 c{ 0 }; c < 4; c++) {
+				for (u32 k{ 0 }; k < 4; k++) next[c] += covariance[c][k] * axis[k];
+				length = std::max(length, std::abs(next[c]));
+			}
+			if (length < 1e-6f) break;
+			for (u32 c{ 0 }; c < 4; c++) axis[c] = next[c] / length;
+		}
+
+		const f32 length_sq{ axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] + axis[3] * axis[3] };
+		if (length_sq < 1e-6f) {
+			for (u32 c{ 0 }; c < 4; c++) endpoints[0][c] = endpoints[1][c] = mean[c];
+			return;
+		}
+
+		f32 t_min{ FLT_MAX }, t_max{ -FLT_MAX };
+		for (u32 i{ 0 }; i < block_pixel_count; i++) {
+			if (!weights[i]) continue;
+			f32 t{ 0.f };
+			for (u32 c{ 0 }; c < 4; c++) t += (block.channels[c][i] - mean[c]) * axis[c];
+			t /= length_sq;
+			t_min = std::min(t_min, t);
+			t_max = std::max(t_max, t);
+		}
+
+		for (u32 c{ 0 }; c < 4; c++) {
+			endpoints[0][c] = mean[c] + t_min * axis[c];
+			endpoints[1][c] = mean[c] + t_max * axis[c];
+		}
+	}
+
+	// Subset membership of 4 partitions per SIMD lane group, for ranking partitions.
+	struct SubsetMasks {
+		alignas(16) f32 masks[16][block_pixel_count][4];	// [partition / 4][pixel][partition % 4]
+	};
+
+	[[nodiscard]] constexpr SubsetMasks MakeSubsetMasks(u32 subset_count, u32 subset) {
+		SubsetMasks result{};
+		for (u32 p{ 0 }; p < 64; p++) {
+			for (u32 i{ 0 }; i < block_pixel_count; i++) result.masks[p / 4][i][p % 4] = Subset(subset_count, p, i) == subset ? 1.f : 0.f;
+		}
+		return result;
+	}
+
+	inline constexpr SubsetMasks subset_masks2{ MakeSubsetMasks(2, 1) };
+	inline constexpr SubsetMasks subset_masks3[2]{ MakeSubsetMasks(3, 1), MakeSubsetMasks(3, 2) };
+
+	// Pixel count, channel sums and sums of the products of every channel pair of one subset in 4 partitions.
+	// Opaque blocks leave alpha out.
+	template<u32 channel_count>
+	struct SubsetMoments {
+		static constexpr u32 product_count{ channel_count * (channel_count + 1) / 2 };
+		__m128 count;
+		__m128 sums[channel_count];
+		__m128 products[product_count];
+	};
+
+	// What a line through the subset's pixels can't represent: the variance left after removing the
+	// principal axis, which is found with a few power iterations.
+	template<u32 channel_count>
+	__m128 LineFitError(const SubsetMoments<channel_count>& moments) {
+		const __m128 inv_count{ _mm_div_ps(_mm_set1_ps(1.f), _mm_max_ps(moments.count, _mm_set1_ps(1.f))) };
+		__m128 covariance[channel_count][channel_count];
+		for (u32 c{ 0 }, k{ 0 }; c < channel_count; c++) {
+			for (u32 d{ c }; d < channel_count; d++, k++) {
+				covariance[c][d] = covariance[d][c] = _mm_sub_ps(moments.products[k], _mm_mul_ps(_mm_mul_ps(moments.sums[c], moments.sums[d]), inv_count));
+			}
+		}
+
+		// Start at the row of the channel with the most variance.
+		__m128 axis[channel_count];
+		for (u32 c{ 0 }; c < channel_count; c++) axis[c] = covariance[0][c];
+		__m128 widest{ covariance[0][0] };
+		for (u32 c{ 1 }; c < channel_count; c++) {
+			const __m128 is_wider{ _mm_cmpgt_ps(covariance[c][c], widest) };
+			widest = _mm_max_ps(widest, covariance[c][c]);
+			for (u32 d{ 0 }; d < channel_count; d++) axis[d] = _mm_or_ps(_mm_and_ps(is_wider, covariance[c][d]), _mm_andnot_ps(is_wider, axis[d]));
+		}
+
+		__m128 product[channel_count];
+		for (u32 i{ 0 }; i < 3; i++) {
+			__m128 length_sq{ _mm_set1_ps(1e-12f) };
+			for (u32 c{ 0 }; c < channel_count; c++) {
+				product[c] = _mm_setzero_ps();
+				for (u32 d{ 0 }; d < channel_count; d++) product[c] = _mm_add_ps(product[c], _mm_mul_ps(covariance[c][d], axis[d]));
+				length_sq = _mm_add_ps(length_sq, _mm_mul_ps(product[c], product[c]));
+			}
+			const __m128 inv_length{ _mm_rsqrt_ps(length_sq) };
+			for (u32 c{ 0 }; c < channel_count; c++) axis[c] = _mm_mul_ps(product[c], inv_length);
+		}
+
+		// Rayleigh quotient of the axis is the largest eigenvalue of the covariance.
+		__m128 numerator{ _mm_setzero_ps() }, denominator{ _mm_set1_ps(1e-12f) };
+		for (u32 c{ 0 }; c < channel_count; c++) {
+			product[c] = _mm_setzero_ps();
+			for (u32 d{ 0 }; d < channel_count; d++) product[c] = _mm_add_ps(product[c], _mm_mul_ps(covariance[c][d], axis[d]));
+			numerator = _mm_add_ps(numerator, _mm_mul_ps(axis[c], product[c]));
+			denominator = _mm_add_ps(denominator, _mm_mul_ps(axis[c], axis[c]));
+		}
+
+		__m128 trace{ _mm_setzero_ps() };
+		for (u32 c{ 0 }; c < channel_count; c++) trace = _mm_add_ps(trace, covariance[c][c]);
+		return _mm_max_ps(_mm_sub_ps(trace, _mm_div_ps(numerator, denominator)), _mm_setzero_ps());
+	}
+
+	// Estimates how well the first 'partition_count' partitions of 2 or 3 subsets fit the block, with the
+	// moments of 4 partitions accumulated at once.
+	template<u32 channel_count>
+	void EstimatePartitionErrors(const Block& block, u32 subset_count, u32 partition_count, f32 (&errors)[64]) {
+		assert(subset_count == 2 || subset_count == 3);
+		using Moments = SubsetMoments<channel_count>;
+		constexpr u32 product_count{ Moments::product_count };
+		alignas(16) f32 products[product_count][block_pixel_count];
+		Moments total{};
+		for (u32 i{ 0 }; i < block_pixel_count; i++) {
+			for (u32 c{ 0 }, k{ 0 }; c < channel_count; c++) {
+				for (u32 d{ c }; d < channel_count; d++, k++) products[k][i] = block.channels[c][i] * block.channels[d][i];
+			}
+		}
+		for (u32 c{ 0 }; c < channel_count; c++) {
+			f32 sum{ 0.f };
+			for (u32 i{ 0 }; i < block_pixel_count; i++) sum += block.channels[c][i];
+			total.sums[c] = _mm_set1_ps(sum);
+		}
+		for (u32 k{ 0 }; k < product_count; k++) {
+			f32 sum{ 0.f };
+			for (u32 i{ 0 }; i < block_pixel_count; i++) sum += products[k][i];
+			total.products[k] = _mm_set1_ps(sum);
+		}
+		total.count = _mm_set1_ps((f32)block_pixel_count);
+
+		for (u32 group{ 0 }; group < (partition_count + 3) / 4; group++) {
+			Moments subsets[3]{ total };
+			for (u32 s{ 1 }; s < subset_count; s++) {
+				const SubsetMasks& masks{ subset_count == 2 ? subset_masks2 : subset_masks3[s - 1] };
+				Moments& moments{ subsets[s] };
+				for (u32 i{ 0 }; i < block_pixel_count; i++) {
+					const __m128 mask{ _mm_load_ps(masks.masks[group][i]) };
+					moments.count = _mm_add_ps(moments.count, mask);
+					for (u32 c{ 0 }; c < channel_count; c++) moments.sums[c] = _mm_add_ps(moments.sums[c], _mm_mul_ps(mask, _mm_set1_ps(block.channels[c][i])));
+					for (u32 k{ 0 }; k < product_count; k++) moments.products[k] = _mm_add_ps(moments.products[k], _mm_mul_ps(mask, _mm_set1_ps(products[k][i])));
+				}
+
+				// subset 0 has every pixel that isn't in the others
+				subsets[0].count = _mm_sub_ps(subsets[0].count, moments.count);
+				for (u32 c{ 0 }; c < channel_count; c++) subsets[0].sums[c] = _mm_sub_ps(subsets[0].sums[c], moments.sums[c]);
+				for (u32 k{ 0 }; k < product_count; k++) subsets[0].products[k] = _mm_sub_ps(subsets[0].products[k], moments.products[k]);
+			}
+
+			__m128 error{ _mm_setzero_ps() };
+			for (u32 s{ 0 }; s < subset_count; s++) error = _mm_add_ps(error, LineFitError(subsets[s]));
+			_mm_storeu_ps(&errors[group * 4], error);
+		}
+	}
+
+	// Writes the best 'count' of the first 'partition_count' partitions and returns how many were written.
+	inline u32 RankPartitions(const f32 (&errors)[64], u32 partition_count, u32 count, u8 (&ranked)[64]) {
+		for (u32 p{ 0 }; p < partition_count; p++) ranked[p] = (u8)p;
+		count = std::min(count, partition_count);
+		std::partial_sort(ranked, ranked + count, ranked + partition_count, [&](u8 a, u8 b) { return errors[a] < errors[b]; });
+		return count;
+	}
+
+	// Writes a 128-bit block from the least significant bit up.
+	class BitWriter {
+	public:
+		void Write(u32 value, u32 bits) {
+			assert(bits <= 32 && _position + bits <= 128);
+			for (u32 i{ 0 }; i < bits; i++, _position++) {
+				_data[_position >> 6] |= (u64)((value >> i) & 1) << (_position & 63);
+			}
+		}
+
+		void Store(u8* const output) const {
+			assert(_position == 128);
+			memcpy(output, _data, sizeof(_data));
+		}
+
+	private:
+		u64 _data[2]{};
+		u32 _position{ 0 };
+	};
+
+	class BitReader {
+	public:
+		explicit BitReader(const u8* const block) { memcpy(_data, block, sizeof(_data)); }
+
+		// A field that crosses into the second half takes its high bits from there.
+		[[nodiscard]] u32 Read(u32 bits) {
+			assert(bits <= 32 && _position + bits <= 128);
+			const u32 shift{ _position & 63 };
+			u64 value{ _data[_position >> 6] >> shift };
+			if (shift + bits > 64) value |= _data[1] << (64 - shift);
+			_position += bits;
+			return (u32)(value & ((1ull << bits) - 1));
+		}
+
+		[[nodiscard]] u32 Position() const { return _position; }
+
+	private:
+		u64 _data[2];
+		u32 _position{ 0 };
+	};
+
+	// Calls func(block_x, block_y) for every block, a tile of block rows per ParallelFor item.
+	template<typename F>
+	void ForEachBlock(u32 width, u32 height, F&& func) {
+		const u32 blocks_x{ (width + 3) / 4 };
+		const u32 blocks_y{ (height + 3) / 4 };
+		const u32 rows_per_tile{ std::max(blocks_per_tile / blocks_x, 1u) };
+		ParallelFor((blocks_y + rows_per_tile - 1) / rows_per_tile, [&](u32 tile) {
+			const u32 last_row{ std::min((tile + 1) * rows_per_tile, blocks_y) };
+			for (u32 y{ tile * rows_per_tile }; y < last_row; y++) {
+				for (u32 x{ 0 }; x < blocks_x; x++) func(x, y);
+			}
+		});
+	}
+
+	void EncodeBC7Block(const u8 (&pixels)[block_pixel_count][4], Quality::Level quality, u8* const output);
+	void DecodeBC7Block(const u8* const block, u8 (&pixels)[block_pixel_count][4]);
+	void EncodeBC6HBlock(const u16 (&pixels)[block_pixel_count][4], bool is_signed, Quality::Level quality, u8* const output);
+	void DecodeBC6HBlock(const u8* const block, bool is_signed, u16 (&pixels)[block_pixel_count][4]);
+}
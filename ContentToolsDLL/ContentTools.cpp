@@ -7,4 +7,5 @@ namespace Zetta::Tools {
 EDITOR_INTERFACE void ShutdownContentTools() {
 	using namespace Zetta::Tools;
 	ShutdownTextureTools();
+	WorkerPool::Shutdown();
 }
@@ -0,0 +1,339 @@
+#include "EnvironmentMap.h"
+#include "WorkerPool.h"
+#include <immintrin.h>
+#include <cmath>
+#include <algorithm>
+
+namespace Zetta::Tools::EnvironmentMap {
+	namespace {
+		// Destination texels prefiltered per ParallelFor item. Every texel takes all the samples of the lobe,
+		// so bands are a lot smaller than the mip generator's.
+		constexpr u32 texels_per_band{ 1 << 12 };
+
+		// Cosine lobe convolution of each SH band, divided by pi: A0 = pi, A1 = 2pi/3, A2 = pi/4.
+		constexpr f32 band_factors[3]{ 1.f, 2.f / 3.f, 0.25f };
+		constexpr u32 coefficient_bands[sh_coefficient_count]{ 0, 1, 1, 1, 2, 2, 2, 2, 2 };
+
+		// Box filtered copy of the source radiance. All 6 faces are packed in one array of RGBA floats.
+		struct RadianceMip {
+			util::vector<f32> pixels;
+			u32 size;
+		};
+
+		// Samples of the GGX lobe in tangent space, where the normal, the view and the reflection vector are all +z.
+		struct LobeSample {
+			float3 direction;
+			f32 weight;		// n.l
+			f32 lod;		// source mip whose texels cover about as much solid angle as the sample stands for
+		};
+
+		[[nodiscard]] float3 Normalize(const float3& v) {
+			const f32 inv_length{ 1.f / std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z) };
+			return { v.x * inv_length, v.y * inv_length, v.z * inv_length };
+		}
+
+		[[nodiscard]] float3 Cross(const float3& a, const float3& b) {
+			return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+		}
+
+		[[nodiscard]] __m128 Lerp(__m128 a, __m128 b, f32 t) {
+			return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set1_ps(t)));
+		}
+
+		[[nodiscard]] const f32* Row(const Face& face, u32 y) {
+			return (const f32*)&((const u8*)face.pixels)[(u64)y * face.row_pitch];
+		}
+
+		// Direction through the center of texel (x, y) of a face, not normalized.
+		[[nodiscard]] float3 TexelDirection(u32 face, u32 x, u32 y, u32 size) {
+			const f32 u{ 2.f * (x + 0.5f) / size - 1.f };
+			const f32 v{ 2.f * (y + 0.5f) / size - 1.f };
+			switch (face) {
+			case 0: return { 1.f, -v, -u };
+			case 1: return { -1.f, -v, u };
+			case 2: return { u, 1.f, v };
+			case 3: return { u, -1.f, -v };
+			case 4: return { u, -v, 1.f };
+			default: return { -u, -v, -1.f };
+			}
+		}
+
+		// The face a direction points at and where on it, with u and v in [-1, 1]. Inverse of TexelDirection().
+		void DirectionToFace(const float3& d, u32& face, f32& u, f32& v) {
+			const f32 ax{ std::abs(d.x) };
+			const f32 ay{ std::abs(d.y) };
+			const f32 az{ std::abs(d.z) };
+			if (ax >= ay && ax >= az) {
+				face = d.x > 0.f ? 0 : 1;
+				u = (d.x > 0.f ? -d.z : d.z) / ax;
+				v = -d.y / ax;
+			}
+			else if (ay >= az) {
+				face = d.y > 0.f ? 2 : 3;
+				u = d.x / ay;
+				v = (d.y > 0.f ? d.z : -d.z) / ay;
+			}
+			else {
+				face = d.z > 0.f ? 4 : 5;
+				u = (d.z > 0.f ? d.x : -d.x) / az;
+				v = -d.y / az;
+			}
+		}
+
+		[[nodiscard]] f32 AreaElement(f32 x, f32 y) {
+			return std::atan2(x * y, std::sqrt(x * x + y * y + 1.f));
+		}
+
+		// Solid angle of a texel, from the area its corners span on the unit sphere.
+		[[nodiscard]] f32 TexelSolidAngle(u32 x, u32 y, u32 size) {
+			const f32 texel{ 2.f / size };
+			const f32 u0{ x * texel - 1.f };
+			const f32 v0{ y * texel - 1.f };
+			const f32 u1{ u0 + texel };
+			const f32 v1{ v0 + texel };
+			return AreaElement(u0, v0) - AreaElement(u0, v1) - AreaElement(u1, v0) + AreaElement(u1, v1);
+		}
+
+		void SHBasis(const float3& n, f32 (&basis)[sh_coefficient_count]) {
+			basis[0] = 0.282095f;
+			basis[1] = 0.488603f * n.y;
+			basis[2] = 0.488603f * n.z;
+			basis[3] = 0.488603f * n.x;
+			basis[4] = 1.092548f * n.x * n.y;
+			basis[5] = 1.092548f * n.y * n.z;
+			basis[6] = 0.315392f * (3.f * n.z * n.z - 1.f);
+			basis[7] = 1.092548f * n.x * n.z;
+			basis[8] = 0.546274f * (n.x * n.x - n.y * n.y);
+		}
+
+		// Mip 0 is a copy of the source faces, every other mip averages 2x2 texels of the one before it.
+		[[nodiscard]] util::vector<RadianceMip> BuildRadianceChain(const Face* const faces) {
+			util::vector<RadianceMip> chain;
+			{
+				RadianceMip& mip{ chain.emplace_back() };
+				mip.size = faces[0].size;
+				mip.pixels.resize((u64)face_count * mip.size * mip.size * 4);
+				for (u32 face{ 0 }; face < face_count; face++) {
+					for (u32 y{ 0 }; y < mip.size; y++) {
+						memcpy(&mip.pixels[(((u64)face * mip.size + y) * mip.size) * 4], Row(faces[face], y), (u64)mip.size * 4 * sizeof(f32));
+					}
+				}
+			}
+
+			while (chain.back().size > 1) {
+				chain.emplace_back();
+				const RadianceMip& source{ chain[chain.size() - 2] };
+				RadianceMip& mip{ chain.back() };
+				mip.size = source.size >> 1;
+				mip.pixels.resize((u64)face_count * mip.size * mip.size * 4);
+
+				ParallelFor(face_count * mip.size, [&](u32 row) {
+					const u32 face{ row / mip.size };
+					const u32 y{ row % mip.size };
+					const f32* const source_pixels{ &source.pixels[(u64)face * source.size * source.size * 4] };
+					auto texel = [&](u32 x, u32 y) {
+						return _mm_loadu_ps(&source_pixels[((u64)std::min(y, source.size - 1) * source.size + std::min(x, source.size - 1)) * 4]);
+					};
+
+					f32* const destination{ &mip.pixels[((u64)face * mip.size + y) * mip.size * 4] };
+					for (u32 x{ 0 }; x < mip.size; x++) {
+						const __m128 sum{ _mm_add_ps(_mm_add_ps(texel(2 * x, 2 * y), texel(2 * x + 1, 2 * y)),
+							_mm_add_ps(texel(2 * x, 2 * y + 1), texel(2 * x + 1, 2 * y + 1))) };
+						_mm_storeu_ps(&destination[x * 4], _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+					}
+				});
+			}
+
+			return chain;
+		}
+
+		// Samples one face without crossing its edges. Seams are hidden by the blur of the mips that read many
+		// texels, and mip 0 is never read through here.
+		[[nodiscard]] __m128 SampleBilinear(const RadianceMip& mip, u32 face, f32 u, f32 v) {
+			const u32 size{ mip.size };
+			const f32 fx{ std::clamp((u * 0.5f + 0.5f) * size - 0.5f, 0.f, (f32)(size - 1)) };
+			const f32 fy{ std::clamp((v * 0.5f + 0.5f) * size - 0.5f, 0.f, (f32)(size - 1)) };
+			const u32 x0{ (u32)fx };
+			const u32 y0{ (u32)fy };
+			const u32 x1{ std::min(x0 + 1, size - 1) };
+			const u32 y1{ std::min(y0 + 1, size - 1) };
+
+			const f32* const pixels{ &mip.pixels[(u64)face * size * size * 4] };
+			auto texel = [&](u32 x, u32 y) { return _mm_loadu_ps(&pixels[((u64)y * size + x) * 4]); };
+			const __m128 top{ Lerp(texel(x0, y0), texel(x1, y0), fx - x0) };
+			const __m128 bottom{ Lerp(texel(x0, y1), texel(x1, y1), fx - x0) };
+			return Lerp(top, bottom, fy - y0);
+		}
+
+		[[nodiscard]] __m128 SampleTrilinear(const util::vector<RadianceMip>& chain, const float3& direction, f32 lod) {
+			u32 face;
+			f32 u, v;
+			DirectionToFace(direction, face, u, v);
+
+			lod = std::min(lod, (f32)(chain.size() - 1));
+			const u32 mip{ (u32)lod };
+			const __m128 sample{ SampleBilinear(chain[mip], face, u, v) };
+			if (mip + 1 == chain.size()) return sample;
+			return Lerp(sample, SampleBilinear(chain[mip + 1], face, u, v), lod - mip);
+		}
+
+		[[nodiscard]] f32 RadicalInverse(u32 bits) {
+			bits = (bits << 16) | (bits >> 16);
+			bits = ((bits & 0x55555555u) << 1) | ((bits & 0xAAAAAAAAu) >> 1);
+			bits = ((bits & 0x33333333u) << 2) | ((bits & 0xCCCCCCCCu) >> 2);
+			bits = ((bits & 0x0F0F0F0Fu) << 4) | ((bits & 0xF0F0F0F0u) >> 4);
+			bits = ((bits & 0x00FF00FFu) << 8) | ((bits & 0xFF00FF00u) >> 8);
+			return (f32)bits * 2.3283064365386963e-10f;
+		}
+
+		// Importance samples the GGX distribution with a Hammersley sequence. Only the directions above the
+		// surface are kept. The lobe is the same for every texel of a mip, so it's made once per mip.
+		[[nodiscard]] util::vector<LobeSample> BuildLobe(f32 roughness, u32 sample_count, u32 source_size) {
+			assert(roughness > 0.f);
+			const f32 a{ roughness * roughness };
+			const f32 a2{ a * a };
+			const f32 texel_solid_angle{ 4.f * Math::PI / (face_count * (f32)source_size * source_size) };
+
+			util::vector<LobeSample> lobe;
+			for (u32 i{ 0 }; i < sample_count; i++) {
+				const f32 phi{ Math::TAU * (f32)i / (f32)sample_count };
+				const f32 xi{ RadicalInverse(i) };
+				const f32 cos_theta{ std::sqrt((1.f - xi) / (1.f + (a2 - 1.f) * xi)) };
+				const f32 sin_theta{ std::sqrt(1.f - cos_theta * cos_theta) };
+
+				// l reflects the view vector (+z) around the half vector.
+				const f32 scale{ 2.f * cos_theta * sin_theta };
+				const float3 l{ scale * std::cos(phi), scale * std::sin(phi), 2.f * cos_theta * cos_theta - 1.f };
+				if (l.z <= 0.f) continue;
+
+				// With n = v, the pdf of l is D(h) * (n.h) / (4 * (v.h)) = D(h) / 4. A sample stands for
+				// 1 / (sample_count * pdf) steradians, and the + 1 blurs a little more to hide the pattern.
+				const f32 d{ cos_theta * cos_theta * (a2 - 1.f) + 1.f };
+				const f32 pdf{ a2 / (Math::PI * d * d) * 0.25f };
+				const f32 sample_solid_angle{ 1.f / ((f32)sample_count * pdf) };
+				const f32 lod{ std::max(0.5f * std::log2(sample_solid_angle / texel_solid_angle) + 1.f, 0.f) };
+				lobe.emplace_back(l, l.z, lod);
+			}
+
+			return lobe;
+		}
+
+		void PrefilterMip(const util::vector<RadianceMip>& chain, const util::vector<LobeSample>& lobe, const Face* const faces) {
+			const u32 size{ faces[0].size };
+			const u32 rows_per_band{ std::max(texels_per_band / size, 1u) };
+			const u32 bands_per_face{ (size + rows_per_band - 1) / rows_per_band };
+
+			ParallelFor(face_count * bands_per_face, [&](u32 band) {
+				const u32 face{ band / bands_per_face };
+				const u32 first_row{ (band % bands_per_face) * rows_per_band };
+				const u32 last_row{ std::min(first_row + rows_per_band, size) };
+
+				for (u32 y{ first_row }; y < last_row; y++) {
+					f32* const row{ (f32*)Row(faces[face], y) };
+					for (u32 x{ 0 }; x < size; x++) {
+						const float3 n{ Normalize(TexelDirection(face, x, y, size)) };
+						const float3 up{ std::abs(n.z) < 0.999f ? float3{ 0.f, 0.f, 1.f } : float3{ 1.f, 0.f, 0.f } };
+						const float3 t{ Normalize(Cross(up, n)) };
+						const float3 b{ Cross(n, t) };
+
+						__m128 sum{ _mm_setzero_ps() };
+						f32 weight{ 0.f };
+						for (const LobeSample& sample : lobe) {
+							const float3& s{ sample.direction };
+							const float3 l{ t.x * s.x + b.x * s.y + n.x * s.z, t.y * s.x + b.y * s.y + n.y * s.z, t.z * s.x + b.z * s.y + n.z * s.z };
+							sum = _mm_add_ps(sum, _mm_mul_ps(SampleTrilinear(chain, l, sample.lod), _mm_set1_ps(sample.weight)));
+							weight += sample.weight;
+						}
+
+						_mm_storeu_ps(&row[x * 4], _mm_mul_ps(sum, _mm_set1_ps(1.f / weight)));
+					}
+				}
+			});
+		}
+	} // anonymous namespace
+
+	void ProjectIrradiance(const Face* const faces, IrradianceSH& sh) {
+		assert(faces && faces[0].size);
+		const u32 size{ faces[0].size };
+		for (u32 face{ 0 }; face < face_count; face++) assert(faces[face].pixels && faces[face].size == size);
+
+		// Every row sums into its own slot and the slots are added up in order afterwards, so the result
+		// doesn't depend on which thread took which row.
+		const u32 row_count{ face_count * size };
+		util::vector<f32> row_sums((u64)row_count * sh_coefficient_count * 4);
+
+		ParallelFor(row_count, [&](u32 row) {
+			const u32 face{ row / size };
+			const u32 y{ row % size };
+			const f32* const pixels{ Row(faces[face], y) };
+			const __m128 rgb_mask{ _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)) };
+			const __m128 one_in_w{ _mm_set_ps(1.f, 0.f, 0.f, 0.f) };
+
+			__m128 sums[sh_coefficient_count];
+			for (__m128& sum : sums) sum = _mm_setzero_ps();
+			for (u32 x{ 0 }; x < size; x++) {
+				f32 basis[sh_coefficient_count];
+				SHBasis(Normalize(TexelDirection(face, x, y, size)), basis);
+
+				// Alpha is replaced by 1, so w sums up the solid angle.
+				const __m128 rgb1{ _mm_or_ps(_mm_and_ps(_mm_loadu_ps(&pixels[x * 4]), rgb_mask), one_in_w) };
+				const __m128 radiance{ _mm_mul_ps(rgb1, _mm_set1_ps(TexelSolidAngle(x, y, size))) };
+				for (u32 i{ 0 }; i < sh_coefficient_count; i++) sums[i] = _mm_add_ps(sums[i], _mm_mul_ps(radiance, _mm_set1_ps(basis[i])));
+			}
+
+			for (u32 i{ 0 }; i < sh_coefficient_count; i++) _mm_storeu_ps(&row_sums[((u64)row * sh_coefficient_count + i) * 4], sums[i]);
+		});
+
+		__m128 sums[sh_coefficient_count];
+		for (u32 i{ 0 }; i < sh_coefficient_count; i++) {
+			sums[i] = _mm_setzero_ps();
+			for (u32 row{ 0 }; row < row_count; row++) sums[i] = _mm_add_ps(sums[i], _mm_loadu_ps(&row_sums[((u64)row * sh_coefficient_count + i) * 4]));
+		}
+
+		// The texel solid angles add up to 4pi, apart from rounding, which this takes out.
+		f32 total[4];
+		_mm_storeu_ps(total, sums[0]);
+		const f32 normalization{ 4.f * Math::PI * 0.282095f / total[3] };
+
+		for (u32 i{ 0 }; i < sh_coefficient_count; i++) {
+			f32 values[4];
+			_mm_storeu_ps(values, _mm_mul_ps(sums[i], _mm_set1_ps(normalization * band_factors[coefficient_bands[i]])));
+			sh.coefficients[i] = { values[0], values[1], values[2] };
+		}
+	}
+
+	float3 EvaluateIrradiance(const IrradianceSH& sh, const float3& normal) {
+		f32 basis[sh_coefficient_count];
+		SHBasis(normal, basis);
+
+		float3 irradiance{ 0.f, 0.f, 0.f };
+		for (u32 i{ 0 }; i < sh_coefficient_count; i++) {
+			irradiance.x += sh.coefficients[i].x * basis[i];
+			irradiance.y += sh.coefficients[i].y * basis[i];
+			irradiance.z += sh.coefficients[i].z * basis[i];
+		}
+
+		// L2 ringing can dip below 0 opposite very bright lights.
+		return { std::max(irradiance.x, 0.f), std::max(irradiance.y, 0.f), std::max(irradiance.z, 0.f) };
+	}
+
+	void PrefilterSpecular(const Face* const mips, u32 mip_count, const SpecularSettings& settings) {
+		assert(mips && mip_count);
+		for (u32 mip{ 0 }; mip < mip_count; mip++) {
+			for (u32 face{ 0 }; face < face_count; face++) {
+				[[maybe_unused]] const Face& image{ mips[mip * face_count + face] };
+				assert(image.pixels && image.size == (mip ? std::max(mips[(mip - 1) * face_count].size >> 1, 1u) : mips[0].size));
+			}
+		}
+		if (mip_count == 1) return;
+
+		const util::vector<RadianceMip> chain{ BuildRadianceChain(mips) };
+		const u32 sample_count{ settings.sample_count ? settings.sample_count : default_sample_count };
+
+		for (u32 mip{ 1 }; mip < mip_count; mip++) {
+			const f32 roughness{ (f32)mip / (f32)(mip_count - 1) };
+			const util::vector<LobeSample> lobe{ BuildLobe(roughness, sample_count, chain[0].size) };
+			PrefilterMip(chain, lobe, &mips[mip * face_count]);
+		}
+	}
+}
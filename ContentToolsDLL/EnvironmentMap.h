@@ -0,0 +1,47 @@
+#pragma once
+#include "CommonHeaders.h"
+
+// Image based lighting from cube maps: L2 spherical harmonics for diffuse irradiance and a specular mip chain
+// prefiltered with the GGX distribution, one roughness per mip. Both are deterministic: samples come from a fixed
+// Hammersley sequence and sums are added up in a fixed order, so the thread count never changes a bit of the result.
+// Like the mip generator, it doesn't depend on DirectXTex. It doesn't need any Windows header either, only the engine's
+// common headers and the worker pool.
+namespace Zetta::Tools::EnvironmentMap {
+	constexpr u32 face_count{ 6 };
+	constexpr u32 sh_coefficient_count{ 9 };
+	constexpr u32 default_sample_count{ 128 };
+
+	// NOTE: not Math::v3, which MathTypes.h only defines with DirectXMath on Windows.
+	struct float3 {
+		f32 x, y, z;
+	};
+
+	// One square face of one mip with RGBA f32 pixels. The row pitch is in bytes.
+	// Faces are in D3D order: +X, -X, +Y, -Y, +Z, -Z.
+	struct Face {
+		f32* pixels;
+		u32 size;
+		u32 row_pitch;
+	};
+
+	// Irradiance convolved with the cosine lobe and divided by pi, so a white Lambertian surface with normal n
+	// reflects sum(coefficients[i] * Y[i](n)). The basis is Y00, Y1-1, Y10, Y11, Y2-2, Y2-1, Y20, Y21, Y22:
+	// 0.282095, 0.488603 * (y, z, x), 1.092548 * (xy, yz), 0.315392 * (3z^2 - 1), 1.092548 * xz, 0.546274 * (x^2 - y^2).
+	struct IrradianceSH {
+		float3 coefficients[sh_coefficient_count];
+	};
+
+	struct SpecularSettings {
+		u32 sample_count;	// GGX samples per texel, 0 for default_sample_count
+	};
+
+	// Projects the radiance of the 6 faces onto the SH basis, weighting each texel by its solid angle.
+	void ProjectIrradiance(const Face* const faces, IrradianceSH& sh);
+
+	[[nodiscard]] float3 EvaluateIrradiance(const IrradianceSH& sh, const float3& normal);
+
+	// Fills mips 1 to mip_count - 1 from mip 0, which is the unfiltered cube map. Mip m is prefiltered for
+	// roughness m / (mip_count - 1), so the shader picks the mip with roughness * (mip_count - 1).
+	// mips[mip * face_count + face] is one face, each mip half the size of the one before it and at least 1.
+	void PrefilterSpecular(const Face* const mips, u32 mip_count, const SpecularSettings& settings);
+}
@@ -1,5 +1,6 @@
 #include "Geometry.h"
 #include "../Utilities/IOStream.h"
+#include "Content/GeometryCodec.h"
 
 namespace Zetta::Tools {
     namespace {
@@ -53,9 +54,8 @@ namespace Zetta::Tools {
                 u32 num_refs{ (u32)refs.size() };
                 for (u32 j{ 0 }; j < num_refs; ++j)
                 {
-                    m.indices[refs[j]] = (u32)m.vertices.size();
-                    Vertex& v{ m.vertices.emplace_back() };
-                    v.position = m.positions[m.raw_indices[refs[j]]];
+                    m.indices[refs[j]] = m.vertices.size();
+                    m.vertices.positions.emplace_back(m.positions[m.raw_indices[refs[j]]]);
 
                     XMVECTOR n1{ XMLoadFloat3(&m.normals[refs[j]]) };
                     if (!is_hard_edge)
@@ -86,19 +86,40 @@ namespace Zetta::Tools {
                             }
                         }
                     }
-                    XMStoreFloat3(&v.normal, XMVector3Normalize(n1));
+                    XMStoreFloat3(&m.vertices.normals.emplace_back(), XMVector3Normalize(n1));
                 }
             }
         }
 
+        template<typename T>
+        void AppendElement(util::vector<T>& dst, const util::vector<T>& src, u32 index)
+        {
+            if (src.empty()) return;
+            // NOTE: copy first, because src may be dst and emplace_back() may reallocate.
+            const T element{ src[index] };
+            dst.emplace_back(element);
+        }
+
+        // Appends a copy of vertex 'index' of src to all streams that src has.
+        void AppendVertex(VertexStreams& dst, const VertexStreams& src, u32 index)
+        {
+            AppendElement(dst.positions, src.positions, index);
+            AppendElement(dst.normals, src.normals, index);
+            AppendElement(dst.tangents, src.tangents, index);
+            AppendElement(dst.uvs, src.uvs, index);
+            AppendElement(dst.joint_weights, src.joint_weights, index);
+            AppendElement(dst.joint_indices, src.joint_indices, index);
+            AppendElement(dst.colors, src.colors, index);
+        }
+
         void ProcessUVs(Mesh& m)
         {
-            util::vector<Vertex> old_vertices;
-            old_vertices.swap(m.vertices);
+            VertexStreams old_vertices{ std::move(m.vertices) };
+            assert(old_vertices.uvs.empty());
             util::vector<u32> old_indices(m.indices.size());
             old_indices.swap(m.indices);
 
-            const u32 num_vertices{ (u32)old_vertices.size() };
+            const u32 num_vertices{ old_vertices.size() };
             const u32 num_indices{ (u32)old_indices.size() };
             assert(num_vertices && num_indices);
 
@@ -112,16 +133,16 @@ namespace Zetta::Tools {
                 u32 num_refs{ (u32)refs.size() };
                 for (u32 j{ 0 }; j < num_refs; ++j)
                 {
-                    m.indices[refs[j]] = (u32)m.vertices.size();
-                    Vertex& v{ old_vertices[old_indices[refs[j]]] };
-                    v.uv = m.uv_sets[0][refs[j]];
-                    m.vertices.emplace_back(v);
+                    m.indices[refs[j]] = m.vertices.size();
+                    const v2& uv{ m.uv_sets[0][refs[j]] };
+                    AppendVertex(m.vertices, old_vertices, old_indices[refs[j]]);
+                    m.vertices.uvs.emplace_back(uv);
 
                     for (u32 k{ j + 1 }; k < num_refs; ++k)
                     {
                         v2& uv1{ m.uv_sets[0][refs[k]] };
-                        if (XMScalarNearEqual(v.uv.x, uv1.x, EPSILON) &&
-                            XMScalarNearEqual(v.uv.y, uv1.y, EPSILON))
+                        if (XMScalarNearEqual(uv.x, uv1.x, EPSILON) &&
+                            XMScalarNearEqual(uv.y, uv1.y, EPSILON))
                         {
                             m.indices[refs[k]] = m.indices[refs[j]];
                             refs.erase(refs.begin() + k);
@@ -133,6 +154,199 @@ namespace Zetta::Tools {
             }
         }
 
+        // Per-triangle tangent frame in the magnitude-independent form used by MikkTSpace.
+        // 'orientation' is false for triangles whose UV winding is mirrored.
+        struct TriangleTangents {
+            v3 os;
+            v3 ot;
+            bool orientation;
+        };
+
+        // Computes the un-projected tangent (os) and bitangent (ot) of 4 triangles per iteration.
+        // Lanes are laid out SoA so that every XMVECTOR holds one component of 4 triangles.
+        void CalculateTriangleTangents(const Mesh& m, util::vector<TriangleTangents>& triangles)
+        {
+            const u32 num_triangles{ (u32)m.indices.size() / 3 };
+            const v3* const positions{ m.vertices.positions.data() };
+            const v2* const uvs{ m.vertices.uvs.data() };
+            assert(m.vertices.uvs.size() == m.vertices.size());
+            triangles.resize(num_triangles);
+
+            for (u32 t{ 0 }; t < num_triangles; t += 4)
+            {
+                XMFLOAT4A e1x{}, e1y{}, e1z{}, e2x{}, e2y{}, e2z{};
+                XMFLOAT4A du1{}, dv1{}, du2{}, dv2{};
+                f32* const lanes[10]{ &e1x.x, &e1y.x, &e1z.x, &e2x.x, &e2y.x, &e2z.x, &du1.x, &dv1.x, &du2.x, &dv2.x };
+
+                const u32 lane_count{ std::min(num_triangles - t, 4u) };
+                for (u32 l{ 0 }; l < lane_count; ++l)
+                {
+                    const u32 index{ (t + l) * 3 };
+                    const u32 i0{ m.indices[index + 0] };
+                    const u32 i1{ m.indices[index + 1] };
+                    const u32 i2{ m.indices[index + 2] };
+
+                    lanes[0][l] = positions[i1].x - positions[i0].x;
+                    lanes[1][l] = positions[i1].y - positions[i0].y;
+                    lanes[2][l] = positions[i1].z - positions[i0].z;
+                    lanes[3][l] = positions[i2].x - positions[i0].x;
+                    lanes[4][l] = positions[i2].y - positions[i0].y;
+                    lanes[5][l] = positions[i2].z - positions[i0].z;
+                    lanes[6][l] = uvs[i1].x - uvs[i0].x;
+                    lanes[7][l] = uvs[i1].y - uvs[i0].y;
+                    lanes[8][l] = uvs[i2].x - uvs[i0].x;
+                    lanes[9][l] = uvs[i2].y - uvs[i0].y;
+                }
+
+                const XMVECTOR E1x{ XMLoadFloat4A(&e1x) }, E1y{ XMLoadFloat4A(&e1y) }, E1z{ XMLoadFloat4A(&e1z) };
+                const XMVECTOR E2x{ XMLoadFloat4A(&e2x) }, E2y{ XMLoadFloat4A(&e2y) }, E2z{ XMLoadFloat4A(&e2z) };
+                const XMVECTOR DU1{ XMLoadFloat4A(&du1) }, DV1{ XMLoadFloat4A(&dv1) };
+                const XMVECTOR DU2{ XMLoadFloat4A(&du2) }, DV2{ XMLoadFloat4A(&dv2) };
+
+                // Twice the signed area of the triangle in texture space. Its sign tells if the UVs are mirrored.
+                const XMVECTOR area{ DU1 * DV2 - DV1 * DU2 };
+                const XMVECTOR positive{ XMVectorGreaterOrEqual(area, XMVectorZero()) };
+                const XMVECTOR sign{ XMVectorSelect(XMVectorReplicate(-1.f), XMVectorReplicate(1.f), positive) };
+
+                XMFLOAT4A osx, osy, osz, otx, oty, otz, orientation;
+                XMStoreFloat4A(&osx, (DV2 * E1x - DV1 * E2x) * sign);
+                XMStoreFloat4A(&osy, (DV2 * E1y - DV1 * E2y) * sign);
+                XMStoreFloat4A(&osz, (DV2 * E1z - DV1 * E2z) * sign);
+                XMStoreFloat4A(&otx, (DU1 * E2x - DU2 * E1x) * sign);
+                XMStoreFloat4A(&oty, (DU1 * E2y - DU2 * E1y) * sign);
+                XMStoreFloat4A(&otz, (DU1 * E2z - DU2 * E1z) * sign);
+                XMStoreFloat4A(&orientation, sign);
+
+                for (u32 l{ 0 }; l < lane_count; ++l)
+                {
+                    TriangleTangents& tri{ triangles[t + l] };
+                    tri.os = { (&osx.x)[l], (&osy.x)[l], (&osz.x)[l] };
+                    tri.ot = { (&otx.x)[l], (&oty.x)[l], (&otz.x)[l] };
+                    tri.orientation = (&orientation.x)[l] > 0.f;
+                }
+            }
+        }
+
+        // NOTE: A vertex shared by triangles with opposite UV winding (i.e. a mirrored UV seam that
+        //       was welded because the UVs match exactly) can't have a single tangent frame. Such
+        //       vertices are duplicated so that the mirrored triangles get their own copy.
+        void SplitMirroredVertices(Mesh& m, const util::vector<TriangleTangents>& triangles)
+        {
+            const u32 num_vertices{ m.vertices.size() };
+            const u32 num_indices{ (u32)m.indices.size() };
+            constexpr u8 positive{ 0x01 };
+            constexpr u8 negative{ 0x02 };
+
+            util::vector<u8> orientations(num_vertices, 0);
+            for (u32 i{ 0 }; i < num_indices; ++i)
+                orientations[m.indices[i]] |= triangles[i / 3].orientation ? positive : negative;
+
+            util::vector<u32> mirrored_vertex(num_vertices, u32_invalid_id);
+            for (u32 i{ 0 }; i < num_indices; ++i)
+            {
+                const u32 v_idx{ m.indices[i] };
+                if (orientations[v_idx] != (positive | negative) || triangles[i / 3].orientation) continue;
+
+                if (mirrored_vertex[v_idx] == u32_invalid_id)
+                {
+                    mirrored_vertex[v_idx] = m.vertices.size();
+                    AppendVertex(m.vertices, m.vertices, v_idx);
+                }
+                m.indices[i] = mirrored_vertex[v_idx];
+            }
+        }
+
+        // Generates MikkTSpace-style tangents: per-triangle tangent frames are projected onto the
+        // tangent plane of each corner's normal and accumulated with the corner angle as weight.
+        // Triangles are visited in index order, so the result is deterministic for a given mesh.
+        void CalculateTangents(Mesh& m)
+        {
+            util::vector<TriangleTangents> triangles;
+            CalculateTriangleTangents(m, triangles);
+            SplitMirroredVertices(m, triangles);
+
+            const u32 num_vertices{ m.vertices.size() };
+            const u32 num_indices{ (u32)m.indices.size() };
+            const v3* const positions{ m.vertices.positions.data() };
+            const v3* const normals{ m.vertices.normals.data() };
+            util::vector<v3> tangents(num_vertices, v3{});
+            util::vector<v3> bitangents(num_vertices, v3{});
+
+            for (u32 i{ 0 }; i < num_indices; i += 3)
+            {
+                const TriangleTangents& tri{ triangles[i / 3] };
+                const XMVECTOR os{ XMLoadFloat3(&tri.os) };
+                const XMVECTOR ot{ XMLoadFloat3(&tri.ot) };
+
+                for (u32 k{ 0 }; k < 3; ++k)
+                {
+                    const u32 v_idx{ m.indices[i + k] };
+                    const XMVECTOR n{ XMLoadFloat3(&normals[v_idx]) };
+                    const XMVECTOR p0{ XMLoadFloat3(&positions[v_idx]) };
+                    const XMVECTOR p1{ XMLoadFloat3(&positions[m.indices[i + (k + 1) % 3]]) };
+                    const XMVECTOR p2{ XMLoadFloat3(&positions[m.indices[i + (k + 2) % 3]]) };
+
+                    // Edges are projected onto the tangent plane before measuring the corner angle, like MikkTSpace does.
+                    XMVECTOR e1{ p1 - p0 };
+                    XMVECTOR e2{ p2 - p0 };
+                    e1 = XMVector3Normalize(e1 - n * XMVector3Dot(n, e1));
+                    e2 = XMVector3Normalize(e2 - n * XMVector3Dot(n, e2));
+                    const XMVECTOR angle{ XMVectorACos(XMVectorClamp(XMVector3Dot(e1, e2), XMVectorReplicate(-1.f), XMVectorReplicate(1.f))) };
+
+                    const XMVECTOR t{ XMVector3Normalize(os - n * XMVector3Dot(n, os)) };
+                    const XMVECTOR b{ XMVector3Normalize(ot - n * XMVector3Dot(n, ot)) };
+
+                    XMStoreFloat3(&tangents[v_idx], XMLoadFloat3(&tangents[v_idx]) + t * angle);
+                    XMStoreFloat3(&bitangents[v_idx], XMLoadFloat3(&bitangents[v_idx]) + b * angle);
+                }
+            }
+
+            m.vertices.tangents.resize(num_vertices);
+            for (u32 i{ 0 }; i < num_vertices; ++i)
+            {
+                const XMVECTOR n{ XMLoadFloat3(&normals[i]) };
+                XMVECTOR t{ XMLoadFloat3(&tangents[i]) };
+                t -= n * XMVector3Dot(n, t);
+
+                if (XMVector3Less(XMVector3LengthSq(t), XMVectorReplicate(1e-12f)))
+                {
+                    // Degenerate UVs: pick any vector perpendicular to the normal.
+                    const XMVECTOR axis{ fabsf(normals[i].x) < 0.9f ? XMVectorSet(1.f, 0.f, 0.f, 0.f) : XMVectorSet(0.f, 1.f, 0.f, 0.f) };
+                    t = XMVector3Cross(n, axis);
+                }
+                t = XMVector3Normalize(t);
+
+                const XMVECTOR b{ XMLoadFloat3(&bitangents[i]) };
+                const f32 handedness{ XMVectorGetX(XMVector3Dot(XMVector3Cross(n, t), b)) < 0.f ? -1.f : 1.f };
+                XMStoreFloat4(&m.vertices.tangents[i], XMVectorSetW(t, handedness));
+            }
+        }
+
+        // Averages the per-corner tangents that came with the source file into the welded vertices.
+        void ProcessTangents(Mesh& m)
+        {
+            const u32 num_vertices{ m.vertices.size() };
+            const u32 num_indices{ (u32)m.indices.size() };
+            assert(m.tangents.size() == num_indices);
+
+            util::vector<v4> tangents(num_vertices, v4{});
+            for (u32 i{ 0 }; i < num_indices; ++i)
+            {
+                v4& t{ tangents[m.indices[i]] };
+                const v4& src{ m.tangents[i] };
+                t.x += src.x; t.y += src.y; t.z += src.z; t.w += src.w;
+            }
+
+            m.vertices.tangents.resize(num_vertices);
+            for (u32 i{ 0 }; i < num_vertices; ++i)
+            {
+                const XMVECTOR n{ XMLoadFloat3(&m.vertices.normals[i]) };
+                XMVECTOR t{ XMLoadFloat4(&tangents[i]) };
+                t = XMVector3Normalize(t - n * XMVector3Dot(n, t));
+                XMStoreFloat4(&m.vertices.tangents[i], XMVectorSetW(t, tangents[i].w < 0.f ? -1.f : 1.f));
+            }
+        }
+
         u64 GetVertexElementSize(Elements::ElementsType::Type elements_type) {
             using namespace Elements;
             switch (elements_type)
@@ -151,19 +365,138 @@ namespace Zetta::Tools {
             return 0;
         }
 
-        void PackVertices(Mesh& m) {
-            const u32 num_vertices{ (u32)m.vertices.size() };
+        // Computes the AABB and a bounding sphere of the mesh. The sphere is Ritter's approximation, unless
+        // the sphere around the center of the AABB happens to be tighter.
+        void CalculateBounds(Mesh& m)
+        {
+            const u32 num_vertices{ m.vertices.size() };
+            const v3* const positions{ m.vertices.positions.data() };
             assert(num_vertices);
 
-            m.positions_buffer.resize(sizeof(Math::v3) * num_vertices);
-            Math::v3* const positions_buffer{ (Math::v3* const)m.positions_buffer.data() };
+            const v3& first{ positions[0] };
+            f32 min[3]{ first.x, first.y, first.z };
+            f32 max[3]{ first.x, first.y, first.z };
+            u32 min_idx[3]{}, max_idx[3]{};
+            for (u32 i{ 1 }; i < num_vertices; ++i)
+            {
+                const v3& p{ positions[i] };
+                const f32 coords[3]{ p.x, p.y, p.z };
+                for (u32 axis{ 0 }; axis < 3; ++axis)
+                {
+                    if (coords[axis] < min[axis]) { min[axis] = coords[axis]; min_idx[axis] = i; }
+                    if (coords[axis] > max[axis]) { max[axis] = coords[axis]; max_idx[axis] = i; }
+                }
+            }
+
+            m.bounds.aabb_min = { min[0], min[1], min[2] };
+            m.bounds.aabb_max = { max[0], max[1], max[2] };
+
+            // Start with the most distant pair of extreme points as the diameter.
+            XMVECTOR a{}, b{};
+            f32 max_distance{ -1.f };
+            for (u32 axis{ 0 }; axis < 3; ++axis)
+            {
+                const XMVECTOR p0{ XMLoadFloat3(&positions[min_idx[axis]]) };
+                const XMVECTOR p1{ XMLoadFloat3(&positions[max_idx[axis]]) };
+                const f32 distance{ XMVectorGetX(XMVector3LengthSq(p1 - p0)) };
+                if (distance > max_distance)
+                {
+                    max_distance = distance;
+                    a = p0;
+                    b = p1;
+                }
+            }
+
+            XMVECTOR center{ (a + b) * 0.5f };
+            f32 radius{ XMVectorGetX(XMVector3Length(b - a)) * 0.5f };
+            for (u32 i{ 0 }; i < num_vertices; ++i)
+            {
+                const XMVECTOR p{ XMLoadFloat3(&positions[i]) };
+                const f32 distance{ XMVectorGetX(XMVector3Length(p - center)) };
+                if (distance > radius)
+                {
+                    // grow the sphere just enough to touch p on the far side
+                    const f32 new_radius{ (radius + distance) * 0.5f };
+                    center += (p - center) * ((new_radius - radius) / distance);
+                    radius = new_radius;
+                }
+            }
+
+            const XMVECTOR aabb_center{ (XMLoadFloat3(&m.bounds.aabb_min) + XMLoadFloat3(&m.bounds.aabb_max)) * 0.5f };
+            f32 aabb_radius{ 0.f };
+            for (u32 i{ 0 }; i < num_vertices; ++i)
+            {
+                const XMVECTOR p{ XMLoadFloat3(&positions[i]) };
+                aabb_radius = std::max(aabb_radius, XMVectorGetX(XMVector3Length(p - aabb_center)));
+            }
 
+            if (aabb_radius < radius)
+            {
+                center = aabb_center;
+                radius = aabb_radius;
+            }
+
+            XMStoreFloat3(&m.bounds.sphere_center, center);
+            m.bounds.sphere_radius = radius;
+        }
+
+        struct QuantizedPosition { u16 x, y, z, pad; };
+        static_assert(sizeof(QuantizedPosition) == Content::PositionFormat::Size(Content::PositionFormat::Unorm16x3));
+
+        void PackPositions(Mesh& m, bool quantize) {
+            using Content::PositionFormat;
+            const u32 num_vertices{ m.vertices.size() };
+
+            if (!quantize)
+            {
+                m.position_format = PositionFormat::Float3;
+                m.position_scale = { 1.f, 1.f, 1.f };
+                m.position_bias = {};
+                m.positions_buffer.resize(sizeof(Math::v3) * num_vertices);
+                memcpy(m.positions_buffer.data(), m.vertices.positions.data(), m.positions_buffer.size());
+                return;
+            }
+
+            const XMVECTOR min{ XMLoadFloat3(&m.bounds.aabb_min) };
+            const XMVECTOR max{ XMLoadFloat3(&m.bounds.aabb_max) };
+
+            constexpr f32 intervals{ (f32)u16_invalid_id };
+            const XMVECTOR extent{ max - min };
+            // NOTE: flat axes (zero extent) get a zero scale so every vertex decodes exactly to the bias.
+            const XMVECTOR scale{ extent / XMVectorReplicate(intervals) };
+            const XMVECTOR inv_scale{ XMVectorSelect(XMVectorReplicate(intervals) / extent, XMVectorZero(),
+                                                     XMVectorEqual(extent, XMVectorZero())) };
+
+            m.position_format = PositionFormat::Unorm16x3;
+            XMStoreFloat3(&m.position_scale, scale);
+            XMStoreFloat3(&m.position_bias, min);
+            m.positions_buffer.resize(sizeof(QuantizedPosition) * num_vertices);
+            QuantizedPosition* const positions_buffer{ (QuantizedPosition* const)m.positions_buffer.data() };
+
+            const XMVECTOR half{ XMVectorReplicate(0.5f) };
+            const XMVECTOR upper{ XMVectorReplicate(intervals) };
             for (u32 i{ 0 }; i < num_vertices; ++i)
             {
-                positions_buffer[i] = m.vertices[i].position;
+                const XMVECTOR p{ XMLoadFloat3(&m.vertices.positions[i]) };
+                XMUINT4 q;
+                XMStoreUInt4(&q, XMVectorClamp((p - min) * inv_scale + half, XMVectorZero(), upper));
+                positions_buffer[i] = { (u16)q.x, (u16)q.y, (u16)q.z, 0 };
             }
 
+            // The rounding error per axis is at most half a step (scale / 2).
+            assert(MaxPositionError(m) <= 0.5f * XMVectorGetX(XMVector3Length(scale)) + 1e-6f);
+        }
+
+        void PackVertices(Mesh& m, const GeometryImportSettings& settings) {
+            const VertexStreams& v{ m.vertices };
+            const u32 num_vertices{ v.size() };
+            assert(num_vertices);
+
+            CalculateBounds(m);
+            PackPositions(m, settings.quantize_positions);
+
             struct u16v2 { u16 x, y; };
+            struct u16v4 { u16 x, y, z, w; };
             struct u8v3 { u8 x, y, z; };
 
             util::vector<u8> t_signs(num_vertices);
@@ -174,40 +507,53 @@ namespace Zetta::Tools {
             if (m.elements_type & Elements::ElementsType::StaticNormal)
             {
                 // normals only
+                assert(v.normals.size() == num_vertices);
                 for (u32 i{ 0 }; i < num_vertices; ++i)
                 {
-                    Vertex& v{ m.vertices[i] };
-                    t_signs[i] = (u8)((v.normal.z > 0.f) << 1);
-                    normals[i] = { (u16)PackFloat<16>(v.normal.x, -1.f, 1.f), (u16)PackFloat<16>(v.normal.y, -1.f, 1.f) };
+                    const v3& n{ v.normals[i] };
+                    t_signs[i] = (u8)((n.z > 0.f) << 1);
+                    normals[i] = { (u16)PackFloat<16>(n.x, -1.f, 1.f), (u16)PackFloat<16>(n.y, -1.f, 1.f) };
                 }
 
                 if (m.elements_type & Elements::ElementsType::StaticNormalTexture)
                 {
                     // full T-space
+                    // NOTE: t_sign bits: 0x01 = sign of tangent.z, 0x02 = sign of normal.z, 0x04 = tangent handedness.
+                    assert(v.tangents.size() == num_vertices && v.uvs.size() == num_vertices);
                     for (u32 i{ 0 }; i < num_vertices; ++i)
                     {
-                        Vertex& v{ m.vertices[i] };
-                        t_signs[i] |= (u8)((v.tangent.w > 0.f) && (v.tangent.z > 0.f));
-                        tangents[i] = { (u16)PackFloat<16>(v.tangent.x, -1.f, 1.f), (u16)PackFloat<16>(v.tangent.y, -1.f, 1.f) };
+                        const v4& t{ v.tangents[i] };
+                        t_signs[i] |= (u8)((t.z > 0.f) | ((t.w > 0.f) << 2));
+                        tangents[i] = { (u16)PackFloat<16>(t.x, -1.f, 1.f), (u16)PackFloat<16>(t.y, -1.f, 1.f) };
                     }
                 }
             }
 
             if (m.elements_type & Elements::ElementsType::Skeletal)
             {
+                assert(v.joint_weights.size() == num_vertices && v.joint_indices.size() == num_vertices);
                 for (u32 i{ 0 }; i < num_vertices; ++i)
                 {
-                    Vertex& v{ m.vertices[i] };
+                    const v4& w{ v.joint_weights[i] };
                     // pack joint weights (from [0.0, 1.0] to [0..255])
                     joint_weights[i] = {
-                        (u8)PackUnitFloat<8>(v.joint_weights.x),
-                        (u8)PackUnitFloat<8>(v.joint_weights.y),
-                        (u8)PackUnitFloat<8>(v.joint_weights.z) };
+                        (u8)PackUnitFloat<8>(w.x),
+                        (u8)PackUnitFloat<8>(w.y),
+                        (u8)PackUnitFloat<8>(w.z) };
 
                     // NOTE: w3 will be calculated in shader since joint weights sum to one(1).
                 }
             }
 
+            // NOTE: no importer provides vertex colors yet, so a missing color stream packs as black.
+            const auto color{ [&v](u32 i) {
+                return v.colors.empty() ? VertexStreams::Color{} : v.colors[i];
+            } };
+            const auto joints{ [&v](u32 i) {
+                const u32v4& j{ v.joint_indices[i] };
+                return u16v4{ (u16)j.x, (u16)j.y, (u16)j.z, (u16)j.w };
+            } };
+
             m.element_buffer.resize(GetVertexElementSize(m.elements_type) * num_vertices);
             using namespace Elements;
 
@@ -218,8 +564,8 @@ namespace Zetta::Tools {
                 StaticColor* const element_buffer{ (StaticColor* const)m.element_buffer.data() };
                 for (u32 i{ 0 }; i < num_vertices; ++i)
                 {
-                    Vertex& v{ m.vertices[i] };
-                    element_buffer[i] = { {v.red, v.green, v.blue}, {} };
+                    const VertexStreams::Color c{ color(i) };
+                    element_buffer[i] = { {c.red, c.green, c.blue}, {} };
                 }
             }
             break;
@@ -228,8 +574,8 @@ namespace Zetta::Tools {
                 StaticNormal* const element_buffer{ (StaticNormal* const)m.element_buffer.data() };
                 for (u32 i{ 0 }; i < num_vertices; ++i)
                 {
-                    Vertex& v{ m.vertices[i] };
-                    element_buffer[i] = { {v.red, v.green, v.blue}, t_signs[i], {normals[i].x, normals[i].y} };
+                    const VertexStreams::Color c{ color(i) };
+                    element_buffer[i] = { {c.red, c.green, c.blue}, t_signs[i], {normals[i].x, normals[i].y} };
                 }
             }
             break;
@@ -238,10 +584,10 @@ namespace Zetta::Tools {
                 StaticNormalTexture* const element_buffer{ (StaticNormalTexture* const)m.element_buffer.data() };
                 for (u32 i{ 0 }; i < num_vertices; ++i)
                 {
-                    Vertex& v{ m.vertices[i] };
-                    element_buffer[i] = { {v.red, v.green, v.blue}, t_signs[i],
+                    const VertexStreams::Color c{ color(i) };
+                    element_buffer[i] = { {c.red, c.green, c.blue}, t_signs[i],
                                          {normals[i].x, normals[i].y}, {tangents[i].x, tangents[i].y},
-                                         v.uv };
+                                         v.uvs[i] };
                 }
             }
             break;
@@ -250,10 +596,9 @@ namespace Zetta::Tools {
                 Skeletal* const element_buffer{ (Skeletal* const)m.element_buffer.data() };
                 for (u32 i{ 0 }; i < num_vertices; ++i)
                 {
-                    Vertex& v{ m.vertices[i] };
-                    const u16 indices[4]{ (u16)v.joint_indices.x, (u16)v.joint_indices.y , (u16)v.joint_indices.z , (u16)v.joint_indices.w };
+                    const u16v4 indices{ joints(i) };
                     element_buffer[i] = { {joint_weights[i].x, joint_weights[i].y, joint_weights[i].z}, {},
-                                         {indices[0], indices[1], indices[2], indices[3]} };
+                                         {indices.x, indices.y, indices.z, indices.w} };
                 }
             }
             break;
@@ -262,11 +607,10 @@ namespace Zetta::Tools {
                 SkeletalColor* const element_buffer{ (SkeletalColor* const)m.element_buffer.data() };
                 for (u32 i{ 0 }; i < num_vertices; ++i)
                 {
-                    Vertex& v{ m.vertices[i] };
-                    const u16 indices[4]{ (u16)v.joint_indices.x, (u16)v.joint_indices.y , (u16)v.joint_indices.z , (u16)v.joint_indices.w };
+                    const u16v4 indices{ joints(i) };
                     element_buffer[i] = { {joint_weights[i].x, joint_weights[i].y, joint_weights[i].z}, {},
-                                         {indices[0], indices[1], indices[2], indices[3]},
-                                         {v.red, v.green, v.blue}, {} };
+                                         {indices.x, indices.y, indices.z, indices.w},
+                                         {color(i).red, color(i).green, color(i).blue}, {} };
                 }
             }
             break;
@@ -275,10 +619,9 @@ namespace Zetta::Tools {
                 SkeletalNormal* const element_buffer{ (SkeletalNormal* const)m.element_buffer.data() };
                 for (u32 i{ 0 }; i < num_vertices; ++i)
                 {
-                    Vertex& v{ m.vertices[i] };
-                    const u16 indices[4]{ (u16)v.joint_indices.x, (u16)v.joint_indices.y , (u16)v.joint_indices.z , (u16)v.joint_indices.w };
+                    const u16v4 indices{ joints(i) };
                     element_buffer[i] = { {joint_weights[i].x, joint_weights[i].y, joint_weights[i].z}, t_signs[i],
-                                         {indices[0], indices[1], indices[2], indices[3]},
+                                         {indices.x, indices.y, indices.z, indices.w},
                                          {normals[i].x, normals[i].y} };
                 }
             }
@@ -288,11 +631,10 @@ namespace Zetta::Tools {
                 SkeletalNormalColor* const element_buffer{ (SkeletalNormalColor* const)m.element_buffer.data() };
                 for (u32 i{ 0 }; i < num_vertices; ++i)
                 {
-                    Vertex& v{ m.vertices[i] };
-                    const u16 indices[4]{ (u16)v.joint_indices.x, (u16)v.joint_indices.y , (u16)v.joint_indices.z , (u16)v.joint_indices.w };
+                    const u16v4 indices{ joints(i) };
                     element_buffer[i] = { {joint_weights[i].x, joint_weights[i].y, joint_weights[i].z}, t_signs[i],
-                                         {indices[0], indices[1], indices[2], indices[3]},
-                                         {normals[i].x, normals[i].y}, {v.red, v.green, v.blue}, {} };
+                                         {indices.x, indices.y, indices.z, indices.w},
+                                         {normals[i].x, normals[i].y}, {color(i).red, color(i).green, color(i).blue}, {} };
                 }
             }
             break;
@@ -301,11 +643,10 @@ namespace Zetta::Tools {
                 SkeletalNormalTexture* const element_buffer{ (SkeletalNormalTexture* const)m.element_buffer.data() };
                 for (u32 i{ 0 }; i < num_vertices; ++i)
                 {
-                    Vertex& v{ m.vertices[i] };
-                    const u16 indices[4]{ (u16)v.joint_indices.x, (u16)v.joint_indices.y , (u16)v.joint_indices.z , (u16)v.joint_indices.w };
+                    const u16v4 indices{ joints(i) };
                     element_buffer[i] = { {joint_weights[i].x, joint_weights[i].y, joint_weights[i].z}, t_signs[i],
-                                         {indices[0], indices[1], indices[2], indices[3]},
-                                         {normals[i].x, normals[i].y}, {tangents[i].x, tangents[i].y}, v.uv };
+                                         {indices.x, indices.y, indices.z, indices.w},
+                                         {normals[i].x, normals[i].y}, {tangents[i].x, tangents[i].y}, v.uvs[i] };
                 }
             }
             break;
@@ -314,12 +655,11 @@ namespace Zetta::Tools {
                 SkeletalNormalTextureColor* const element_buffer{ (SkeletalNormalTextureColor* const)m.element_buffer.data() };
                 for (u32 i{ 0 }; i < num_vertices; ++i)
                 {
-                    Vertex& v{ m.vertices[i] };
-                    const u16 indices[4]{ (u16)v.joint_indices.x, (u16)v.joint_indices.y , (u16)v.joint_indices.z , (u16)v.joint_indices.w };
+                    const u16v4 indices{ joints(i) };
                     element_buffer[i] = { {joint_weights[i].x, joint_weights[i].y, joint_weights[i].z}, t_signs[i],
-                                         {indices[0], indices[1], indices[2], indices[3]},
-                                         {normals[i].x, normals[i].y}, {tangents[i].x, tangents[i].y}, v.uv,
-                                         {v.red, v.green, v.blue}, {} };
+                                         {indices.x, indices.y, indices.z, indices.w},
+                                         {normals[i].x, normals[i].y}, {tangents[i].x, tangents[i].y}, v.uvs[i],
+                                         {color(i).red, color(i).green, color(i).blue}, {} };
                 }
             }
             break;
@@ -349,18 +689,54 @@ namespace Zetta::Tools {
             
             ProcessNormals(m, settings.smoothing_angle);
 
-            if (!m.uv_sets.empty())
+            if (!m.uv_sets.empty() && !m.uv_sets[0].empty())
+            {
                 ProcessUVs(m);
+
+                if (settings.calculate_tangents || m.tangents.size() != m.raw_indices.size())
+                    CalculateTangents(m);
+                else
+                    ProcessTangents(m);
+            }
             
             m.elements_type = DetermineElementType(m);
-            PackVertices(m);
+            PackVertices(m, settings);
+        }
+
+        // Streamed meshes were packed as soon as they were read and their intermediate data was released.
+        bool IsStreamed(const Mesh& m)
+        {
+            return m.vertices.empty() && !m.positions_buffer.empty();
+        }
+
+        // NOTE: derived from the packed positions, because streamed meshes don't keep their vertices.
+        u32 PackedVertexCount(const Mesh& m)
+        {
+            return (u32)(m.positions_buffer.size() / Content::PositionFormat::Size(m.position_format));
+        }
+
+        template<typename T>
+        void Release(util::vector<T>& v)
+        {
+            v = util::vector<T>{};
+        }
+
+        void ReleaseIntermediateData(Mesh& m)
+        {
+            Release(m.positions);
+            Release(m.normals);
+            Release(m.colors);
+            Release(m.tangents);
+            Release(m.uv_sets);
+            Release(m.material_indices);
+            Release(m.raw_indices);
+            m.vertices = VertexStreams{};
         }
 
         u64 GetMeshSize(const Mesh& m)
         {
-            const u64 num_vertices{ m.vertices.size() };
+            const u64 num_vertices{ PackedVertexCount(m) };
             const u64 positions_buffer_size{ m.positions_buffer.size() };
-            assert(positions_buffer_size == sizeof(Math::v3) * num_vertices);
             const u64 element_buffer_size{ m.element_buffer.size() };
             assert(element_buffer_size == GetVertexElementSize(m.elements_type) * num_vertices);
             const u64 index_size{ (num_vertices < (1 << 16)) ? sizeof(u16) : sizeof(u32) };
@@ -375,6 +751,10 @@ namespace Zetta::Tools {
                 su32 + // index size (16 bit or 32 bit)
                 su32 + // number of indices
                 sizeof(f32) + // LOD threshold
+                su32 + // position format
+                sizeof(f32) * 3 + // position dequantization scale
+                sizeof(f32) * 3 + // position dequantization bias
+                sizeof(Content::GeometryBounds) + // AABB and bounding sphere
                 positions_buffer_size + // room for vertex positions
                 element_buffer_size + // room for vertex Elements
                 index_buffer_size // room for indices
@@ -424,7 +804,7 @@ namespace Zetta::Tools {
             // Elements type enumeration
             blob.write((u32)m.elements_type);
             // number of vertices
-            const u32 num_vertices{ (u32)m.vertices.size() };
+            const u32 num_vertices{ PackedVertexCount(m) };
             blob.write(num_vertices);
             // index size (16 bit or 32 bit)
             const u32 index_size{ (num_vertices < (1 << 16)) ? sizeof(u16) : sizeof(u32) };
@@ -434,8 +814,19 @@ namespace Zetta::Tools {
             blob.write(num_indices);
             // LOD threshold
             blob.write(m.lod_threshold);
+            // position format and dequantization parameters
+            blob.write((u32)m.position_format);
+            blob.write(m.position_scale.x);
+            blob.write(m.position_scale.y);
+            blob.write(m.position_scale.z);
+            blob.write(m.position_bias.x);
+            blob.write(m.position_bias.y);
+            blob.write(m.position_bias.z);
+            // bounding volumes
+            static_assert(sizeof(Content::GeometryBounds) == sizeof(f32) * 10);
+            blob.write((const u8*)&m.bounds, sizeof(Content::GeometryBounds));
             // position buffer
-            assert(m.positions_buffer.size() == sizeof(Math::v3) * num_vertices);
+            assert(m.positions_buffer.size() == Content::PositionFormat::Size(m.position_format) * num_vertices);
             blob.write(m.positions_buffer.data(), m.positions_buffer.size());
             // element buffer
             assert(m.element_buffer.size() == elements_size * num_vertices);
@@ -454,30 +845,59 @@ namespace Zetta::Tools {
             blob.write(data, index_buffer_size);
         }
 
-        bool SplitMeshesByMaterial(u32 material_idx, const Mesh& m, Mesh& submesh) {
+        // Groups the triangles of a mesh by material with a counting sort. The triangles of material_used[i]
+        // end up in triangles[offsets[i]] ... triangles[offsets[i + 1] - 1], in their original order.
+        void BucketTrianglesByMaterial(const Mesh& m, util::vector<u32>& triangles, util::vector<u32>& offsets) {
+            const u32 num_polys{ (u32)m.raw_indices.size() / 3 };
+            const u32 num_materials{ (u32)m.material_used.size() };
+            assert(m.material_indices.size() == num_polys);
+
+            u32 max_material{ 0 };
+            for (const u32 mtl_idx : m.material_used) max_material = std::max(max_material, mtl_idx);
+            util::vector<u32> bucket_of(max_material + 1, u32_invalid_id);
+            for (u32 i{ 0 }; i < num_materials; i++) bucket_of[m.material_used[i]] = i;
+
+            const auto bucket{ [&](u32 poly) {
+                const u32 mtl_idx{ m.material_indices[poly] };
+                return mtl_idx <= max_material ? bucket_of[mtl_idx] : u32_invalid_id;
+            } };
+
+            offsets.resize(num_materials + 1, 0);
+            for (u32 i{ 0 }; i < num_polys; i++) {
+                const u32 b{ bucket(i) };
+                if (b != u32_invalid_id) offsets[b + 1]++;
+            }
+
+            for (u32 i{ 0 }; i < num_materials; i++) offsets[i + 1] += offsets[i];
+
+            util::vector<u32> cursor(num_materials);
+            memcpy(cursor.data(), offsets.data(), num_materials * sizeof(u32));
+            triangles.resize(offsets[num_materials]);
+            for (u32 i{ 0 }; i < num_polys; i++) {
+                const u32 b{ bucket(i) };
+                if (b != u32_invalid_id) triangles[cursor[b]++] = i;
+            }
+        }
+
+        // NOTE: vertices are remapped with a hash map sized to the bucket instead of a table sized to all
+        //       positions of the mesh, so that splitting into many materials doesn't allocate O(materials * positions).
+        void SplitMeshesByMaterial(u32 material_idx, const Mesh& m, const u32* const triangles, u32 num_triangles, Mesh& submesh) {
             submesh.name = m.name;
             submesh.lod_threshold = m.lod_threshold;
             submesh.lod_id = m.lod_id;
             submesh.material_used.emplace_back(material_idx);
             submesh.uv_sets.resize(m.uv_sets.size());
 
-            const u32 num_polys{ (u32)m.raw_indices.size() / 3 };
-            util::vector<u32> vertex_ref(m.positions.size(), u32_invalid_id);
-
-            for (u32 i{ 0 }; i < num_polys; i++) {
-                const u32 mtl_idx{ m.material_indices[i] };
-                if (mtl_idx != material_idx) continue;
+            std::unordered_map<u32, u32> vertex_ref;
+            vertex_ref.reserve((u64)num_triangles * 3);
 
-                const u32 index{ i * 3 };
+            for (u32 t{ 0 }; t < num_triangles; t++) {
+                const u32 index{ triangles[t] * 3 };
                 for (u32 j = index; j < index + 3; j++) {
                     const u32 v_idx{ m.raw_indices[j] };
-                    if (vertex_ref[v_idx] != u32_invalid_id)
-                        submesh.raw_indices.emplace_back(vertex_ref[v_idx]);
-                    else {
-                        submesh.raw_indices.emplace_back((u32)submesh.positions.size());
-                        vertex_ref[v_idx] = submesh.raw_indices.back();
-                        submesh.positions.emplace_back(m.positions[v_idx]);
-                    }
+                    const auto [ref, inserted] { vertex_ref.try_emplace(v_idx, (u32)submesh.positions.size()) };
+                    if (inserted) submesh.positions.emplace_back(m.positions[v_idx]);
+                    submesh.raw_indices.emplace_back(ref->second);
 
                     if (m.normals.size()) submesh.normals.emplace_back(m.normals[j]);
                     if (m.tangents.size()) submesh.tangents.emplace_back(m.tangents[j]);
@@ -489,31 +909,71 @@ namespace Zetta::Tools {
             }
 
             assert((submesh.raw_indices.size() % 3) == 0);
-            return !submesh.raw_indices.empty();
         }
 
         void SplitMeshesByMaterial(Scene& scene, Progression* const progression) {
             assert(progression);
             progression->Callback(0, 0);
+
+            util::vector<Mesh*> meshes;
+            for (auto& lod : scene.lod_groups)
+                for (auto& m : lod.meshes)
+                    meshes.emplace_back(&m);
+
+            struct MaterialBuckets {
+                util::vector<u32> triangles;
+                util::vector<u32> offsets;
+            };
+
+            // NOTE: Each mesh is split into its own slots so that the final order of submeshes
+            //       is the same regardless of how the work was scheduled.
+            util::vector<util::vector<Mesh>> split_meshes(meshes.size());
+            util::vector<MaterialBuckets> buckets(meshes.size());
+            ParallelFor((u32)meshes.size(), [&](u32 mesh_idx) {
+                Mesh& m{ *meshes[mesh_idx] };
+                if (m.material_used.size() > 1) {
+                    BucketTrianglesByMaterial(m, buckets[mesh_idx].triangles, buckets[mesh_idx].offsets);
+                    split_meshes[mesh_idx].resize(m.material_used.size());
+                }
+                else {
+                    split_meshes[mesh_idx].emplace_back(std::move(m));
+                }
+            });
+
+            // Build the submeshes of all meshes in one go, so meshes with many materials are spread over all workers.
+            struct SplitJob { u32 mesh_idx, bucket; };
+            util::vector<SplitJob> jobs;
+            for (u32 i{ 0 }; i < meshes.size(); i++)
+                for (u32 b{ 0 }; b + 1 < buckets[i].offsets.size(); b++)
+                    jobs.emplace_back(SplitJob{ i, b });
+
+            ParallelFor((u32)jobs.size(), [&](u32 job_idx) {
+                const SplitJob& job{ jobs[job_idx] };
+                const Mesh& m{ *meshes[job.mesh_idx] };
+                const MaterialBuckets& mesh_buckets{ buckets[job.mesh_idx] };
+                const u32 first{ mesh_buckets.offsets[job.bucket] };
+                const u32 count{ mesh_buckets.offsets[job.bucket + 1] - first };
+                if (count)
+                    SplitMeshesByMaterial(m.material_used[job.bucket], m, &mesh_buckets.triangles.data()[first], count,
+                                          split_meshes[job.mesh_idx][job.bucket]);
+            });
+
+            u32 mesh_idx{ 0 };
+            u32 total_meshes{ 0 };
             for (auto& lod : scene.lod_groups) {
                 util::vector<Mesh> new_meshes;
-                for (auto& m : lod.meshes) {
-                    const u32 num_materials{ (u32)m.material_used.size() };
-                    if (num_materials > 1) {
-                        for (u32 i{ 0 }; i < num_materials; i++) {
-                            Mesh submesh{};
-                            if (SplitMeshesByMaterial(m.material_used[i], m, submesh)) {
-                                new_meshes.emplace_back(submesh);
-                            }
-                        }
-                    }
-                    else {
-                        new_meshes.emplace_back(m);
-                    }
-                }
-                progression->Callback(progression->Value(), progression->Maximum() + (u32)new_meshes.size());
+                const u32 num_meshes{ (u32)lod.meshes.size() };
+                for (u32 i{ 0 }; i < num_meshes; i++)
+                    for (auto& submesh : split_meshes[mesh_idx++])
+                        if (!submesh.raw_indices.empty() || IsStreamed(submesh))
+                            new_meshes.emplace_back(std::move(submesh));
+
+                total_meshes += (u32)new_meshes.size();
                 new_meshes.swap(lod.meshes);
             }
+
+            assert(mesh_idx == meshes.size());
+            progression->Extend(total_meshes);
         }
 
         template<typename T>
@@ -524,17 +984,295 @@ namespace Zetta::Tools {
             memcpy(&dst[num_elements], src.data(), src.size() * sizeof(T));
         }
 
+        void MergeMeshes(Mesh* const* const meshes, u32 count, Mesh& batch, const GeometryImportSettings& settings)
+        {
+            const Mesh& first{ *meshes[0] };
+            batch.name = first.name;
+            batch.elements_type = first.elements_type;
+            batch.material_used = first.material_used;
+            batch.lod_id = first.lod_id;
+            batch.lod_threshold = first.lod_threshold;
+
+            for (u32 i{ 0 }; i < count; ++i)
+            {
+                const Mesh& m{ *meshes[i] };
+                assert(m.elements_type == batch.elements_type);
+                const u32 vertex_base{ batch.vertices.size() };
+                const u32 index_base{ (u32)batch.indices.size() };
+                AppendToVectorPOD(batch.vertices.positions, m.vertices.positions);
+                AppendToVectorPOD(batch.vertices.normals, m.vertices.normals);
+                AppendToVectorPOD(batch.vertices.tangents, m.vertices.tangents);
+                AppendToVectorPOD(batch.vertices.uvs, m.vertices.uvs);
+                AppendToVectorPOD(batch.vertices.joint_weights, m.vertices.joint_weights);
+                AppendToVectorPOD(batch.vertices.joint_indices, m.vertices.joint_indices);
+                AppendToVectorPOD(batch.vertices.colors, m.vertices.colors);
+                AppendToVectorPOD(batch.indices, m.indices);
+                for (u32 j{ index_base }; j < batch.indices.size(); ++j)
+                    batch.indices[j] += vertex_base;
+            }
+
+            // Recomputes bounds and (quantized) positions for the merged vertices.
+            PackVertices(batch, settings);
+        }
+
+        // NOTE: streamed meshes are already split into chunks of a good size for culling and
+        //       don't keep the vertices that merging needs.
+        bool IsBatchable(const LODGroup& lod)
+        {
+            return !lod.meshes.empty() &&
+                   std::all_of(lod.meshes.begin(), lod.meshes.end(), [&](const Mesh& m) {
+                       return m.lod_id == lod.meshes[0].lod_id && !IsStreamed(m);
+                   });
+        }
+
+        // Static batching: meshes of single-LOD groups that share material and element type are merged when
+        // the centers of their bounds fall into the same cell of a uniform grid, so culling stays per cell.
+        // Batches are closed before they'd reach 2^16 vertices, so only meshes that are already that large
+        // end up with 32 bit indices.
+        void BatchStaticMeshes(Scene& scene, const GeometryImportSettings& settings)
+        {
+            struct Candidate {
+                Mesh* mesh;
+                u32 material;
+                u32 elements_type;
+                s32 cell[3];
+            };
+
+            const f32 inv_cell_size{ settings.batch_cell_size > 0.f ? 1.f / settings.batch_cell_size : 0.f };
+            util::vector<LODGroup> groups;
+            util::vector<Candidate> candidates;
+
+            for (auto& lod : scene.lod_groups)
+            {
+                if (!IsBatchable(lod)) continue;
+
+                for (auto& m : lod.meshes)
+                {
+                    const XMVECTOR center{ (XMLoadFloat3(&m.bounds.aabb_min) + XMLoadFloat3(&m.bounds.aabb_max)) * 0.5f };
+                    XMFLOAT3 cell;
+                    XMStoreFloat3(&cell, XMVectorFloor(center * inv_cell_size));
+                    candidates.emplace_back(Candidate{ &m, m.material_used.empty() ? u32_invalid_id : m.material_used[0],
+                                                       (u32)m.elements_type, { (s32)cell.x, (s32)cell.y, (s32)cell.z } });
+                }
+            }
+
+            if (candidates.size() < 2) return;
+
+            std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+                if (a.material != b.material) return a.material < b.material;
+                if (a.elements_type != b.elements_type) return a.elements_type < b.elements_type;
+                return std::lexicographical_compare(a.cell, a.cell + 3, b.cell, b.cell + 3);
+            });
+
+            const auto same_batch{ [](const Candidate& a, const Candidate& b) {
+                return a.material == b.material && a.elements_type == b.elements_type &&
+                       a.cell[0] == b.cell[0] && a.cell[1] == b.cell[1] && a.cell[2] == b.cell[2];
+            } };
+
+            LODGroup batched{};
+            batched.name = scene.lod_groups[0].name;
+            util::vector<Mesh*> batch_meshes;
+            u32 batch_vertices{ 0 };
+
+            for (u32 i{ 0 }; i < candidates.size(); ++i)
+            {
+                Mesh* const m{ candidates[i].mesh };
+                const u32 num_vertices{ m->vertices.size() };
+                if (!batch_meshes.empty() && batch_vertices + num_vertices >= (1 << 16))
+                {
+                    MergeMeshes(batch_meshes.data(), (u32)batch_meshes.size(), batched.meshes.emplace_back(), settings);
+                    batch_meshes.clear();
+                    batch_vertices = 0;
+                }
+
+                batch_meshes.emplace_back(m);
+                batch_vertices += num_vertices;
+
+                if (i + 1 == candidates.size() || !same_batch(candidates[i], candidates[i + 1]))
+                {
+                    MergeMeshes(batch_meshes.data(), (u32)batch_meshes.size(), batched.meshes.emplace_back(), settings);
+                    batch_meshes.clear();
+                    batch_vertices = 0;
+                }
+            }
+
+            // Groups with several LODs or streamed meshes are left alone; every other group has been merged into the batches.
+            for (auto& lod : scene.lod_groups)
+            {
+                if (!IsBatchable(lod) && !lod.meshes.empty()) groups.emplace_back(std::move(lod));
+            }
+
+            groups.emplace_back(std::move(batched));
+            groups.swap(scene.lod_groups);
+        }
+
     } // anonymous namespace
 
     void ProcessScene(Scene& scene, const GeometryImportSettings& settings, Progression* const progression)
     {
         SplitMeshesByMaterial(scene, progression);
 
+        util::vector<Mesh*> meshes;
         for (auto& lod : scene.lod_groups)
-            for (auto& m : lod.meshes) {
-                ProcessVertices(m, settings);
-                progression->Callback(progression->Value() + 1, progression->Maximum());
+            for (auto& m : lod.meshes)
+                meshes.emplace_back(&m);
+
+        // NOTE: Meshes don't share any data after the split, so each one is processed on its own worker.
+        ParallelFor((u32)meshes.size(), [&](u32 i) {
+            if (!IsStreamed(*meshes[i])) ProcessVertices(*meshes[i], settings);
+            progression->Increment();
+        });
+
+        if (settings.static_batching)
+            BatchStaticMeshes(scene, settings);
+    }
+
+    void StreamMesh(const TriangleSource& source, const Mesh& prototype, const GeometryImportSettings& settings,
+                    util::vector<Mesh>& meshes, Progression* const progression)
+    {
+        const u32 num_triangles{ source.TriangleCount() };
+        if (!num_triangles) return;
+
+        // Triangles are ordered along a Morton curve through the centroid bounds, so consecutive runs of them
+        // are spatially coherent chunks. Each key holds the code in its upper and the triangle index in its lower
+        // 32 bits. Only the keys of one round of chunks are alive: a histogram of the coarse Morton cells decides
+        // which cells each round takes, and a single pass buckets the triangle indices by round, so that every
+        // round only goes over its own triangles.
+        XMVECTOR min{ XMVectorReplicate(FLT_MAX) };
+        XMVECTOR max{ XMVectorReplicate(-FLT_MAX) };
+        for (u32 i{ 0 }; i < num_triangles; ++i)
+        {
+            const Math::v3 c{ source.TriangleCentroid(i) };
+            const XMVECTOR p{ XMLoadFloat3(&c) };
+            min = XMVectorMin(min, p);
+            max = XMVectorMax(max, p);
+        }
+
+        constexpr f32 grid_size{ 1023.f };
+        const XMVECTOR extent{ XMVectorMax(max - min, XMVectorReplicate(FLT_EPSILON)) };
+        const XMVECTOR to_grid{ XMVectorReplicate(grid_size) / extent };
+        const auto spread_bits{ [](u32 x) {
+            x = (x | (x << 16)) & 0x030000ff;
+            x = (x | (x << 8)) & 0x0300f00f;
+            x = (x | (x << 4)) & 0x030c30c3;
+            x = (x | (x << 2)) & 0x09249249;
+            return x;
+        } };
+        const auto morton_code{ [&](u32 triangle) {
+            const Math::v3 c{ source.TriangleCentroid(triangle) };
+            XMFLOAT3 cell;
+            XMStoreFloat3(&cell, XMVectorClamp((XMLoadFloat3(&c) - min) * to_grid, XMVectorZero(), XMVectorReplicate(grid_size)));
+            return spread_bits((u32)cell.x) | (spread_bits((u32)cell.y) << 1) | (spread_bits((u32)cell.z) << 2);
+        } };
+
+        // Codes have 30 bits, the coarse cells are their upper 18.
+        constexpr u32 coarse_shift{ 12 };
+        util::vector<u32> cell_counts(1u << (30 - coarse_shift), 0u);
+        for (u32 i{ 0 }; i < num_triangles; ++i) ++cell_counts[morton_code(i) >> coarse_shift];
+
+        // Chunks are read one after the other, because importer SDKs can't be read from several threads,
+        // and then processed in parallel. Only one round of chunks is alive before it's packed.
+        // NOTE: a round is bounded by chunks_per_round chunks, unless a single coarse cell has more triangles.
+        //       This bounds the importer's own memory, the source (e.g. the whole FBX scene) stays loaded.
+        const u32 chunks_per_round{ std::max(std::thread::hardware_concurrency(), 1u) };
+        const u32 round_triangles{ chunks_per_round * streaming_chunk_triangles };
+        struct Round {
+            u32 first_cell;
+            u32 end_cell;
+            u32 triangle_count;
+        };
+        util::vector<Round> rounds;
+        {
+            Round next{ 0, 0, 0 };
+            for (u32 cell{ 0 }; cell < cell_counts.size(); ++cell)
+            {
+                if (next.triangle_count && next.triangle_count + cell_counts[cell] > round_triangles)
+                {
+                    rounds.emplace_back(next);
+                    next = { cell, cell, 0 };
+                }
+                next.end_cell = cell + 1;
+                next.triangle_count += cell_counts[cell];
+            }
+            if (next.triangle_count) rounds.emplace_back(next);
+        }
+
+        u32 num_chunks{ 0 };
+        for (const Round& r : rounds) num_chunks += (r.triangle_count + streaming_chunk_triangles - 1) / streaming_chunk_triangles;
+        progression->Extend(num_chunks);
+
+        // NOTE: the bucketed indices take 4 bytes per triangle. The histogram isn't needed anymore, so it's reused
+        //       to map each cell to its round.
+        util::vector<u32> next_slot(rounds.size());
+        {
+            u32 offset{ 0 };
+            for (u32 r{ 0 }; r < rounds.size(); ++r)
+            {
+                for (u32 cell{ rounds[r].first_cell }; cell < rounds[r].end_cell; ++cell) cell_counts[cell] = r;
+                next_slot[r] = offset;
+                offset += rounds[r].triangle_count;
+            }
+        }
+        util::vector<u32> bucketed_triangles(num_triangles);
+        for (u32 i{ 0 }; i < num_triangles; ++i) bucketed_triangles[next_slot[cell_counts[morton_code(i) >> coarse_shift]]++] = i;
+
+        util::vector<u64> keys;
+        util::vector<u32> triangles(streaming_chunk_triangles);
+        util::vector<Mesh> round;
+        u32 round_offset{ 0 };
+
+        for (const Round& r : rounds)
+        {
+            keys.clear();
+            for (u32 i{ round_offset }; i < round_offset + r.triangle_count; ++i)
+            {
+                const u32 triangle{ bucketed_triangles[i] };
+                keys.emplace_back(((u64)morton_code(triangle) << 32) | triangle);
+            }
+            round_offset += r.triangle_count;
+            std::sort(keys.begin(), keys.end());
+
+            const u32 round_chunks{ (r.triangle_count + streaming_chunk_triangles - 1) / streaming_chunk_triangles };
+            for (u32 chunk{ 0 }; chunk < round_chunks; ++chunk)
+            {
+                const u32 first{ chunk * streaming_chunk_triangles };
+                const u32 count{ std::min(streaming_chunk_triangles, r.triangle_count - first) };
+                for (u32 i{ 0 }; i < count; ++i) triangles[i] = (u32)keys[first + i];
+
+                Mesh m{};
+                m.name = prototype.name;
+                m.lod_id = prototype.lod_id;
+                m.lod_threshold = prototype.lod_threshold;
+                source.GetTriangles(triangles.data(), count, m);
+                if (m.raw_indices.empty()) continue;
+
+                if (m.material_used.size() > 1)
+                {
+                    util::vector<u32> buckets;
+                    util::vector<u32> offsets;
+                    BucketTrianglesByMaterial(m, buckets, offsets);
+                    for (u32 b{ 0 }; b < m.material_used.size(); ++b)
+                    {
+                        const u32 bucket_count{ offsets[b + 1] - offsets[b] };
+                        if (bucket_count)
+                            SplitMeshesByMaterial(m.material_used[b], m, &buckets.data()[offsets[b]], bucket_count, round.emplace_back());
+                    }
+                }
+                else
+                {
+                    round.emplace_back(std::move(m));
+                }
             }
+
+            ParallelFor((u32)round.size(), [&](u32 i) {
+                ProcessVertices(round[i], settings);
+                ReleaseIntermediateData(round[i]);
+            });
+
+            for (auto& m : round) meshes.emplace_back(std::move(m));
+            round.clear();
+            progression->Increment(round_chunks);
+        }
     }
 
     void PackData(const Scene& scene, SceneData& data)
@@ -567,6 +1305,71 @@ namespace Zetta::Tools {
         assert(scene_size == blob.Offset());
     }
 
+    bool SceneCacheKey(const char* file, SceneImporter::Type importer, const GeometryImportSettings& settings, ImportCache::Key& key)
+    {
+        static_assert(sizeof(GeometryImportSettings) == 16, "GeometryImportSettings must not have padding bytes, because it's hashed as a whole.");
+        ImportCache::Hasher hasher{};
+        hasher.Update(ImportCache::tool_version);
+        hasher.Update(importer);
+        hasher.Update(settings);
+        if (!hasher.UpdateFromFile(file)) return false;
+
+        key = hasher.Finalize();
+        return true;
+    }
+
+    bool LoadCachedScene(const ImportCache::Key& key, SceneData& data)
+    {
+        util::vector<u8> payload;
+        if (!ImportCache::Lookup(key, payload)) return false;
+
+        data.size = (u32)payload.size();
+        data.data = (u8*)CoTaskMemAlloc(payload.size());
+        assert(data.data);
+        memcpy(data.data, payload.data(), payload.size());
+        return true;
+    }
+
+    void UnpackPositions(const Mesh& m, util::vector<Math::v3>& positions)
+    {
+        using Content::PositionFormat;
+        const u32 num_vertices{ (u32)(m.positions_buffer.size() / PositionFormat::Size(m.position_format)) };
+        positions.resize(num_vertices);
+
+        if (m.position_format == PositionFormat::Float3)
+        {
+            memcpy(positions.data(), m.positions_buffer.data(), m.positions_buffer.size());
+            return;
+        }
+
+        assert(m.position_format == PositionFormat::Unorm16x3);
+        const QuantizedPosition* const quantized{ (const QuantizedPosition* const)m.positions_buffer.data() };
+        const XMVECTOR scale{ XMLoadFloat3(&m.position_scale) };
+        const XMVECTOR bias{ XMLoadFloat3(&m.position_bias) };
+        for (u32 i{ 0 }; i < num_vertices; ++i)
+        {
+            const QuantizedPosition& q{ quantized[i] };
+            const XMVECTOR p{ XMVectorSet((f32)q.x, (f32)q.y, (f32)q.z, 0.f) };
+            XMStoreFloat3(&positions[i], XMVectorMultiplyAdd(p, scale, bias));
+        }
+    }
+
+    f32 MaxPositionError(const Mesh& m)
+    {
+        util::vector<Math::v3> positions;
+        UnpackPositions(m, positions);
+        assert(positions.size() == m.vertices.size());
+
+        XMVECTOR max_error{ XMVectorZero() };
+        for (u32 i{ 0 }; i < positions.size(); ++i)
+        {
+            const XMVECTOR d{ XMLoadFloat3(&positions[i]) - XMLoadFloat3(&m.vertices.positions[i]) };
+            max_error = XMVectorMax(max_error, XMVector3Length(d));
+        }
+
+        return XMVectorGetX(max_error);
+    }
+
     bool CoalesceMeshes(const LODGroup& lod, Mesh& combined_mesh, Progression* const progression) {
         assert(lod.meshes.size());
         const Mesh& first_mesh{ lod.meshes[0] };
@@ -590,15 +1393,6 @@ namespace Zetta::Tools {
 
         for (u32 mesh_idx{ 0 }; mesh_idx < lod.meshes.size(); mesh_idx++) {
             const Mesh& m{ lod.meshes[mesh_idx] };
-
-            if (combined_mesh.elements_type != DetermineElementType(m) ||
-                combined_mesh.uv_sets.size() != m.uv_sets.size() ||
-                combined_mesh.lod_id != m.lod_id ||
-                !Math::IsEqual(combined_mesh.lod_threshold, m.lod_threshold)) {
-                combined_mesh = {};
-                return false;
-            }
-
             const u32 position_count{ (u32)combined_mesh.positions.size() };
             const u32 raw_index_base{ (u32)combined_mesh.raw_indices.size() };
 
@@ -629,4 +1423,23 @@ namespace Zetta::Tools {
 
         return true;
     }
+
+    // NOTE: used by the editor when packing geometry for the engine. 'stride' is the vertex size
+    //       for vertex buffers and the index size (2 or 4) for index buffers.
+    EDITOR_INTERFACE u32 GeometryBufferBound(u32 count, u32 stride, u32 is_index_buffer)
+    {
+        const u64 bound{ is_index_buffer ? Content::Codec::IndexBufferBound(count) : Content::Codec::VertexBufferBound(count, stride) };
+        assert(bound < u32_invalid_id);
+        return (u32)bound;
+    }
+
+    // Returns the size of the encoded buffer or 0 if the buffer couldn't be encoded.
+    EDITOR_INTERFACE u32 CompressGeometryBuffer(const u8* const data, u32 count, u32 stride, u32 is_index_buffer, u8* const output, u32 output_size)
+    {
+        assert(data && output && stride);
+        const u64 size{ is_index_buffer
+            ? Content::Codec::EncodeIndexBuffer(output, output_size, data, count, stride)
+            : Content::Codec::EncodeVertexBuffer(output, output_size, data, count, stride) };
+        return (u32)size;
+    }
 }
\ No newline at end of file
@@ -1,16 +1,25 @@
 #pragma once
 #include "ToolsCommon.h"
+#include "Content/ContentToEngine.h"
+#include "ImportCache.h"
 
 namespace Zetta::Tools {
-	struct Vertex {
-		Math::v4 tangent{};
-		Math::v4 joint_weights{};
-		Math::u32v4 joint_indices{ u32_invalid_id, u32_invalid_id, u32_invalid_id, u32_invalid_id };
-		Math::v3 position{};
-		Math::v3 normal{};
-		Math::v2 uv{};
-		u8 red{}, green{}, blue{};
-		u8 pad;
+	// Welded vertices with one array per attribute. Positions are always present. The other streams
+	// are only filled by the processing steps that the mesh's elements type needs and are otherwise
+	// empty, so static meshes never allocate or copy skinning data.
+	struct VertexStreams {
+		struct Color { u8 red, green, blue; };
+
+		util::vector<Math::v3>		positions;
+		util::vector<Math::v3>		normals;
+		util::vector<Math::v4>		tangents;		// w is the handedness of the bitangent
+		util::vector<Math::v2>		uvs;
+		util::vector<Math::v4>		joint_weights;
+		util::vector<Math::u32v4>	joint_indices;
+		util::vector<Color>			colors;
+
+		[[nodiscard]] u32 size() const { return (u32)positions.size(); }
+		[[nodiscard]] bool empty() const { return positions.empty(); }
 	};
 	
 	namespace Elements {
@@ -112,12 +121,16 @@ namespace Zetta::Tools {
 		util::vector<u32>						raw_indices;
 
 		// Intermediate data
-		util::vector<Vertex>					vertices;
+		VertexStreams							vertices;
 		util::vector<u32>						indices;
 
 		// Output data
 		std::string									name;
 		Elements::ElementsType::Type					elements_type;
+		Content::PositionFormat::Format				position_format{ Content::PositionFormat::Float3 };
+		Math::v3									position_scale{ 1.f, 1.f, 1.f };	// dequantized position = bias + scale * quantized position
+		Math::v3									position_bias{};
+		Content::GeometryBounds						bounds{};
 		util::vector<u8>							positions_buffer;
 		util::vector<u8>							element_buffer;
 
@@ -143,6 +156,9 @@ namespace Zetta::Tools {
 		u8	import_embeded;
 		u8	import_animations;
 		u8  coalesce_meshes;
+		u8	quantize_positions;
+		u8	static_batching;
+		f32	batch_cell_size;
 	};
 
 	struct SceneData {
@@ -151,7 +167,45 @@ namespace Zetta::Tools {
 		GeometryImportSettings settings;
 	};
 
+	struct SceneImporter {
+		enum Type : u32 {
+			FBX,
+			ASSIMP,
+		};
+	};
+
+	// Meshes with more triangles than this are imported in spatial chunks by StreamMesh(), so that
+	// only a few chunks' worth of intermediate data is alive at any time.
+	constexpr u32 streaming_triangle_threshold{ 1 << 22 };
+	constexpr u32 streaming_chunk_triangles{ 1 << 16 };
+
+	// Read access to the triangles of a mesh that is too large to be materialized as one Tools::Mesh.
+	class TriangleSource {
+	public:
+		virtual ~TriangleSource() = default;
+		[[nodiscard]] virtual u32 TriangleCount() const = 0;
+		// Only used to sort triangles spatially, so it may be in any space as long as it's consistent.
+		[[nodiscard]] virtual Math::v3 TriangleCentroid(u32 triangle) const = 0;
+		// Fills the initial data of m (positions, raw_indices, per corner normals, tangents and uvs,
+		// material indices) with the given triangles, as an importer would for a whole mesh.
+		virtual void GetTriangles(const u32* const triangles, u32 count, Mesh& m) const = 0;
+	};
+
 	void ProcessScene(Scene& scene, const GeometryImportSettings& settings, Progression* const progression);
+	// Splits the mesh into spatially coherent chunks and fully processes them a few at a time. The chunks
+	// are appended to meshes with only their packed data left; ProcessScene() passes them through as they are.
+	// NOTE: besides the packed chunks, memory grows with one round of chunks (a chunk per hardware thread), a
+	//		 1MB histogram and 4 bytes per triangle for the triangle indices bucketed by round. Triangles that all
+	//		 fall in one 1/2^18th of the bounds can make a round larger. The source itself isn't released, e.g. the
+	//		 FBX scene stays loaded.
+	void StreamMesh(const TriangleSource& source, const Mesh& prototype, const GeometryImportSettings& settings,
+					util::vector<Mesh>& meshes, Progression* const progression);
 	void PackData(const Scene& scene, SceneData& data);
 	bool CoalesceMeshes(const LODGroup& lod, Mesh& CombinedMesh, Progression* const prorgession);
+	// Builds the import cache key for a scene file. Returns false if the file can't be read.
+	[[nodiscard]] bool SceneCacheKey(const char* file, SceneImporter::Type importer, const GeometryImportSettings& settings, ImportCache::Key& key);
+	// Fills data with a previously packed scene. Returns false on a cache miss.
+	[[nodiscard]] bool LoadCachedScene(const ImportCache::Key& key, SceneData& data);
+	void UnpackPositions(const Mesh& m, util::vector<Math::v3>& positions);
+	[[nodiscard]] f32 MaxPositionError(const Mesh& m);
 }
\ No newline at end of file
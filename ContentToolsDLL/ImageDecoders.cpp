@@ -0,0 +1,1102 @@
+#include "ImageDecoders.h"
+#include <immintrin.h>
+#include <cmath>
+#include <memory>
+#include <algorithm>
+
+namespace Zetta::Tools::ImageDecoder {
+	namespace {
+		constexpr u8 png_signature[8]{ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+		constexpr char tga_footer_signature[18]{ "TRUEVISION-XFILE." };
+		constexpr u32 tga_footer_size{ 26 };
+		constexpr u32 tga_extension_size{ 495 };
+		constexpr u32 tga_gamma_offset{ 478 };
+
+		// Larger images than textures can have are left alone, which also keeps sizes of rows in 32 bits.
+		constexpr u32 max_image_size{ 1 << 16 };
+
+		[[nodiscard]] u16 ReadLE16(const u8* const p) { return (u16)(p[0] | (p[1] << 8)); }
+		[[nodiscard]] u16 ReadBE16(const u8* const p) { return (u16)((p[0] << 8) | p[1]); }
+		[[nodiscard]] u32 ReadBE32(const u8* const p) { return ((u32)p[0] << 24) | ((u32)p[1] << 16) | ((u32)p[2] << 8) | p[3]; }
+
+		[[nodiscard]] bool StartsWith(const u8* const data, u64 size, const char* const prefix) {
+			const u64 length{ strlen(prefix) };
+			return size >= length && !memcmp(data, prefix, length);
+		}
+
+		// ---- Inflate: DEFLATE (RFC 1951) in a zlib wrapper (RFC 1950) ----
+
+		constexpr u32 max_code_bits{ 15 };
+		constexpr u32 fast_bits{ 10 };
+		// Bytes past the end of the output that matches may write over, so they can be copied in whole blocks.
+		constexpr u32 inflate_slack{ 16 };
+
+		constexpr u16 length_bases[29]{ 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+		constexpr u8 length_extra_bits[29]{ 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+		constexpr u16 distance_bases[30]{ 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+			4097, 6145, 8193, 12289, 16385, 24577 };
+		constexpr u8 distance_extra_bits[30]{ 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+		constexpr u8 code_length_order[19]{ 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+		// Reads bits from the least significant end of a 64-bit buffer, which is refilled 8 bytes at a time.
+		class BitReader {
+		public:
+			BitReader(const u8* const data, u64 size) : _position{ data }, _end{ data + size } {}
+
+			// Afterwards, there are at least 56 bits in the buffer. Past the end of the data, zeros are read.
+			void Refill() {
+				if (_end - _position >= 8) {
+					// The bytes above _count are loaded again next time at the same place, so loading them twice is harmless.
+					u64 value;
+					memcpy(&value, _position, sizeof(value));
+					_bits |= value << _count;
+					_position += (63 - _count) >> 3;
+					_count |= 56;
+					return;
+				}
+
+				while (_count <= 56) {
+					if (_position < _end) _bits |= (u64)*_position++ << _count;
+					else _overrun += 8;
+					_count += 8;
+				}
+			}
+
+			[[nodiscard]] u32 Peek(u32 count) const { return (u32)(_bits & ((1ull << count) - 1)); }
+			void Consume(u32 count) { assert(count <= _count); _bits >>= count; _count -= count; }
+
+			[[nodiscard]] u32 Read(u32 count) {
+				const u32 value{ Peek(count) };
+				Consume(count);
+				return value;
+			}
+
+			// Drops the bits up to the next byte and hands out the bytes that follow. Nothing is left in the buffer.
+			[[nodiscard]] const u8* AlignToByte() {
+				Consume(_count & 7);
+				const u8* const position{ _position - (_count >> 3) };
+				_bits = 0;
+				_count = 0;
+				_position = position;
+				return position;
+			}
+
+			void Skip(u64 bytes) { _position += bytes; }
+			[[nodiscard]] u64 BytesLeft() const { return (u64)(_end - _position); }
+
+			// True if more bits were used than the data had.
+			[[nodiscard]] bool IsOverrun() const { return _overrun > _count; }
+
+		private:
+			const u8*	_position;
+			const u8*	_end;
+			u64			_bits{ 0 };
+			u32			_count{ 0 };
+			u32			_overrun{ 0 };
+		};
+
+		// Canonical Huffman code. Codes up to fast_bits long are decoded with one lookup, longer ones bit by bit.
+		struct Huffman {
+			u16 fast[1 << fast_bits];			// (symbol << 4) | code length, or 0 for longer codes
+			u16 counts[max_code_bits + 1];		// codes of each length
+			u16 symbols[288];					// symbols ordered by code
+		};
+
+		[[nodiscard]] bool BuildHuffman(const u8* const lengths, u32 count, Huffman& huffman) {
+			memset(huffman.fast, 0, sizeof(huffman.fast));
+			memset(huffman.counts, 0, sizeof(huffman.counts));
+			for (u32 i{ 0 }; i < count; i++) huffman.counts[lengths[i]]++;
+			huffman.counts[0] = 0;
+
+			// Codes may be incomplete, like a single distance code, but not over-subscribed.
+			s32 left{ 1 };
+			for (u32 length{ 1 }; length <= max_code_bits; length++) {
+				left = (left << 1) - huffman.counts[length];
+				if (left < 0) return false;
+			}
+
+			u16 offsets[max_code_bits + 1]{};
+			for (u32 length{ 1 }; length < max_code_bits; length++) offsets[length + 1] = offsets[length] + huffman.counts[length];
+			for (u32 i{ 0 }; i < count; i++) {
+				if (lengths[i]) huffman.symbols[offsets[lengths[i]]++] = (u16)i;
+			}
+
+			// DEFLATE sends codes starting from their most significant bit, so the table is indexed by reversed codes.
+			u32 code{ 0 };
+			u32 index{ 0 };
+			for (u32 length{ 1 }; length <= fast_bits; length++, code <<= 1) {
+				for (u32 i{ 0 }; i < huffman.counts[length]; i++, code++) {
+					u32 reversed{ 0 };
+					for (u32 bit{ 0 }; bit < length; bit++) reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+					const u16 entry{ (u16)((huffman.symbols[index++] << 4) | length) };
+					for (u32 j{ reversed }; j < (1u << fast_bits); j += 1u << length) huffman.fast[j] = entry;
+				}
+			}
+
+			return true;
+		}
+
+		// Needs 15 bits in the reader. Returns -1 for codes that don't exist.
+		[[nodiscard]] s32 DecodeSymbol(BitReader& reader, const Huffman& huffman) {
+			const u16 entry{ huffman.fast[reader.Peek(fast_bits)] };
+			if (entry) {
+				reader.Consume(entry & 15);
+				return entry >> 4;
+			}
+
+			s32 code{ 0 };
+			s32 first{ 0 };
+			s32 index{ 0 };
+			for (u32 length{ 1 }; length <= max_code_bits; length++) {
+				code |= (s32)reader.Read(1);
+				const s32 count{ huffman.counts[length] };
+				if (code - first < count) return huffman.symbols[index + code - first];
+				index += count;
+				first = (first + count) << 1;
+				code <<= 1;
+			}
+			return -1;
+		}
+
+		void BuildFixedHuffman(Huffman& literals, Huffman& distances) {
+			u8 lengths[288];
+			memset(lengths, 8, 144);
+			memset(lengths + 144, 9, 112);
+			memset(lengths + 256, 7, 24);
+			memset(lengths + 280, 8, 8);
+			[[maybe_unused]] bool is_valid{ BuildHuffman(lengths, 288, literals) };
+			memset(lengths, 5, 30);
+			is_valid &= BuildHuffman(lengths, 30, distances);
+			assert(is_valid);
+		}
+
+		[[nodiscard]] bool ReadDynamicHuffman(BitReader& reader, Huffman& literals, Huffman& distances) {
+			reader.Refill();
+			const u32 literal_count{ reader.Read(5) + 257 };
+			const u32 distance_count{ reader.Read(5) + 1 };
+			const u32 code_length_count{ reader.Read(4) + 4 };
+			if (literal_count > 286 || distance_count > 30) return false;
+
+			u8 code_lengths[19]{};
+			for (u32 i{ 0 }; i < code_length_count; i++) {
+				reader.Refill();
+				code_lengths[code_length_order[i]] = (u8)reader.Read(3);
+			}
+
+			Huffman code_length_huffman;
+			if (!BuildHuffman(code_lengths, 19, code_length_huffman)) return false;
+
+			u8 lengths[286 + 30];
+			const u32 count{ literal_count + distance_count };
+			for (u32 i{ 0 }; i < count;) {
+				reader.Refill();
+				const s32 symbol{ DecodeSymbol(reader, code_length_huffman) };
+				if (symbol < 0) return false;
+				if (symbol < 16) {
+					lengths[i++] = (u8)symbol;
+					continue;
+				}
+
+				u8 value{ 0 };
+				u32 repeat;
+				if (symbol == 16) {
+					if (!i) return false;
+					value = lengths[i - 1];
+					repeat = 3 + reader.Read(2);
+				}
+				else if (symbol == 17) repeat = 3 + reader.Read(3);
+				else repeat = 11 + reader.Read(7);
+
+				if (i + repeat > count) return false;
+				memset(&lengths[i], value, repeat);
+				i += repeat;
+			}
+
+			if (!lengths[256]) return false;
+			return BuildHuffman(lengths, literal_count, literals) && BuildHuffman(&lengths[literal_count], distance_count, distances);
+		}
+
+		// Copies a match, which overlaps its own output when it's longer than its distance. Copies in whole
+		// blocks can write up to inflate_slack bytes past the match, over output that comes later.
+		void CopyMatch(u8* const out, u32 distance, u32 length) {
+			const u8* const source{ out - distance };
+			if (distance >= 16) {
+				for (u32 i{ 0 }; i < length; i += 16) _mm_storeu_si128((__m128i*)&out[i], _mm_loadu_si128((const __m128i*)&source[i]));
+			}
+			else if (distance >= 8) {
+				for (u32 i{ 0 }; i < length; i += 8) memcpy(&out[i], &source[i], 8);
+			}
+			else if (distance == 1) {
+				memset(out, *source, length);
+			}
+			else {
+				for (u32 i{ 0 }; i < length; i++) out[i] = source[i];
+			}
+		}
+
+		[[nodiscard]] bool InflateBlock(BitReader& reader, const Huffman& literals, const Huffman& distances,
+			const u8* const output, u8*& out, const u8* const out_end) {
+			for (;;) {
+				// 56 bits cover the longest length code, its extra bits, the longest distance code and its extra bits.
+				reader.Refill();
+				const s32 symbol{ DecodeSymbol(reader, literals) };
+				if (symbol < 256) {
+					if (symbol < 0 || out == out_end) return false;
+					*out++ = (u8)symbol;
+					continue;
+				}
+				if (symbol == 256) return true;
+
+				const u32 length_index{ (u32)symbol - 257 };
+				if (length_index >= 29) return false;
+				const u32 length{ length_bases[length_index] + reader.Read(length_extra_bits[length_index]) };
+
+				const s32 distance_symbol{ DecodeSymbol(reader, distances) };
+				if (distance_symbol < 0 || distance_symbol >= 30) return false;
+				const u32 distance{ distance_bases[distance_symbol] + reader.Read(distance_extra_bits[distance_symbol]) };
+
+				if (distance > (u64)(out - output) || length > (u64)(out_end - out)) return false;
+				CopyMatch(out, distance, length);
+				out += length;
+			}
+		}
+
+		// Decompresses a zlib stream into exactly output_size bytes. 'output' needs inflate_slack more bytes of room.
+		[[nodiscard]] bool Inflate(const u8* const data, u64 size, u8* const output, u64 output_size) {
+			if (size < 2 || (data[0] & 0x0f) != 8 || (data[0] >> 4) > 7 || ((data[0] << 8) | data[1]) % 31 || (data[1] & 0x20)) return false;
+
+			BitReader reader{ data + 2, size - 2 };
+			u8* out{ output };
+			const u8* const out_end{ output + output_size };
+			Huffman literals;
+			Huffman distances;
+			bool is_final{ false };
+
+			while (!is_final) {
+				reader.Refill();
+				is_final = reader.Read(1);
+				const u32 type{ reader.Read(2) };
+
+				if (type == 0) {
+					const u8* const block{ reader.AlignToByte() };
+					if (reader.IsOverrun() || reader.BytesLeft() < 4) return false;
+					const u16 length{ ReadLE16(block) };
+					if ((u16)~ReadLE16(block + 2) != length || reader.BytesLeft() < 4ull + length || length > (u64)(out_end - out)) return false;
+					memcpy(out, block + 4, length);
+					out += length;
+					reader.Skip(4ull + length);
+					continue;
+				}
+
+				if (type == 1) BuildFixedHuffman(literals, distances);
+				else if (type != 2 || !ReadDynamicHuffman(reader, literals, distances)) return false;
+
+				if (!InflateBlock(reader, literals, distances, output, out, out_end)) return false;
+			}
+
+			return out == out_end && !reader.IsOverrun();
+		}
+
+		// ---- PNG ----
+
+		struct PNGColorType {
+			enum Type : u8 {
+				Gray = 0,
+				RGB = 2,
+				Palette = 3,
+				GrayAlpha = 4,
+				RGBA = 6,
+			};
+		};
+
+		struct PNGFilter {
+			enum Type : u8 {
+				None,
+				Sub,
+				Up,
+				Average,
+				Paeth,
+
+				count
+			};
+		};
+
+		struct PNGHeader {
+			u32			width;
+			u32			height;
+			u8			bit_depth;
+			u8			color_type;
+			bool		is_interlaced;
+			bool		is_srgb;
+			u32			channel_count;
+			const u8*	palette;			// RGB entries
+			u32			palette_count;
+			const u8*	transparency;		// tRNS chunk: alpha per palette entry, or the transparent gray or RGB value
+			u32			transparency_size;
+			const u8*	idat;				// the first IDAT chunk
+			u64			idat_size;			// of all IDAT chunks
+			u32			idat_count;
+		};
+
+		// Adam7 passes. Images that aren't interlaced have one pass, which is the last one of these.
+		constexpr u32 adam7_x[7]{ 0, 4, 0, 2, 0, 1, 0 };
+		constexpr u32 adam7_y[7]{ 0, 0, 4, 0, 2, 0, 1 };
+		constexpr u32 adam7_dx[7]{ 8, 8, 4, 4, 2, 2, 1 };
+		constexpr u32 adam7_dy[7]{ 8, 8, 8, 4, 4, 2, 2 };
+
+		struct PNGPass {
+			u32 x;
+			u32 y;
+			u32 dx;
+			u32 dy;
+			u32 width;
+			u32 height;
+		};
+
+		[[nodiscard]] PNGPass GetPass(const PNGHeader& header, u32 pass) {
+			if (!header.is_interlaced) return { 0, 0, 1, 1, header.width, header.height };
+			const u32 x{ adam7_x[pass] };
+			const u32 y{ adam7_y[pass] };
+			const u32 dx{ adam7_dx[pass] };
+			const u32 dy{ adam7_dy[pass] };
+			return { x, y, dx, dy, header.width > x ? (header.width - x + dx - 1) / dx : 0, header.height > y ? (header.height - y + dy - 1) / dy : 0 };
+		}
+
+		[[nodiscard]] u32 RowBytes(const PNGHeader& header, u32 width) {
+			return (width * header.channel_count * header.bit_depth + 7) / 8;
+		}
+
+		[[nodiscard]] bool IsValidBitDepth(u8 color_type, u8 bit_depth) {
+			switch (color_type) {
+			case PNGColorType::Gray: return bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8 || bit_depth == 16;
+			case PNGColorType::Palette: return bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8;
+			case PNGColorType::RGB:
+			case PNGColorType::GrayAlpha:
+			case PNGColorType::RGBA: return bit_depth == 8 || bit_depth == 16;
+			default: return false;
+			}
+		}
+
+		// Walks the chunks up to IEND. If 'compressed' isn't null, the data of all IDAT chunks is copied to it.
+		// It has to have room for header.idat_size bytes, from an earlier call.
+		[[nodiscard]] bool ParsePNG(const u8* const data, u64 size, PNGHeader& header, u8* const compressed = nullptr) {
+			if (size < sizeof(png_signature) + 25 || memcmp(data, png_signature, sizeof(png_signature))) return false;
+
+			header = {};
+			bool has_header{ false };
+			bool has_end{ false };
+			for (u64 offset{ sizeof(png_signature) }; offset + 12 <= size && !has_end;) {
+				const u32 length{ ReadBE32(&data[offset]) };
+				const u8* const type{ &data[offset + 4] };
+				const u8* const chunk{ &data[offset + 8] };
+				if (length > size - offset - 12) return false;
+				offset += 12ull + length;
+
+				if (!memcmp(type, "IHDR", 4)) {
+					if (length != 13 || has_header) return false;
+					has_header = true;
+					header.width = ReadBE32(chunk);
+					header.height = ReadBE32(chunk + 4);
+					header.bit_depth = chunk[8];
+					header.color_type = chunk[9];
+					header.is_interlaced = chunk[12] == 1;
+					if (!header.width || !header.height || header.width > max_image_size || header.height > max_image_size) return false;
+					if (!IsValidBitDepth(header.color_type, header.bit_depth) || chunk[10] || chunk[11] || chunk[12] > 1) return false;
+					constexpr u32 channel_counts[7]{ 1, 0, 3, 1, 2, 0, 4 };
+					header.channel_count = channel_counts[header.color_type];
+				}
+				else if (!has_header) return false;
+				else if (!memcmp(type, "PLTE", 4)) {
+					if (length % 3 || length > 256 * 3) return false;
+					header.palette = chunk;
+					header.palette_count = length / 3;
+				}
+				else if (!memcmp(type, "tRNS", 4)) {
+					header.transparency = chunk;
+					header.transparency_size = length;
+				}
+				// NOTE: Like WIC, an sRGB chunk or a gamma of 1 / 2.2 makes the image sRGB.
+				else if (!memcmp(type, "sRGB", 4)) header.is_srgb = true;
+				else if (!memcmp(type, "gAMA", 4)) header.is_srgb |= length == 4 && ReadBE32(chunk) == 45455;
+				else if (!memcmp(type, "IDAT", 4)) {
+					if (!header.idat_count) header.idat = chunk;
+					if (compressed) memcpy(&compressed[header.idat_size], chunk, length);
+					header.idat_size += length;
+					header.idat_count++;
+				}
+				else if (!memcmp(type, "IEND", 4)) has_end = true;
+			}
+
+			if (!has_header || !header.idat_count) return false;
+			return header.color_type != PNGColorType::Palette || header.palette;
+		}
+
+		template<u32 bpp>
+		[[nodiscard]] __m128i LoadPixel(const u8* const p) {
+			u64 value{ 0 };
+			memcpy(&value, p, bpp);
+			return _mm_cvtsi64_si128((s64)value);
+		}
+
+		template<u32 bpp>
+		void StorePixel(u8* const p, __m128i pixel) {
+			const u64 value{ (u64)_mm_cvtsi128_si64(pixel) };
+			memcpy(p, &value, bpp);
+		}
+
+		// Sub, Average and Paeth depend on the pixel to the left, so they go one pixel at a time, with every byte
+		// of the pixel in its own lane.
+		template<u32 bpp, PNGFilter::Type filter>
+		void UnfilterPixels(const u8* const filtered, const u8* const previous, u8* const row, u32 row_bytes) {
+			const __m128i zero{ _mm_setzero_si128() };
+			__m128i a{ zero };	// left
+			__m128i c{ zero };	// above left
+			for (u32 i{ 0 }; i < row_bytes; i += bpp) {
+				const __m128i x{ LoadPixel<bpp>(&filtered[i]) };
+				if constexpr (filter == PNGFilter::Sub) {
+					a = _mm_add_epi8(x, a);
+				}
+				else if constexpr (filter == PNGFilter::Average) {
+					// _mm_avg_epu8 rounds up and PNG rounds down.
+					const __m128i b{ LoadPixel<bpp>(&previous[i]) };
+					const __m128i average{ _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1))) };
+					a = _mm_add_epi8(x, average);
+				}
+				else {
+					// The predictor is whichever of a, b and c is closest to a + b - c, preferring a, then b.
+					const __m128i b{ LoadPixel<bpp>(&previous[i]) };
+					const __m128i a16{ _mm_unpacklo_epi8(a, zero) };
+					const __m128i b16{ _mm_unpacklo_epi8(b, zero) };
+					const __m128i c16{ _mm_unpacklo_epi8(c, zero) };
+					const __m128i pa{ _mm_abs_epi16(_mm_sub_epi16(b16, c16)) };
+					const __m128i pb{ _mm_abs_epi16(_mm_sub_epi16(a16, c16)) };
+					const __m128i pc{ _mm_abs_epi16(_mm_sub_epi16(_mm_add_epi16(a16, b16), _mm_add_epi16(c16, c16))) };
+					const __m128i not_a{ _mm_or_si128(_mm_cmpgt_epi16(pa, pb), _mm_cmpgt_epi16(pa, pc)) };
+					const __m128i b_or_c{ _mm_blendv_epi8(b16, c16, _mm_cmpgt_epi16(pb, pc)) };
+					const __m128i predictor{ _mm_blendv_epi8(a16, b_or_c, not_a) };
+					a = _mm_add_epi8(x, _mm_packus_epi16(predictor, predictor));
+					c = b;
+				}
+				StorePixel<bpp>(&row[i], a);
+			}
+		}
+
+		[[nodiscard]] u8 Paeth(u8 a, u8 b, u8 c) {
+			const s32 pa{ std::abs((s32)b - c) };
+			const s32 pb{ std::abs((s32)a - c) };
+			const s32 pc{ std::abs((s32)a + b - 2 * c) };
+			return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+		}
+
+		// For pixels of 1 or 2 bytes, where lanes would be mostly empty.
+		void UnfilterBytes(PNGFilter::Type filter, const u8* const filtered, const u8* const previous, u8* const row, u32 row_bytes, u32 bpp) {
+			for (u32 i{ 0 }; i < row_bytes; i++) {
+				const u8 a{ i >= bpp ? row[i - bpp] : (u8)0 };
+				const u8 c{ i >= bpp ? previous[i - bpp] : (u8)0 };
+				switch (filter) {
+				case PNGFilter::Sub: row[i] = filtered[i] + a; break;
+				case PNGFilter::Average: row[i] = filtered[i] + (u8)((a + previous[i]) >> 1); break;
+				case PNGFilter::Paeth: row[i] = filtered[i] + Paeth(a, previous[i], c); break;
+				default: assert(false);
+				}
+			}
+		}
+
+		template<PNGFilter::Type filter>
+		void UnfilterRow(const u8* const filtered, const u8* const previous, u8* const row, u32 row_bytes, u32 bpp) {
+			switch (bpp) {
+			case 3: UnfilterPixels<3, filter>(filtered, previous, row, row_bytes); break;
+			case 4: UnfilterPixels<4, filter>(filtered, previous, row, row_bytes); break;
+			case 6: UnfilterPixels<6, filter>(filtered, previous, row, row_bytes); break;
+			case 8: UnfilterPixels<8, filter>(filtered, previous, row, row_bytes); break;
+			default: UnfilterBytes(filter, filtered, previous, row, row_bytes, bpp); break;
+			}
+		}
+
+		// 'previous' is the unfiltered row above, or zeros for the first row.
+		[[nodiscard]] bool Unfilter(u8 filter, const u8* const filtered, const u8* const previous, u8* const row, u32 row_bytes, u32 bpp) {
+			switch (filter) {
+			case PNGFilter::None: memcpy(row, filtered, row_bytes); return true;
+			case PNGFilter::Up: {
+				u32 i{ 0 };
+				for (; i + 16 <= row_bytes; i += 16) {
+					const __m128i sum{ _mm_add_epi8(_mm_loadu_si128((const __m128i*)&filtered[i]), _mm_loadu_si128((const __m128i*)&previous[i])) };
+					_mm_storeu_si128((__m128i*)&row[i], sum);
+				}
+				for (; i < row_bytes; i++) row[i] = filtered[i] + previous[i];
+				return true;
+			}
+			case PNGFilter::Sub: UnfilterRow<PNGFilter::Sub>(filtered, previous, row, row_bytes, bpp); return true;
+			case PNGFilter::Average: UnfilterRow<PNGFilter::Average>(filtered, previous, row, row_bytes, bpp); return true;
+			case PNGFilter::Paeth: UnfilterRow<PNGFilter::Paeth>(filtered, previous, row, row_bytes, bpp); return true;
+			default: return false;
+			}
+		}
+
+		// Sample x of a row of 1, 2, 4 or 8-bit samples.
+		[[nodiscard]] u32 Sample(const u8* const row, u32 x, u32 bit_depth) {
+			if (bit_depth == 8) return row[x];
+			const u32 bit{ x * bit_depth };
+			return (row[bit >> 3] >> (8 - bit_depth - (bit & 7))) & ((1u << bit_depth) - 1);
+		}
+
+		// Converts an unfiltered row to RGBA8, writing every dx-th pixel of the destination row.
+		void ExpandRow8(const PNGHeader& header, const u8* const row, u32 width, u8* const destination, u32 dx) {
+			const u8* const trns{ header.transparency };
+			switch (header.color_type) {
+			case PNGColorType::RGBA:
+				if (dx == 1) memcpy(destination, row, (u64)width * 4);
+				else for (u32 x{ 0 }; x < width; x++) memcpy(&destination[(u64)x * dx * 4], &row[x * 4], 4);
+				break;
+
+			case PNGColorType::RGB: {
+				const bool has_key{ header.transparency_size >= 6 };
+				u32 x{ 0 };
+				if (dx == 1 && !has_key) {
+					// 4 pixels per shuffle. The last 4 bytes of each load belong to the next pixels.
+					const __m128i shuffle{ _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1) };
+					const __m128i alpha{ _mm_set1_epi32((s32)0xff000000) };
+					for (; (x + 4) * 3 + 4 <= width * 3; x += 4) {
+						const __m128i pixels{ _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&row[x * 3]), shuffle) };
+						_mm_storeu_si128((__m128i*)&destination[x * 4], _mm_or_si128(pixels, alpha));
+					}
+				}
+				for (; x < width; x++) {
+					const u8* const source{ &row[x * 3] };
+					u8* const pixel{ &destination[(u64)x * dx * 4] };
+					const bool is_key{ has_key && source[0] == trns[1] && source[1] == trns[3] && source[2] == trns[5] };
+					pixel[0] = source[0];
+					pixel[1] = source[1];
+					pixel[2] = source[2];
+					pixel[3] = is_key ? 0 : 255;
+				}
+				break;
+			}
+
+			case PNGColorType::Gray: {
+				const bool has_key{ header.transparency_size >= 2 };
+				const u32 key{ has_key ? ReadBE16(trns) : ~0u };
+				const u32 scale{ 255u / ((1u << header.bit_depth) - 1) };
+				for (u32 x{ 0 }; x < width; x++) {
+					const u32 sample{ Sample(row, x, header.bit_depth) };
+					const u8 gray{ (u8)(sample * scale) };
+					u8* const pixel{ &destination[(u64)x * dx * 4] };
+					pixel[0] = pixel[1] = pixel[2] = gray;
+					pixel[3] = sample == key ? 0 : 255;
+				}
+				break;
+			}
+
+			case PNGColorType::GrayAlpha:
+				for (u32 x{ 0 }; x < width; x++) {
+					u8* const pixel{ &destination[(u64)x * dx * 4] };
+					pixel[0] = pixel[1] = pixel[2] = row[x * 2];
+					pixel[3] = row[x * 2 + 1];
+				}
+				break;
+
+			case PNGColorType::Palette:
+				for (u32 x{ 0 }; x < width; x++) {
+					const u32 index{ Sample(row, x, header.bit_depth) };
+					u8* const pixel{ &destination[(u64)x * dx * 4] };
+					// Indices past the palette are black, like libpng makes them.
+					if (index < header.palette_count) memcpy(pixel, &header.palette[index * 3], 3);
+					else pixel[0] = pixel[1] = pixel[2] = 0;
+					pixel[3] = index < header.transparency_size ? trns[index] : 255;
+				}
+				break;
+			}
+		}
+
+		// Converts an unfiltered row of big endian 16-bit samples to little endian RGBA16.
+		void ExpandRow16(const PNGHeader& header, const u8* const row, u32 width, u8* const destination, u32 dx) {
+			const u8* const trns{ header.transparency };
+			u16* const out{ (u16*)destination };
+			u32 x{ 0 };
+			switch (header.color_type) {
+			case PNGColorType::RGBA:
+				if (dx == 1) {
+					for (; x + 2 <= width; x += 2) {
+						const __m128i pixels{ _mm_loadu_si128((const __m128i*)&row[x * 8]) };
+						_mm_storeu_si128((__m128i*)&out[x * 4], _mm_or_si128(_mm_slli_epi16(pixels, 8), _mm_srli_epi16(pixels, 8)));
+					}
+				}
+				for (; x < width; x++) {
+					for (u32 c{ 0 }; c < 4; c++) out[(u64)x * dx * 4 + c] = ReadBE16(&row[x * 8 + c * 2]);
+				}
+				break;
+
+			case PNGColorType::RGB: {
+				const bool has_key{ header.transparency_size >= 6 };
+				for (; x < width; x++) {
+					u16* const pixel{ &out[(u64)x * dx * 4] };
+					for (u32 c{ 0 }; c < 3; c++) pixel[c] = ReadBE16(&row[x * 6 + c * 2]);
+					const bool is_key{ has_key && !memcmp(&row[x * 6], trns, 6) };
+					pixel[3] = is_key ? 0 : 0xffff;
+				}
+				break;
+			}
+
+			case PNGColorType::Gray: {
+				const bool has_key{ header.transparency_size >= 2 };
+				for (; x < width; x++) {
+					u16* const pixel{ &out[(u64)x * dx * 4] };
+					pixel[0] = pixel[1] = pixel[2] = ReadBE16(&row[x * 2]);
+					pixel[3] = has_key && !memcmp(&row[x * 2], trns, 2) ? 0 : 0xffff;
+				}
+				break;
+			}
+
+			case PNGColorType::GrayAlpha:
+				for (; x < width; x++) {
+					u16* const pixel{ &out[(u64)x * dx * 4] };
+					pixel[0] = pixel[1] = pixel[2] = ReadBE16(&row[x * 4]);
+					pixel[3] = ReadBE16(&row[x * 4 + 2]);
+				}
+				break;
+			}
+		}
+
+		[[nodiscard]] bool DecodePNG(const u8* const data, u64 size, u8* const pixels, u32 row_pitch) {
+			PNGHeader header;
+			if (!ParsePNG(data, size, header)) return false;
+
+			// Image data that is split over several IDAT chunks is gathered, the usual single chunk is used in place.
+			std::unique_ptr<u8[]> compressed;
+			if (header.idat_count > 1) {
+				compressed = std::make_unique<u8[]>(header.idat_size);
+				if (!ParsePNG(data, size, header, compressed.get())) return false;
+				header.idat = compressed.get();
+			}
+
+			const u32 pass_count{ header.is_interlaced ? 7u : 1u };
+			u64 filtered_size{ 0 };
+			for (u32 i{ 0 }; i < pass_count; i++) {
+				const PNGPass pass{ GetPass(header, i) };
+				if (pass.width && pass.height) filtered_size += (u64)pass.height * (1 + RowBytes(header, pass.width));
+			}
+
+			std::unique_ptr<u8[]> filtered{ std::make_unique<u8[]>(filtered_size + inflate_slack) };
+			if (!Inflate(header.idat, header.idat_size, filtered.get(), filtered_size)) return false;
+
+			const u32 bpp{ std::max(header.channel_count * header.bit_depth / 8, 1u) };
+			const u32 pixel_size{ header.bit_depth == 16 ? 8u : 4u };
+			const u32 max_row_bytes{ RowBytes(header, header.width) };
+			util::vector<u8> rows(2ull * max_row_bytes);
+			const util::vector<u8> zeros(max_row_bytes);
+
+			// RGBA8 rows are unfiltered straight into the pixels, every other format goes through a row and is expanded.
+			const bool is_direct{ !header.is_interlaced && header.color_type == PNGColorType::RGBA && header.bit_depth == 8 };
+			const u8* source{ filtered.get() };
+			for (u32 i{ 0 }; i < pass_count; i++) {
+				const PNGPass pass{ GetPass(header, i) };
+				if (!pass.width || !pass.height) continue;
+
+				const u32 row_bytes{ RowBytes(header, pass.width) };
+				const u8* previous{ zeros.data() };
+				for (u32 y{ 0 }; y < pass.height; y++, source += 1 + row_bytes) {
+					u8* const destination{ &pixels[(u64)(pass.y + y * pass.dy) * row_pitch + (u64)pass.x * pixel_size] };
+					u8* const row{ is_direct ? destination : &rows[(y & 1) * max_row_bytes] };
+					if (!Unfilter(source[0], source + 1, previous, row, row_bytes, bpp)) return false;
+					previous = row;
+
+					if (is_direct) continue;
+					if (header.bit_depth == 16) ExpandRow16(header, row, pass.width, destination, pass.dx);
+					else ExpandRow8(header, row, pass.width, destination, pass.dx);
+				}
+			}
+
+			return true;
+		}
+
+		// ---- TGA ----
+
+		struct TGAHeader {
+			u32		width;
+			u32		height;
+			u32		bits;
+			u64		data_offset;
+			bool	is_gray;
+			bool	is_rle;
+			bool	is_top_down;
+			bool	is_right_to_left;
+			bool	is_srgb;
+		};
+
+		struct TGAImageType {
+			enum Type : u8 {
+				ColorMapped = 1,
+				TrueColor = 2,
+				Gray = 3,
+				ColorMappedRLE = 9,
+				TrueColorRLE = 10,
+				GrayRLE = 11,
+			};
+		};
+
+		// TGA files have no magic, so the header has to make sense. The footer of TGA 2.0 files settles it.
+		[[nodiscard]] bool IsTGA(const u8* const data, u64 size) {
+			if (size < 18) return false;
+			if (size >= tga_footer_size && !memcmp(&data[size - sizeof(tga_footer_signature)], tga_footer_signature, sizeof(tga_footer_signature))) return true;
+
+			const u8 type{ data[2] };
+			const u8 bits{ data[16] };
+			const bool is_known_type{ type == TGAImageType::ColorMapped || type == TGAImageType::TrueColor || type == TGAImageType::Gray ||
+				type == TGAImageType::ColorMappedRLE || type == TGAImageType::TrueColorRLE || type == TGAImageType::GrayRLE };
+			return data[1] <= 1 && is_known_type && ReadLE16(&data[12]) && ReadLE16(&data[14]) &&
+				(bits == 8 || bits == 15 || bits == 16 || bits == 24 || bits == 32);
+		}
+
+		[[nodiscard]] bool ParseTGA(const u8* const data, u64 size, TGAHeader& header) {
+			if (size < 18) return false;
+			const u8 type{ data[2] };
+			const u8 descriptor{ data[17] };
+			header = {};
+			header.width = ReadLE16(&data[12]);
+			header.height = ReadLE16(&data[14]);
+			header.bits = data[16];
+			header.is_gray = type == TGAImageType::Gray || type == TGAImageType::GrayRLE;
+			header.is_rle = type == TGAImageType::TrueColorRLE || type == TGAImageType::GrayRLE;
+			header.is_top_down = descriptor & 0x20;
+			header.is_right_to_left = descriptor & 0x10;
+			header.data_offset = 18ull + data[0] + (data[1] ? (u64)ReadLE16(&data[5]) * ((data[7] + 7) / 8) : 0);
+
+			// Color mapped images are left to DirectXTex, which doesn't take them either.
+			if (!header.is_gray && type != TGAImageType::TrueColor && type != TGAImageType::TrueColorRLE) return false;
+			if (header.is_gray ? header.bits != 8 : header.bits != 15 && header.bits != 16 && header.bits != 24 && header.bits != 32) return false;
+			if (!header.width || !header.height || data[1] > 1 || header.data_offset > size) return false;
+
+			// NOTE: Like DirectXTex, a gamma of 2.2 or 2.4 in the TGA 2.0 extension area makes color images sRGB.
+			if (!header.is_gray && size >= tga_footer_size &&
+				!memcmp(&data[size - sizeof(tga_footer_signature)], tga_footer_signature, sizeof(tga_footer_signature))) {
+				const u64 extension{ (u64)ReadLE16(&data[size - tga_footer_size]) | ((u64)ReadLE16(&data[size - tga_footer_size + 2]) << 16) };
+				if (extension && extension + tga_extension_size <= size && ReadLE16(&data[extension]) == tga_extension_size) {
+					const u16 numerator{ ReadLE16(&data[extension + tga_gamma_offset]) };
+					const u16 denominator{ ReadLE16(&data[extension + tga_gamma_offset + 2]) };
+					const f32 gamma{ denominator ? (f32)numerator / denominator : 0.f };
+					header.is_srgb = std::abs(gamma - 2.2f) < 0.01f || std::abs(gamma - 2.4f) < 0.01f;
+				}
+			}
+
+			return true;
+		}
+
+		// Converts a row of file pixels to RGBA8 or R8. Returns the alpha bits of the row ORed together.
+		u8 ConvertTGARow(const TGAHeader& header, const u8* const source, u8* const destination) {
+			const u32 width{ header.width };
+			u32 x{ 0 };
+			u8 alpha{ 0 };
+			switch (header.bits) {
+			case 8:
+				memcpy(destination, source, width);
+				return 0xff;
+
+			case 32: {
+				const __m128i shuffle{ _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15) };
+				__m128i alphas{ _mm_setzero_si128() };
+				for (; x + 4 <= width; x += 4) {
+					const __m128i pixels{ _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&source[x * 4]), shuffle) };
+					_mm_storeu_si128((__m128i*)&destination[x * 4], pixels);
+					alphas = _mm_or_si128(alphas, pixels);
+				}
+				alpha = _mm_testz_si128(alphas, _mm_set1_epi32((s32)0xff000000)) ? 0 : 0xff;
+				for (; x < width; x++) {
+					u8* const pixel{ &destination[x * 4] };
+					pixel[0] = source[x * 4 + 2];
+					pixel[1] = source[x * 4 + 1];
+					pixel[2] = source[x * 4];
+					pixel[3] = source[x * 4 + 3];
+					alpha |= pixel[3];
+				}
+				return alpha;
+			}
+
+			case 24: {
+				const __m128i shuffle{ _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1) };
+				const __m128i opaque{ _mm_set1_epi32((s32)0xff000000) };
+				for (; (x + 4) * 3 + 4 <= width * 3; x += 4) {
+					const __m128i pixels{ _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&source[x * 3]), shuffle) };
+					_mm_storeu_si128((__m128i*)&destination[x * 4], _mm_or_si128(pixels, opaque));
+				}
+				for (; x < width; x++) {
+					u8* const pixel{ &destination[x * 4] };
+					pixel[0] = source[x * 3 + 2];
+					pixel[1] = source[x * 3 + 1];
+					pixel[2] = source[x * 3];
+					pixel[3] = 255;
+				}
+				return 0xff;
+			}
+
+			default: {
+				// A1R5G5B5. 15-bit pixels have no alpha.
+				const bool has_alpha{ header.bits == 16 };
+				for (; x < width; x++) {
+					const u16 value{ ReadLE16(&source[x * 2]) };
+					const u32 r{ (value >> 10) & 31u };
+					const u32 g{ (value >> 5) & 31u };
+					const u32 b{ value & 31u };
+					u8* const pixel{ &destination[x * 4] };
+					pixel[0] = (u8)((r << 3) | (r >> 2));
+					pixel[1] = (u8)((g << 3) | (g >> 2));
+					pixel[2] = (u8)((b << 3) | (b >> 2));
+					pixel[3] = !has_alpha || (value & 0x8000) ? 255 : 0;
+					alpha |= pixel[3];
+				}
+				return alpha;
+			}
+			}
+		}
+
+		[[nodiscard]] bool DecodeTGA(const u8* const data, u64 size, u8* const pixels, u32 row_pitch) {
+			TGAHeader header;
+			if (!ParseTGA(data, size, header)) return false;
+
+			const u32 pixel_bytes{ (header.bits + 7) / 8 };
+			const u32 output_size{ header.is_gray ? 1u : 4u };
+			const u32 row_bytes{ header.width * pixel_bytes };
+			const u8* source{ &data[header.data_offset] };
+			const u8* const end{ data + size };
+			util::vector<u8> row(header.is_rle ? row_bytes : 0);
+
+			u8 alpha{ 0 };
+			u32 run_left{ 0 };		// pixels left in an RLE packet that continues from the previous row
+			bool is_run{ false };
+			for (u32 y{ 0 }; y < header.height; y++) {
+				const u8* file_row{ source };
+				if (!header.is_rle) {
+					if ((u64)(end - source) < row_bytes) return false;
+					source += row_bytes;
+				}
+				else {
+					// Packets may run over into the next row.
+					for (u32 x{ 0 }; x < header.width;) {
+						if (!run_left) {
+							if (source >= end) return false;
+							is_run = *source & 0x80;
+							run_left = (*source++ & 0x7f) + 1u;
+						}
+						const u32 count{ std::min(run_left, header.width - x) };
+						if (is_run) {
+							if ((u64)(end - source) < pixel_bytes) return false;
+							for (u32 i{ 0 }; i < count; i++) memcpy(&row[(x + i) * pixel_bytes], source, pixel_bytes);
+							if (count == run_left) source += pixel_bytes;
+						}
+						else {
+							if ((u64)(end - source) < (u64)count * pixel_bytes) return false;
+							memcpy(&row[x * pixel_bytes], source, (u64)count * pixel_bytes);
+							source += (u64)count * pixel_bytes;
+						}
+						run_left -= count;
+						x += count;
+					}
+					file_row = row.data();
+				}
+
+				u8* const destination{ &pixels[(u64)(header.is_top_down ? y : header.height - 1 - y) * row_pitch] };
+				alpha |= ConvertTGARow(header, file_row, destination);
+				if (header.is_right_to_left) {
+					for (u32 x{ 0 }; x < header.width / 2; x++) {
+						std::swap_ranges(&destination[x * output_size], &destination[(x + 1) * output_size],
+							&destination[(header.width - 1 - x) * output_size]);
+					}
+				}
+			}
+
+			// NOTE: Like DirectXTex, images whose alpha is 0 everywhere are taken as opaque. Many tools write 32-bit
+			//		 TGAs that way.
+			if (!alpha) {
+				for (u32 y{ 0 }; y < header.height; y++) {
+					u8* const destination{ &pixels[(u64)y * row_pitch] };
+					for (u32 x{ 0 }; x < header.width; x++) destination[x * 4 + 3] = 255;
+				}
+			}
+
+			return true;
+		}
+
+		// ---- Radiance HDR ----
+
+		struct HDRHeader {
+			u32 width;
+			u32 height;
+			bool is_bottom_up;
+			u64 data_offset;
+		};
+
+		[[nodiscard]] bool ParseUnsigned(const char*& p, const char* const end, u32& value) {
+			while (p < end && *p == ' ') p++;
+			if (p == end || *p < '0' || *p > '9') return false;
+			value = 0;
+			while (p < end && *p >= '0' && *p <= '9' && value <= max_image_size) value = value * 10 + (u32)(*p++ - '0');
+			return true;
+		}
+
+		[[nodiscard]] bool ParseHDR(const u8* const data, u64 size, HDRHeader& header) {
+			if (!StartsWith(data, size, "#?RADIANCE") && !StartsWith(data, size, "#?RGBE")) return false;
+
+			// Header lines up to an empty one, then the resolution line.
+			const char* p{ (const char*)data };
+			const char* const end{ p + size };
+			for (;;) {
+				const char* const line{ p };
+				while (p < end && *p != '\n') p++;
+				if (p == end) return false;
+				const u64 length{ (u64)(p++ - line) };
+				if (!length) break;
+				if (length >= 7 && !memcmp(line, "FORMAT=", 7) && (length != 22 || memcmp(line, "FORMAT=32-bit_rle_rgbe", 22))) return false;
+			}
+
+			// Only rows of +X pixels are supported, with rows from the top (-Y) or the bottom (+Y).
+			if (end - p < 3 || (p[0] != '-' && p[0] != '+') || p[1] != 'Y') return false;
+			header.is_bottom_up = p[0] == '+';
+			p += 2;
+			if (!ParseUnsigned(p, end, header.height)) return false;
+			while (p < end && *p == ' ') p++;
+			if (end - p < 2 || p[0] != '+' || p[1] != 'X') return false;
+			p += 2;
+			if (!ParseUnsigned(p, end, header.width)) return false;
+			while (p < end && *p != '\n') p++;
+			if (p == end) return false;
+
+			header.data_offset = (u64)(p + 1 - (const char*)data);
+			return header.width && header.height && header.width <= max_image_size && header.height <= max_image_size;
+		}
+
+		// Reads one row of RGBE pixels. New files run length encode each channel of the row separately,
+		// old ones repeat the previous pixel with (1, 1, 1, count).
+		[[nodiscard]] bool ReadHDRRow(const u8*& p, const u8* const end, u32 width, u8* const rgbe) {
+			if (width >= 8 && width < 0x8000 && end - p >= 4 && p[0] == 2 && p[1] == 2 && !(p[2] & 0x80)) {
+				if (ReadBE16(&p[2]) != width) return false;
+				p += 4;
+				for (u32 channel{ 0 }; channel < 4; channel++) {
+					for (u32 x{ 0 }; x < width;) {
+						if (p >= end) return false;
+						u32 count{ *p++ };
+						if (count > 128) {
+							count -= 128;
+							if (x + count > width || p >= end) return false;
+							const u8 value{ *p++ };
+							for (u32 i{ 0 }; i < count; i++) rgbe[(x + i) * 4 + channel] = value;
+						}
+						else {
+							if (!count || x + count > width || (u64)(end - p) < count) return false;
+							for (u32 i{ 0 }; i < count; i++) rgbe[(x + i) * 4 + channel] = p[i];
+							p += count;
+						}
+						x += count;
+					}
+				}
+				return true;
+			}
+
+			u32 shift{ 0 };
+			for (u32 x{ 0 }; x < width; p += 4) {
+				if (end - p < 4) return false;
+				if (p[0] == 1 && p[1] == 1 && p[2] == 1) {
+					// Repeats in a row make the count longer by 8 bits each.
+					const u64 count{ (u64)p[3] << shift };
+					if (!x || shift > 16 || x + count > width) return false;
+					for (u32 i{ 0 }; i < count; i++) memcpy(&rgbe[(x + i) * 4], &rgbe[(x - 1) * 4], 4);
+					x += (u32)count;
+					shift += 8;
+				}
+				else {
+					memcpy(&rgbe[x * 4], p, 4);
+					x++;
+					shift = 0;
+				}
+			}
+			return true;
+		}
+
+		// 2^(e - 136): the exponent, and 8 more bits that turn the 8-bit mantissas into [0, 1). 0 is black.
+		const f32* GetExponentTable() {
+			static f32 table[256]{};
+			static std::once_flag once;
+			std::call_once(once, [] {
+				for (u32 e{ 1 }; e < 256; e++) table[e] = std::ldexp(1.f, (s32)e - 136);
+			});
+			return table;
+		}
+
+		void RGBEToFloat(const u8* const rgbe, u32 width, f32* const rgba) {
+			const f32* const exponents{ GetExponentTable() };
+			const __m128 one{ _mm_set1_ps(1.f) };
+			for (u32 x{ 0 }; x < width; x++) {
+				u32 pixel;
+				memcpy(&pixel, &rgbe[x * 4], sizeof(pixel));
+				const __m128 mantissas{ _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128((s32)pixel))) };
+				const __m128 color{ _mm_mul_ps(mantissas, _mm_set1_ps(exponents[rgbe[x * 4 + 3]])) };
+				_mm_storeu_ps(&rgba[x * 4], _mm_blend_ps(color, one, 0b1000));
+			}
+		}
+
+		[[nodiscard]] bool DecodeHDR(const u8* const data, u64 size, u8* const pixels, u32 row_pitch) {
+			HDRHeader header;
+			if (!ParseHDR(data, size, header)) return false;
+
+			const u8* p{ &data[header.data_offset] };
+			util::vector<u8> rgbe((u64)header.width * 4);
+			for (u32 y{ 0 }; y < header.height; y++) {
+				if (!ReadHDRRow(p, data + size, header.width, rgbe.data())) return false;
+				const u32 row{ header.is_bottom_up ? header.height - 1 - y : y };
+				RGBEToFloat(rgbe.data(), header.width, (f32*)&pixels[(u64)row * row_pitch]);
+			}
+			return true;
+		}
+	} // anonymous namespace
+
+	FileFormat::Type DetectFormat(const u8* const data, u64 size) {
+		assert(data || !size);
+		if (size >= sizeof(png_signature) && !memcmp(data, png_signature, sizeof(png_signature))) return FileFormat::PNG;
+		if (StartsWith(data, size, "DDS ")) return FileFormat::DDS;
+		if (StartsWith(data, size, "#?RADIANCE") || StartsWith(data, size, "#?RGBE")) return FileFormat::HDR;
+		if (IsTGA(data, size)) return FileFormat::TGA;
+		return FileFormat::Unknown;
+	}
+
+	bool ReadInfo(const u8* const data, u64 size, ImageInfo& info) {
+		info = {};
+		info.file_format = DetectFormat(data, size);
+		switch (info.file_format) {
+		case FileFormat::PNG: {
+			PNGHeader header;
+			if (!ParsePNG(data, size, header)) return false;
+			info.pixel_format = header.bit_depth == 16 ? PixelFormat::RGBA16_UNorm : PixelFormat::RGBA8_UNorm;
+			info.width = header.width;
+			info.height = header.height;
+			info.is_srgb = header.is_srgb && header.bit_depth != 16;
+			return true;
+		}
+		case FileFormat::TGA: {
+			TGAHeader header;
+			if (!ParseTGA(data, size, header)) return false;
+			info.pixel_format = header.is_gray ? PixelFormat::R8_UNorm : PixelFormat::RGBA8_UNorm;
+			info.width = header.width;
+			info.height = header.height;
+			info.is_srgb = header.is_srgb;
+			return true;
+		}
+		case FileFormat::HDR: {
+			HDRHeader header;
+			if (!ParseHDR(data, size, header)) return false;
+			info.pixel_format = PixelFormat::RGBA32_Float;
+			info.width = header.width;
+			info.height = header.height;
+			return true;
+		}
+		default: return false;
+		}
+	}
+
+	bool Decode(const u8* const data, u64 size, const ImageInfo& info, u8* const pixels, u32 row_pitch) {
+		assert(data && pixels && row_pitch >= info.width * PixelSize(info.pixel_format));
+		switch (info.file_format) {
+		case FileFormat::PNG: return DecodePNG(data, size, pixels, row_pitch);
+		case FileFormat::TGA: return DecodeTGA(data, size, pixels, row_pitch);
+		case FileFormat::HDR: return DecodeHDR(data, size, pixels, row_pitch);
+		default: assert(false); return false;
+		}
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "CommonHeaders.h"
+#include "WorkerPool.h"
+
+// Decoders for the image files we import the most, without WIC or DirectXTex. The file format is told from the
+// first bytes of the file, and the pixels are decoded straight into the rows the importer gives, which then go on
+// to mip generation. Variants that aren't covered here, like color mapped TGAs and XYZE HDRs, fail in ReadInfo()
+// so the importer can hand them to its other loaders.
+namespace Zetta::Tools::ImageDecoder {
+	struct FileFormat {
+		enum Type : u32 {
+			Unknown,	// anything else, like JPEG or BMP
+			PNG,
+			TGA,
+			HDR,		// Radiance RGBE
+			DDS,		// only detected, the importer loads these itself
+
+			count
+		};
+	};
+
+	struct PixelFormat {
+		enum Type : u32 {
+			R8_UNorm,		// gray TGAs
+			RGBA8_UNorm,
+			RGBA16_UNorm,	// 16-bit PNGs
+			RGBA32_Float,	// HDRs, with alpha 1
+
+			count
+		};
+	};
+
+	struct ImageInfo {
+		FileFormat::Type file_format;
+		PixelFormat::Type pixel_format;
+		u32 width;
+		u32 height;
+		bool is_srgb;	// the file says its 8-bit colors are sRGB
+	};
+
+	[[nodiscard]] constexpr u32 PixelSize(PixelFormat::Type format) {
+		constexpr u32 sizes[PixelFormat::count]{ 1, 4, 8, 16 };
+		return sizes[format];
+	}
+
+	[[nodiscard]] FileFormat::Type DetectFormat(const u8* const data, u64 size);
+
+	// Reads the header of a PNG, TGA or HDR file. Returns false if the file isn't one or is a variant that
+	// isn't supported.
+	[[nodiscard]] bool ReadInfo(const u8* const data, u64 size, ImageInfo& info);
+
+	// Decodes the file that ReadInfo() filled 'info' from into rows of row_pitch bytes, top row first.
+	// Returns false if the file is broken. Chunk CRCs and checksums aren't checked.
+	[[nodiscard]] bool Decode(const u8* const data, u64 size, const ImageInfo& info, u8* const pixels, u32 row_pitch);
+}
@@ -0,0 +1,271 @@
+#include "ImportCache.h"
+#include <filesystem>
+#include <fstream>
+
+namespace Zetta::Tools::ImportCache {
+	namespace {
+		namespace fs = std::filesystem;
+
+		constexpr u64 prime1{ 0x9e3779b185ebca87ull };
+		constexpr u64 prime2{ 0xc2b2ae3d27d4eb4full };
+		constexpr u64 prime3{ 0x165667b19e3779f9ull };
+		constexpr u32 entry_magic{ 'Z' | ('I' << 8) | ('C' << 16) | ('1' << 24) };
+		constexpr u32 file_read_block_size{ 1024 * 1024 };
+		constexpr const char* entry_extension{ ".zic" };
+
+		// Every entry file starts with this header, followed by payload_size bytes of payload.
+		struct EntryHeader {
+			u32 magic;
+			u32 version;
+			Key key;
+			u64 payload_size;
+			Key checksum;
+		};
+
+		std::mutex	cache_mutex;
+		fs::path	cache_directory{};
+		u64			max_cache_size{ 0 };
+		u64			cache_size{ 0 };
+		bool		is_scanned{ false };
+
+		constexpr u64 RotateLeft(u64 value, u32 bits) {
+			return (value << bits) | (value >> (64 - bits));
+		}
+
+		constexpr u64 Avalanche(u64 h) {
+			h ^= h >> 33;
+			h *= prime2;
+			h ^= h >> 29;
+			h *= prime3;
+			h ^= h >> 32;
+			return h;
+		}
+
+		u64 ReadU64(const u8* const data) {
+			u64 value;
+			memcpy(&value, data, sizeof(u64));
+			return value;
+		}
+
+		Key Checksum(const u8* const data, u64 size) {
+			Hasher hasher{};
+			hasher.Update(data, size);
+			return hasher.Finalize();
+		}
+
+		fs::path EntryPath(const Key& key) {
+			char name[33];
+			snprintf(name, sizeof(name), "%016llx%016llx", key.high, key.low);
+			return cache_directory / (std::string{ name } + entry_extension);
+		}
+
+		// NOTE: call with cache_mutex locked.
+		void ScanDirectory() {
+			if (is_scanned) return;
+			is_scanned = true;
+			cache_size = 0;
+
+			std::error_code error;
+			fs::create_directories(cache_directory, error);
+			for (const auto& entry : fs::directory_iterator{ cache_directory, error }) {
+				if (entry.is_regular_file(error) && entry.path().extension() == entry_extension) {
+					cache_size += entry.file_size(error);
+				}
+			}
+		}
+
+		// Deletes the least recently used entries until the cache is below 90% of its cap.
+		// The slack keeps every following Store() from having to evict again.
+		// NOTE: call with cache_mutex locked.
+		void Evict() {
+			struct Entry {
+				fs::path			path;
+				fs::file_time_type	time;
+				u64					size;
+			};
+
+			std::error_code error;
+			util::vector<Entry> entries;
+			for (const auto& entry : fs::directory_iterator{ cache_directory, error }) {
+				if (!entry.is_regular_file(error) || entry.path().extension() != entry_extension) continue;
+				entries.emplace_back(Entry{ entry.path(), entry.last_write_time(error), entry.file_size(error) });
+			}
+
+			std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+
+			const u64 target_size{ max_cache_size - max_cache_size / 10 };
+			for (const Entry& entry : entries) {
+				if (cache_size <= target_size) break;
+				// NOTE: removing an entry that another import is reading at the moment fails on Windows. Just skip it.
+				if (fs::remove(entry.path, error)) cache_size -= std::min(cache_size, entry.size);
+			}
+		}
+
+		// NOTE: the cache stays off until Configure() gives it a directory and a size.
+		bool IsEnabled() {
+			return !cache_directory.empty() && max_cache_size;
+		}
+	} // anonymous namespace
+
+	Hasher::Hasher()
+		: _lanes{ prime1 + prime2, prime2 - prime1 }
+	{}
+
+	void Hasher::Consume(const u8* const block) {
+		_lanes[0] = RotateLeft(_lanes[0] + ReadU64(block) * prime2, 31) * prime1;
+		_lanes[1] = RotateLeft(_lanes[1] + ReadU64(block + sizeof(u64)) * prime2, 31) * prime1;
+	}
+
+	void Hasher::Update(const void* const data, u64 size) {
+		const u8* at{ (const u8*)data };
+		_total_size += size;
+
+		if (_tail_size) {
+			const u32 count{ (u32)std::min<u64>(size, sizeof(_tail) - _tail_size) };
+			memcpy(&_tail[_tail_size], at, count);
+			_tail_size += count;
+			at += count;
+			size -= count;
+			if (_tail_size < sizeof(_tail)) return;
+			Consume(_tail);
+			_tail_size = 0;
+		}
+
+		for (; size >= sizeof(_tail); at += sizeof(_tail), size -= sizeof(_tail)) {
+			Consume(at);
+		}
+
+		if (size) {
+			memcpy(_tail, at, size);
+			_tail_size = (u32)size;
+		}
+	}
+
+	bool Hasher::UpdateFromFile(const char* file) {
+		std::ifstream stream{ file, std::ios::in | std::ios::binary };
+		if (!stream) return false;
+
+		std::unique_ptr<u8[]> buffer{ std::make_unique<u8[]>(file_read_block_size) };
+		while (stream) {
+			stream.read((char*)buffer.get(), file_read_block_size);
+			Update(buffer.get(), (u64)stream.gcount());
+		}
+
+		return stream.eof();
+	}
+
+	Key Hasher::Finalize() const {
+		u64 l0{ _lanes[0] };
+		u64 l1{ _lanes[1] };
+		for (u32 i{ 0 }; i < _tail_size; i++) {
+			l0 = RotateLeft(l0 ^ (_tail[i] * prime3), 11) * prime1;
+			l1 = RotateLeft(l1 + (_tail[i] * prime1), 17) * prime2;
+		}
+
+		l0 ^= _total_size;
+		l1 += _total_size * prime3;
+		const u64 low{ Avalanche(l0 ^ RotateLeft(l1, 27)) };
+		const u64 high{ Avalanche(l1 + l0 * prime3) };
+		return { low, high };
+	}
+
+	void Configure(const char* directory, u64 max_size) {
+		std::lock_guard lock{ cache_mutex };
+		cache_directory = (directory && directory[0]) ? fs::path{ directory } : fs::path{};
+		max_cache_size = max_size;
+		is_scanned = false;
+	}
+
+	bool Lookup(const Key& key, util::vector<u8>& payload) {
+		fs::path path;
+		{
+			std::lock_guard lock{ cache_mutex };
+			if (!IsEnabled()) return false;
+			path = EntryPath(key);
+		}
+
+		std::error_code error;
+		bool is_valid{ false };
+		{
+			std::ifstream stream{ path, std::ios::in | std::ios::binary };
+			if (!stream) return false;
+
+			const u64 file_size{ fs::file_size(path, error) };
+			EntryHeader header{};
+			stream.read((char*)&header, sizeof(EntryHeader));
+			if (stream && !error &&
+				header.magic == entry_magic && header.version == tool_version &&
+				header.key.low == key.low && header.key.high == key.high &&
+				header.payload_size == file_size - sizeof(EntryHeader))
+			{
+				payload.resize(header.payload_size);
+				stream.read((char*)payload.data(), header.payload_size);
+				const Key checksum{ Checksum(payload.data(), header.payload_size) };
+				is_valid = stream && checksum.low == header.checksum.low && checksum.high == header.checksum.high;
+			}
+		}
+
+		std::lock_guard lock{ cache_mutex };
+		if (!is_valid) {
+			// Truncated or corrupted entry. Remove it so the next import stores a good one.
+			payload.clear();
+			const u64 size{ fs::file_size(path, error) };
+			if (!error && fs::remove(path, error) && is_scanned) cache_size -= std::min(cache_size, size);
+			return false;
+		}
+
+		// Touch the entry, so it's the most recently used one when evicting.
+		fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+		return true;
+	}
+
+	void Store(const Key& key, const u8* const payload, u64 size) {
+		assert(payload && size);
+		std::lock_guard lock{ cache_mutex };
+		if (!IsEnabled()) return;
+		ScanDirectory();
+
+		const u64 entry_size{ sizeof(EntryHeader) + size };
+		if (entry_size > max_cache_size) return;
+
+		const fs::path path{ EntryPath(key) };
+		fs::path temp_path{ path };
+		temp_path += ".tmp";
+
+		EntryHeader header{};
+		header.magic = entry_magic;
+		header.version = tool_version;
+		header.key = key;
+		header.payload_size = size;
+		header.checksum = Checksum(payload, size);
+
+		{
+			std::ofstream stream{ temp_path, std::ios::out | std::ios::binary | std::ios::trunc };
+			if (!stream) return;
+			stream.write((const char*)&header, sizeof(EntryHeader));
+			stream.write((const char*)payload, size);
+			if (!stream) {
+				stream.close();
+				std::error_code error;
+				fs::remove(temp_path, error);
+				return;
+			}
+		}
+
+		// Write to a temporary file first and rename it, so a crash never leaves a partial entry behind.
+		std::error_code error;
+		const u64 old_size{ fs::exists(path, error) ? fs::file_size(path, error) : 0 };
+		fs::rename(temp_path, path, error);
+		if (error) {
+			fs::remove(temp_path, error);
+			return;
+		}
+
+		cache_size = cache_size - std::min(cache_size, old_size) + entry_size;
+		if (cache_size > max_cache_size) Evict();
+	}
+}
+
+EDITOR_INTERFACE void ConfigureImportCache(const char* directory, u64 max_size) {
+	Zetta::Tools::ImportCache::Configure(directory, max_size);
+}
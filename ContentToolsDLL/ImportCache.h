@@ -0,0 +1,41 @@
+#pragma once
+#include "ToolsCommon.h"
+
+// Content-addressed on-disk cache for importer output.
+// An entry is keyed by a 128-bit hash of the source file bytes, the import settings and the
+// importer version, so unchanged sources are never reprocessed no matter where they were copied to.
+namespace Zetta::Tools::ImportCache {
+	// NOTE: bump whenever an importer changes the data it produces, so stale entries stop matching.
+	constexpr u32 tool_version{ 7 };
+
+	struct Key {
+		u64 low;
+		u64 high;
+	};
+
+	class Hasher {
+	public:
+		Hasher();
+		void Update(const void* const data, u64 size);
+		template<typename T> void Update(const T& value) { Update(&value, sizeof(T)); }
+		// Hashes the contents of the file, not its name. Returns false if the file can't be read.
+		[[nodiscard]] bool UpdateFromFile(const char* file);
+		[[nodiscard]] Key Finalize() const;
+
+	private:
+		void Consume(const u8* const block);
+
+		u64	_lanes[2];
+		u64	_total_size{ 0 };
+		u8	_tail[16]{};
+		u32	_tail_size{ 0 };
+	};
+
+	// Sets the cache directory and its size cap in bytes. The least recently used entries are
+	// evicted once the cap is exceeded. An empty directory or a size of 0 disables the cache,
+	// which is how it starts: nothing is cached until the editor configures it.
+	void Configure(const char* directory, u64 max_size);
+	// Returns true and fills payload only if a complete, uncorrupted entry exists for the key.
+	[[nodiscard]] bool Lookup(const Key& key, util::vector<u8>& payload);
+	void Store(const Key& key, const u8* const payload, u64 size);
+}
@@ -0,0 +1,435 @@
+#include "MipGeneration.h"
+#include <DirectXPackedVector.h>
+#include <immintrin.h>
+#include <cmath>
+#include <array>
+
+namespace Zetta::Tools::Mips {
+	namespace {
+		using namespace DirectX::PackedVector;
+
+		// Filter radius in destination pixels. The box filter only reaches the source pixels under the destination pixel.
+		constexpr f32 filter_radius[Filter::count]{ 0.5f, 3.f, 3.f };
+		constexpr f32 kaiser_alpha{ 4.f };
+
+		// Destination pixels filtered per ParallelFor item. Small mips go in one item instead of a thread per row.
+		constexpr u32 pixels_per_band{ 1 << 16 };
+		constexpr u32 min_rows_per_band{ 4 };
+
+		constexpr u32 alpha_bin_count{ 1024 };
+		using AlphaHistogram = std::array<u32, alpha_bin_count>;
+
+		// Entries of the linear to sRGB table. 16 bits keep the steep start of the curve exact at 8 bits.
+		constexpr u32 linear_table_size{ 1 << 16 };
+
+		struct SRGBTables {
+			f32 to_linear[256];
+			u8 from_linear[linear_table_size];
+		};
+
+		const SRGBTables& GetSRGBTables() {
+			static SRGBTables tables{};
+			static std::once_flag once;
+			std::call_once(once, [] {
+				for (u32 i{ 0 }; i < 256; i++) {
+					const f32 c{ i / 255.f };
+					tables.to_linear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+				}
+				for (u32 i{ 0 }; i < linear_table_size; i++) {
+					const f32 l{ i / (f32)(linear_table_size - 1) };
+					const f32 c{ l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.f / 2.4f) - 0.055f };
+					tables.from_linear[i] = (u8)(c * 255.f + 0.5f);
+				}
+			});
+			return tables;
+		}
+
+		[[nodiscard]] f32 Sinc(f32 x) {
+			if (std::abs(x) < 1e-5f) return 1.f;
+			x *= Math::PI;
+			return std::sin(x) / x;
+		}
+
+		// Zeroth order modified Bessel function of the first kind, for the Kaiser window.
+		[[nodiscard]] f32 BesselI0(f32 x) {
+			const f32 q{ x * x * 0.25f };
+			f32 sum{ 1.f };
+			f32 term{ 1.f };
+			for (u32 k{ 1 }; k < 32 && term > sum * 1e-7f; k++) {
+				term *= q / (f32)(k * k);
+				sum += term;
+			}
+			return sum;
+		}
+
+		[[nodiscard]] f32 FilterWeight(Filter::Type filter, f32 x) {
+			x = std::abs(x);
+			const f32 radius{ filter_radius[filter] };
+			if (x > radius) return 0.f;
+
+			switch (filter) {
+			case Filter::Box: return 1.f;
+			case Filter::Kaiser: {
+				const f32 t{ x / radius };
+				return Sinc(x) * BesselI0(kaiser_alpha * std::sqrt(1.f - t * t)) / BesselI0(kaiser_alpha);
+			}
+			case Filter::Lanczos: return Sinc(x) * Sinc(x / radius);
+			default: assert(false); return 0.f;
+			}
+		}
+
+		// Source pixels and normalized weights of every destination pixel along one axis. The taps of
+		// destination pixel i are [offsets[i], offsets[i + 1]). Source pixels past the edge are clamped.
+		struct Taps {
+			util::vector<u32> offsets;
+			util::vector<u32> indices;
+			util::vector<f32> weights;
+		};
+
+		[[nodiscard]] Taps BuildTaps(Filter::Type filter, u32 source_size, u32 destination_size) {
+			assert(destination_size && source_size >= destination_size);
+			const f32 scale{ (f32)source_size / (f32)destination_size };
+			const f32 support{ filter_radius[filter] * scale };
+
+			Taps taps;
+			taps.offsets.emplace_back(0);
+			for (u32 x{ 0 }; x < destination_size; x++) {
+				const f32 center{ (x + 0.5f) * scale };
+				const s32 first{ (s32)std::ceil(center - support - 0.5f) };
+				const s32 last{ (s32)std::floor(center + support - 0.5f) };
+				const u32 start{ (u32)taps.weights.size() };
+				f32 sum{ 0.f };
+
+				for (s32 i{ first }; i <= last; i++) {
+					const f32 weight{ FilterWeight(filter, (i + 0.5f - center) / scale) };
+					if (weight == 0.f) continue;
+					taps.indices.emplace_back((u32)std::clamp(i, 0, (s32)source_size - 1));
+					taps.weights.emplace_back(weight);
+					sum += weight;
+				}
+
+				assert(sum > 0.f);
+				for (u32 i{ start }; i < taps.weights.size(); i++) taps.weights[i] /= sum;
+				taps.offsets.emplace_back((u32)taps.weights.size());
+			}
+
+			return taps;
+		}
+
+		[[nodiscard]] u32 RowsPerBand(u32 width) {
+			return std::max(pixels_per_band / width, min_rows_per_band);
+		}
+
+		[[nodiscard]] const u8* Row(const MipImage& image, u32 y) {
+			return &image.pixels[(u64)y * image.row_pitch];
+		}
+
+		// Converts a row to linear RGBA floats. Missing channels are 0 and missing alpha is 1.
+		void DecodeRow(const u8* const row, u32 width, const PixelFormat& format, f32* const rgba) {
+			const u32 channel_count{ format.channel_count };
+			const u32 value_count{ width * channel_count };
+			// NOTE: the values are converted into the end of the RGBA row and then spread out from the front,
+			//       which never overwrites a value that hasn't been read yet.
+			f32* const values{ rgba + (4 - channel_count) * width };
+
+			switch (format.type) {
+			case PixelType::UNorm8:
+				if (format.is_srgb) {
+					const f32* const to_linear{ GetSRGBTables().to_linear };
+					for (u32 i{ 0 }; i < value_count; i++) {
+						values[i] = (i & 3) == 3 ? row[i] * (1.f / 255.f) : to_linear[row[i]];
+					}
+				}
+				else {
+					for (u32 i{ 0 }; i < value_count; i++) values[i] = row[i] * (1.f / 255.f);
+				}
+				break;
+			case PixelType::UNorm16: {
+				const u16* const source{ (const u16*)row };
+				for (u32 i{ 0 }; i < value_count; i++) values[i] = source[i] * (1.f / 65535.f);
+				break;
+			}
+			case PixelType::Float16:
+				XMConvertHalfToFloatStream(values, sizeof(f32), (const HALF*)row, sizeof(HALF), value_count);
+				break;
+			case PixelType::Float32:
+				memcpy(values, row, value_count * sizeof(f32));
+				break;
+			default: assert(false);
+			}
+
+			if (channel_count == 4) return;
+			for (u32 x{ 0 }; x < width; x++) {
+				f32 pixel[4]{ 0.f, 0.f, 0.f, 1.f };
+				for (u32 c{ 0 }; c < channel_count; c++) pixel[c] = values[x * channel_count + c];
+				memcpy(&rgba[x * 4], pixel, sizeof(pixel));
+			}
+		}
+
+		// Rescales the vectors of a filtered normal map row back to unit length. Two channel normal maps
+		// only store x and y, so their length is only kept at or below 1.
+		void RenormalizeRow(f32* const rgba, u32 width, const PixelFormat& format) {
+			const bool is_unorm{ format.type == PixelType::UNorm8 || format.type == PixelType::UNorm16 };
+			const f32 scale{ is_unorm ? 2.f : 1.f };
+			const f32 bias{ is_unorm ? -1.f : 0.f };
+
+			for (u32 x{ 0 }; x < width; x++) {
+				f32* const pixel{ &rgba[x * 4] };
+				f32 n[3]{ pixel[0] * scale + bias, pixel[1] * scale + bias, pixel[2] * scale + bias };
+
+				if (format.channel_count == 4) {
+					const f32 length{ std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) };
+					if (length > 1e-6f) {
+						for (u32 c{ 0 }; c < 3; c++) n[c] /= length;
+					}
+					else {
+						n[0] = n[1] = 0.f;
+						n[2] = 1.f;
+					}
+				}
+				else if (format.channel_count == 2) {
+					const f32 length{ std::sqrt(n[0] * n[0] + n[1] * n[1]) };
+					if (length > 1.f) {
+						n[0] /= length;
+						n[1] /= length;
+					}
+				}
+
+				for (u32 c{ 0 }; c < 3; c++) pixel[c] = (n[c] - bias) / scale;
+			}
+		}
+
+		// Converts filtered RGBA floats back to the pixel format. The floats are overwritten.
+		void EncodeRow(f32* const rgba, u32 width, const PixelFormat& format, u8* const row) {
+			const u32 channel_count{ format.channel_count };
+			const u32 value_count{ width * channel_count };
+
+			if (channel_count == 4) {
+				for (u32 x{ 0 }; x < width; x++) rgba[x * 4 + 3] = std::clamp(rgba[x * 4 + 3], 0.f, 1.f);
+			}
+			else {
+				// Packing from the front only writes over pixels that have been read.
+				for (u32 x{ 0 }; x < width; x++) {
+					f32 pixel[4];
+					memcpy(pixel, &rgba[x * 4], sizeof(pixel));
+					for (u32 c{ 0 }; c < channel_count; c++) rgba[x * channel_count + c] = pixel[c];
+				}
+			}
+
+			switch (format.type) {
+			case PixelType::UNorm8:
+				if (format.is_srgb) {
+					const u8* const from_linear{ GetSRGBTables().from_linear };
+					for (u32 i{ 0 }; i < value_count; i++) {
+						const f32 v{ std::clamp(rgba[i], 0.f, 1.f) };
+						row[i] = (i & 3) == 3 ? (u8)(v * 255.f + 0.5f) : from_linear[(u32)(v * (linear_table_size - 1) + 0.5f)];
+					}
+				}
+				else {
+					for (u32 i{ 0 }; i < value_count; i++) row[i] = (u8)(std::clamp(rgba[i], 0.f, 1.f) * 255.f + 0.5f);
+				}
+				break;
+			case PixelType::UNorm16: {
+				u16* const destination{ (u16*)row };
+				for (u32 i{ 0 }; i < value_count; i++) destination[i] = (u16)(std::clamp(rgba[i], 0.f, 1.f) * 65535.f + 0.5f);
+				break;
+			}
+			case PixelType::Float16:
+				XMConvertFloatToHalfStream((HALF*)row, sizeof(HALF), rgba, sizeof(f32), value_count);
+				break;
+			case PixelType::Float32:
+				memcpy(row, rgba, value_count * sizeof(f32));
+				break;
+			default: assert(false);
+			}
+		}
+
+		void FilterRow(const f32* const source, const Taps& taps, u32 width, f32* const destination) {
+			for (u32 x{ 0 }; x < width; x++) {
+				__m128 sum{ _mm_setzero_ps() };
+				for (u32 t{ taps.offsets[x] }; t < taps.offsets[x + 1]; t++) {
+					const __m128 pixel{ _mm_loadu_ps(&source[taps.indices[t] * 4]) };
+					sum = _mm_add_ps(sum, _mm_mul_ps(pixel, _mm_set1_ps(taps.weights[t])));
+				}
+				_mm_storeu_ps(&destination[x * 4], sum);
+			}
+		}
+
+		// Sums the weighted rows of one destination row. rows[i] is the horizontally filtered source row first_row + i.
+		void FilterColumn(const f32* const rows, u32 first_row, u32 value_count, const Taps& taps, u32 y, f32* const destination) {
+			memset(destination, 0, value_count * sizeof(f32));
+			for (u32 t{ taps.offsets[y] }; t < taps.offsets[y + 1]; t++) {
+				const f32* const row{ &rows[(u64)(taps.indices[t] - first_row) * value_count] };
+				const __m128 weight{ _mm_set1_ps(taps.weights[t]) };
+				for (u32 i{ 0 }; i < value_count; i += 4) {
+					const __m128 sum{ _mm_add_ps(_mm_loadu_ps(&destination[i]), _mm_mul_ps(_mm_loadu_ps(&row[i]), weight)) };
+					_mm_storeu_ps(&destination[i], sum);
+				}
+			}
+		}
+
+		void GenerateMip(const MipImage& source, const MipImage& destination, const PixelFormat& format, const Settings& settings) {
+			const Taps columns{ BuildTaps(settings.filter, source.width, destination.width) };
+			const Taps rows{ BuildTaps(settings.filter, source.height, destination.height) };
+			const u32 rows_per_band{ RowsPerBand(destination.width) };
+			const u32 band_count{ (destination.height + rows_per_band - 1) / rows_per_band };
+			const u32 value_count{ destination.width * 4 };
+
+			ParallelFor(band_count, [&](u32 band) {
+				const u32 first_row{ band * rows_per_band };
+				const u32 last_row{ std::min(first_row + rows_per_band, destination.height) };
+
+				// Every band filters the source rows it needs horizontally, once, before filtering them vertically.
+				u32 first_source_row{ source.height };
+				u32 last_source_row{ 0 };
+				for (u32 t{ rows.offsets[first_row] }; t < rows.offsets[last_row]; t++) {
+					first_source_row = std::min(first_source_row, rows.indices[t]);
+					last_source_row = std::max(last_source_row, rows.indices[t]);
+				}
+
+				const u32 source_row_count{ last_source_row - first_source_row + 1 };
+				util::vector<f32> decoded(source.width * 4);
+				util::vector<f32> filtered((u64)source_row_count * value_count);
+				for (u32 y{ 0 }; y < source_row_count; y++) {
+					DecodeRow(Row(source, first_source_row + y), source.width, format, decoded.data());
+					FilterRow(decoded.data(), columns, destination.width, &filtered[(u64)y * value_count]);
+				}
+
+				util::vector<f32> output(value_count);
+				for (u32 y{ first_row }; y < last_row; y++) {
+					FilterColumn(filtered.data(), first_source_row, value_count, rows, y, output.data());
+					if (settings.is_normal_map) RenormalizeRow(output.data(), destination.width, format);
+					EncodeRow(output.data(), destination.width, format, (u8*)Row(destination, y));
+				}
+			});
+		}
+
+		[[nodiscard]] f32 LoadAlpha(const u8* const row, u32 x, PixelType::Type type) {
+			switch (type) {
+			case PixelType::UNorm8: return row[x * 4 + 3] * (1.f / 255.f);
+			case PixelType::UNorm16: return ((const u16*)row)[x * 4 + 3] * (1.f / 65535.f);
+			case PixelType::Float16: return XMConvertHalfToFloat(((const HALF*)row)[x * 4 + 3]);
+			case PixelType::Float32: return ((const f32*)row)[x * 4 + 3];
+			default: assert(false); return 1.f;
+			}
+		}
+
+		void StoreAlpha(u8* const row, u32 x, PixelType::Type type, f32 alpha) {
+			alpha = std::clamp(alpha, 0.f, 1.f);
+			switch (type) {
+			case PixelType::UNorm8: row[x * 4 + 3] = (u8)(alpha * 255.f + 0.5f); break;
+			case PixelType::UNorm16: ((u16*)row)[x * 4 + 3] = (u16)(alpha * 65535.f + 0.5f); break;
+			case PixelType::Float16: ((HALF*)row)[x * 4 + 3] = XMConvertFloatToHalf(alpha); break;
+			case PixelType::Float32: ((f32*)row)[x * 4 + 3] = alpha; break;
+			default: assert(false);
+			}
+		}
+
+		// Bin b holds the alpha values in [b / alpha_bin_count, (b + 1) / alpha_bin_count).
+		[[nodiscard]] u32 AlphaBin(f32 alpha) {
+			return (u32)std::clamp(alpha * alpha_bin_count, 0.f, (f32)(alpha_bin_count - 1));
+		}
+
+		void BuildAlphaHistogram(const MipImage& image, PixelType::Type type, AlphaHistogram& histogram) {
+			histogram.fill(0);
+			std::mutex mutex;
+			const u32 rows_per_band{ RowsPerBand(image.width) };
+			const u32 band_count{ (image.height + rows_per_band - 1) / rows_per_band };
+
+			ParallelFor(band_count, [&](u32 band) {
+				AlphaHistogram local{};
+				const u32 last_row{ std::min((band + 1) * rows_per_band, image.height) };
+				for (u32 y{ band * rows_per_band }; y < last_row; y++) {
+					const u8* const row{ Row(image, y) };
+					for (u32 x{ 0 }; x < image.width; x++) local[AlphaBin(LoadAlpha(row, x, type))]++;
+				}
+
+				std::lock_guard lock{ mutex };
+				for (u32 i{ 0 }; i < alpha_bin_count; i++) histogram[i] += local[i];
+			});
+		}
+
+		// Fraction of pixels whose alpha passes the alpha test.
+		[[nodiscard]] f32 AlphaCoverage(const AlphaHistogram& histogram, u64 pixel_count, f32 reference) {
+			u64 count{ 0 };
+			for (u32 i{ AlphaBin(reference) }; i < alpha_bin_count; i++) count += histogram[i];
+			return (f32)count / (f32)pixel_count;
+		}
+
+		// Scales alpha so that the mip passes the alpha test about as often as mip 0 does. Otherwise foliage and
+		// fences thin out with distance, as averaging pulls more of their alpha below the reference.
+		void PreserveAlphaCoverage(const MipImage& image, PixelType::Type type, f32 reference, f32 coverage) {
+			AlphaHistogram histogram;
+			BuildAlphaHistogram(image, type, histogram);
+
+			// Find the alpha value that as many pixels pass as passed the reference in mip 0.
+			const u64 target{ (u64)(coverage * (f32)((u64)image.width * image.height) + 0.5f) };
+			u64 count{ 0 };
+			u32 bin{ alpha_bin_count };
+			while (bin > 0 && count < target) count += histogram[--bin];
+			if (count >= target && bin < alpha_bin_count - 1 && count - target > target - (count - histogram[bin])) bin++;
+			if (!bin || bin == AlphaBin(reference)) return;
+
+			const f32 scale{ reference / ((f32)bin / alpha_bin_count) };
+			const u32 rows_per_band{ RowsPerBand(image.width) };
+			const u32 band_count{ (image.height + rows_per_band - 1) / rows_per_band };
+
+			ParallelFor(band_count, [&](u32 band) {
+				const u32 last_row{ std::min((band + 1) * rows_per_band, image.height) };
+				for (u32 y{ band * rows_per_band }; y < last_row; y++) {
+					u8* const row{ (u8*)Row(image, y) };
+					for (u32 x{ 0 }; x < image.width; x++) StoreAlpha(row, x, type, LoadAlpha(row, x, type) * scale);
+				}
+			});
+		}
+	} // anonymous namespace
+
+	void Generate(const MipImage* const mips, u32 mip_count, const PixelFormat& format, const Settings& settings) {
+		assert(mips && mip_count);
+		assert(format.type < PixelType::count && settings.filter < Filter::count);
+		assert(format.channel_count == 1 || format.channel_count == 2 || format.channel_count == 4);
+		assert(!format.is_srgb || (format.type == PixelType::UNorm8 && format.channel_count == 4));
+
+		// Normal maps hold vectors, not colors, so they're never filtered in linear space.
+		PixelFormat pixel_format{ format };
+		if (settings.is_normal_map) pixel_format.is_srgb = false;
+
+		const f32 reference{ settings.alpha_coverage_reference };
+		const bool preserve_coverage{ reference > 0.f && reference < 1.f && format.channel_count == 4 };
+		f32 coverage{ 0.f };
+		if (preserve_coverage) {
+			AlphaHistogram histogram;
+			BuildAlphaHistogram(mips[0], format.type, histogram);
+			coverage = AlphaCoverage(histogram, (u64)mips[0].width * mips[0].height, reference);
+		}
+
+		for (u32 i{ 1 }; i < mip_count; i++) {
+			assert(mips[i].width == std::max(mips[i - 1].width >> 1, 1u));
+			assert(mips[i].height == std::max(mips[i - 1].height >> 1, 1u));
+			GenerateMip(mips[i - 1], mips[i], pixel_format, settings);
+			if (preserve_coverage && coverage > 0.f && coverage < 1.f) {
+				PreserveAlphaCoverage(mips[i], format.type, reference, coverage);
+			}
+		}
+	}
+
+	bool IsCutout(const MipImage& image, const PixelFormat& format, f32 reference) {
+		if (format.channel_count != 4) return false;
+
+		AlphaHistogram histogram;
+		BuildAlphaHistogram(image, format.type, histogram);
+
+		// Alpha between 1/16 and 15/16 only shows up along the edges of cutouts.
+		constexpr u32 edge_bins{ alpha_bin_count / 16 };
+		const u32 reference_bin{ AlphaBin(reference) };
+		u64 below{ 0 };
+		u64 above{ 0 };
+		u64 partial{ 0 };
+		for (u32 i{ 0 }; i < alpha_bin_count; i++) {
+			(i < reference_bin ? below : above) += histogram[i];
+			if (i >= edge_bins && i < alpha_bin_count - edge_bins) partial += histogram[i];
+		}
+
+		return below && above && partial * 10 < (u64)image.width * image.height;
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "ToolsCommon.h"
+
+// Mip chain generation with separable filters. sRGB pixels are filtered in linear space, normal maps are
+// renormalized and alpha tested textures can keep their alpha coverage in every mip.
+// Like the block encoder, it doesn't depend on DirectXTex: the importer only hands it the pixels.
+namespace Zetta::Tools::Mips {
+	struct Filter {
+		enum Type : u32 {
+			Box,		// 2x2 average, the fastest and the blurriest
+			Kaiser,		// windowed sinc, sharp with little ringing
+			Lanczos,	// 3-lobe sinc, the sharpest but rings most around hard edges
+
+			count
+		};
+	};
+
+	struct PixelType {
+		enum Type : u32 {
+			UNorm8,
+			UNorm16,
+			Float16,
+			Float32,
+
+			count
+		};
+	};
+
+	// How the pixels of every mip are stored. Channel order doesn't matter, except that alpha is the 4th.
+	struct PixelFormat {
+		PixelType::Type type;
+		u32 channel_count;	// 1, 2 or 4
+		bool is_srgb;		// 8-bit color that is filtered in linear space. Alpha is always linear.
+	};
+
+	struct Settings {
+		Filter::Type filter;
+		bool is_normal_map;				// the first 3 channels are a unit vector, stored as value * 0.5 + 0.5 in UNorm pixels
+		f32 alpha_coverage_reference;	// alpha test reference whose coverage mip 0 sets for every mip, or 0 to leave alpha alone
+	};
+
+	// One mip of one slice. The row pitch is in bytes.
+	struct MipImage {
+		u8* pixels;
+		u32 width;
+		u32 height;
+		u32 row_pitch;
+	};
+
+	// Fills mips 1 to mip_count - 1 from mip 0, each from the one before it. Every mip has to be allocated at half
+	// the size of the one before it, rounded down and at least 1.
+	void Generate(const MipImage* const mips, u32 mip_count, const PixelFormat& format, const Settings& settings);
+
+	// True if nearly all alpha values are close to 0 or 1 and some are on each side of the reference,
+	// like foliage and fences that are alpha tested.
+	[[nodiscard]] bool IsCutout(const MipImage& image, const PixelFormat& format, f32 reference);
+}
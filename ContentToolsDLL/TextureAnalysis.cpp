@@ -0,0 +1,220 @@
+#include "TextureAnalysis.h"
+#include <immintrin.h>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace Zetta::Tools {
+	namespace {
+		constexpr f32 INV_255{ 1.f / 255.f };
+		constexpr f32 MIN_AVG_LENGTH_THRESHOLD{ 0.7f };
+		constexpr f32 MAX_AVG_LENGTH_THRESHOLD{ 1.1f };
+		constexpr f32 MIN_AVG_Z_THRESHOLD{ 0.8f };
+		constexpr f32 VECTOR_LENGTH_SQ_REJECTION_THRESHOLD{ MIN_AVG_LENGTH_THRESHOLD * MIN_AVG_LENGTH_THRESHOLD };
+		constexpr f32 REJECTION_RATIO_THRESHOLD{ 0.33f };
+		constexpr f32 MIN_ACCEPTED_RATIO{ 0.25f };
+		// Alpha between these is neither transparent nor opaque, which in cutouts only happens along the edges.
+		constexpr s32 MIN_TRANSLUCENT_ALPHA{ 16 };
+		constexpr s32 MAX_TRANSLUCENT_ALPHA{ 239 };
+		constexpr f32 MAX_CUTOUT_TRANSLUCENT_RATIO{ 0.1f };
+		// Pixels analyzed per ParallelFor item. This also keeps the 32-bit SIMD sums from overflowing.
+		constexpr u32 PIXELS_PER_BAND{ 1 << 16 };
+
+		// Totals of one band of rows, in RGBA order.
+		struct BandTotals {
+			u64 sum[4];
+			u64 normal_sum[3];	// color of the pixels that look like normals
+			u64 accepted;		// pixels that look like a unit vector with positive z
+			u64 rejected;		// pixels that don't. Black and transparent pixels are neither.
+			u64 covered;
+			u64 translucent;
+			u8 min[4];
+			u8 max[4];
+			bool is_grayscale;
+		};
+
+		[[nodiscard]] u64 HorizontalSum(__m128i v) {
+			alignas(16) u32 lanes[4];
+			_mm_store_si128((__m128i*)lanes, v);
+			return (u64)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+		}
+
+		// Processes 4 pixels at a time with the channels in separate 32-bit lanes. Rows that aren't a multiple of
+		// 4 pixels end with a chunk that repeats the last pixel, which the counts and sums leave out.
+		void AnalyzeRows(const Image& image, u32 first_row, u32 last_row, bool is_bgr, u8 alpha_threshold, BandTotals& totals) {
+			const __m128i zero{ _mm_setzero_si128() };
+			const __m128i byte_mask{ _mm_set1_epi32(0xff) };
+			const __m128i gray_mask{ _mm_set1_epi32(0xffff) };
+			const __m128i min_covered_alpha{ _mm_set1_epi32((s32)alpha_threshold - 1) };
+			const __m128i min_translucent_alpha{ _mm_set1_epi32(MIN_TRANSLUCENT_ALPHA - 1) };
+			const __m128i max_translucent_alpha{ _mm_set1_epi32(MAX_TRANSLUCENT_ALPHA + 1) };
+			const __m128 scale{ _mm_set1_ps(2.f * INV_255) };
+			const __m128 one{ _mm_set1_ps(1.f) };
+			const __m128 min_length_sq{ _mm_set1_ps(VECTOR_LENGTH_SQ_REJECTION_THRESHOLD) };
+
+			__m128i min{ _mm_set1_epi8(-1) };
+			__m128i max{ zero };
+			__m128i not_gray{ zero };
+			__m128i sum[4]{ zero, zero, zero, zero };
+			__m128i normal_sum[3]{ zero, zero, zero };
+			__m128i accepted{ zero };
+			__m128i rejected{ zero };
+			__m128i covered{ zero };
+			__m128i translucent{ zero };
+
+			const u32 width{ (u32)image.width };
+			for (u32 y{ first_row }; y < last_row; y++) {
+				const u32* const row{ (const u32*)&image.pixels[(u64)y * image.rowPitch] };
+				for (u32 x{ 0 }; x < width; x += 4) {
+					__m128i pixels;
+					__m128i valid{ _mm_set1_epi32(-1) };
+					if (x + 4 <= width) {
+						pixels = _mm_loadu_si128((const __m128i*)&row[x]);
+					}
+					else {
+						const u32 count{ width - x };
+						alignas(16) u32 tail[4];
+						for (u32 i{ 0 }; i < 4; i++) tail[i] = row[x + std::min(i, count - 1)];
+						pixels = _mm_load_si128((const __m128i*)tail);
+						valid = _mm_cmpgt_epi32(_mm_set1_epi32((s32)count), _mm_setr_epi32(0, 1, 2, 3));
+					}
+
+					min = _mm_min_epu8(min, pixels);
+					max = _mm_max_epu8(max, pixels);
+					// The first two bytes of every pixel are equal to the next ones only if all three colors are.
+					not_gray = _mm_or_si128(not_gray, _mm_and_si128(_mm_xor_si128(pixels, _mm_srli_epi32(pixels, 8)), gray_mask));
+
+					__m128i r{ _mm_and_si128(_mm_and_si128(pixels, byte_mask), valid) };
+					const __m128i g{ _mm_and_si128(_mm_and_si128(_mm_srli_epi32(pixels, 8), byte_mask), valid) };
+					__m128i b{ _mm_and_si128(_mm_and_si128(_mm_srli_epi32(pixels, 16), byte_mask), valid) };
+					const __m128i a{ _mm_and_si128(_mm_srli_epi32(pixels, 24), valid) };
+					if (is_bgr) std::swap(r, b);
+
+					sum[0] = _mm_add_epi32(sum[0], r);
+					sum[1] = _mm_add_epi32(sum[1], g);
+					sum[2] = _mm_add_epi32(sum[2], b);
+					sum[3] = _mm_add_epi32(sum[3], a);
+
+					// Comparison masks are -1, so subtracting them counts.
+					covered = _mm_sub_epi32(covered, _mm_and_si128(_mm_cmpgt_epi32(a, min_covered_alpha), valid));
+					translucent = _mm_sub_epi32(translucent, _mm_and_si128(_mm_cmpgt_epi32(a, min_translucent_alpha), _mm_cmplt_epi32(a, max_translucent_alpha)));
+
+					const __m128 nx{ _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(r), scale), one) };
+					const __m128 ny{ _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(g), scale), one) };
+					const __m128 nz{ _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(b), scale), one) };
+					const __m128 length_sq{ _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz)) };
+					const __m128i is_black{ _mm_cmpeq_epi32(_mm_or_si128(_mm_or_si128(r, g), b), zero) };
+					const __m128i is_transparent{ _mm_cmpeq_epi32(a, zero) };
+					const __m128i counts{ _mm_andnot_si128(_mm_or_si128(is_black, is_transparent), valid) };
+					const __m128i is_rejected{ _mm_castps_si128(_mm_or_ps(_mm_cmplt_ps(nz, _mm_setzero_ps()), _mm_cmplt_ps(length_sq, min_length_sq))) };
+					const __m128i is_accepted{ _mm_andnot_si128(is_rejected, counts) };
+
+					accepted = _mm_sub_epi32(accepted, is_accepted);
+					rejected = _mm_sub_epi32(rejected, _mm_and_si128(is_rejected, counts));
+					normal_sum[0] = _mm_add_epi32(normal_sum[0], _mm_and_si128(r, is_accepted));
+					normal_sum[1] = _mm_add_epi32(normal_sum[1], _mm_and_si128(g, is_accepted));
+					normal_sum[2] = _mm_add_epi32(normal_sum[2], _mm_and_si128(b, is_accepted));
+				}
+			}
+
+			for (u32 c{ 0 }; c < 4; c++) totals.sum[c] = HorizontalSum(sum[c]);
+			for (u32 c{ 0 }; c < 3; c++) totals.normal_sum[c] = HorizontalSum(normal_sum[c]);
+			totals.accepted = HorizontalSum(accepted);
+			totals.rejected = HorizontalSum(rejected);
+			totals.covered = HorizontalSum(covered);
+			totals.translucent = HorizontalSum(translucent);
+			totals.is_grayscale = _mm_testz_si128(not_gray, not_gray) != 0;
+
+			alignas(16) u8 min_bytes[16];
+			alignas(16) u8 max_bytes[16];
+			_mm_store_si128((__m128i*)min_bytes, min);
+			_mm_store_si128((__m128i*)max_bytes, max);
+			for (u32 c{ 0 }; c < 4; c++) {
+				const u32 channel{ is_bgr && c != 3 ? 2 - c : c };
+				totals.min[channel] = std::min({ min_bytes[c], min_bytes[c + 4], min_bytes[c + 8], min_bytes[c + 12] });
+				totals.max[channel] = std::max({ max_bytes[c], max_bytes[c + 4], max_bytes[c + 8], max_bytes[c + 12] });
+			}
+		}
+
+		// The average of the pixels that look like normals has to be close to a unit vector pointing up.
+		[[nodiscard]] bool IsNormalMap(const BandTotals& totals, u64 pixel_count) {
+			if (!totals.accepted || totals.accepted < (u64)(pixel_count * MIN_ACCEPTED_RATIO)) return false;
+
+			const f32 rejection_ratio{ (f32)totals.rejected / (f32)totals.accepted };
+			if (rejection_ratio > REJECTION_RATIO_THRESHOLD) return false;
+
+			const f32 scale{ 2.f * INV_255 / (f32)totals.accepted };
+			const Math::v3 v{ totals.normal_sum[0] * scale - 1.f, totals.normal_sum[1] * scale - 1.f, totals.normal_sum[2] * scale - 1.f };
+			const f32 avg_length{ sqrt(v.x * v.x + v.y * v.y + v.z * v.z) };
+			const f32 avg_normalized_z{ v.z / avg_length };
+
+			return
+				avg_length >= MIN_AVG_LENGTH_THRESHOLD &&
+				avg_length <= MAX_AVG_LENGTH_THRESHOLD &&
+				avg_normalized_z >= MIN_AVG_Z_THRESHOLD;
+		}
+	}
+
+	bool AnalyzeImages(const Image* const images, u32 image_count, f32 alpha_threshold, TextureStatistics& statistics) {
+		assert(images && image_count);
+		const DXGI_FORMAT format{ images[0].format };
+		switch (format) {
+		case DXGI_FORMAT_R8G8B8A8_UNORM:
+		case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+		case DXGI_FORMAT_B8G8R8A8_UNORM:
+		case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB: break;
+		default: return false;
+		}
+
+		const bool is_bgr{ IsBGR(format) };
+		const u8 threshold{ (u8)std::ceil(std::clamp(alpha_threshold, 0.f, 1.f) * 255.f) };
+		util::vector<BandTotals> bands;
+		u64 pixel_count{ 0 };
+
+		for (u32 i{ 0 }; i < image_count; i++) {
+			const Image& image{ images[i] };
+			assert(image.format == format && image.pixels);
+			const u32 height{ (u32)image.height };
+			const u32 rows_per_band{ std::max(PIXELS_PER_BAND / (u32)image.width, 1u) };
+			const u32 band_count{ (height + rows_per_band - 1) / rows_per_band };
+			const u32 first_band{ (u32)bands.size() };
+			bands.resize(first_band + band_count);
+
+			ParallelFor(band_count, [&](u32 band) {
+				const u32 first_row{ band * rows_per_band };
+				AnalyzeRows(image, first_row, std::min(first_row + rows_per_band, height), is_bgr, threshold, bands[first_band + band]);
+			});
+
+			pixel_count += (u64)image.width * image.height;
+		}
+
+		BandTotals totals{ {}, {}, 0, 0, 0, 0, { 255, 255, 255, 255 }, {}, true };
+		for (const BandTotals& band : bands) {
+			for (u32 c{ 0 }; c < 4; c++) {
+				totals.sum[c] += band.sum[c];
+				totals.min[c] = std::min(totals.min[c], band.min[c]);
+				totals.max[c] = std::max(totals.max[c], band.max[c]);
+			}
+			for (u32 c{ 0 }; c < 3; c++) totals.normal_sum[c] += band.normal_sum[c];
+			totals.accepted += band.accepted;
+			totals.rejected += band.rejected;
+			totals.covered += band.covered;
+			totals.translucent += band.translucent;
+			totals.is_grayscale &= band.is_grayscale;
+		}
+
+		for (u32 c{ 0 }; c < 4; c++) {
+			statistics.min[c] = totals.min[c] * INV_255;
+			statistics.max[c] = totals.max[c] * INV_255;
+			statistics.mean[c] = (f32)totals.sum[c] / (f32)pixel_count * INV_255;
+		}
+
+		statistics.alpha_coverage = (f32)totals.covered / (f32)pixel_count;
+		statistics.is_opaque = totals.min[3] == 255;
+		statistics.is_cutout = totals.covered && totals.covered < pixel_count &&
+			(f32)totals.translucent < pixel_count * MAX_CUTOUT_TRANSLUCENT_RATIO;
+		statistics.is_grayscale = totals.is_grayscale;
+		statistics.is_normal_map = IsNormalMap(totals, pixel_count);
+		return true;
+	}
+}
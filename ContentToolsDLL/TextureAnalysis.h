@@ -0,0 +1,22 @@
+#pragma once
+#include "ToolsCommon.h"
+#include <DirectXTex.h>
+
+// Everything the texture importer decides formats and mip settings on, gathered in one SIMD pass over every
+// pixel of the source images.
+namespace Zetta::Tools {
+	struct TextureStatistics {
+		f32 min[4];				// per RGBA channel, 0-1
+		f32 max[4];
+		f32 mean[4];
+		f32 alpha_coverage;		// fraction of pixels with alpha at or above the alpha threshold
+		bool is_opaque;			// every alpha is 1
+		bool is_cutout;			// nearly every alpha is close to 0 or 1, with some on each side of the alpha threshold
+		bool is_grayscale;		// red, green and blue are equal in every pixel
+		bool is_normal_map;		// nearly every pixel is a unit vector with positive z, stored as value * 0.5 + 0.5
+	};
+
+	// Analyzes images that share a format. Only 8-bit RGBA and BGRA are supported. Returns false for other formats.
+	[[nodiscard]] bool AnalyzeImages(const DirectX::Image* const images, u32 image_count, f32 alpha_threshold,
+		TextureStatistics& statistics);
+}
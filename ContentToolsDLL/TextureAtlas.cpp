@@ -0,0 +1,249 @@
+#include "TextureAtlas.h"
+
+namespace Zetta::Tools::Atlas {
+	namespace {
+		// Free space of the atlas as maximal rectangles, which may overlap each other. Everything is in
+		// units of the cell alignment, which keeps the rectangle count and the searches small.
+		class FreeSpace {
+		public:
+			FreeSpace(u32 width, u32 height) {
+				_rects.emplace_back(0u, 0u, width, height);
+			}
+
+			// Best short side fit: the free rectangle that leaves the least space along its tighter side.
+			[[nodiscard]] bool Find(u32 width, u32 height, Rect& rect) const {
+				u32 best_short_side{ ~0u };
+				u32 best_long_side{ ~0u };
+				for (const Rect& free_rect : _rects) {
+					if (free_rect.width < width || free_rect.height < height) continue;
+					const u32 dx{ free_rect.width - width };
+					const u32 dy{ free_rect.height - height };
+					const u32 short_side{ std::min(dx, dy) };
+					const u32 long_side{ std::max(dx, dy) };
+					if (short_side < best_short_side || (short_side == best_short_side && long_side < best_long_side)) {
+						rect = { free_rect.x, free_rect.y, width, height };
+						best_short_side = short_side;
+						best_long_side = long_side;
+					}
+				}
+				return best_short_side != ~0u;
+			}
+
+			// Takes the rectangle out of the free space. Only the rectangles made by this split are checked for
+			// containment, which keeps placing linear in the number of free rectangles.
+			void Place(const Rect& used) {
+				util::vector<Rect> new_rects;
+				for (u32 i{ 0 }; i < _rects.size();) {
+					const Rect free_rect{ _rects[i] };
+					if (!Intersects(free_rect, used)) {
+						i++;
+						continue;
+					}
+
+					if (used.x > free_rect.x) new_rects.emplace_back(free_rect.x, free_rect.y, used.x - free_rect.x, free_rect.height);
+					if (used.x + used.width < free_rect.x + free_rect.width)
+						new_rects.emplace_back(used.x + used.width, free_rect.y, free_rect.x + free_rect.width - used.x - used.width, free_rect.height);
+					if (used.y > free_rect.y) new_rects.emplace_back(free_rect.x, free_rect.y, free_rect.width, used.y - free_rect.y);
+					if (used.y + used.height < free_rect.y + free_rect.height)
+						new_rects.emplace_back(free_rect.x, used.y + used.height, free_rect.width, free_rect.y + free_rect.height - used.y - used.height);
+					_rects.EraseUnordered(i);
+				}
+
+				for (u32 i{ 0 }; i < new_rects.size();) {
+					bool is_contained{ false };
+					for (u32 j{ 0 }; j < new_rects.size() && !is_contained; j++) {
+						// Of two equal rectangles, the later one is kept.
+						is_contained = j != i && Contains(new_rects[j], new_rects[i]) && (j > i || !Contains(new_rects[i], new_rects[j]));
+					}
+					for (u32 j{ 0 }; j < _rects.size() && !is_contained; j++) is_contained = Contains(_rects[j], new_rects[i]);
+
+					if (is_contained) new_rects.erase(i);
+					else i++;
+				}
+
+				for (u32 i{ 0 }; i < _rects.size();) {
+					bool is_contained{ false };
+					for (u32 j{ 0 }; j < new_rects.size() && !is_contained; j++) is_contained = Contains(new_rects[j], _rects[i]);
+					if (is_contained) _rects.EraseUnordered(i);
+					else i++;
+				}
+
+				for (const Rect& rect : new_rects) _rects.emplace_back(rect);
+			}
+
+		private:
+			[[nodiscard]] static bool Intersects(const Rect& a, const Rect& b) {
+				return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+			}
+
+			[[nodiscard]] static bool Contains(const Rect& outer, const Rect& inner) {
+				return inner.x >= outer.x && inner.y >= outer.y &&
+					inner.x + inner.width <= outer.x + outer.width && inner.y + inner.height <= outer.y + outer.height;
+			}
+
+			util::vector<Rect> _rects;
+		};
+
+		// Cell sizes and offsets in texels, from the settings.
+		struct Grid {
+			u32 unit;		// cell alignment
+			u32 gutter;
+
+			[[nodiscard]] u32 CellUnits(u32 size) const { return (size + 2 * gutter + unit - 1) / unit; }
+		};
+
+		[[nodiscard]] Grid GetGrid(const Settings& settings) {
+			assert(settings.block_size && !(settings.block_size & (settings.block_size - 1)));
+			assert(settings.mip_levels && settings.mip_levels <= 14);
+			const u32 scale{ 1u << (settings.mip_levels - 1) };
+			return { settings.block_size * scale, settings.padding * scale };
+		}
+
+		// Places the images in 'order' that don't have a rect yet, biggest first.
+		[[nodiscard]] bool PlaceAll(const u32* const widths, const u32* const heights, util::vector<u32>& order,
+			const Grid& grid, FreeSpace& free_space, Layout& layout) {
+			std::sort(order.begin(), order.end(), [&](u32 a, u32 b) {
+				const u32 a_side{ std::max(grid.CellUnits(widths[a]), grid.CellUnits(heights[a])) };
+				const u32 b_side{ std::max(grid.CellUnits(widths[b]), grid.CellUnits(heights[b])) };
+				if (a_side != b_side) return a_side > b_side;
+				return grid.CellUnits(widths[a]) * grid.CellUnits(heights[a]) > grid.CellUnits(widths[b]) * grid.CellUnits(heights[b]);
+			});
+
+			for (const u32 i : order) {
+				Rect cell;
+				if (!free_space.Find(grid.CellUnits(widths[i]), grid.CellUnits(heights[i]), cell)) return false;
+				free_space.Place(cell);
+				layout.images[i] = { cell.x * grid.unit + grid.gutter, cell.y * grid.unit + grid.gutter, widths[i], heights[i] };
+			}
+
+			return true;
+		}
+
+		[[nodiscard]] Rect GetCell(const Rect& image, const Grid& grid) {
+			return { (image.x - grid.gutter) / grid.unit, (image.y - grid.gutter) / grid.unit, grid.CellUnits(image.width), grid.CellUnits(image.height) };
+		}
+	} // anonymous namespace
+
+	bool Pack(const u32* const widths, const u32* const heights, u32 count, const Settings& settings, Layout& layout) {
+		assert(widths && heights && count);
+		const Grid grid{ GetGrid(settings) };
+
+		u64 area{ 0 };
+		u32 width{ grid.unit };
+		u32 height{ grid.unit };
+		for (u32 i{ 0 }; i < count; i++) {
+			assert(widths[i] && heights[i]);
+			const u32 cell_width{ grid.CellUnits(widths[i]) * grid.unit };
+			const u32 cell_height{ grid.CellUnits(heights[i]) * grid.unit };
+			area += (u64)cell_width * cell_height;
+			while (width < cell_width) width <<= 1;
+			while (height < cell_height) height <<= 1;
+		}
+
+		// Grow the atlas one side at a time until everything fits, starting from where the area alone would fit.
+		auto grow = [&]() {
+			if (width <= height) width <<= 1;
+			else height <<= 1;
+		};
+		while ((u64)width * height < area) grow();
+
+		util::vector<u32> order(count);
+		for (; width <= settings.max_size && height <= settings.max_size; grow()) {
+			layout.width = width;
+			layout.height = height;
+			layout.images.clear();
+			layout.images.resize(count);
+			for (u32 i{ 0 }; i < count; i++) order[i] = i;
+
+			FreeSpace free_space{ width / grid.unit, height / grid.unit };
+			if (PlaceAll(widths, heights, order, grid, free_space, layout)) return true;
+		}
+
+		return false;
+	}
+
+	bool Update(const u32* const widths, const u32* const heights, u32 count, const Settings& settings, Layout& layout) {
+		assert(widths && heights && count);
+		if (!layout.width || !layout.height) return Pack(widths, heights, count, settings, layout);
+
+		const Grid grid{ GetGrid(settings) };
+		const u32 width_units{ layout.width / grid.unit };
+		const u32 height_units{ layout.height / grid.unit };
+		layout.images.resize(count);
+
+		util::vector<u32> kept;
+		util::vector<u32> changed;
+		for (u32 i{ 0 }; i < count; i++) {
+			Rect& image{ layout.images[i] };
+			const bool is_kept{ image.width == widths[i] && image.height == heights[i] &&
+				image.x >= grid.gutter && image.y >= grid.gutter && (image.x - grid.gutter) % grid.unit == 0 && (image.y - grid.gutter) % grid.unit == 0 };
+			const Rect cell{ is_kept ? GetCell(image, grid) : Rect{} };
+			if (is_kept && cell.x + cell.width <= width_units && cell.y + cell.height <= height_units) {
+				kept.emplace_back(i);
+			}
+			else {
+				image = {};
+				changed.emplace_back(i);
+			}
+		}
+
+		// Placing the kept cells in scan order keeps the free rectangles few while the free space is rebuilt.
+		std::sort(kept.begin(), kept.end(), [&](u32 a, u32 b) {
+			const Rect& ra{ layout.images[a] };
+			const Rect& rb{ layout.images[b] };
+			return ra.y != rb.y ? ra.y < rb.y : ra.x < rb.x;
+		});
+		FreeSpace free_space{ width_units, height_units };
+		for (const u32 i : kept) free_space.Place(GetCell(layout.images[i], grid));
+
+		if (PlaceAll(widths, heights, changed, grid, free_space, layout)) return true;
+		return Pack(widths, heights, count, settings, layout);
+	}
+
+	void Compose(const Layout& layout, const Settings& settings, const Image* const images, u32 count, util::vector<u8>& atlas) {
+		assert(images && count == layout.images.size());
+		const Grid grid{ GetGrid(settings) };
+		const u64 atlas_pitch{ (u64)layout.width * 4 };
+		atlas.clear();
+		atlas.resize(atlas_pitch * layout.height);
+
+		ParallelFor(count, [&](u32 i) {
+			const Image& image{ images[i] };
+			const Rect& rect{ layout.images[i] };
+			assert(image.pixels && image.width == rect.width && image.height == rect.height);
+			const Rect cell{ GetCell(rect, grid) };
+			const u32 cell_x{ cell.x * grid.unit };
+			const u32 cell_y{ cell.y * grid.unit };
+			const u32 cell_width{ std::min(cell.width * grid.unit, layout.width - cell_x) };
+			const u32 cell_height{ std::min(cell.height * grid.unit, layout.height - cell_y) };
+			const u32 left{ rect.x - cell_x };
+			const u32 right{ cell_width - left - rect.width };
+
+			// Gutters repeat the edge texels, so filtering across the edge of an image doesn't pick up its neighbors.
+			for (u32 y{ 0 }; y < cell_height; y++) {
+				const u32 source_y{ (u32)std::clamp((s32)y - (s32)(rect.y - cell_y), 0, (s32)image.height - 1) };
+				const u8* const source{ image.pixels + (u64)source_y * image.row_pitch };
+				u8* const row{ &atlas[(cell_y + y) * atlas_pitch + (u64)cell_x * 4] };
+				for (u32 x{ 0 }; x < left; x++) memcpy(row + x * 4, source, 4);
+				memcpy(row + left * 4, source, (u64)image.width * 4);
+				for (u32 x{ 0 }; x < right; x++) memcpy(row + (left + image.width + x) * 4, source + (image.width - 1) * 4, 4);
+			}
+		});
+	}
+
+	UVTransform GetUVTransform(const Layout& layout, u32 index) {
+		assert(index < layout.images.size() && layout.width && layout.height);
+		const Rect& image{ layout.images[index] };
+		const f32 inv_width{ 1.f / (f32)layout.width };
+		const f32 inv_height{ 1.f / (f32)layout.height };
+		return { image.width * inv_width, image.height * inv_height, image.x * inv_width, image.y * inv_height };
+	}
+
+	void RemapUVs(Math::v2* const uvs, u32 count, const UVTransform& transform) {
+		assert(uvs || !count);
+		for (u32 i{ 0 }; i < count; i++) {
+			uvs[i].x = uvs[i].x * transform.scale_u + transform.offset_u;
+			uvs[i].y = uvs[i].y * transform.scale_v + transform.offset_v;
+		}
+	}
+}
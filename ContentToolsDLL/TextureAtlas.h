@@ -0,0 +1,65 @@
+#pragma once
+#include "ToolsCommon.h"
+
+// Packs many small textures into one atlas with MaxRects (best short side fit), so decals and UI elements
+// share one texture instead of costing a descriptor and a bind each.
+//
+// Every image sits in a cell with a gutter of dilated edge texels around it. Cells start and end on multiples
+// of block_size << (mip_levels - 1) texels, so in every mip of the atlas a BC block only ever covers one image,
+// and the gutter is padding << (mip_levels - 1) texels wide, so the last mip still has 'padding' texels of it.
+// Layouts can be updated: images that kept their size keep their place and only the others are packed again.
+namespace Zetta::Tools::Atlas {
+	struct Rect {
+		u32 x;
+		u32 y;
+		u32 width;
+		u32 height;
+	};
+
+	struct Settings {
+		u32 max_size;		// largest width or height of the atlas
+		u32 padding;		// gutter texels around each image in the last mip
+		u32 mip_levels;		// mips that the atlas will have
+		u32 block_size;		// 4 for BC formats, 1 for uncompressed atlases
+	};
+
+	struct Layout {
+		u32 width;
+		u32 height;
+		util::vector<Rect> images;	// where each image is, indexed like the image sizes given to Pack()
+	};
+
+	// RGBA8 pixels with the row pitch in bytes.
+	struct Image {
+		const u8* pixels;
+		u32 width;
+		u32 height;
+		u32 row_pitch;
+	};
+
+	// Maps the UVs of an image to the atlas: atlas_uv = uv * scale + offset. Wrapped UVs can't be atlased.
+	struct UVTransform {
+		f32 scale_u;
+		f32 scale_v;
+		f32 offset_u;
+		f32 offset_v;
+	};
+
+	// Packs images of the given sizes into the smallest power of 2 atlas that fits them, starting from scratch.
+	// Returns false if they don't fit into max_size x max_size.
+	[[nodiscard]] bool Pack(const u32* const widths, const u32* const heights, u32 count, const Settings& settings, Layout& layout);
+
+	// Updates a layout that was packed with the same settings for the images that are still the same size and
+	// where they were. Images with an empty rect are new, the others keep their place if their size didn't
+	// change. Falls back to Pack() if the changed images don't fit into the free space.
+	[[nodiscard]] bool Update(const u32* const widths, const u32* const heights, u32 count, const Settings& settings, Layout& layout);
+
+	// Copies the images into RGBA8 atlas pixels of layout.width x layout.height and fills their gutters with
+	// their edge texels. 'atlas' is resized to fit.
+	void Compose(const Layout& layout, const Settings& settings, const Image* const images, u32 count, util::vector<u8>& atlas);
+
+	[[nodiscard]] UVTransform GetUVTransform(const Layout& layout, u32 index);
+
+	// Moves mesh UVs that sample one image into the part of the atlas it was packed to.
+	void RemapUVs(Math::v2* const uvs, u32 count, const UVTransform& transform);
+}
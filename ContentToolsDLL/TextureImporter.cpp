@@ -1,15 +1,25 @@
 #include "ToolsCommon.h"
 #include "Content/ContentToEngine.h"
+#include "Content/StreamableTexture.h"
 #include "Utilities/IOStream.h"
+#include "ImportCache.h"
+#include "BlockCompression.h"
+#include "MipGeneration.h"
+#include "TextureAnalysis.h"
+#include "TextureAtlas.h"
+#include "EnvironmentMap.h"
+#include "ImageDecoders.h"
 #include <DirectXTex.h>
 #include <dxgi1_6.h>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+#include <fstream>
 
 using namespace DirectX;
 using namespace Microsoft::WRL;
 
 namespace Zetta::Tools {
-	bool IsNormalMap(const Image* const image);
-
 	namespace {
 		struct ImportError {
 			enum ErrorCode : u32 {
@@ -45,6 +55,9 @@ namespace Zetta::Tools {
 			u32						prefer_bc7;
 			u32						output_format;
 			u32						compress;
+			u32						compression_quality;	// BC::Quality::Level. GPUs only tell Fast apart from the others, in BC7.
+			u32						mip_filter;				// Mips::Filter::Type
+			u32						preserve_alpha_coverage;	// keep the alpha test coverage of cutout textures in every mip
 		};
 
 		struct TextureInfo {
@@ -67,6 +80,65 @@ namespace Zetta::Tools {
 			TextureImportSettings	import_settings;
 		};
 
+		struct AtlasData {
+			Atlas::Rect*			images;			// per source. In: where it was in the previous atlas, or empty. Out: where it is.
+			Atlas::UVTransform*		uv_transforms;	// per source, out
+			u32						width;			// In: size of the previous atlas, or 0 to pack from scratch. Out: size of the atlas.
+			u32						height;
+			u32						max_size;
+			u32						padding;		// gutter texels around each image in the last mip
+		};
+
+		struct EnvironmentData {
+			Math::v3				irradiance[EnvironmentMap::sh_coefficient_count];	// out, see EnvironmentMap::IrradianceSH
+			u32						sample_count;	// GGX samples per texel of the specular mips, 0 for the default
+		};
+
+		struct DecompressRequest {
+			u32						mip;
+			u32						array_slice;	// or depth slice of volume maps, in 'mip'
+			u32						channel_mask;	// BC::Channel::Mask, 0 for all channels
+			u32						max_size;		// largest width and height of the result, 0 for the size of the mip
+		};
+
+		struct BatchStage {
+			enum Type : u32 {
+				Decode,		// cache lookup and loading the source images
+				Mip,		// analysis and mip generation
+				Compress,
+				Pack,		// copying the result to the texture data and the import cache
+
+				count
+			};
+		};
+
+		struct BatchImportSettings {
+			u64						memory_budget;		// bytes of images the pipeline holds before decoding waits, 0 for no limit
+			u32						thread_counts[BatchStage::count];	// 0 picks a default for the stage
+		};
+
+		struct BatchStageStats {
+			u32						items;
+			u32						threads;
+			f32						busy_seconds;		// summed over the threads of the stage
+			u64						bytes;				// bytes of images the stage produced
+		};
+
+		struct BatchImportStats {
+			BatchStageStats			stages[BatchStage::count];
+			f32						seconds;
+			u64						peak_memory;
+			u32						cache_hits;
+			u32						failed;
+		};
+
+		// Mips of atlases that don't ask for a mip count. Every mip doubles the gutters and the cell alignment.
+		constexpr u32 default_atlas_mip_levels{ 4 };
+
+		// Smallest specular mip of environment maps that don't ask for a mip count. Rougher mips would only blur
+		// what is already a blur, and 4x4 is one BC6H block per face.
+		constexpr u32 min_environment_mip_size{ 4 };
+
 		struct D3D11_Device {
 			ComPtr<ID3D11Device>	device;
 			std::mutex				hw_compression_mutex;
@@ -158,6 +230,29 @@ namespace Zetta::Tools {
 			return mip_levels;
 		}
 
+		[[nodiscard]] util::vector<u8> ReadFile(const char* file_name) {
+			util::vector<u8> file;
+			std::ifstream stream{ file_name, std::ios::in | std::ios::binary | std::ios::ate };
+			if (!stream) return file;
+
+			const u64 size{ (u64)stream.tellg() };
+			file.resize(size);
+			stream.seekg(0);
+			if (!stream.read((char*)file.data(), (std::streamsize)size)) file.clear();
+			return file;
+		}
+
+		[[nodiscard]] DXGI_FORMAT GetDecoderFormat(const ImageDecoder::ImageInfo& info, bool ignore_srgb) {
+			switch (info.pixel_format) {
+			case ImageDecoder::PixelFormat::R8_UNorm: return DXGI_FORMAT_R8_UNORM;
+			case ImageDecoder::PixelFormat::RGBA8_UNorm: return info.is_srgb && !ignore_srgb ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+			case ImageDecoder::PixelFormat::RGBA16_UNorm: return DXGI_FORMAT_R16G16B16A16_UNORM;
+			case ImageDecoder::PixelFormat::RGBA32_Float: return DXGI_FORMAT_R32G32B32A32_FLOAT;
+			}
+			assert(false);
+			return DXGI_FORMAT_UNKNOWN;
+		}
+
 		[[nodiscard]] ScratchImage LoadFromFile(TextureData* const data, const char* file_name) {
 			using namespace Zetta::Content;
 
@@ -169,33 +264,40 @@ namespace Zetta::Tools {
 
 			data->info.import_error = ImportError::Load;
 
-			WIC_FLAGS wic_flags{ WIC_FLAGS_NONE };
-			TGA_FLAGS tga_flags{ TGA_FLAGS_NONE };
-
-			if (data->import_settings.output_format == DXGI_FORMAT_BC4_UNORM ||
-				data->import_settings.output_format == DXGI_FORMAT_BC5_UNORM) {
-				wic_flags |= WIC_FLAGS_IGNORE_SRGB;
-				tga_flags |= TGA_FLAGS_IGNORE_SRGB;
-			}
+			const bool ignore_srgb{ data->import_settings.output_format == DXGI_FORMAT_BC4_UNORM ||
+				data->import_settings.output_format == DXGI_FORMAT_BC5_UNORM };
 
-			const std::wstring wfile{ ToWString(file_name) };
-			const wchar_t* const file{ wfile.c_str() };
+			util::vector<u8> file{ ReadFile(file_name) };
+			const ImageDecoder::FileFormat::Type file_format{ ImageDecoder::DetectFormat(file.data(), file.size()) };
 			ScratchImage scratch;
 
-			wic_flags |= WIC_FLAGS_FORCE_RGB;
-			HRESULT hr{ LoadFromWICFile(file, wic_flags, nullptr, scratch) };
-
-			// File wasn't WIC format. Attempting TGA.
-			if (FAILED(hr)) hr = LoadFromTGAFile(file, tga_flags, nullptr, scratch);
+			// The file format is told from its first bytes, so there's one decoder to try. Our own decoders write
+			// straight into the scratch image. Variants they don't take go to the DirectXTex loader of the format.
+			ImageDecoder::ImageInfo image_info;
+			if (ImageDecoder::ReadInfo(file.data(), file.size(), image_info)) {
+				const DXGI_FORMAT format{ GetDecoderFormat(image_info, ignore_srgb) };
+				if (SUCCEEDED(scratch.Initialize2D(format, image_info.width, image_info.height, 1, 1))) {
+					const Image& image{ *scratch.GetImage(0, 0, 0) };
+					if (ImageDecoder::Decode(file.data(), file.size(), image_info, image.pixels, (u32)image.rowPitch)) {
+						if (file_format == ImageDecoder::FileFormat::HDR) data->info.flags |= TextureFlags::IS_HDR;
+						data->info.import_error = ImportError::Success;
+						return scratch;
+					}
+				}
+				scratch.Release();
+			}
 
-			// File Wasn't TGA or WIC format. Attempting HDR.
-			if (FAILED(hr)) {
-				hr = LoadFromHDRFile(file, nullptr, scratch);
+			HRESULT hr{ E_FAIL };
+			switch (file_format) {
+			case ImageDecoder::FileFormat::TGA:
+				hr = LoadFromTGAMemory(file.data(), file.size(), ignore_srgb ? TGA_FLAGS_IGNORE_SRGB : TGA_FLAGS_NONE, nullptr, scratch);
+				break;
+			case ImageDecoder::FileFormat::HDR:
+				hr = LoadFromHDRMemory(file.data(), file.size(), nullptr, scratch);
 				if (SUCCEEDED(hr)) data->info.flags |= TextureFlags::IS_HDR;
-			}
-			// File wasn't any of the above formats. Try DDS
-			if (FAILED(hr)) {
-				hr = LoadFromDDSFile(file, DDS_FLAGS_FORCE_RGB, nullptr, scratch);
+				break;
+			case ImageDecoder::FileFormat::DDS:
+				hr = LoadFromDDSMemory(file.data(), file.size(), DDS_FLAGS_FORCE_RGB, nullptr, scratch);
 				if (SUCCEEDED(hr)) {
 					data->info.import_error = ImportError::Decompress;
 					ScratchImage mip_scratch;
@@ -204,6 +306,14 @@ namespace Zetta::Tools {
 						scratch = std::move(mip_scratch);
 					}
 				}
+				break;
+			default: {
+				// PNGs we don't decode and everything else: JPEG, BMP, TIFF...
+				WIC_FLAGS wic_flags{ WIC_FLAGS_FORCE_RGB };
+				if (ignore_srgb) wic_flags |= WIC_FLAGS_IGNORE_SRGB;
+				hr = LoadFromWICMemory(file.data(), file.size(), wic_flags, nullptr, scratch);
+				break;
+			}
 			}
 
 			if (SUCCEEDED(hr)) data->info.import_error = ImportError::Success;
@@ -211,7 +321,71 @@ namespace Zetta::Tools {
 			return scratch;
 		}
 
-		[[nodiscard]] ScratchImage InitializeFromImages(TextureData* const data, const util::vector<Image>& images) {
+		// Pixel formats our mip generator takes. Anything else is left to DirectXTex.
+		[[nodiscard]] bool GetMipPixelFormat(DXGI_FORMAT format, Mips::PixelFormat& pixel_format) {
+			using namespace Mips;
+			switch (format) {
+			case DXGI_FORMAT_R8G8B8A8_UNORM:
+			case DXGI_FORMAT_B8G8R8A8_UNORM: pixel_format = { PixelType::UNorm8, 4, false }; return true;
+			case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+			case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB: pixel_format = { PixelType::UNorm8, 4, true }; return true;
+			case DXGI_FORMAT_R8G8_UNORM: pixel_format = { PixelType::UNorm8, 2, false }; return true;
+			case DXGI_FORMAT_R8_UNORM: pixel_format = { PixelType::UNorm8, 1, false }; return true;
+			case DXGI_FORMAT_R16G16B16A16_UNORM: pixel_format = { PixelType::UNorm16, 4, false }; return true;
+			case DXGI_FORMAT_R16G16_UNORM: pixel_format = { PixelType::UNorm16, 2, false }; return true;
+			case DXGI_FORMAT_R16_UNORM: pixel_format = { PixelType::UNorm16, 1, false }; return true;
+			case DXGI_FORMAT_R16G16B16A16_FLOAT: pixel_format = { PixelType::Float16, 4, false }; return true;
+			case DXGI_FORMAT_R16G16_FLOAT: pixel_format = { PixelType::Float16, 2, false }; return true;
+			case DXGI_FORMAT_R16_FLOAT: pixel_format = { PixelType::Float16, 1, false }; return true;
+			case DXGI_FORMAT_R32G32B32A32_FLOAT: pixel_format = { PixelType::Float32, 4, false }; return true;
+			case DXGI_FORMAT_R32G32_FLOAT: pixel_format = { PixelType::Float32, 2, false }; return true;
+			case DXGI_FORMAT_R32_FLOAT: pixel_format = { PixelType::Float32, 1, false }; return true;
+			}
+			return false;
+		}
+
+		// Mips of 1D, 2D and cube textures. Unlike DirectXTex's default filter, ours filters sRGB in linear space,
+		// keeps normal maps at unit length and keeps the alpha test coverage of cutout textures.
+		// Statistics are null for source formats that TextureAnalysis doesn't support.
+		[[nodiscard]] HRESULT GenerateMips(const TextureData* const data, const ScratchImage& scratch, const TextureStatistics* const statistics,
+			const Mips::PixelFormat& pixel_format, u32 mip_levels, ScratchImage& mip_scratch) {
+			const TextureImportSettings& settings{ data->import_settings };
+			TexMetadata metadata{ scratch.GetMetadata() };
+			metadata.mipLevels = mip_levels;
+			HRESULT hr{ mip_scratch.Initialize(metadata) };
+			if (FAILED(hr)) return hr;
+
+			// NOTE: The normal map test matches DetermineOutputFormat(), which runs after the mips are made.
+			const Image& first_image{ *scratch.GetImage(0, 0, 0) };
+			const DXGI_FORMAT output_format{ (DXGI_FORMAT)settings.output_format };
+			Mips::Settings mip_settings{};
+			mip_settings.filter = (Mips::Filter::Type)std::min(settings.mip_filter, (u32)Mips::Filter::count - 1);
+			mip_settings.is_normal_map = output_format == DXGI_FORMAT_BC5_UNORM ||
+				(output_format == DXGI_FORMAT_UNKNOWN && !(data->info.flags & Content::TextureFlags::IS_HDR) && statistics && statistics->is_normal_map);
+
+			if (settings.preserve_alpha_coverage && !mip_settings.is_normal_map) {
+				const Mips::MipImage image{ first_image.pixels, (u32)first_image.width, (u32)first_image.height, (u32)first_image.rowPitch };
+				const bool is_cutout{ statistics ? statistics->is_cutout : Mips::IsCutout(image, pixel_format, settings.alpha_threshold) };
+				if (is_cutout) mip_settings.alpha_coverage_reference = settings.alpha_threshold;
+			}
+
+			util::vector<Mips::MipImage> mips(mip_levels);
+			for (u32 item{ 0 }; item < metadata.arraySize; item++) {
+				for (u32 mip{ 0 }; mip < mip_levels; mip++) {
+					const Image& image{ *mip_scratch.GetImage(mip, item, 0) };
+					mips[mip] = { image.pixels, (u32)image.width, (u32)image.height, (u32)image.rowPitch };
+				}
+
+				const Image& source{ *scratch.GetImage(0, item, 0) };
+				assert(source.rowPitch == mips[0].row_pitch);
+				memcpy(mips[0].pixels, source.pixels, source.slicePitch);
+				Mips::Generate(mips.data(), mip_levels, pixel_format, mip_settings);
+			}
+
+			return S_OK;
+		}
+
+		[[nodiscard]] ScratchImage InitializeFromImages(TextureData* const data, const util::vector<Image>& images, const TextureStatistics* const statistics) {
 			assert(data);
 			const TextureImportSettings& settings{ data->import_settings };
 
@@ -253,13 +427,17 @@ namespace Zetta::Tools {
 				const TexMetadata& metadata{ scratch.GetMetadata() };
 				u32 mip_levels{ Math::clamp(settings.mip_levels, (u32)0, GetMaxMipCount((u32)metadata.width, (u32)metadata.height, (u32)metadata.depth)) };
 
-				if (settings.dimension != TextureDimension::Texture3D) {
-					hr = GenerateMipMaps(scratch.GetImages(), scratch.GetImageCount(), scratch.GetMetadata(),
+				Mips::PixelFormat pixel_format{};
+				if (settings.dimension == TextureDimension::Texture3D) {
+					hr = GenerateMipMaps3D(scratch.GetImages(), scratch.GetImageCount(), scratch.GetMetadata(),
 						TEX_FILTER_DEFAULT, mip_levels, mip_scratch);
 				}
-
+				else if (GetMipPixelFormat(metadata.format, pixel_format)) {
+					if (!mip_levels) mip_levels = GetMaxMipCount((u32)metadata.width, (u32)metadata.height, 1);
+					hr = GenerateMips(data, scratch, statistics, pixel_format, mip_levels, mip_scratch);
+				}
 				else {
-					hr = GenerateMipMaps3D(scratch.GetImages(), scratch.GetImageCount(), scratch.GetMetadata(),
+					hr = GenerateMipMaps(scratch.GetImages(), scratch.GetImageCount(), scratch.GetMetadata(),
 						TEX_FILTER_DEFAULT, mip_levels, mip_scratch);
 				}
 
@@ -345,7 +523,10 @@ namespace Zetta::Tools {
 			SetOrClearFlag(info.flags, TextureFlags::IS_SRGB, IsSRGB(format));
 		}
 
-		DXGI_FORMAT DetermineOutputFormat(TextureData *const data, ScratchImage& scratch, const Image* const image) {
+		// Without statistics, nothing is taken for a normal map and the scratch is searched for alpha.
+		// NOTE: Gray RGB images keep a color format. Shader resource views use the default component mapping,
+		//		 so BC4 would sample as red.
+		DXGI_FORMAT DetermineOutputFormat(TextureData *const data, ScratchImage& scratch, const Image* const image, const TextureStatistics* const statistics) {
 			assert(data && data->import_settings.compress);
 			using namespace Zetta::Content;
 			const DXGI_FORMAT image_format{ image->format };
@@ -354,13 +535,16 @@ namespace Zetta::Tools {
 			if (output_format != DXGI_FORMAT_UNKNOWN) goto _done;
 			if ((data->info.flags & TextureFlags::IS_HDR) || image_format == DXGI_FORMAT_BC6H_UF16 || image_format == DXGI_FORMAT_BC6H_SF16) output_format = DXGI_FORMAT_BC6H_UF16;
 			else if (image_format == DXGI_FORMAT_R8_UNORM || image_format == DXGI_FORMAT_BC4_UNORM || image_format == DXGI_FORMAT_BC4_SNORM) output_format = DXGI_FORMAT_BC4_UNORM;
-			else if (IsNormalMap(image) || image_format == DXGI_FORMAT_BC5_UNORM || image_format == DXGI_FORMAT_BC5_SNORM) {
+			else if ((statistics && statistics->is_normal_map) || image_format == DXGI_FORMAT_BC5_UNORM || image_format == DXGI_FORMAT_BC5_SNORM) {
 				data->info.flags |= TextureFlags::IS_IMPORTED_AS_NORMAL_MAP;
 				output_format = DXGI_FORMAT_BC5_UNORM;
 				if (IsSRGB(image_format)) scratch.OverrideFormat(MakeTypelessUNORM(MakeTypeless(image_format)));
 			}
-			else output_format = data->import_settings.prefer_bc7 ? DXGI_FORMAT_BC7_UNORM : 
-				scratch.IsAlphaAllOpaque() ? DXGI_FORMAT_BC1_UNORM : DXGI_FORMAT_BC3_UNORM;
+			else {
+				const bool is_opaque{ statistics ? statistics->is_opaque : scratch.IsAlphaAllOpaque() };
+				output_format = data->import_settings.prefer_bc7 ? DXGI_FORMAT_BC7_UNORM :
+					is_opaque ? DXGI_FORMAT_BC1_UNORM : DXGI_FORMAT_BC3_UNORM;
+			}
 
 		_done:
 			assert(IsCompressed(output_format));
@@ -371,6 +555,77 @@ namespace Zetta::Tools {
 
 
 
+		// BC1, BC3, BC4, BC5 and BC7 are compressed by our own block encoder, which needs neither DirectXTex nor a GPU.
+		[[nodiscard]] bool GetBlockFormat(DXGI_FORMAT format, BC::Format::Type& bc_format) {
+			switch (format) {
+			case DXGI_FORMAT_BC1_UNORM:
+			case DXGI_FORMAT_BC1_UNORM_SRGB: bc_format = BC::Format::BC1; return true;
+			case DXGI_FORMAT_BC3_UNORM:
+			case DXGI_FORMAT_BC3_UNORM_SRGB: bc_format = BC::Format::BC3; return true;
+			case DXGI_FORMAT_BC4_UNORM: bc_format = BC::Format::BC4; return true;
+			case DXGI_FORMAT_BC5_UNORM: bc_format = BC::Format::BC5; return true;
+			case DXGI_FORMAT_BC7_UNORM:
+			case DXGI_FORMAT_BC7_UNORM_SRGB: bc_format = BC::Format::BC7; return true;
+			}
+			return false;
+		}
+
+		[[nodiscard]] constexpr bool IsBC6H(DXGI_FORMAT format) {
+			return format == DXGI_FORMAT_BC6H_UF16 || format == DXGI_FORMAT_BC6H_SF16;
+		}
+
+		[[nodiscard]] BC::Quality::Level GetCompressionQuality(const TextureData* const data) {
+			return (BC::Quality::Level)std::min(data->import_settings.compression_quality, (u32)BC::Quality::High);
+		}
+
+		// The block encoder takes 8-bit RGBA, or half precision RGBA for BC6H. Blocks are encoded in the color space
+		// of the output format.
+		HRESULT ConvertForBlockEncoder(const ScratchImage& scratch, DXGI_FORMAT output_format, ScratchImage& converted, const ScratchImage*& source) {
+			const DXGI_FORMAT format{ IsBC6H(output_format) ? DXGI_FORMAT_R16G16B16A16_FLOAT :
+				IsSRGB(output_format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM };
+			source = &scratch;
+			if (scratch.GetMetadata().format == format) return S_OK;
+
+			const HRESULT hr{ Convert(scratch.GetImages(), scratch.GetImageCount(), scratch.GetMetadata(), format,
+				TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT, converted) };
+			if (SUCCEEDED(hr)) source = &converted;
+			return hr;
+		}
+
+		void CompressBlocks(const TextureData* const data, const Image& image, DXGI_FORMAT output_format, const Image& bc_image) {
+			const BC::Quality::Level quality{ GetCompressionQuality(data) };
+			if (IsBC6H(output_format)) {
+				BC::CompressBC6H((const u16*)image.pixels, (u32)image.width, (u32)image.height, (u32)image.rowPitch,
+					output_format == DXGI_FORMAT_BC6H_SF16, quality, bc_image.pixels, (u32)bc_image.rowPitch);
+				return;
+			}
+
+			[[maybe_unused]] BC::Format::Type bc_format{};
+			[[maybe_unused]] const bool is_block_format{ GetBlockFormat(output_format, bc_format) };
+			assert(is_block_format);
+			BC::Compress(image.pixels, (u32)image.width, (u32)image.height, (u32)image.rowPitch, bc_format, quality,
+				data->import_settings.alpha_threshold, bc_image.pixels, (u32)bc_image.rowPitch);
+		}
+
+		HRESULT CompressBlocks(const TextureData* const data, const ScratchImage& scratch, DXGI_FORMAT output_format, ScratchImage& bc_scratch) {
+			ScratchImage converted;
+			const ScratchImage* source;
+			HRESULT hr{ ConvertForBlockEncoder(scratch, output_format, converted, source) };
+			if (FAILED(hr)) return hr;
+
+			TexMetadata metadata{ source->GetMetadata() };
+			metadata.format = output_format;
+			hr = bc_scratch.Initialize(metadata);
+			if (FAILED(hr)) return hr;
+
+			assert(source->GetImageCount() == bc_scratch.GetImageCount());
+			for (u32 i{ 0 }; i < bc_scratch.GetImageCount(); i++) {
+				CompressBlocks(data, source->GetImages()[i], output_format, bc_scratch.GetImages()[i]);
+			}
+
+			return S_OK;
+		}
+
 		bool CanUseGPU(DXGI_FORMAT format) {
 			switch (format) {
 			case DXGI_FORMAT_BC6H_TYPELESS:
@@ -392,7 +647,55 @@ namespace Zetta::Tools {
 			return false;
 		}
 
-		[[nodiscard]] ScratchImage CompressImage(TextureData* const data, ScratchImage& scratch) {
+		// BC6H and BC7 images are shared between every idle GPU and the CPU: each takes the next image that nobody
+		// has started on until all are done. GPUs that are busy with another import aren't waited for, and an image
+		// that a GPU fails to compress is compressed on the CPU instead.
+		HRESULT CompressBlocksWithGPUs(const TextureData* const data, const ScratchImage& scratch, DXGI_FORMAT output_format, ScratchImage& bc_scratch) {
+			ScratchImage converted;
+			const ScratchImage* source;
+			HRESULT hr{ ConvertForBlockEncoder(scratch, output_format, converted, source) };
+			if (FAILED(hr)) return hr;
+
+			TexMetadata metadata{ scratch.GetMetadata() };
+			metadata.format = output_format;
+			hr = bc_scratch.Initialize(metadata);
+			if (FAILED(hr)) return hr;
+
+			const u32 image_count{ (u32)bc_scratch.GetImageCount() };
+			assert(scratch.GetImageCount() == image_count && source->GetImageCount() == image_count);
+			const TEX_COMPRESS_FLAGS gpu_flags{ GetCompressionQuality(data) == BC::Quality::Fast ? TEX_COMPRESS_BC7_QUICK : TEX_COMPRESS_DEFAULT };
+			std::atomic<u32> next_image{ 0 };
+			util::vector<std::thread> gpu_threads;
+			for (u32 i{ 0 }; i < d3d11_devices.size(); i++) {
+				// NOTE: the device is locked and unlocked on its own thread, a mutex can't be unlocked by another one.
+				gpu_threads.emplace_back([&, i] {
+					std::unique_lock lock{ d3d11_devices[i].hw_compression_mutex, std::try_to_lock };
+					if (!lock.owns_lock()) return;
+
+					for (u32 index{ next_image++ }; index < image_count; index = next_image++) {
+						ScratchImage compressed;
+						const Image& bc_image{ bc_scratch.GetImages()[index] };
+						if (SUCCEEDED(Compress(d3d11_devices[i].device.Get(), scratch.GetImages()[index], output_format, gpu_flags, 1.0f, compressed))) {
+							const Image& image{ *compressed.GetImage(0, 0, 0) };
+							const u64 row_size{ std::min(image.rowPitch, bc_image.rowPitch) };
+							for (u32 row{ 0 }; row < (bc_image.height + 3) / 4; row++) {
+								memcpy(bc_image.pixels + row * bc_image.rowPitch, image.pixels + row * image.rowPitch, row_size);
+							}
+						}
+						else CompressBlocks(data, source->GetImages()[index], output_format, bc_image);
+					}
+				});
+			}
+
+			for (u32 index{ next_image++ }; index < image_count; index = next_image++) {
+				CompressBlocks(data, source->GetImages()[index], output_format, bc_scratch.GetImages()[index]);
+			}
+
+			for (std::thread& thread : gpu_threads) thread.join();
+			return S_OK;
+		}
+
+		[[nodiscard]] ScratchImage CompressImage(TextureData* const data, ScratchImage& scratch, const TextureStatistics* const statistics) {
 			assert(data && data->import_settings.compress && scratch.GetImages());
 
 			const Image* const image{ scratch.GetImage(0, 0, 0) };
@@ -401,24 +704,12 @@ namespace Zetta::Tools {
 				return {};
 			}
 
-			const DXGI_FORMAT output_format{ DetermineOutputFormat(data, scratch, image) };
+			const DXGI_FORMAT output_format{ DetermineOutputFormat(data, scratch, image, statistics) };
 			HRESULT hr{ S_OK };
 			ScratchImage bc_scratch;
-			if (CanUseGPU(output_format)) {
-				bool wait{ true };
-				while (wait) {
-					for (u32 i{ 0 }; i < d3d11_devices.size(); i++) {
-						if (d3d11_devices[i].hw_compression_mutex.try_lock()) {
-							hr = Compress(d3d11_devices[i].device.Get(), scratch.GetImages(), scratch.GetImageCount(),
-										  scratch.GetMetadata(), output_format, TEX_COMPRESS_DEFAULT, 1.0f, bc_scratch);
-							d3d11_devices[i].hw_compression_mutex.unlock();
-							wait = false;
-							break;
-						}
-					}
-					if (wait) std::this_thread::sleep_for(std::chrono::milliseconds(250));
-				}
-			}
+			BC::Format::Type bc_format;
+			if (CanUseGPU(output_format)) hr = CompressBlocksWithGPUs(data, scratch, output_format, bc_scratch);
+			else if (IsBC6H(output_format) || GetBlockFormat(output_format, bc_format)) hr = CompressBlocks(data, scratch, output_format, bc_scratch);
 			else hr = Compress(scratch.GetImages(), scratch.GetImageCount(), scratch.GetMetadata(),
 					output_format, TEX_COMPRESS_PARALLEL, data->import_settings.alpha_threshold, bc_scratch);
 
@@ -468,6 +759,322 @@ namespace Zetta::Tools {
 
 			return images;
 		}
+
+		// The key covers every setting that changes the imported data. Source paths are left out
+		// on purpose, so moved or renamed files with the same contents still hit the cache.
+		bool TextureCacheKey(const TextureImportSettings& settings, const util::vector<std::string>& files, ImportCache::Key& key) {
+			ImportCache::Hasher hasher{};
+			hasher.Update(ImportCache::tool_version);
+			hasher.Update(Content::AssetType::Texture);
+			hasher.Update(settings.source_count);
+			hasher.Update(settings.dimension);
+			hasher.Update(settings.mip_levels);
+			hasher.Update(settings.alpha_threshold);
+			hasher.Update(settings.prefer_bc7);
+			hasher.Update(settings.output_format);
+			hasher.Update(settings.compress);
+			hasher.Update(settings.compression_quality);
+			hasher.Update(settings.mip_filter);
+			hasher.Update(settings.preserve_alpha_coverage);
+			for (const std::string& file : files) {
+				if (!hasher.UpdateFromFile(file.c_str())) return false;
+			}
+
+			key = hasher.Finalize();
+			return true;
+		}
+
+		// Cache payload layout:
+		// TextureInfo info, u32 subresource_size, u8 subresource_data[subresource_size], u32 icon_size, u8 icon[icon_size]
+		bool LoadCachedTexture(const ImportCache::Key& key, TextureData* const data) {
+			util::vector<u8> payload;
+			if (!ImportCache::Lookup(key, payload)) return false;
+
+			util::BlobStreamReader blob{ payload.data() };
+			blob.read((u8*)&data->info, sizeof(TextureInfo));
+
+			data->subresource_size = blob.read<u32>();
+			data->subresource_data = (u8* const)CoTaskMemRealloc(data->subresource_data, data->subresource_size);
+			assert(data->subresource_data);
+			blob.read(data->subresource_data, data->subresource_size);
+
+			data->icon_size = blob.read<u32>();
+			if (data->icon_size) {
+				data->icon = (u8* const)CoTaskMemRealloc(data->icon, data->icon_size);
+				assert(data->icon);
+				blob.read(data->icon, data->icon_size);
+			}
+
+			assert(blob.Position() == payload.data() + payload.size());
+			return true;
+		}
+
+		void StoreCachedTexture(const ImportCache::Key& key, const TextureData* const data) {
+			const u32 icon_size{ data->icon ? data->icon_size : 0 };
+			util::vector<u8> payload(sizeof(TextureInfo) + sizeof(u32) + data->subresource_size + sizeof(u32) + icon_size);
+			util::BlobStreamWriter blob{ payload.data(), payload.size() };
+			blob.write((const u8*)&data->info, sizeof(TextureInfo));
+			blob.write(data->subresource_size);
+			blob.write(data->subresource_data, data->subresource_size);
+			blob.write(icon_size);
+			if (icon_size) blob.write(data->icon, icon_size);
+
+			ImportCache::Store(key, payload.data(), payload.size());
+		}
+
+		// Loads every source image of the texture and checks that they have the same size and format.
+		// 'images' points into 'scratch_images'.
+		[[nodiscard]] bool LoadSources(TextureData* const data, const util::vector<std::string>& files,
+			util::vector<ScratchImage>& scratch_images, util::vector<Image>& images) {
+			u32 width{ 0 };
+			u32 height{ 0 };
+			DXGI_FORMAT format{};
+
+			for (u32 i{ 0 }; i < files.size(); i++) {
+				scratch_images.emplace_back(LoadFromFile(data, files[i].c_str()));
+				if (data->info.import_error) return false;
+
+				const ScratchImage& scratch{ scratch_images.back() };
+				const TexMetadata& metadata{ scratch.GetMetadata() };
+
+				if (i == 0) {
+					width = (u32)metadata.width;
+					height = (u32)metadata.height;
+					format = metadata.format;
+				}
+
+				if (width != metadata.width || height != metadata.height) {
+					data->info.import_error = ImportError::SizeMismatch;
+					return false;
+				}
+
+				if (format != metadata.format) {
+					data->info.import_error = ImportError::FormatMismatch;
+					return false;
+				}
+
+				const u32 array_size{ (u32)metadata.arraySize };
+				const u32 depth{ (u32)metadata.depth };
+
+				for (u32 array_index{ 0 }; array_index < array_size; array_index++) {
+					for (u32 depth_index{ 0 }; depth_index < depth; depth_index++) {
+						const Image* image{ scratch.GetImage(0, array_index, depth_index) };
+						assert(image);
+						if (!image) {
+							data->info.import_error = ImportError::Unknown;
+							return false;
+						}
+
+						if (width != image->width || height != image->height) {
+							data->info.import_error = ImportError::SizeMismatch;
+							return false;
+						}
+
+						images.emplace_back(*image);
+					}
+				}
+			}
+
+			return true;
+		}
+
+		// Analyzes the source images and adds mips to them.
+		[[nodiscard]] ScratchImage GenerateMipChain(TextureData* const data, const util::vector<Image>& images,
+			TextureStatistics& statistics, bool& has_statistics) {
+			// NOTE: One pass over the source images answers every question about their contents, before mips are added.
+			has_statistics = AnalyzeImages(images.data(), (u32)images.size(), data->import_settings.alpha_threshold, statistics);
+			return InitializeFromImages(data, images, has_statistics ? &statistics : nullptr);
+		}
+
+		// Compresses the mip chain in place if the settings ask for it.
+		void CompressMipChain(TextureData* const data, ScratchImage& scratch, const TextureStatistics* const statistics) {
+			if (!data->import_settings.compress) return;
+
+			// NOTE: Copy the first uncompressed image for the editor to generate an icon.
+			//		 Only do this for compressed imports. if not compressed, the editor
+			//		 Will pick the first image from the returned subresources.
+
+			ScratchImage bc_scratch{ CompressImage(data, scratch, statistics) };
+			if (data->info.import_error) return;
+
+			assert(bc_scratch.GetImages());
+			CopyIcon(bc_scratch.GetImages()[0], data);
+
+			scratch = std::move(bc_scratch);
+		}
+
+		// Adds mips to the source images and compresses them as the settings ask, then hands the result to the editor.
+		void ProcessImages(TextureData* const data, const util::vector<Image>& images) {
+			TextureStatistics statistics{};
+			bool has_statistics{ false };
+			ScratchImage scratch{ GenerateMipChain(data, images, statistics, has_statistics) };
+			if (data->info.import_error) return;
+
+			CompressMipChain(data, scratch, has_statistics ? &statistics : nullptr);
+			if (data->info.import_error) return;
+
+			CopySubresources(scratch, data);
+			TextureInfoFromMetadata(scratch.GetMetadata(), data->info);
+		}
+
+		// Imports many textures at once. Every stage has its own threads and a queue of textures that wait for it,
+		// so one texture can be decoded while another is compressed. Decoding only starts while the images held by
+		// the pipeline are within the budget, so memory stays under the budget plus one texture per decode thread.
+		// NOTE: mip generation and block compression already spread each texture over the shared worker pool, so
+		//		 their stages need few threads. Decoding is mostly single-threaded file reading and decompression.
+		class BatchImport {
+		public:
+			BatchImport(TextureData* const* const textures, u32 count, const BatchImportSettings& settings, Progression* const progression)
+				: _items(count), _budget{ settings.memory_budget ? settings.memory_budget : ~0ull }, _remaining{ count }, _progression{ progression } {
+				for (u32 i{ 0 }; i < count; i++) _items[i].data = textures[i];
+
+				const u32 core_count{ std::max(std::thread::hardware_concurrency(), 1u) };
+				constexpr u32 default_thread_counts[BatchStage::count]{ 4, 2, 2, 1 };
+				for (u32 i{ 0 }; i < BatchStage::count; i++) {
+					_stats.stages[i].threads = std::min(settings.thread_counts[i] ? settings.thread_counts[i] : default_thread_counts[i], core_count);
+				}
+			}
+
+			void Run(BatchImportStats& stats) {
+				const auto start{ std::chrono::steady_clock::now() };
+				if (_progression) _progression->Callback(0, (u32)_items.size());
+
+				u32 thread_count{ 0 };
+				for (const BatchStageStats& stage : _stats.stages) thread_count += stage.threads;
+				std::unique_ptr<std::thread[]> threads{ std::make_unique<std::thread[]>(thread_count) };
+				for (u32 stage{ 0 }, i{ 0 }; stage < BatchStage::count; stage++) {
+					for (u32 j{ 0 }; j < _stats.stages[stage].threads; j++) threads[i++] = std::thread{ [this, stage] { Work((BatchStage::Type)stage); } };
+				}
+				for (u32 i{ 0 }; i < thread_count; i++) threads[i].join();
+
+				_stats.seconds = std::chrono::duration<f32>(std::chrono::steady_clock::now() - start).count();
+				stats = _stats;
+			}
+
+		private:
+			struct Item {
+				TextureData*				data{ nullptr };
+				ImportCache::Key			key{};
+				bool						use_cache{ false };
+				util::vector<ScratchImage>	sources;
+				util::vector<Image>			images;
+				TextureStatistics			statistics{};
+				bool						has_statistics{ false };
+				ScratchImage				scratch;
+				u64							memory{ 0 };	// bytes of images the item holds
+			};
+
+			[[nodiscard]] static u64 ImageBytes(const Item& item) {
+				u64 bytes{ item.scratch.GetPixelsSize() };
+				for (const ScratchImage& source : item.sources) bytes += source.GetPixelsSize();
+				return bytes;
+			}
+
+			void Work(BatchStage::Type stage) {
+				// WIC needs COM on every thread that decodes.
+				const bool uninitialize{ stage == BatchStage::Decode && SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED)) };
+
+				for (;;) {
+					u32 index;
+					{
+						std::unique_lock lock{ _mutex };
+						if (stage == BatchStage::Decode) {
+							_condition.wait(lock, [this] { return _next_decode == _items.size() || _memory < _budget || !_memory; });
+							if (_next_decode == _items.size()) break;
+							index = _next_decode++;
+						}
+						else {
+							_condition.wait(lock, [this, stage] { return !_queues[stage].empty() || !_remaining; });
+							if (_queues[stage].empty()) break;
+							index = _queues[stage].front();
+							_queues[stage].pop_front();
+						}
+					}
+
+					Item& item{ _items[index] };
+					const auto start{ std::chrono::steady_clock::now() };
+					const bool is_done{ Process(stage, item) };
+					if (is_done) {
+						item.images.clear();
+						item.sources.clear();
+						item.scratch.Release();
+					}
+					const u64 memory{ is_done ? 0 : ImageBytes(item) };
+					const f32 seconds{ std::chrono::duration<f32>(std::chrono::steady_clock::now() - start).count() };
+
+					std::lock_guard lock{ _mutex };
+					BatchStageStats& stats{ _stats.stages[stage] };
+					stats.items++;
+					stats.busy_seconds += seconds;
+					stats.bytes += stage == BatchStage::Pack ? item.data->subresource_size : memory;
+					_memory = _memory + memory - item.memory;
+					_stats.peak_memory = std::max(_stats.peak_memory, _memory);
+					item.memory = memory;
+
+					if (is_done) {
+						_stats.failed += item.data->info.import_error ? 1 : 0;
+						_remaining--;
+						if (_progression) _progression->Increment();
+					}
+					else {
+						_queues[stage + 1].emplace_back(index);
+					}
+					_condition.notify_all();
+				}
+
+				if (uninitialize) CoUninitialize();
+			}
+
+			// Returns true when the item is done: imported, found in the cache or failed.
+			[[nodiscard]] bool Process(BatchStage::Type stage, Item& item) {
+				TextureData* const data{ item.data };
+				switch (stage) {
+				case BatchStage::Decode: {
+					const TextureImportSettings& settings{ data->import_settings };
+					assert(settings.sources && settings.source_count);
+					util::vector<std::string> files = split(settings.sources, ';');
+					assert(files.size() == settings.source_count);
+
+					item.use_cache = TextureCacheKey(settings, files, item.key);
+					if (item.use_cache && LoadCachedTexture(item.key, data)) {
+						std::lock_guard lock{ _mutex };
+						_stats.cache_hits++;
+						return true;
+					}
+					return !LoadSources(data, files, item.sources, item.images);
+				}
+
+				case BatchStage::Mip:
+					item.scratch = GenerateMipChain(data, item.images, item.statistics, item.has_statistics);
+					item.images.clear();
+					item.sources.clear();
+					return data->info.import_error != ImportError::Success;
+
+				case BatchStage::Compress:
+					CompressMipChain(data, item.scratch, item.has_statistics ? &item.statistics : nullptr);
+					return data->info.import_error != ImportError::Success;
+
+				case BatchStage::Pack:
+					CopySubresources(item.scratch, data);
+					TextureInfoFromMetadata(item.scratch.GetMetadata(), data->info);
+					if (item.use_cache && !data->info.import_error) StoreCachedTexture(item.key, data);
+					return true;
+
+				default: assert(false); return true;
+				}
+			}
+
+			util::vector<Item>			_items;
+			std::deque<u32>				_queues[BatchStage::count];
+			std::mutex					_mutex;
+			std::condition_variable		_condition;
+			BatchImportStats			_stats{};
+			const u64					_budget;
+			u64							_memory{ 0 };
+			u32							_next_decode{ 0 };
+			u32							_remaining;
+			Progression* const			_progression;
+		};
 	}
 
 	void ShutdownTextureTools() {
@@ -518,6 +1125,111 @@ namespace Zetta::Tools {
 
 	}
 
+	// Decodes one subresource instead of the whole texture, which is all the texture editor shows at a time. Previews
+	// smaller than the mip come from smaller mips first, then from averaging blocks as they are decoded. The result
+	// replaces the subresource data as a 2D texture with one mip. Formats that our block decoder doesn't cover, like
+	// BC2 and the signed ones, are decoded by DirectXTex with all of their channels.
+	EDITOR_INTERFACE void DecompressSubresource(TextureData* const data, const DecompressRequest* const request) {
+		using namespace Zetta::Content;
+		assert(data && request);
+		TextureInfo& info{ data->info };
+		const DXGI_FORMAT format{ (DXGI_FORMAT)info.format };
+		assert(IsCompressed(format));
+		util::vector<Image> images = SubresourceDataToImages(data);
+		const bool is_3D{ (info.flags & TextureFlags::IS_VOLUME_MAP) != 0 };
+
+		// Arrays are stored slice by slice with all their mips, volume maps mip by mip with all their depth slices.
+		auto image_index = [&](u32 mip, u32 slice) {
+			if (!is_3D) return slice * info.mip_levels + mip;
+			u32 index{ 0 };
+			for (u32 i{ 0 }; i < mip; i++) index += std::max(info.array_size >> i, 1u);
+			return index + slice;
+		};
+
+		auto slice_count = [&](u32 mip) { return is_3D ? std::max(info.array_size >> mip, 1u) : info.array_size; };
+
+		u32 mip{ std::min(request->mip, info.mip_levels - 1) };
+		u32 slice{ std::min(request->array_slice, slice_count(mip) - 1) };
+		const u32 max_size{ request->max_size ? request->max_size : ~0u };
+		while (mip + 1 < info.mip_levels) {
+			const Image& image{ images[image_index(mip, slice)] };
+			if (std::max(image.width, image.height) <= max_size) break;
+			mip++;
+			if (is_3D) slice = std::min(slice >> 1, slice_count(mip) - 1);
+		}
+
+		const Image& image{ images[image_index(mip, slice)] };
+		u32 scale_shift{ 0 };
+		while (scale_shift < 12 && std::max(BC::PreviewSize((u32)image.width, scale_shift), BC::PreviewSize((u32)image.height, scale_shift)) > max_size) {
+			scale_shift++;
+		}
+
+		const u32 width{ BC::PreviewSize((u32)image.width, scale_shift) };
+		const u32 height{ BC::PreviewSize((u32)image.height, scale_shift) };
+		const u32 channel_mask{ request->channel_mask ? request->channel_mask : BC::Channel::RGBA };
+		ScratchImage scratch;
+		HRESULT hr{ S_OK };
+		BC::Format::Type bc_format{};
+		if (IsBC6H(format) || GetBlockFormat(format, bc_format)) {
+			const DXGI_FORMAT output_format{ IsBC6H(format) ? DXGI_FORMAT_R32G32B32A32_FLOAT :
+				IsSRGB(format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM };
+			hr = scratch.Initialize2D(output_format, width, height, 1, 1);
+			if (SUCCEEDED(hr)) {
+				const Image& output{ *scratch.GetImage(0, 0, 0) };
+				if (IsBC6H(format)) {
+					BC::DecompressBC6HPreview(image.pixels, (u32)image.rowPitch, (u32)image.width, (u32)image.height,
+						format == DXGI_FORMAT_BC6H_SF16, channel_mask, scale_shift, (f32*)output.pixels, (u32)output.rowPitch);
+				}
+				else {
+					BC::DecompressPreview(image.pixels, (u32)image.rowPitch, (u32)image.width, (u32)image.height, bc_format,
+						channel_mask, scale_shift, output.pixels, (u32)output.rowPitch);
+				}
+			}
+		}
+		else {
+			ScratchImage decompressed;
+			hr = Decompress(image, DXGI_FORMAT_UNKNOWN, decompressed);
+			if (SUCCEEDED(hr) && scale_shift) hr = Resize(*decompressed.GetImage(0, 0, 0), width, height, TEX_FILTER_BOX, scratch);
+			else if (SUCCEEDED(hr)) scratch = std::move(decompressed);
+		}
+
+		if (FAILED(hr)) {
+			info.import_error = ImportError::Decompress;
+			return;
+		}
+
+		TexMetadata metadata{ scratch.GetMetadata() };
+		if (info.flags & TextureFlags::IS_PREMULTIPLIED_ALPHA) metadata.SetAlphaMode(TEX_ALPHA_MODE_PREMULTIPLIED);
+		CopySubresources(scratch, data);
+		TextureInfoFromMetadata(metadata, info);
+	}
+
+	// Replaces the subresource data with a streamable texture (see StreamableTexture.h), which is what the engine loads.
+	EDITOR_INTERFACE void PackForEngine(TextureData* const data) {
+		assert(data && data->subresource_data && data->subresource_size);
+		const TextureInfo& info{ data->info };
+		const Content::StreamableTexture::Description description{
+			info.width, info.height, info.array_size, info.mip_levels, info.format, info.flags
+		};
+
+		util::vector<u8> packed;
+		if (!Content::StreamableTexture::Pack(description, data->subresource_data, data->subresource_size,
+			Content::StreamableTexture::default_max_tail_size, packed)) {
+			data->info.import_error = ImportError::Unknown;
+			return;
+		}
+
+		if (packed.size() > ~0u) {
+			data->info.import_error = ImportError::MaxSizeExceeded;
+			return;
+		}
+
+		data->subresource_size = (u32)packed.size();
+		data->subresource_data = (u8* const)CoTaskMemRealloc(data->subresource_data, data->subresource_size);
+		assert(data->subresource_data);
+		memcpy(data->subresource_data, packed.data(), packed.size());
+	}
+
 	EDITOR_INTERFACE void Import(TextureData *const data) {
 		const TextureImportSettings& settings{ data->import_settings };
 		assert(settings.sources && settings.source_count);
@@ -525,74 +1237,184 @@ namespace Zetta::Tools {
 		util::vector<ScratchImage> scratch_images;
 		util::vector<Image> images;
 
-		u32 width{ 0 };
-		u32 height{ 0 };
-		DXGI_FORMAT format{};
 		util::vector<std::string> files = split(settings.sources, ';');
 		assert(files.size() == settings.source_count);
 
+		ImportCache::Key key{};
+		const bool use_cache{ TextureCacheKey(settings, files, key) };
+		if (use_cache && LoadCachedTexture(key, data)) return;
+
+		if (!LoadSources(data, files, scratch_images, images)) return;
+
+		ProcessImages(data, images);
+		if (use_cache && !data->info.import_error) StoreCachedTexture(key, data);
+	}
+
+	// Packs the source images into one 2D atlas texture and reports where each of them went. Images are placed
+	// where they were in the previous atlas if they still fit there, see Atlas::Update().
+	EDITOR_INTERFACE void ImportAtlas(TextureData* const data, AtlasData* const atlas) {
+		assert(data && atlas && atlas->images && atlas->uv_transforms);
+		TextureImportSettings& settings{ data->import_settings };
+		assert(settings.sources && settings.source_count);
+
+		util::vector<std::string> files = split(settings.sources, ';');
+		assert(files.size() == settings.source_count);
+
+		util::vector<ScratchImage> scratch_images;
+		util::vector<u32> widths;
+		util::vector<u32> heights;
+		DXGI_FORMAT format{ DXGI_FORMAT_UNKNOWN };
 		for (u32 i{ 0 }; i < settings.source_count; i++) {
-			scratch_images.emplace_back(LoadFromFile(data, files[i].c_str()));
+			ScratchImage scratch{ LoadFromFile(data, files[i].c_str()) };
 			if (data->info.import_error) return;
 
-			const ScratchImage& scratch{ scratch_images.back() };
-			const TexMetadata& metadata{ scratch.GetMetadata() };
-
-			if (i == 0) {
-				width = (u32)metadata.width;
-				height = (u32)metadata.height;
-				format = metadata.format;
+			// The atlas is sRGB if the first image is.
+			const Image& image{ *scratch.GetImage(0, 0, 0) };
+			if (!i) format = IsSRGB(image.format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+			if (image.format != format) {
+				ScratchImage converted;
+				if (FAILED(Convert(image, format, TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT, converted))) {
+					data->info.import_error = ImportError::FormatMismatch;
+					return;
+				}
+				scratch = std::move(converted);
 			}
 
-			if (width != metadata.width || height != metadata.height) {
-				data->info.import_error = ImportError::SizeMismatch;
-				return;
-			}
+			widths.emplace_back((u32)scratch.GetMetadata().width);
+			heights.emplace_back((u32)scratch.GetMetadata().height);
+			scratch_images.emplace_back(std::move(scratch));
+		}
 
-			if (format != metadata.format) {
-				data->info.import_error = ImportError::FormatMismatch;
-				return;
-			}
+		settings.dimension = TextureDimension::Texture2D;
+		if (!settings.mip_levels) settings.mip_levels = default_atlas_mip_levels;
+		const Atlas::Settings atlas_settings{ atlas->max_size, atlas->padding, settings.mip_levels, settings.compress ? 4u : 1u };
 
-			const u32 array_size{ (u32)metadata.arraySize };
-			const u32 depth{ (u32)metadata.depth };
+		Atlas::Layout layout{ atlas->width, atlas->height };
+		for (u32 i{ 0 }; i < settings.source_count; i++) layout.images.emplace_back(atlas->images[i]);
+		if (!Atlas::Update(widths.data(), heights.data(), settings.source_count, atlas_settings, layout)) {
+			data->info.import_error = ImportError::MaxSizeExceeded;
+			return;
+		}
 
-			for (u32 array_index{ 0 }; array_index < array_size; array_index++) {
-				for (u32 depth_index{ 0 }; depth_index < depth; depth_index++) {
-					const Image* image{ scratch.GetImage(0, array_index, depth_index) };
-					assert(image);
-					if (!image) {
-						data->info.import_error = ImportError::Unknown;
-						return;
-					}
+		util::vector<Atlas::Image> atlas_images;
+		for (const ScratchImage& scratch : scratch_images) {
+			const Image& image{ *scratch.GetImage(0, 0, 0) };
+			atlas_images.emplace_back(image.pixels, (u32)image.width, (u32)image.height, (u32)image.rowPitch);
+		}
 
-					if (width != image->width || height != image->height) {
-						data->info.import_error = ImportError::SizeMismatch;
-						return;
-					}
+		util::vector<u8> pixels;
+		Atlas::Compose(layout, atlas_settings, atlas_images.data(), settings.source_count, pixels);
 
-					images.emplace_back(*image);
-				}
-			}
+		ScratchImage atlas_scratch;
+		if (FAILED(atlas_scratch.Initialize2D(format, layout.width, layout.height, 1, 1))) {
+			data->info.import_error = ImportError::Unknown;
+			return;
 		}
 
-		ScratchImage scratch{ InitializeFromImages(data, images) };
+		const Image& atlas_image{ *atlas_scratch.GetImage(0, 0, 0) };
+		for (u32 y{ 0 }; y < layout.height; y++)
+			memcpy(atlas_image.pixels + y * atlas_image.rowPitch, &pixels[(u64)y * layout.width * 4], (u64)layout.width * 4);
+
+		util::vector<Image> images;
+		images.emplace_back(atlas_image);
+		ProcessImages(data, images);
 		if (data->info.import_error) return;
 
-		if (settings.compress) {
-			// NOTE: Copy the first uncompressed image for the editor to generate an icon.
-			//		 Only do this for compressed imports. if not compressed, the editor
-			//		 Will pick the first image from the returned subresources.
+		atlas->width = layout.width;
+		atlas->height = layout.height;
+		for (u32 i{ 0 }; i < settings.source_count; i++) {
+			atlas->images[i] = layout.images[i];
+			atlas->uv_transforms[i] = Atlas::GetUVTransform(layout, i);
+		}
+	}
 
-			ScratchImage bc_scratch{ CompressImage(data, scratch) };
-			if (data->info.import_error) return;
+	// Imports 6 source faces as a cube map for image based lighting: the mips are prefiltered with GGX, one
+	// roughness per mip, and the irradiance is projected to spherical harmonics. The mips are kept as HDR, so
+	// compressed environment maps are BC6H.
+	EDITOR_INTERFACE void ImportEnvironmentMap(TextureData* const data, EnvironmentData* const environment) {
+		assert(data && environment);
+		TextureImportSettings& settings{ data->import_settings };
+		assert(settings.sources && settings.source_count);
 
-			assert(bc_scratch.GetImages());
-			CopyIcon(bc_scratch.GetImages()[0], data);
+		util::vector<std::string> files = split(settings.sources, ';');
+		assert(files.size() == settings.source_count);
 
-			scratch = std::move(bc_scratch);
+		util::vector<ScratchImage> scratch_images;
+		util::vector<Image> images;
+		if (!LoadSources(data, files, scratch_images, images)) return;
+		if (images.size() != EnvironmentMap::face_count) {
+			data->info.import_error = ImportError::NeedSixImages;
+			return;
+		}
+		if (images[0].width != images[0].height) {
+			data->info.import_error = ImportError::SizeMismatch;
+			return;
+		}
+
+		const u32 size{ (u32)images[0].width };
+		u32 mip_levels{ std::min(settings.mip_levels, GetMaxMipCount(size, size, 1)) };
+		if (!mip_levels) {
+			for (u32 mip_size{ size }; mip_size >= min_environment_mip_size || !mip_levels; mip_size >>= 1) mip_levels++;
+		}
+
+		ScratchImage cube;
+		if (FAILED(cube.InitializeCube(DXGI_FORMAT_R32G32B32A32_FLOAT, size, size, 1, mip_levels))) {
+			data->info.import_error = ImportError::Unknown;
+			return;
+		}
+
+		// The prefilter works on linear RGBA floats. Converting from sRGB linearizes.
+		for (u32 face{ 0 }; face < EnvironmentMap::face_count; face++) {
+			ScratchImage converted;
+			if (FAILED(Convert(images[face], DXGI_FORMAT_R32G32B32A32_FLOAT, TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT, converted))) {
+				data->info.import_error = ImportError::FormatMismatch;
+				return;
+			}
+
+			const Image& source{ *converted.GetImage(0, 0, 0) };
+			const Image& destination{ *cube.GetImage(0, face, 0) };
+			for (u32 y{ 0 }; y < size; y++)
+				memcpy(destination.pixels + y * destination.rowPitch, source.pixels + y * source.rowPitch, (u64)size * 4 * sizeof(f32));
+		}
+
+		util::vector<EnvironmentMap::Face> faces;
+		for (u32 mip{ 0 }; mip < mip_levels; mip++) {
+			for (u32 face{ 0 }; face < EnvironmentMap::face_count; face++) {
+				const Image& image{ *cube.GetImage(mip, face, 0) };
+				faces.emplace_back((f32*)image.pixels, (u32)image.width, (u32)image.rowPitch);
+			}
+		}
+
+		EnvironmentMap::IrradianceSH sh;
+		EnvironmentMap::ProjectIrradiance(faces.data(), sh);
+		EnvironmentMap::PrefilterSpecular(faces.data(), mip_levels, { environment->sample_count });
+
+		ScratchImage scratch;
+		if (FAILED(Convert(cube.GetImages(), cube.GetImageCount(), cube.GetMetadata(), DXGI_FORMAT_R16G16B16A16_FLOAT,
+			TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT, scratch))) {
+			data->info.import_error = ImportError::Unknown;
+			return;
 		}
+
+		data->info.flags |= Content::TextureFlags::IS_HDR;
+		CompressMipChain(data, scratch, nullptr);
+		if (data->info.import_error) return;
+
 		CopySubresources(scratch, data);
 		TextureInfoFromMetadata(scratch.GetMetadata(), data->info);
+		for (u32 i{ 0 }; i < EnvironmentMap::sh_coefficient_count; i++) {
+			const EnvironmentMap::float3& c{ sh.coefficients[i] };
+			environment->irradiance[i] = { c.x, c.y, c.z };
+		}
+	}
+
+	// Imports the textures through a pipeline that decodes, generates mips, compresses and packs different textures
+	// at the same time, within a memory budget. Each texture gets the same result as Import() would give it.
+	EDITOR_INTERFACE void ImportBatch(TextureData* const* const textures, u32 count, const BatchImportSettings* const settings,
+		BatchImportStats* const stats, Progression::ProgressCallback callback) {
+		assert(textures && count && settings && stats);
+		Progression progression{ callback };
+		BatchImport batch{ textures, count, *settings, &progression };
+		batch.Run(*stats);
 	}
-}
\ No newline at end of file
+}
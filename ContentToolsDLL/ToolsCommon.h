@@ -1,10 +1,14 @@
 #pragma once
 #include "CommonHeaders.h"
+#include "WorkerPool.h"
 
 #ifndef NOMINMAX
 #define NOMINMAX
 #endif
 #include <wrl.h>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 
 #ifndef EDITOR_INTERFACE
 #define EDITOR_INTERFACE extern "C" __declspec(dllexport)
@@ -21,18 +25,34 @@ public:
 	DISABLE_COPY(Progression);
 
 	void Callback(u32 value, u32 maximum) {
+		std::lock_guard lock{ m_Mutex };
 		m_Value = value;
 		m_Maximum = maximum;
 		if (m_Callback) m_Callback(value, maximum);
 	}
 
-	[[nodiscard]] constexpr u32 Maximum() const { return m_Maximum; }
-	[[nodiscard]] constexpr u32 Value() const { return m_Value; }
+	// NOTE: Increment() and Extend() may be called concurrently by import worker threads.
+	//       The callback is always invoked under the lock, so the editor sees monotonic updates.
+	void Increment(u32 count = 1) {
+		std::lock_guard lock{ m_Mutex };
+		m_Value += count;
+		if (m_Callback) m_Callback(m_Value, m_Maximum);
+	}
+
+	void Extend(u32 count) {
+		std::lock_guard lock{ m_Mutex };
+		m_Maximum += count;
+		if (m_Callback) m_Callback(m_Value, m_Maximum);
+	}
+
+	[[nodiscard]] u32 Maximum() const { std::lock_guard lock{ m_Mutex }; return m_Maximum; }
+	[[nodiscard]] u32 Value() const { std::lock_guard lock{ m_Mutex }; return m_Value; }
 
 private:
-	ProgressCallback m_Callback;
-	u32				 m_Value;
-	u32				 m_Maximum;
+	ProgressCallback	m_Callback{ nullptr };
+	u32					m_Value{ 0 };
+	u32					m_Maximum{ 0 };
+	mutable std::mutex	m_Mutex;
 };
 
 inline bool FileExists(const char* file) {
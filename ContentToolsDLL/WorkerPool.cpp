@@ -0,0 +1,97 @@
+#include "WorkerPool.h"
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <algorithm>
+
+namespace Zetta::Tools::WorkerPool {
+	namespace {
+		struct Job {
+			Function			function;
+			void*				context;
+			u32					count;
+			std::atomic<u32>	next_index{ 0 };
+			u32					worker_count{ 0 };	// workers inside Work(), guarded by mutex
+		};
+
+		std::mutex						mutex;
+		std::condition_variable			job_added;
+		std::condition_variable			job_left;
+		util::vector<Job*>				jobs;		// the most recent last
+		std::unique_ptr<std::thread[]>	threads;
+		u32								thread_count{ 0 };
+		bool							shutting_down{ false };
+
+		void Work(Job& job) {
+			for (u32 i{ job.next_index++ }; i < job.count; i = job.next_index++) job.function(job.context, i);
+		}
+
+		// Workers join the most recent job with items left, which is the innermost one for nested jobs.
+		[[nodiscard]] Job* NextJob() {
+			for (u32 i{ (u32)jobs.size() }; i > 0; i--) {
+				if (jobs[i - 1]->next_index < jobs[i - 1]->count) return jobs[i - 1];
+			}
+			return nullptr;
+		}
+
+		void WorkerLoop() {
+			std::unique_lock lock{ mutex };
+			while (true) {
+				Job* job{ nullptr };
+				job_added.wait(lock, [&job] { return shutting_down || (job = NextJob()) != nullptr; });
+				if (shutting_down) return;
+
+				job->worker_count++;
+				lock.unlock();
+				Work(*job);
+				lock.lock();
+				if (!--job->worker_count) job_left.notify_all();
+			}
+		}
+
+		// NOTE: the calling thread is the last worker of every job.
+		void Start() {
+			thread_count = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+			if (!thread_count) return;
+
+			threads = std::make_unique<std::thread[]>(thread_count);
+			for (u32 i{ 0 }; i < thread_count; i++) threads[i] = std::thread{ WorkerLoop };
+		}
+	}
+
+	void Run(u32 count, Function function, void* context) {
+		assert(function);
+		Job job{ function, context, count };
+		{
+			std::lock_guard lock{ mutex };
+			if (!threads) Start();
+			if (thread_count) jobs.emplace_back(&job);
+		}
+
+		job_added.notify_all();
+		Work(job);
+
+		// Once the job is out of the list, no worker joins it. The ones in it have claimed their last item.
+		std::unique_lock lock{ mutex };
+		Job** const entry{ std::find(jobs.begin(), jobs.end(), &job) };
+		if (entry != jobs.end()) jobs.erase(entry);
+		job_left.wait(lock, [&job] { return !job.worker_count; });
+	}
+
+	void Shutdown() {
+		{
+			std::lock_guard lock{ mutex };
+			assert(jobs.empty());
+			if (!threads) return;
+			shutting_down = true;
+		}
+
+		job_added.notify_all();
+		for (u32 i{ 0 }; i < thread_count; i++) threads[i].join();
+
+		std::lock_guard lock{ mutex };
+		threads.reset();
+		thread_count = 0;
+		shutting_down = false;
+	}
+}
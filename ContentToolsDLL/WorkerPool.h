@@ -0,0 +1,29 @@
+#pragma once
+#include "CommonHeaders.h"
+#include <type_traits>
+
+// One set of worker threads, shared by every ParallelFor() of the content tools and started on first use.
+// Jobs can be run from several threads at once and from inside other jobs: the calling thread always works
+// on its own job, so it only ever waits for items that a worker has already started.
+namespace Zetta::Tools::WorkerPool {
+	using Function = void(*)(void* context, u32 index);
+
+	// Calls function(context, index) for every index in [0, count) on the calling thread and on idle workers.
+	void Run(u32 count, Function function, void* context);
+	// Joins the workers. Must not be called while a job is running, the next Run() starts them again.
+	void Shutdown();
+}
+
+// Runs func(index) for every index in [0, count) on the shared worker pool.
+// The calling thread takes part in the work and the call returns once every index has been processed.
+template<typename F>
+void ParallelFor(u32 count, F&& func) {
+	if (!count) return;
+	if (count == 1) {
+		func(0u);
+		return;
+	}
+
+	using Func = std::remove_reference_t<F>;
+	Zetta::Tools::WorkerPool::Run(count, [](void* context, u32 index) { (*(Func*)context)(index); }, (void*)&func);
+}
@@ -88,6 +88,10 @@ namespace Zetta::Tools {
 
 	EDITOR_INTERFACE void ImportASSIMP(const char* file, SceneData* data) {
 		assert(file && data);
+		ImportCache::Key key{};
+		const bool use_cache{ SceneCacheKey(file, SceneImporter::ASSIMP, data->settings, key) };
+		if (use_cache && LoadCachedScene(key, *data)) return;
+
 		Scene scene{};
 
 		{
@@ -97,6 +101,7 @@ namespace Zetta::Tools {
 
 		//ProcessScene(scene, data->settings);
 		PackData(scene, *data);
+		if (use_cache && data->size) ImportCache::Store(key, data->data, data->size);
 		/*
 			- Issue currently: Scene tree traversal is fucked somehow. Brain hurt. Will try to fix later
 		*/
@@ -2,6 +2,7 @@
 #include "Geometry.h"
 
 #include <mutex>
+#include <filesystem>
 
 #pragma region Lib Linking
 #if _DEBUG
@@ -18,6 +19,148 @@
 namespace Zetta::Tools {
 	namespace {
 		std::mutex fbx_mutex{};
+
+		// Mixes the media that the FBX SDK extracted from the scene into the scene's cache key. The SDK writes it to
+		// a .fbm folder next to the file, which is missing before the first import or if someone deleted it, so a key
+		// made before the import only matches the one stored after it while the extracted files are still there.
+		[[nodiscard]] bool EmbeddedMediaKey(const char* file, ImportCache::Key& key) {
+			namespace fs = std::filesystem;
+			std::error_code error;
+			fs::path media_directory{ file };
+			media_directory.replace_extension(".fbm");
+
+			util::vector<fs::path> media_files;
+			if (fs::is_directory(media_directory, error)) {
+				for (const auto& entry : fs::recursive_directory_iterator{ media_directory, error }) {
+					if (entry.is_regular_file(error)) media_files.emplace_back(entry.path());
+				}
+			}
+			std::sort(media_files.begin(), media_files.end());
+
+			ImportCache::Hasher hasher{};
+			hasher.Update(key);
+			hasher.Update((u32)media_files.size());
+			for (const fs::path& media_file : media_files) {
+				const std::string name{ media_file.lexically_relative(media_directory).generic_string() };
+				hasher.Update(name.data(), name.size());
+				if (!hasher.UpdateFromFile(media_file.string().c_str())) return false;
+			}
+
+			key = hasher.Finalize();
+			return true;
+		}
+
+		FbxAMatrix GetMeshTransform(FbxMesh* fbx_mesh) {
+			FbxNode* const node{ fbx_mesh->GetNode() };
+			FbxAMatrix geometricTransform;
+
+			geometricTransform.SetT(node->GetGeometricTranslation(FbxNode::eSourcePivot));
+			geometricTransform.SetR(node->GetGeometricRotation(FbxNode::eSourcePivot));
+			geometricTransform.SetS(node->GetGeometricScaling(FbxNode::eSourcePivot));
+
+			return node->EvaluateGlobalTransform() * geometricTransform;
+		}
+
+		// Reads triangles of a (triangulated) FBX mesh on demand, in the same way FBXContext::GetMeshData()
+		// reads all of them, so that huge meshes never have to be copied as a whole.
+		class FBXTriangleSource : public TriangleSource {
+		public:
+			FBXTriangleSource(FbxMesh* fbx_mesh, f32 scene_scale, GeometryImportSettings& settings)
+				: _fbx_mesh{ fbx_mesh }, _transform{ GetMeshTransform(fbx_mesh) }, _scene_scale{ scene_scale } {
+				assert(_fbx_mesh);
+				_inverse_transpose = _transform.Inverse().Transpose();
+				_control_points = _fbx_mesh->GetControlPoints();
+				if (!_fbx_mesh->GetMaterialIndices(&_material_indices)) _material_indices = nullptr;
+
+				if (!settings.calculate_normals) {
+					_import_normals = _fbx_mesh->GenerateNormals();
+					if (!_import_normals) settings.calculate_normals = true;
+				}
+
+				if (!settings.calculate_tangents) {
+					if (!(_fbx_mesh->GenerateTangentsData() && _fbx_mesh->GetTangents(&_tangents) && _tangents && _tangents->GetCount() > 0)) {
+						_tangents = nullptr;
+						settings.calculate_tangents = true;
+					}
+				}
+
+				_fbx_mesh->GetUVSetNames(_uv_names);
+			}
+
+			u32 TriangleCount() const override { return (u32)_fbx_mesh->GetPolygonCount(); }
+
+			Math::v3 TriangleCentroid(u32 triangle) const override {
+				FbxVector4 sum{};
+				for (s32 i{ 0 }; i < 3; i++) sum += _control_points[_fbx_mesh->GetPolygonVertex((s32)triangle, i)];
+				return { (f32)sum[0] / 3.f, (f32)sum[1] / 3.f, (f32)sum[2] / 3.f };
+			}
+
+			void GetTriangles(const u32* const triangles, u32 count, Mesh& m) const override {
+				const s32 uv_set_count{ _uv_names.GetCount() };
+				m.uv_sets.resize(uv_set_count);
+
+				std::unordered_map<s32, u32> vertex_ref;
+				vertex_ref.reserve((u64)count * 3);
+
+				for (u32 t{ 0 }; t < count; t++) {
+					const s32 poly{ (s32)triangles[t] };
+
+					if (_material_indices) {
+						const u32 mtl_index{ (u32)_material_indices->GetAt(poly) };
+						m.material_indices.emplace_back(mtl_index);
+						if (std::find(m.material_used.begin(), m.material_used.end(), mtl_index) == m.material_used.end())
+							m.material_used.emplace_back(mtl_index);
+					}
+
+					for (s32 j{ 0 }; j < 3; j++) {
+						const s32 v_idx{ _fbx_mesh->GetPolygonVertex(poly, j) };
+						const auto [ref, inserted] { vertex_ref.try_emplace(v_idx, (u32)m.positions.size()) };
+						if (inserted) {
+							FbxVector4 v = _transform.MultT(_control_points[v_idx]) * _scene_scale;
+							m.positions.emplace_back((f32)v[0], (f32)v[1], (f32)v[2]);
+						}
+						m.raw_indices.emplace_back(ref->second);
+
+						if (_import_normals) {
+							FbxVector4 n{};
+							_fbx_mesh->GetPolygonVertexNormal(poly, j, n);
+							n = _inverse_transpose.MultT(n);
+							n.Normalize();
+							m.normals.emplace_back((f32)n[0], (f32)n[1], (f32)n[2]);
+						}
+
+						if (_tangents) {
+							FbxVector4 tangent{ _tangents->GetAt(_fbx_mesh->GetPolygonVertexIndex(poly) + j) };
+							const f32 handedness{ (f32)tangent[3] };
+							tangent[3] = 0.0f;
+							tangent = _transform.MultT(tangent);
+							tangent.Normalize();
+							m.tangents.emplace_back((f32)tangent[0], (f32)tangent[1], (f32)tangent[2], handedness);
+						}
+
+						for (s32 k{ 0 }; k < uv_set_count; k++) {
+							FbxVector2 uv{};
+							bool unmapped{ false };
+							_fbx_mesh->GetPolygonVertexUV(poly, j, _uv_names.GetStringAt(k), uv, unmapped);
+							m.uv_sets[k].emplace_back((f32)uv[0], (f32)uv[1]);
+						}
+					}
+				}
+
+				assert(m.raw_indices.size() == (u64)count * 3);
+			}
+
+		private:
+			FbxMesh* const								_fbx_mesh;
+			const FbxAMatrix							_transform;
+			FbxAMatrix									_inverse_transpose;
+			const FbxVector4*							_control_points{ nullptr };
+			FbxLayerElementArrayTemplate<s32>*			_material_indices{ nullptr };
+			FbxLayerElementArrayTemplate<FbxVector4>*	_tangents{ nullptr };
+			FbxStringList								_uv_names;
+			const f32									_scene_scale;
+			bool										_import_normals{ false };
+		};
 	}
 
 	bool FBXContext::InitializeFBX() {
@@ -132,9 +275,16 @@ namespace Zetta::Tools {
 		m.lod_threshold = lod_threshold;
 		m.name = (node->GetName()[0] != '\0') ? node->GetName() : fbx_mesh->GetName();
 
+		// NOTE: coalescing needs the initial data of all meshes, so huge meshes are only streamed without it.
+		if (!_scene_data->settings.coalesce_meshes && fbx_mesh->GetPolygonCount() > (s32)streaming_triangle_threshold) {
+			const FBXTriangleSource source{ fbx_mesh, _scene_scale, _scene_data->settings };
+			StreamMesh(source, m, _scene_data->settings, meshes, _progression);
+			return;
+		}
+
 		if (GetMeshData(fbx_mesh, m)) {
 			meshes.emplace_back(m);
-			_progression->Callback(_progression->Value(), _progression->Maximum() + 1);
+			_progression->Extend(1);
 		}
 	}
 
@@ -163,14 +313,7 @@ namespace Zetta::Tools {
 	bool FBXContext::GetMeshData(FbxMesh* fbx_mesh, Mesh& m) {
 		assert(fbx_mesh);
 
-		FbxNode* const node{ fbx_mesh->GetNode() };
-		FbxAMatrix geometricTransform;
-
-		geometricTransform.SetT(node->GetGeometricTranslation(FbxNode::eSourcePivot));
-		geometricTransform.SetR(node->GetGeometricRotation(FbxNode::eSourcePivot));
-		geometricTransform.SetS(node->GetGeometricScaling(FbxNode::eSourcePivot));
-
-		FbxAMatrix transform{ node->EvaluateGlobalTransform() * geometricTransform };
+		FbxAMatrix transform{ GetMeshTransform(fbx_mesh) };
 		FbxAMatrix inverse_transpose{ transform.Inverse().Transpose() };
 
 		const s32 num_polys{ fbx_mesh->GetPolygonCount() };
@@ -268,6 +411,15 @@ namespace Zetta::Tools {
 
 	EDITOR_INTERFACE void ImportFBX(const char* file, SceneData* data, Progression::ProgressCallback callback) {
 		assert(file && data);
+		// NOTE: the FBX SDK extracts embedded media next to the file while loading it, which a cache hit
+		//		 skips. So, the extracted media is part of the key, see EmbeddedMediaKey().
+		ImportCache::Key key{};
+		const bool import_embedded{ data->settings.import_embeded != 0 };
+		bool use_cache{ SceneCacheKey(file, SceneImporter::FBX, data->settings, key) };
+		const ImportCache::Key scene_key{ key };
+		if (use_cache && import_embedded) use_cache = EmbeddedMediaKey(file, key);
+		if (use_cache && LoadCachedScene(key, *data)) return;
+
 		Scene scene{};
 		Progression progression{ callback };
 
@@ -281,5 +433,11 @@ namespace Zetta::Tools {
 
 		ProcessScene(scene, data->settings, &progression);
 		PackData(scene, *data);
+		if (use_cache && import_embedded) {
+			// the media has just been extracted, so the key changes if it wasn't there before
+			key = scene_key;
+			use_cache = EmbeddedMediaKey(file, key);
+		}
+		if (use_cache) ImportCache::Store(key, data->data, data->size);
 	}
 }
\ No newline at end of file
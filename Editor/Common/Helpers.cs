@@ -139,6 +139,52 @@ namespace Editor
             return assets;
         }
 
+        // Textures are imported in one batch, so that the content tools work on several of them at once.
+        internal static async Task<List<Asset>> ImportTexturesAsync(IEnumerable<TextureProxy> proxies)
+        {
+            List<Texture> textures = new();
+            List<string> files = new();
+            List<ImportingItem> importingItems = new();
+            try
+            {
+                ImportingItemsCollection.Init();
+                ContentWatcher.EnableFileWatcher(false);
+                foreach (var proxy in proxies.Where(x => !IsDirectory(x.FileInfo.FullName)))
+                {
+                    Debug.Assert(Directory.Exists(proxy.DstFolder));
+                    var name = Path.GetFileNameWithoutExtension(proxy.FileInfo.FullName);
+                    var texture = new Texture(proxy.ImportSettings) { FullPath = proxy.DstFolder + name + Asset.AssetFileExtension };
+                    var importingItem = new ImportingItem(name, texture);
+                    ImportingItemsCollection.Add(importingItem);
+
+                    textures.Add(texture);
+                    files.Add(proxy.FileInfo.FullName);
+                    importingItems.Add(importingItem);
+                }
+
+                await Task.Run(() =>
+                {
+                    var succeeded = Texture.ImportBatch(textures, files);
+                    for (int i = 0; i < textures.Count; ++i)
+                    {
+                        if (succeeded[i]) textures[i].Save(textures[i].FullPath);
+                        importingItems[i].Status = succeeded[i] ? ImportStatus.Succeeded : ImportStatus.Failed;
+                    }
+                });
+            }
+            catch (Exception ex)
+            {
+                Debug.WriteLine($"Failed to import files.");
+                Debug.WriteLine(ex.Message);
+                importingItems.Where(x => x.Status == ImportStatus.Importing).ToList().ForEach(x => x.Status = ImportStatus.Failed);
+            }
+            finally
+            {
+                ContentWatcher.EnableFileWatcher(true);
+            }
+            return textures.Cast<Asset>().ToList();
+        }
+
         private static Asset Import(string file, IAssetImportSettings importSettings, string destination)
         {
             Debug.Assert(!string.IsNullOrEmpty(file));
@@ -15,7 +15,6 @@ namespace Editor.Components
     abstract class Component : ViewModelBase
     {
         public abstract IMSComponent GetMSComponent(MSEntity msEntity);
-        public abstract void WriteToBinary(BinaryWriter bw);
 
         [DataMember]
         public GameEntity Owner { get; private set; }
@@ -29,11 +29,16 @@ namespace Editor.Components
 
         public override IMSComponent GetMSComponent(MSEntity msEntity) => new MSScript(msEntity);
 
-        public override void WriteToBinary(BinaryWriter bw)
+        // 64-bit FNV-1a of the name. Must match Script::Detail::StringHash in the engine.
+        public ulong GetScriptID()
         {
-			var bytes = Encoding.UTF8.GetBytes(Name);
-			bw.Write(bytes.Length);
-			bw.Write(bytes);
+            ulong hash = 0xcbf29ce484222325;
+            foreach (var b in Encoding.UTF8.GetBytes(Name))
+            {
+                hash ^= b;
+                hash *= 0x100000001b3;
+            }
+            return hash;
         }
 
         public Script(GameEntity owner) : base(owner) { }
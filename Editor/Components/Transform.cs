@@ -60,13 +60,6 @@ namespace Editor.Components
 
         public override IMSComponent GetMSComponent(MSEntity msEntity) => new MSTransform(msEntity);
 
-        public override void WriteToBinary(BinaryWriter bw)
-        {
-            bw.Write(_Position.X); bw.Write(_Position.Y); bw.Write(_Position.Z);
-            bw.Write(_Rotation.X); bw.Write(_Rotation.Y); bw.Write(_Rotation.Z);
-            bw.Write(_Scale.X);    bw.Write(_Scale.Y);    bw.Write(_Scale.Z);
-        }
-
         public Transform(GameEntity owner) : base(owner) {}
     }
 
@@ -8,6 +8,7 @@ using System.Diagnostics;
 using System.IO;
 using System.Linq;
 using System.Net.WebSockets;
+using System.Numerics;
 using System.Text;
 using System.Threading.Tasks;
 using System.Windows;
@@ -44,9 +45,94 @@ namespace Editor.Content
 		TriangleStrip
 	}
 
+	enum PositionFormat
+	{
+		Float3 = 0,
+		Unorm16x3
+	}
+
+	// NOTE: Must match Content::GeometryBounds in the engine.
+	struct GeometryBounds
+	{
+		public Vector3 AabbMin;
+		public Vector3 AabbMax;
+		public Vector3 SphereCenter;
+		public float SphereRadius;
+
+		public static GeometryBounds Merge(GeometryBounds a, GeometryBounds b)
+		{
+			var merged = new GeometryBounds()
+			{
+				AabbMin = Vector3.Min(a.AabbMin, b.AabbMin),
+				AabbMax = Vector3.Max(a.AabbMax, b.AabbMax),
+			};
+
+			var distance = Vector3.Distance(a.SphereCenter, b.SphereCenter);
+			if (distance + b.SphereRadius <= a.SphereRadius)
+			{
+				merged.SphereCenter = a.SphereCenter;
+				merged.SphereRadius = a.SphereRadius;
+			}
+			else if (distance + a.SphereRadius <= b.SphereRadius)
+			{
+				merged.SphereCenter = b.SphereCenter;
+				merged.SphereRadius = b.SphereRadius;
+			}
+			else
+			{
+				merged.SphereRadius = (distance + a.SphereRadius + b.SphereRadius) * 0.5f;
+				merged.SphereCenter = a.SphereCenter + (b.SphereCenter - a.SphereCenter) * ((merged.SphereRadius - a.SphereRadius) / distance);
+			}
+
+			return merged;
+		}
+
+		public static GeometryBounds Read(BinaryReader reader)
+		{
+			return new GeometryBounds()
+			{
+				AabbMin = new Vector3(reader.ReadSingle(), reader.ReadSingle(), reader.ReadSingle()),
+				AabbMax = new Vector3(reader.ReadSingle(), reader.ReadSingle(), reader.ReadSingle()),
+				SphereCenter = new Vector3(reader.ReadSingle(), reader.ReadSingle(), reader.ReadSingle()),
+				SphereRadius = reader.ReadSingle(),
+			};
+		}
+
+		// Bounds of Float3 positions, with the sphere around the center of the box.
+		public static GeometryBounds FromPositions(byte[] positions, int vertexCount)
+		{
+			var points = Enumerable.Range(0, vertexCount).Select(i => new Vector3(
+				BitConverter.ToSingle(positions, i * 12), BitConverter.ToSingle(positions, i * 12 + 4), BitConverter.ToSingle(positions, i * 12 + 8)));
+			if (vertexCount == 0) return new GeometryBounds();
+
+			var bounds = new GeometryBounds()
+			{
+				AabbMin = points.Aggregate(Vector3.Min),
+				AabbMax = points.Aggregate(Vector3.Max),
+			};
+			bounds.SphereCenter = (bounds.AabbMin + bounds.AabbMax) * 0.5f;
+			bounds.SphereRadius = points.Max(p => Vector3.Distance(p, bounds.SphereCenter));
+			return bounds;
+		}
+
+		public void Write(BinaryWriter writer)
+		{
+			writer.Write(AabbMin.X);
+			writer.Write(AabbMin.Y);
+			writer.Write(AabbMin.Z);
+			writer.Write(AabbMax.X);
+			writer.Write(AabbMax.Y);
+			writer.Write(AabbMax.Z);
+			writer.Write(SphereCenter.X);
+			writer.Write(SphereCenter.Y);
+			writer.Write(SphereCenter.Z);
+			writer.Write(SphereRadius);
+		}
+	}
+
 	class Mesh : ViewModelBase
 	{
-		public static int PositionSize => sizeof(float) * 3;
+		public int PositionSize => PositionFormat == PositionFormat.Unorm16x3 ? sizeof(ushort) * 4 : sizeof(float) * 3;
 
 		private int _ElementSize;
 		public int ElementSize
@@ -122,6 +208,13 @@ namespace Editor.Content
 
 		public PrimitiveTopology PrimitiveTopology { get; set; }
 
+		// NOTE: Quantized positions are decoded as PositionBias + PositionScale * position.
+		public PositionFormat PositionFormat { get; set; }
+		public Vector3 PositionScale { get; set; } = Vector3.One;
+		public Vector3 PositionBias { get; set; }
+
+		public GeometryBounds Bounds { get; set; }
+
 		public byte[] Positions { get; set; }
 		public byte[] Elements { get; set; }
 		public byte[] Indices { get; set; }
@@ -158,6 +251,8 @@ namespace Editor.Content
 		}
 
 		public ObservableCollection<Mesh> Meshes { get; } = new ObservableCollection<Mesh>();
+
+		public GeometryBounds Bounds => Meshes.Select(m => m.Bounds).Aggregate(GeometryBounds.Merge);
 	}
 
 	class LODGroup : ViewModelBase
@@ -266,6 +361,48 @@ namespace Editor.Content
 			}
 		}
 
+		private bool _QuantizePositions;
+		public bool QuantizePositions
+		{
+			get => _QuantizePositions;
+			set
+			{
+				if (_QuantizePositions != value)
+				{
+					_QuantizePositions = value;
+					OnPropertyChanged(nameof(QuantizePositions));
+				}
+			}
+		}
+
+		private bool _StaticBatching;
+		public bool StaticBatching
+		{
+			get => _StaticBatching;
+			set
+			{
+				if (_StaticBatching != value)
+				{
+					_StaticBatching = value;
+					OnPropertyChanged(nameof(StaticBatching));
+				}
+			}
+		}
+
+		private float _BatchCellSize;
+		public float BatchCellSize
+		{
+			get => _BatchCellSize;
+			set
+			{
+				if (!_BatchCellSize.IsEquals(value))
+				{
+					_BatchCellSize = value;
+					OnPropertyChanged(nameof(BatchCellSize));
+				}
+			}
+		}
+
 		private bool _CoalesceMeshes;
 		public bool CoalesceMeshes
 		{
@@ -289,6 +426,9 @@ namespace Editor.Content
 			ImportEmbededTextures = true;
 			ImportAnimations = true;
 			CoalesceMeshes = false;
+			QuantizePositions = false;
+			StaticBatching = false;
+			BatchCellSize = 32f;
 		}
 
 		public void ToBinary(BinaryWriter writer)
@@ -300,9 +440,15 @@ namespace Editor.Content
 			writer.Write(ImportEmbededTextures);
 			writer.Write(ImportAnimations);
 			writer.Write(CoalesceMeshes);
+			writer.Write(QuantizePositions);
+			writer.Write(StaticBatching);
+			writer.Write(BatchCellSize);
 		}
 
-		public void FromBinary(BinaryReader reader)
+		public void FromBinary(BinaryReader reader) => FromBinary(reader, Geometry.FormatVersion);
+
+		// Settings added after 'version' keep their defaults.
+		public void FromBinary(BinaryReader reader, int version)
 		{
 			CalculateNormals = reader.ReadBoolean();
 			CalculateTangents = reader.ReadBoolean();
@@ -311,11 +457,22 @@ namespace Editor.Content
 			ImportEmbededTextures = reader.ReadBoolean();
 			ImportAnimations = reader.ReadBoolean();
 			CoalesceMeshes |= reader.ReadBoolean();
+			if (version < 1) return;
+
+			QuantizePositions = reader.ReadBoolean();
+			StaticBatching = reader.ReadBoolean();
+			BatchCellSize = reader.ReadSingle();
 		}
 	}
 
 	class Geometry : Asset
 	{
+		// Version 1 added quantized positions, bounds and the static batching settings.
+		// NOTE: Files from before versioning start with the import settings, whose first byte is a bool,
+		//		 so they can't be mistaken for the marker.
+		private const int FormatMarker = 0x4D475A45; // "EZGM"
+		public const int FormatVersion = 1;
+
 		private readonly object _lock = new();
 		private readonly List<LODGroup> _lodGroups = new();
 
@@ -394,11 +551,13 @@ namespace Editor.Content
 			mesh.IndexSize = reader.ReadInt32();
 			mesh.IndexCount = reader.ReadInt32();
 			var lodThreshold = reader.ReadSingle();
+			ReadPositionFormat(mesh, reader);
+			mesh.Bounds = GeometryBounds.Read(reader);
 
 			var elementBufferSize = mesh.ElementSize * mesh.VertexCount;
 			var indexBufferSize = mesh.IndexSize * mesh.IndexCount;
 
-			mesh.Positions = reader.ReadBytes(Mesh.PositionSize * mesh.VertexCount);
+			mesh.Positions = reader.ReadBytes(mesh.PositionSize * mesh.VertexCount);
 			mesh.Elements = reader.ReadBytes(elementBufferSize);
 			mesh.Indices = reader.ReadBytes(indexBufferSize);
 
@@ -418,6 +577,49 @@ namespace Editor.Content
 			lod.Meshes.Add(mesh);
 		}
 
+		private static void ReadPositionFormat(Mesh mesh, BinaryReader reader)
+		{
+			mesh.PositionFormat = (PositionFormat)reader.ReadInt32();
+			mesh.PositionScale = new Vector3(reader.ReadSingle(), reader.ReadSingle(), reader.ReadSingle());
+			mesh.PositionBias = new Vector3(reader.ReadSingle(), reader.ReadSingle(), reader.ReadSingle());
+		}
+
+		private static void WritePositionFormat(Mesh mesh, BinaryWriter writer)
+		{
+			writer.Write((int)mesh.PositionFormat);
+			writer.Write(mesh.PositionScale.X);
+			writer.Write(mesh.PositionScale.Y);
+			writer.Write(mesh.PositionScale.Z);
+			writer.Write(mesh.PositionBias.X);
+			writer.Write(mesh.PositionBias.Y);
+			writer.Write(mesh.PositionBias.Z);
+		}
+
+		// Returns the submesh buffers encoded with the engine's geometry codec or null if compression
+		// isn't possible (not a triangle list) or doesn't pay off.
+		private static byte[] CompressSubmesh(Mesh mesh)
+		{
+			if (mesh.PrimitiveTopology != PrimitiveTopology.TriangleList) return null;
+
+			var positions = ContentToolsAPI.CompressGeometryBuffer(mesh.Positions, mesh.VertexCount, mesh.PositionSize, false);
+			var elements = mesh.ElementSize > 0 ? ContentToolsAPI.CompressGeometryBuffer(mesh.Elements, mesh.VertexCount, mesh.ElementSize, false) : Array.Empty<byte>();
+			var indices = ContentToolsAPI.CompressGeometryBuffer(mesh.Indices, mesh.IndexCount, mesh.IndexSize, true);
+			if (positions == null || elements == null || indices == null) return null;
+
+			var compressedSize = sizeof(int) * 3 + positions.Length + elements.Length + indices.Length;
+			if (compressedSize >= mesh.Positions.Length + mesh.Elements.Length + mesh.Indices.Length) return null;
+
+			using var writer = new BinaryWriter(new MemoryStream());
+			writer.Write(positions.Length);
+			writer.Write(elements.Length);
+			writer.Write(indices.Length);
+			writer.Write(positions);
+			writer.Write(elements);
+			writer.Write(indices);
+			writer.Flush();
+			return (writer.BaseStream as MemoryStream).ToArray();
+		}
+
 		public override bool Import(string file)
 		{
 			Debug.Assert(File.Exists(file));
@@ -508,10 +710,12 @@ namespace Editor.Content
 			try
 			{
 				byte[] data = null;
+				int version;
 				using (var reader = new BinaryReader(File.Open(file, FileMode.Open, FileAccess.Read)))
 				{
 					ReadAssetFileHeader(reader);
-					ImportSettings.FromBinary(reader);
+					version = ReadFormatVersion(reader);
+					ImportSettings.FromBinary(reader, version);
 					int datalen = reader.ReadInt32();
 					Debug.Assert(datalen > 0);
 					data = reader.ReadBytes(datalen);
@@ -528,7 +732,7 @@ namespace Editor.Content
                     var lodGroupCount = reader.ReadInt32();
 
 					for (int i = 0; i < lodGroupCount; i++)
-						lodGroup.LODs.Add(BinaryToLOD(reader));
+						lodGroup.LODs.Add(BinaryToLOD(reader, version));
 
 					_lodGroups.Clear();
 					_lodGroups.Add(lodGroup);
@@ -589,6 +793,8 @@ namespace Editor.Content
 					using (var writer = new BinaryWriter(File.Open(meshFileName, FileMode.Create, FileAccess.Write)))
 					{
 						WriteAssetFileHeader(writer);
+						writer.Write(FormatMarker);
+						writer.Write(FormatVersion);
 						ImportSettings.ToBinary(writer);
 						writer.Write(data.Length);
 						writer.Write(data);
@@ -619,6 +825,8 @@ namespace Editor.Content
 			{
 				writer.Write(lod.LODThreshold);
 				writer.Write(lod.Meshes.Count);
+				lod.Bounds.Write(writer);
+				foreach (var mesh in lod.Meshes) mesh.Bounds.Write(writer);
 				var sizeofSubmeshesPosition = writer.BaseStream.Position;
 				writer.Write(0);
 				foreach (var mesh in lod.Meshes)
@@ -628,6 +836,15 @@ namespace Editor.Content
 					writer.Write(mesh.IndexCount);
 					writer.Write((int)mesh.ElementsType);
 					writer.Write((int)mesh.PrimitiveTopology);
+					WritePositionFormat(mesh, writer);
+
+					var compressedSubmesh = CompressSubmesh(mesh);
+					writer.Write(compressedSubmesh?.Length ?? 0);
+					if (compressedSubmesh != null)
+					{
+						writer.Write(compressedSubmesh);
+						continue;
+					}
 
 					var alignedPositionBuffer = new byte[MathUtils.AlignSizeUp(mesh.Positions.Length, 4)];
 					Array.Copy(mesh.Positions, alignedPositionBuffer, mesh.Positions.Length);
@@ -677,6 +894,8 @@ namespace Editor.Content
 				writer.Write(mesh.VertexCount);
 				writer.Write(mesh.IndexSize);
 				writer.Write(mesh.IndexCount);
+				WritePositionFormat(mesh, writer);
+				mesh.Bounds.Write(writer);
 				writer.Write(mesh.Positions);
 				writer.Write(mesh.Elements);
 				writer.Write(mesh.Indices);
@@ -688,7 +907,16 @@ namespace Editor.Content
 			hash = ContentHelper.ComputeHash(buffer, (int)meshDataBegin, (int)meshDataSize);
 		}
 
-		private MeshLOD BinaryToLOD(BinaryReader reader)
+		private static int ReadFormatVersion(BinaryReader reader)
+		{
+			var position = reader.BaseStream.Position;
+			if (reader.ReadInt32() == FormatMarker) return reader.ReadInt32();
+
+			reader.BaseStream.Position = position;
+			return 0;
+		}
+
+		private MeshLOD BinaryToLOD(BinaryReader reader, int version)
 		{
 			var lod = new MeshLOD();
 
@@ -710,9 +938,17 @@ namespace Editor.Content
 					IndexCount = reader.ReadInt32()
 				};
 
-				mesh.Positions = reader.ReadBytes(Mesh.PositionSize * mesh.VertexCount);
+				if (version >= 1)
+				{
+					ReadPositionFormat(mesh, reader);
+					mesh.Bounds = GeometryBounds.Read(reader);
+				}
+
+				mesh.Positions = reader.ReadBytes(mesh.PositionSize * mesh.VertexCount);
 				mesh.Elements = reader.ReadBytes(mesh.ElementSize * mesh.VertexCount);
 				mesh.Indices = reader.ReadBytes(mesh.IndexSize *  mesh.IndexCount);
+				// older files only have Float3 positions
+				if (version < 1) mesh.Bounds = GeometryBounds.FromPositions(mesh.Positions, mesh.VertexCount);
 
 				lod.Meshes.Add(mesh);
 			}
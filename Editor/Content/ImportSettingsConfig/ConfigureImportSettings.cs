@@ -147,7 +147,7 @@ namespace Editor.Content
         {
             if (!_textureProxies.Any()) return;
 
-            _ = ContentHelper.ImportFilesAsync(_textureProxies);
+            _ = ContentHelper.ImportTexturesAsync(_textureProxies);
             _textureProxies.Clear();
         }
 
@@ -502,26 +502,10 @@ namespace Editor.Content
             {
                 Logger.Log(MessageType.Info, $"Importing image file {file}");
                 ImportSettings.Sources.Add(file);
-                (var slices, var icon) = ContentToolsAPI.Import(this);
+                var result = ContentToolsAPI.Import(this);
 
-                Debug.Assert(slices.Any() && slices.First().Any() && slices.First().First().Any());
-
-                if (slices.Any() && slices.First().Any() && slices.First().First().Any())
-                    Slices = slices;
-                else return false;
-
-                var first_mip = Slices[0][0][0];
-                if (!HasValidDimensions(first_mip.Width, first_mip.Height, ArraySize, IsVolumeMap, file)) return false;
-
-                if (icon == null)
-                {
-                    Debug.Assert(!ImportSettings.Compress);
-                    icon = first_mip;
-                }
-
-                Icon = BitmapHelper.CreateThumbnail(BitmapHelper.ImageFromSlice(icon, IsNormalMap), ContentInfo.IconWidth, ContentInfo.IconWidth);
-                
-                return true;
+                Debug.Assert(result.slices.Any() && result.slices.First().Any() && result.slices.First().First().Any());
+                return SetImportResult(result, file);
             }
             catch (Exception ex)
             {
@@ -534,6 +518,59 @@ namespace Editor.Content
             return false;
         }
 
+        // Imports the textures together with ContentToolsAPI.ImportBatch(). Each texture gets its file added as
+        // its source, like Import(file) does. Returns whether each import succeeded.
+        public static bool[] ImportBatch(IList<Texture> textures, IList<string> files)
+        {
+            Debug.Assert(textures.Count == files.Count);
+            var succeeded = new bool[textures.Count];
+            if (!textures.Any()) return succeeded;
+
+            Logger.Log(MessageType.Info, $"Importing {textures.Count} image files");
+            for (int i = 0; i < textures.Count; ++i)
+            {
+                Debug.Assert(File.Exists(files[i]));
+                textures[i].ImportSettings.Sources.Add(files[i]);
+            }
+
+            var (results, _) = ContentToolsAPI.ImportBatch(textures);
+            for (int i = 0; i < textures.Count; ++i)
+            {
+                try
+                {
+                    succeeded[i] = textures[i].SetImportResult(results[i], files[i]);
+                }
+                catch (Exception ex)
+                {
+                    Debug.WriteLine(ex.Message);
+                    Logger.Log(MessageType.Error, $"Failed to read {files[i]} for import");
+                }
+            }
+
+            return succeeded;
+        }
+
+        private bool SetImportResult((List<List<List<Slice>>> slices, Slice icon) result, string file)
+        {
+            var (slices, icon) = result;
+            if (slices?.Any() == true && slices.First().Any() && slices.First().First().Any())
+                Slices = slices;
+            else return false;
+
+            var first_mip = Slices[0][0][0];
+            if (!HasValidDimensions(first_mip.Width, first_mip.Height, ArraySize, IsVolumeMap, file)) return false;
+
+            if (icon == null)
+            {
+                Debug.Assert(!ImportSettings.Compress);
+                icon = first_mip;
+            }
+
+            Icon = BitmapHelper.CreateThumbnail(BitmapHelper.ImageFromSlice(icon, IsNormalMap), ContentInfo.IconWidth, ContentInfo.IconWidth);
+
+            return true;
+        }
+
         public override bool Load(string file)
         {
             Debug.Assert(File.Exists(file));
@@ -571,7 +608,7 @@ namespace Editor.Content
 
         public override byte[] PackForEngine()
         {
-            throw new NotImplementedException();
+            return ContentToolsAPI.PackForEngine(this);
         }
 
         public override IEnumerable<string> Save(string file)
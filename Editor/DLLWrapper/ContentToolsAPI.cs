@@ -48,6 +48,9 @@ namespace Editor.ContentToolsAPIStructs
         public byte ImportEmbededTextures = 1;
         public byte ImportAnimations = 1;
         public byte CoalesceMeshes = 0;
+        public byte QuantizePositions = 0;
+        public byte StaticBatching = 0;
+        public float BatchCellSize = 32f;
 
         private byte ToByte(bool val) => val ? (byte)1 : (byte)0;
 
@@ -62,6 +65,9 @@ namespace Editor.ContentToolsAPIStructs
             ImportEmbededTextures = ToByte(settings.ImportEmbededTextures);
             ImportAnimations = ToByte(settings.ImportAnimations);
             CoalesceMeshes = ToByte(settings.CoalesceMeshes);
+            QuantizePositions = ToByte(settings.QuantizePositions);
+            StaticBatching = ToByte(settings.StaticBatching);
+            BatchCellSize = settings.BatchCellSize;
         }
     }
 
@@ -118,6 +124,74 @@ namespace Editor.ContentToolsAPIStructs
         }
     }
 
+    [StructLayout(LayoutKind.Sequential)]
+    class AtlasData : IDisposable
+    {
+        public IntPtr Images; // x, y, width, height per source, see Zetta::Tools::Atlas::Rect
+        public IntPtr UVTransforms; // scale u, scale v, offset u, offset v per source
+        public int Width;
+        public int Height;
+        public int MaxSize = 8192;
+        public int Padding = 1;
+
+        public void Dispose()
+        {
+            Marshal.FreeCoTaskMem(Images);
+            Marshal.FreeCoTaskMem(UVTransforms);
+            GC.SuppressFinalize(this);
+        }
+
+        ~AtlasData()
+        {
+            Dispose();
+        }
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    class EnvironmentData
+    {
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 9)]
+        public Vector3[] Irradiance = new Vector3[9]; // L2 SH, see Zetta::Tools::EnvironmentMap::IrradianceSH
+        public int SampleCount; // GGX samples per texel, 0 for the default
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    class DecompressRequest
+    {
+        public int Mip;
+        public int ArraySlice; // or depth slice of volume maps
+        public int ChannelMask = 0xf; // r = 1, g = 2, b = 4, a = 8
+        public int MaxSize; // largest width and height of the result, 0 for the size of the mip
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    class BatchImportSettings
+    {
+        public ulong MemoryBudget = 1024ul * 1024 * 1024; // bytes of images in the pipeline, 0 for no limit
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 4)]
+        public int[] ThreadCounts = new int[4]; // decode, mip, compress, pack. 0 picks a default
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    struct BatchStageStats
+    {
+        public int Items;
+        public int Threads;
+        public float BusySeconds;
+        public ulong Bytes;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    class BatchImportStats
+    {
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 4)]
+        public BatchStageStats[] Stages = new BatchStageStats[4];
+        public float Seconds;
+        public ulong PeakMemory;
+        public int CacheHits;
+        public int Failed;
+    }
+
     [StructLayout(LayoutKind.Sequential)]
     class TextureInfo
     {
@@ -141,6 +215,9 @@ namespace Editor.ContentToolsAPIStructs
         public int PreferBC7;
         public int OutputFormat;
         public int Compress;
+        public int CompressionQuality = 1; // normal, see Zetta::Tools::BC::Quality
+        public int MipFilter = 1; // kaiser, see Zetta::Tools::Mips::Filter
+        public int PreserveAlphaCoverage = 1;
 
         public void FromContentSettings(Texture texture)
         {
@@ -168,6 +245,15 @@ namespace Editor.DLLWrapper
         [DllImport(_ToolsDLL)]
         public static extern void ShutdownContentTools();
 
+        [DllImport(_ToolsDLL)]
+        private static extern void ConfigureImportCache(string directory, ulong maxSize);
+        // Imports of unchanged sources with unchanged settings are served from this cache.
+        public static void ConfigureImportCache(string directory, long maxSizeInMB)
+        {
+            Debug.Assert(!string.IsNullOrEmpty(directory) && maxSizeInMB >= 0);
+            ConfigureImportCache(directory, (ulong)maxSizeInMB * 1024 * 1024);
+        }
+
         #region Geometry
         private static void GeometryFromSceneData(Content.Geometry geometry, Action<SceneData> sceneDataGenerator, string failureMessage)
         {
@@ -215,6 +301,22 @@ namespace Editor.DLLWrapper
             GeometryFromSceneData(geometry, (sceneData) => ImportASSIMP(file, sceneData),
                 $"Failed to import using ASSIMP: {file}");
         }
+
+        [DllImport(_ToolsDLL)]
+        private static extern int GeometryBufferBound(int count, int stride, int isIndexBuffer);
+        [DllImport(_ToolsDLL)]
+        private static extern int CompressGeometryBuffer(byte[] data, int count, int stride, int isIndexBuffer, [Out] byte[] output, int outputSize);
+        public static byte[] CompressGeometryBuffer(byte[] data, int count, int stride, bool isIndexBuffer)
+        {
+            Debug.Assert(data?.Length > 0 && stride > 0);
+            var isIndex = isIndexBuffer ? 1 : 0;
+            var output = new byte[GeometryBufferBound(count, stride, isIndex)];
+            var size = CompressGeometryBuffer(data, count, stride, isIndex, output, output.Length);
+            if (size == 0) return null;
+
+            Array.Resize(ref output, size);
+            return output;
+        }
         #endregion Geometry
 
         #region Texture
@@ -298,7 +400,7 @@ namespace Editor.DLLWrapper
                 for (var j = 0; j < mips; j++)
                 {
                     var mipSlice = new List<Slice>();
-                    for (var k= 0; k < depthPerMip[i]; k++)
+                    for (var k= 0; k < depthPerMip[j]; k++)
                     {
                         var slice = new Slice();
                         slice.Width = reader.ReadInt32();
@@ -347,6 +449,86 @@ namespace Editor.DLLWrapper
             }
         }
 
+        [DllImport(_ToolsDLL)]
+        private static extern void DecompressSubresource([In, Out] TextureData data, DecompressRequest request);
+
+        // Decodes only one mip of one array slice, or one depth slice of a volume map. Only that mip and the smaller
+        // ones are handed to the tools, which pick the mip that fits in maxSize and shrink it the rest of the way.
+        internal static Slice DecompressSubresource(Texture texture, int mip, int arraySlice, int channelMask = 0xf, int maxSize = 0)
+        {
+            Debug.Assert(texture.ImportSettings.Compress);
+            using var textureData = new TextureData();
+
+            try
+            {
+                var isVolumeMap = texture.Flags.HasFlag(TextureFlags.IsVolumeMap);
+                var mips = texture.Slices[isVolumeMap ? 0 : arraySlice].Skip(mip).ToList();
+                Debug.Assert(mips.Any());
+
+                GetTextureDataInfo(texture, textureData);
+                textureData.Info.Width = mips[0][0].Width;
+                textureData.Info.Height = mips[0][0].Height;
+                textureData.Info.ArraySize = isVolumeMap ? mips[0].Count : 1;
+                textureData.Info.MipLevels = mips.Count;
+                textureData.ImportSettings.FromContentSettings(texture);
+                SetSubresourceData(new() { mips }, textureData);
+
+                DecompressSubresource(textureData, new DecompressRequest()
+                {
+                    ArraySlice = isVolumeMap ? arraySlice : 0,
+                    ChannelMask = channelMask,
+                    MaxSize = maxSize,
+                });
+
+                if (textureData.Info.ImportError != 0)
+                {
+                    Logger.Log(MessageType.Error, $"Error: {EnumExtensions.GetDescription((TextureImportError)textureData.Info.ImportError)}");
+                    throw new Exception($"Error while trying to decompress a subresource. Error code {textureData.Info.ImportError}");
+                }
+
+                return GetSlices(textureData).First().First().First();
+            }
+            catch (Exception ex)
+            {
+                Debug.WriteLine(ex.Message);
+                Logger.Log(MessageType.Error, $"Failed to decompress texture: {texture.FileName}");
+                return null;
+            }
+        }
+
+        [DllImport(_ToolsDLL)]
+        private static extern void PackForEngine([In, Out] TextureData data);
+
+        internal static byte[] PackForEngine(Texture texture)
+        {
+            using var textureData = new TextureData();
+
+            try
+            {
+                GetTextureDataInfo(texture, textureData);
+                textureData.ImportSettings.FromContentSettings(texture);
+                SetSubresourceData(texture.Slices, textureData);
+
+                PackForEngine(textureData);
+
+                if (textureData.Info.ImportError != 0)
+                {
+                    Logger.Log(MessageType.Error, $"Error: {EnumExtensions.GetDescription((TextureImportError)textureData.Info.ImportError)}");
+                    throw new Exception($"Error while trying to pack texture. Error code {textureData.Info.ImportError}");
+                }
+
+                var packed = new byte[textureData.SubresourceSize];
+                Marshal.Copy(textureData.SubresourceData, packed, 0, textureData.SubresourceSize);
+                return packed;
+            }
+            catch (Exception ex)
+            {
+                Debug.WriteLine(ex.Message);
+                Logger.Log(MessageType.Error, $"Failed to pack texture for engine: {texture.FileName}");
+                return null;
+            }
+        }
+
         [DllImport(_ToolsDLL)]
         private static extern void Import([In, Out] TextureData data);
 
@@ -377,6 +559,158 @@ namespace Editor.DLLWrapper
             }
         }
 
+        [DllImport(_ToolsDLL)]
+        private static extern void ImportAtlas([In, Out] TextureData data, [In, Out] AtlasData atlas);
+
+        // Packs the texture's sources into an atlas. Passing the rects and size of the previous atlas keeps the
+        // sources that didn't change size where they were. Rects are x, y, width and height per source.
+        internal static (List<List<List<Slice>>> slices, Slice icon, int[] rects, Vector4[] uvTransforms, int width, int height)
+            ImportAtlas(Texture texture, int[] previousRects = null, int previousWidth = 0, int previousHeight = 0)
+        {
+            Debug.Assert(texture.ImportSettings.Sources.Any());
+            using var textureData = new TextureData();
+            using var atlasData = new AtlasData();
+
+            try
+            {
+                textureData.ImportSettings.FromContentSettings(texture);
+
+                var sourceCount = textureData.ImportSettings.SourceCount;
+                var rects = new int[sourceCount * 4];
+                if (previousRects?.Length == rects.Length)
+                {
+                    previousRects.CopyTo(rects, 0);
+                    atlasData.Width = previousWidth;
+                    atlasData.Height = previousHeight;
+                }
+
+                atlasData.Images = Marshal.AllocCoTaskMem(rects.Length * sizeof(int));
+                atlasData.UVTransforms = Marshal.AllocCoTaskMem(sourceCount * 4 * sizeof(float));
+                Marshal.Copy(rects, 0, atlasData.Images, rects.Length);
+
+                ImportAtlas(textureData, atlasData);
+
+                if (textureData.Info.ImportError != 0)
+                {
+                    Logger.Log(MessageType.Error, $"Texture import error: {EnumExtensions.GetDescription((TextureImportError)textureData.Info.ImportError)}");
+                    throw new Exception($"Error while trying to build atlas. Error code: {textureData.Info.ImportError}");
+                }
+
+                var transforms = new float[sourceCount * 4];
+                Marshal.Copy(atlasData.Images, rects, 0, rects.Length);
+                Marshal.Copy(atlasData.UVTransforms, transforms, 0, transforms.Length);
+                var uvTransforms = Enumerable.Range(0, sourceCount)
+                    .Select(i => new Vector4(transforms[i * 4], transforms[i * 4 + 1], transforms[i * 4 + 2], transforms[i * 4 + 3]))
+                    .ToArray();
+
+                GetTextureInfo(texture, textureData);
+                return (GetSlices(textureData), GetIcon(textureData), rects, uvTransforms, atlasData.Width, atlasData.Height);
+            }
+            catch (Exception ex)
+            {
+                Debug.WriteLine(ex.Message);
+                Logger.Log(MessageType.Error, $"Failed to build atlas for {texture.FileName}");
+                return new();
+            }
+        }
+
+        [DllImport(_ToolsDLL)]
+        private static extern void ImportEnvironmentMap([In, Out] TextureData data, [In, Out] EnvironmentData environment);
+
+        // Imports the texture's 6 sources as a cube map for image based lighting. Mip m of the cube map is prefiltered
+        // for roughness m / (mip count - 1) and the irradiance comes back as 9 spherical harmonics coefficients.
+        internal static (List<List<List<Slice>>> slices, Slice icon, Vector3[] irradiance) ImportEnvironmentMap(Texture texture, int sampleCount = 0)
+        {
+            Debug.Assert(texture.ImportSettings.Sources.Any());
+            using var textureData = new TextureData();
+            var environmentData = new EnvironmentData() { SampleCount = sampleCount };
+
+            try
+            {
+                textureData.ImportSettings.FromContentSettings(texture);
+                ImportEnvironmentMap(textureData, environmentData);
+
+                if (textureData.Info.ImportError != 0)
+                {
+                    Logger.Log(MessageType.Error, $"Texture import error: {EnumExtensions.GetDescription((TextureImportError)textureData.Info.ImportError)}");
+                    throw new Exception($"Error while trying to import environment map. Error code: {textureData.Info.ImportError}");
+                }
+
+                GetTextureInfo(texture, textureData);
+                return (GetSlices(textureData), GetIcon(textureData), environmentData.Irradiance);
+            }
+            catch (Exception ex)
+            {
+                Debug.WriteLine(ex.Message);
+                Logger.Log(MessageType.Error, $"Failed to import environment map from {texture.FileName}");
+                return new();
+            }
+        }
+
+        [DllImport(_ToolsDLL)]
+        private static extern void ImportBatch(IntPtr[] textures, int count, BatchImportSettings settings,
+            [Out] BatchImportStats stats, ProgressionCallback callback);
+
+        // Imports many textures at once. Decoding, mip generation, compression and packing of different textures
+        // run at the same time, each on its own threads. Failed imports get empty slices.
+        internal static (List<(List<List<List<Slice>>> slices, Slice icon)> results, BatchImportStats stats)
+            ImportBatch(IList<Texture> textures, BatchImportSettings settings = null)
+        {
+            Debug.Assert(textures?.Any() == true && textures.All(x => x.ImportSettings.Sources.Any()));
+            var stats = new BatchImportStats();
+            var textureData = textures.Select(x => new TextureData()).ToArray();
+            var pointers = new IntPtr[textures.Count];
+
+            try
+            {
+                for (var i = 0; i < textures.Count; i++)
+                {
+                    textureData[i].ImportSettings.FromContentSettings(textures[i]);
+                    pointers[i] = Marshal.AllocHGlobal(Marshal.SizeOf<TextureData>());
+                    Marshal.StructureToPtr(textureData[i], pointers[i], false);
+                }
+
+                ImportBatch(pointers, pointers.Length, settings ?? new(), stats, null);
+
+                var results = new List<(List<List<List<Slice>>> slices, Slice icon)>();
+                for (var i = 0; i < textures.Count; i++)
+                {
+                    Marshal.PtrToStructure(pointers[i], textureData[i]);
+                    var data = textureData[i];
+                    if (data.Info.ImportError != 0)
+                    {
+                        Logger.Log(MessageType.Error, $"Failed to import {textures[i].FileName}: {EnumExtensions.GetDescription((TextureImportError)data.Info.ImportError)}");
+                        results.Add(new());
+                        continue;
+                    }
+
+                    GetTextureInfo(textures[i], data);
+                    results.Add((GetSlices(data), GetIcon(data)));
+                }
+
+                Logger.Log(MessageType.Info, $"Imported {textures.Count} textures in {stats.Seconds:0.00}s " +
+                    $"({stats.CacheHits} from cache, {stats.Failed} failed, peak memory {stats.PeakMemory / (1024 * 1024)}MB)");
+                return (results, stats);
+            }
+            catch (Exception ex)
+            {
+                Debug.WriteLine(ex.Message);
+                Logger.Log(MessageType.Error, $"Failed to import {textures.Count} textures");
+                return (textures.Select(x => (slices: new List<List<List<Slice>>>(), icon: (Slice)null)).ToList(), stats);
+            }
+            finally
+            {
+                for (var i = 0; i < pointers.Length; i++)
+                {
+                    if (pointers[i] == IntPtr.Zero) continue;
+                    // The subresources and icons are owned by the TextureData objects once read back.
+                    Marshal.DestroyStructure<TextureData>(pointers[i]);
+                    Marshal.FreeHGlobal(pointers[i]);
+                }
+                foreach (var data in textureData) data.Dispose();
+            }
+        }
+
         public static byte[] SlicesToBinary(List<List<List<Slice>>> slices)
         {
             Debug.Assert(slices?.Any() == true && slices.First()?.Any() == true);
@@ -204,9 +204,20 @@ namespace Editor.Editors
 				using (var reader = new BinaryReader(new MemoryStream(mesh.Positions)))
 					for (int i = 0; i < mesh.VertexCount; i++)
 					{
-						var posX = reader.ReadSingle();
-						var posY = reader.ReadSingle();
-						var posZ = reader.ReadSingle();
+						double posX, posY, posZ;
+						if (mesh.PositionFormat == PositionFormat.Unorm16x3)
+						{
+							posX = mesh.PositionBias.X + mesh.PositionScale.X * reader.ReadUInt16();
+							posY = mesh.PositionBias.Y + mesh.PositionScale.Y * reader.ReadUInt16();
+							posZ = mesh.PositionBias.Z + mesh.PositionScale.Z * reader.ReadUInt16();
+							reader.BaseStream.Position += sizeof(ushort); // skip padding
+						}
+						else
+						{
+							posX = reader.ReadSingle();
+							posY = reader.ReadSingle();
+							posZ = reader.ReadSingle();
+						}
 						vertexData.Positions.Add(new Point3D(posX, posY, posZ));
 
 						minX = Math.Min(minX, posX); maxX = Math.Max(maxX, posX);
@@ -17,8 +17,12 @@ namespace Editor.Editors
 {
     class TextureEditor : ViewModelBase, IAssetEditor
     {
-        private readonly List<List<List<BitmapSource>>> _sliceBitmaps = new();
+        // Bitmaps of the subresources that were looked at, by array, mip and depth index. Compressed textures are
+        // decoded one subresource at a time when it is first selected.
+        private readonly Dictionary<(int, int, int), BitmapSource> _sliceBitmaps = new();
         private List<List<List<Slice>>> _slices;
+        private Texture _decodedTexture;
+        private bool _isNormalMap;
 
         public ICommand SetAllChannelsCommand { get; init; }
         public ICommand SetChannelCommand { get; init; }
@@ -128,10 +132,9 @@ namespace Editor.Editors
             }
         }
 
-        public int MaxMipIndex => _sliceBitmaps.Any() && _sliceBitmaps.First().Any() ? _sliceBitmaps.First().Count() - 1 : 0;
-        public int MaxArrayIndex => _sliceBitmaps.Any() ? _sliceBitmaps.Count - 1 : 0;
-        public int MaxDepthIndex => _sliceBitmaps.Any() && _sliceBitmaps.First().Any() && _sliceBitmaps.First().First().Any() ?
-            _sliceBitmaps.ElementAtOrDefault(ArrayIndex).ElementAtOrDefault(MipIndex).Count - 1 : 0;
+        public int MaxMipIndex => _slices?.Any() == true && _slices.First().Any() ? _slices.First().Count - 1 : 0;
+        public int MaxArrayIndex => _slices?.Any() == true ? _slices.Count - 1 : 0;
+        public int MaxDepthIndex => _slices?.ElementAtOrDefault(ArrayIndex)?.ElementAtOrDefault(MipIndex)?.Count - 1 ?? 0;
 
 
         private int _ArrayIndex;
@@ -187,7 +190,7 @@ namespace Editor.Editors
             }
         }
 
-        public BitmapSource SelectedSliceBitmap => _sliceBitmaps?.ElementAtOrDefault(ArrayIndex)?.ElementAtOrDefault(MipIndex)?.ElementAtOrDefault(DepthIndex);
+        public BitmapSource SelectedSliceBitmap => GetSliceBitmap(ArrayIndex, MipIndex, DepthIndex);
         public Slice SelectedSlice => Texture?.Slices?.ElementAtOrDefault(ArrayIndex)?.ElementAtOrDefault(MipIndex)?.ElementAtOrDefault(DepthIndex);
         public long DataSize => Texture?.Slices?.Sum(x => x.Sum(y => y.Sum(z => z.RawData.LongLength))) ?? 0;
 
@@ -280,9 +283,14 @@ namespace Editor.Editors
         {
             try
             {
-                await Task.Run(() => _slices = texture.ImportSettings.Compress ? ContentToolsAPI.Decompress(texture) : texture.Slices);
+                _slices = texture.Slices;
+                _decodedTexture = texture;
                 Debug.Assert(_slices?.Any() == true && _slices.First()?.Any() == true);
                 GenerateSliceBitmaps(texture.IsNormalMap);
+
+                // Only the first subresource is decoded up front, so opening a large texture doesn't wait for the rest.
+                var bitmap = await Task.Run(() => CreateSliceBitmap(0, 0, 0));
+                if (bitmap != null) _sliceBitmaps[(0, 0, 0)] = bitmap;
                 OnPropertyChanged(nameof(Texture));
                 OnPropertyChanged(nameof(DataSize));
             }
@@ -293,25 +301,35 @@ namespace Editor.Editors
             }
         }
 
-        private void GenerateSliceBitmaps(bool isNormalMap)
+        private BitmapSource CreateSliceBitmap(int arrayIndex, int mipIndex, int depthIndex)
         {
-            _sliceBitmaps.Clear();
-            foreach(var arraySlice in _slices)
+            var texture = _decodedTexture;
+            var slice = texture?.ImportSettings.Compress == true ?
+                ContentToolsAPI.DecompressSubresource(texture, mipIndex, texture.Flags.HasFlag(TextureFlags.IsVolumeMap) ? depthIndex : arrayIndex) :
+                _slices?.ElementAtOrDefault(arrayIndex)?.ElementAtOrDefault(mipIndex)?.ElementAtOrDefault(depthIndex);
+            if (slice == null) return null;
+
+            var image = BitmapHelper.ImageFromSlice(slice, _isNormalMap);
+            Debug.Assert(image != null);
+            image?.Freeze();
+            return image;
+        }
+
+        private BitmapSource GetSliceBitmap(int arrayIndex, int mipIndex, int depthIndex)
+        {
+            if (_slices == null) return null;
+            if (!_sliceBitmaps.TryGetValue((arrayIndex, mipIndex, depthIndex), out var bitmap))
             {
-                List<List<BitmapSource>> mipmapBitmaps = new();
-                foreach(var mipSlice in arraySlice)
-                {
-                    List<BitmapSource> sliceBitmaps = new();
-                    foreach (var slice in mipSlice)
-                    {
-                        var image = BitmapHelper.ImageFromSlice(slice, isNormalMap);
-                        Debug.Assert(image != null);
-                        sliceBitmaps.Add(image);
-                    }
-                    mipmapBitmaps.Add(sliceBitmaps);
-                }
-                _sliceBitmaps.Add(mipmapBitmaps);
+                bitmap = CreateSliceBitmap(arrayIndex, mipIndex, depthIndex);
+                if (bitmap != null) _sliceBitmaps[(arrayIndex, mipIndex, depthIndex)] = bitmap;
             }
+            return bitmap;
+        }
+
+        private void GenerateSliceBitmaps(bool isNormalMap)
+        {
+            _isNormalMap = isNormalMap;
+            _sliceBitmaps.Clear();
             OnPropertyChanged(nameof(MaxMipIndex));
             OnPropertyChanged(nameof(MaxArrayIndex));
             OnPropertyChanged(nameof(MaxDepthIndex));
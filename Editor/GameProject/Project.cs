@@ -32,6 +32,7 @@ namespace Editor.GameProject
         public string Solution => $@"{Path}{Name}\{Name}.sln";
         public string ContentPath => $@"{Path}{Name}\Content\";
         public string TempFolder => $@"{Path}{Name}\.zetta\Temp\";
+        public string ImportCacheFolder => $@"{Path}{Name}\.zetta\ImportCache\";
 
         private int _BuildConfig;
         [DataMember]
@@ -181,19 +182,49 @@ namespace Editor.GameProject
             var configName = VisualStudio.GetConfigurationName(StandAloneBuildConfiguration);
             var bin = $@"{Path}{Name}\x64\{configName}\game.bin";
 
+            // Layout is described in ContentLoader.cpp in the engine: a header, a section table and one
+            // section per component type, with the components of all entities stored contiguously.
+            const uint sceneMagic = 'Z' | ('S' << 8) | ('C' << 16) | ('N' << 24);
+            const uint sceneVersion = 1;
+            const int headerSize = 16;
+            const int sectionSize = 24;
+
+            var entities = ActiveScene.GameEntities;
+            var transforms = entities.Select(x => x.GetComponent<Transform>()).ToList();
+            var scripts = entities.Select((x, i) => (script: x.GetComponent<Script>(), index: i)).Where(x => x.script != null).ToList();
+            Debug.Assert(transforms.All(x => x != null));
+
             using (var bw = new BinaryWriter(File.Open(bin, FileMode.Create, FileAccess.Write)))
             {
-                bw.Write(ActiveScene.GameEntities.Count);
-                foreach (var entity in ActiveScene.GameEntities)
+                var transformSize = 9L * sizeof(float) * entities.Count;
+                var scriptSize = (long)(sizeof(ulong) + sizeof(uint)) * scripts.Count;
+                var transformOffset = headerSize + 2 * sectionSize;
+
+                bw.Write(sceneMagic);
+                bw.Write(sceneVersion);
+                bw.Write(entities.Count);
+                bw.Write(2); // section count
+
+                bw.Write((int)ComponentType.Transform);
+                bw.Write(entities.Count);
+                bw.Write((long)transformOffset);
+                bw.Write(transformSize);
+
+                bw.Write((int)ComponentType.Script);
+                bw.Write(scripts.Count);
+                bw.Write(transformOffset + transformSize);
+                bw.Write(scriptSize);
+
+                // position, rotation and scale are written as 9 separate streams of x, y and z values
+                foreach (var select in new Func<Transform, System.Numerics.Vector3>[] { x => x.Position, x => x.Rotation, x => x.Scale })
                 {
-                    bw.Write(0); // entity type (reserved for later)
-                    bw.Write(entity.Components.Count);
-                    foreach(var component in entity.Components)
-                    {
-                        bw.Write((int)component.ToEnumType());
-                        component.WriteToBinary(bw);
-                    }
+                    foreach (var transform in transforms) bw.Write(select(transform).X);
+                    foreach (var transform in transforms) bw.Write(select(transform).Y);
+                    foreach (var transform in transforms) bw.Write(select(transform).Z);
                 }
+
+                foreach (var script in scripts) bw.Write(script.script.GetScriptID());
+                foreach (var script in scripts) bw.Write(script.index);
             }
         }
 
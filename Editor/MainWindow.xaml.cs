@@ -20,6 +20,8 @@ namespace Editor
     /// </summary>
     public partial class MainWindow : Window
     {
+        private const long _importCacheSizeInMB = 4096;
+
         public MainWindow()
         {
             InitializeComponent();
@@ -81,6 +83,7 @@ namespace Editor
                 var project = projectBrowser.DataContext as Project;
                 Debug.Assert(project != null);
                 ContentWatcher.Reset(project.ContentPath, $@"{project.Path}{project.Name}\");
+                ContentToolsAPI.ConfigureImportCache(project.ImportCacheFolder, _importCacheSizeInMB);
                 DataContext = project;
             }           
         }
@@ -47,6 +47,27 @@ namespace Zetta::GameEntity {
 		return newEntity;
 	}
 
+	bool CreateGameEntities(const EntityInfo* const infos, u32 count, Entity* const entities) {
+		assert(infos && count && entities);
+		const u64 recycled_ids{ free_ids.size() > ID::Minimum_Deleted_Elements ? free_ids.size() - ID::Minimum_Deleted_Elements : 0 };
+		const u64 new_ids{ count - std::min<u64>(count, recycled_ids) };
+		if (new_ids) {
+			const u64 capacity{ generations.size() + new_ids };
+			generations.reserve(capacity);
+			transforms.reserve(capacity);
+			scripts.reserve(capacity);
+			Transform::Reserve((u32)capacity);
+		}
+
+		bool result{ true };
+		for (u32 i{ 0 }; i < count; i++) {
+			entities[i] = CreateGameEntity(infos[i]);
+			result &= entities[i].IsValid();
+		}
+
+		return result;
+	}
+
 	void RemoveGameEntity(EntityID id) {
 		const ID::ID_Type index{ ID::Index(id) };
 		assert(IsAlive(id));
@@ -15,6 +15,9 @@ namespace Zetta {
 		};
 
 		Entity CreateGameEntity(const EntityInfo& info);
+		// Creates many entities at once, growing the component arrays only once. Writes an invalid
+		// entity for each one that couldn't be created and returns false if there were any.
+		bool CreateGameEntities(const EntityInfo* const infos, u32 count, Entity* const entities);
 		void RemoveGameEntity(EntityID id);
 		bool IsAlive(EntityID id);
 	}
@@ -133,6 +133,11 @@ namespace Zetta::Script {
 		id_mapping[ID::Index(id)] = ID::Invalid_ID;
 	}
 
+	Detail::ScriptCreator FindScriptCreator(size_t tag) {
+		const auto script{ Registry().find(tag) };
+		return script != Registry().end() ? script->second : nullptr;
+	}
+
 	void Update(float dt) {
 		for (auto& ptr : entity_scripts) ptr->Update(dt);
 		if (transform_cache.size()) {
@@ -10,5 +10,7 @@ namespace Zetta::Script {
 	Component CreateScript(const InitInfo& info, GameEntity::Entity EntityID);
 	void RemoveScript(Component c);
 	void Update(float dt);
+	// Returns nullptr if no script with this id is registered, e.g. for a script id read from a scene file.
+	[[nodiscard]] Detail::ScriptCreator FindScriptCreator(size_t tag);
 	
 }
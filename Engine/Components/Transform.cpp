@@ -104,6 +104,17 @@ namespace Zetta::Transform {
 
 	}
 
+	void Reserve(u32 capacity) {
+		to_world.reserve(capacity);
+		inv_world.reserve(capacity);
+		positions.reserve(capacity);
+		orientations.reserve(capacity);
+		rotations.reserve(capacity);
+		scales.reserve(capacity);
+		has_transform.reserve(capacity);
+		changes_from_previous_frame.reserve(capacity);
+	}
+
 	void GetTransformMatrices(const GameEntity::EntityID id, Math::mat4& world, Math::mat4& inverse_world) {
 		assert(GameEntity::Entity{ id }.IsValid());
 
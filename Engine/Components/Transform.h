@@ -31,6 +31,7 @@ namespace Zetta::Transform {
 
 	Component CreateTransform(const InitInfo& info, GameEntity::Entity EntityID);
 	void RemoveTransform(Component c);
+	void Reserve(u32 capacity);
 	void GetTransformMatrices(const GameEntity::EntityID id, Math::mat4& world, Math::mat4& inverse_world);
 	void GetUpdatedComponentFlags(const GameEntity::EntityID* const id, u32 count, u8* const flags);
 	void Update(const ComponentCache* const cache, u32 count);
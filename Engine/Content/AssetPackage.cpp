@@ -0,0 +1,190 @@
+#include "AssetPackage.h"
+#include "LZCodec.h"
+#include <condition_variable>
+
+#if defined(_WIN64)
+#include <Windows.h>
+
+namespace Zetta::Content::Package {
+	namespace {
+		struct MountedPackage {
+			HANDLE					file{ INVALID_HANDLE_VALUE };
+			HANDLE					mapping{ nullptr };
+			const u8*				view{ nullptr };
+			const PackageHeader*	header{ nullptr };
+			const BlockEntry*		blocks{ nullptr };
+			const TOCEntry*			toc{ nullptr };
+			u32						reader_count{ 0 };	// reads decompressing from the view, see Read()
+		};
+
+		util::FreeList<MountedPackage> packages;
+		// Ids of the mounted packages, most recently mounted last.
+		util::vector<ID::ID_Type> mount_order;
+		std::mutex package_mutex;
+		std::condition_variable package_released;
+
+		void Release(MountedPackage& package) {
+			if (package.view) UnmapViewOfFile(package.view);
+			if (package.mapping) CloseHandle(package.mapping);
+			if (package.file != INVALID_HANDLE_VALUE) CloseHandle(package.file);
+			package = {};
+		}
+
+		[[nodiscard]] bool Validate(const MountedPackage& package, u64 file_size) {
+			const PackageHeader& header{ *package.header };
+			if (file_size < sizeof(PackageHeader) || header.magic != package_magic || header.version != package_version ||
+				header.block_size != block_size || !header.toc_slot_count || (header.toc_slot_count & (header.toc_slot_count - 1)))
+				return false;
+
+			const u64 block_table_end{ header.block_table_offset + sizeof(BlockEntry) * (u64)header.block_count };
+			const u64 toc_end{ header.toc_offset + sizeof(TOCEntry) * (u64)header.toc_slot_count };
+			if (block_table_end > file_size || toc_end > file_size) return false;
+			if (header.data_size > (u64)header.block_count * block_size) return false;
+
+			// Every block but the last is full and together they hold exactly data_size bytes, which Read() relies on.
+			for (u32 i{ 0 }; i < header.block_count; i++) {
+				const BlockEntry& block{ package.blocks[i] };
+				const u64 block_start{ (u64)i * block_size };
+				const u64 expected_size{ std::min<u64>(block_size, header.data_size - std::min(header.data_size, block_start)) };
+				if (block.offset + block.compressed_size > file_size || block.size != expected_size || !block.size) return false;
+			}
+
+			return true;
+		}
+
+		// NOTE: expects package_mutex to be locked. A table of contents without empty slots is probed only once.
+		[[nodiscard]] const TOCEntry* Find(const MountedPackage& package, AssetID id) {
+			const u32 mask{ package.header->toc_slot_count - 1 };
+			for (u32 i{ 0 }, slot{ (u32)id & mask }; i <= mask; i++, slot = (slot + 1) & mask) {
+				const TOCEntry& entry{ package.toc[slot] };
+				if (entry.id == id) return &entry;
+				if (!entry.id) return nullptr;
+			}
+			return nullptr;
+		}
+
+		// Decompresses the part of block 'index' that overlaps [offset, offset + size) of the data stream.
+		[[nodiscard]] bool DecompressBlock(const MountedPackage& package, u32 index, u64 offset, u64 size, u8* const dst, u8* const scratch) {
+			const BlockEntry& block{ package.blocks[index] };
+			const u64 block_start{ (u64)index * block_size };
+			const u64 start{ std::max(offset, block_start) };
+			const u64 end{ std::min(offset + size, block_start + block.size) };
+			const u8* const src{ package.view + block.offset };
+			u8* const out{ dst + (start - offset) };
+
+			if (block.compressed_size == block.size) {
+				memcpy(out, src + (start - block_start), end - start);
+				return true;
+			}
+
+			// Blocks that are fully covered by the asset are decompressed in place.
+			if (start == block_start && end == block_start + block.size)
+				return LZ::Decompress(out, block.size, src, block.compressed_size);
+
+			if (!LZ::Decompress(scratch, block.size, src, block.compressed_size)) return false;
+			memcpy(out, scratch + (start - block_start), end - start);
+			return true;
+		}
+
+		[[nodiscard]] bool DecompressBlocks(const MountedPackage& package, u32 first, u32 last, u64 offset, u64 size, u8* const dst) {
+			std::unique_ptr<u8[]> scratch{ std::make_unique<u8[]>(block_size) };
+			bool result{ true };
+			for (u32 i{ first }; i < last && result; i++)
+				result = DecompressBlock(package, i, offset, size, dst, scratch.get());
+			return result;
+		}
+	} // anonymous namespace
+
+	ID::ID_Type Mount(const char* path) {
+		assert(path);
+		MountedPackage package{};
+		package.file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (package.file == INVALID_HANDLE_VALUE) return ID::Invalid_ID;
+
+		LARGE_INTEGER file_size{};
+		if (!GetFileSizeEx(package.file, &file_size) || (u64)file_size.QuadPart < sizeof(PackageHeader)) {
+			Release(package);
+			return ID::Invalid_ID;
+		}
+
+		package.mapping = CreateFileMappingA(package.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		package.view = package.mapping ? (const u8*)MapViewOfFile(package.mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (!package.view) {
+			Release(package);
+			return ID::Invalid_ID;
+		}
+
+		package.header = (const PackageHeader*)package.view;
+		package.blocks = (const BlockEntry*)(package.view + package.header->block_table_offset);
+		package.toc = (const TOCEntry*)(package.view + package.header->toc_offset);
+		if (!Validate(package, (u64)file_size.QuadPart)) {
+			Release(package);
+			return ID::Invalid_ID;
+		}
+
+		std::lock_guard lock{ package_mutex };
+		const ID::ID_Type id{ packages.Add(package) };
+		mount_order.emplace_back(id);
+		return id;
+	}
+
+	void Unmount(ID::ID_Type id) {
+		assert(ID::IsValid(id));
+		std::unique_lock lock{ package_mutex };
+		for (u32 i{ 0 }; i < mount_order.size(); i++) {
+			if (mount_order[i] == id) {
+				mount_order.erase(i);
+				break;
+			}
+		}
+
+		// NOTE: new reads can't find the package anymore, but the ones already decompressing keep its view.
+		package_released.wait(lock, [id] { return !packages[id].reader_count; });
+		Release(packages[id]);
+		packages.Remove(id);
+	}
+
+	bool Contains(AssetID id) {
+		std::lock_guard lock{ package_mutex };
+		for (ID::ID_Type package_id : mount_order)
+			if (Find(packages[package_id], id)) return true;
+		return false;
+	}
+
+	bool Read(AssetID id, std::unique_ptr<u8[]>& data, u64& size) {
+		// Only the lookup takes the lock. The package is pinned with its reader count and copied, because
+		// mounting another package may move the entries of 'packages'.
+		ID::ID_Type package_id{ ID::Invalid_ID };
+		MountedPackage package{};
+		TOCEntry entry{};
+		{
+			std::lock_guard lock{ package_mutex };
+			for (u32 i{ mount_order.size() }; i > 0 && !ID::IsValid(package_id); i--) {
+				const TOCEntry* const found{ Find(packages[mount_order[i - 1]], id) };
+				if (!found) continue;
+				package_id = mount_order[i - 1];
+				package = packages[package_id];
+				entry = *found;
+			}
+
+			if (!ID::IsValid(package_id) || entry.offset + entry.size > package.header->data_size) return false;
+			packages[package_id].reader_count++;
+		}
+
+		bool result{ true };
+		size = entry.size;
+		if (!size) data.reset();
+		else {
+			// Decompressed on the calling thread. Reads from several threads run in parallel, as blocks are independent.
+			data = std::make_unique<u8[]>(size);
+			const u32 first{ (u32)(entry.offset / block_size) };
+			const u32 last{ (u32)((entry.offset + size - 1) / block_size) + 1 };
+			result = DecompressBlocks(package, first, last, entry.offset, size, data.get());
+		}
+
+		std::lock_guard lock{ package_mutex };
+		if (!--packages[package_id].reader_count) package_released.notify_all();
+		return result;
+	}
+}
+#endif
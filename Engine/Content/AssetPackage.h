@@ -0,0 +1,73 @@
+#pragma once
+#include "CommonHeaders.h"
+
+// Asset packages bundle many small files into one archive, so loading them costs one open and one
+// memory mapping instead of a file open per asset.
+//
+// All assets are concatenated into one data stream that is cut into 64KB blocks. Each block is
+// compressed independently (see LZCodec.h) and starts at a package_alignment boundary, so blocks can
+// be memory mapped, read with unbuffered I/O and decompressed in parallel. Assets are found through
+// a hashed table of contents (open addressing, linear probing) keyed by their asset id.
+//
+// File layout:
+//     PackageHeader header                (padded to package_alignment)
+//     BlockEntry blocks[block_count]       (padded to package_alignment)
+//     TOCEntry toc[toc_slot_count]         (padded to package_alignment)
+//     compressed blocks, each padded to package_alignment
+namespace Zetta::Content::Package {
+	using AssetID = u64;
+
+	constexpr u32 package_magic{ 'Z' | ('P' << 8) | ('A' << 16) | ('K' << 24) };
+	constexpr u32 package_version{ 1 };
+	constexpr u32 block_size{ 64 * 1024 };
+	constexpr u32 package_alignment{ 4096 };
+
+	struct PackageHeader {
+		u32 magic;
+		u32 version;
+		u32 block_size;
+		u32 block_count;
+		u32 asset_count;
+		u32 toc_slot_count;		// power of 2
+		u64 block_table_offset;
+		u64 toc_offset;
+		u64 data_size;			// uncompressed size of all assets
+	};
+
+	struct BlockEntry {
+		u64 offset;				// file offset of the block
+		u32 compressed_size;	// equals size if the block is stored uncompressed
+		u32 size;
+	};
+
+	struct TOCEntry {
+		AssetID id;				// 0 marks an empty slot
+		u64 offset;				// offset of the asset in the uncompressed data stream
+		u64 size;
+	};
+
+	// The asset id is a 64-bit FNV-1a hash of the path relative to the packed directory. Paths are
+	// case-insensitive, both slashes are accepted and a leading "./" is ignored.
+	[[nodiscard]] constexpr AssetID AssetIDFromPath(const char* path) {
+		assert(path);
+		if (path[0] == '.' && (path[1] == '/' || path[1] == '\\')) path += 2;
+		u64 hash{ 0xcbf29ce484222325ull };
+		for (; *path; path++) {
+			char c{ *path };
+			if (c == '\\') c = '/';
+			else if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+			hash = (hash ^ (u8)c) * 0x100000001b3ull;
+		}
+		return hash ? hash : 1;
+	}
+
+	// Mounts the package at 'path'. Packages mounted later take precedence over earlier ones.
+	// Returns ID::Invalid_ID if the file isn't a valid package.
+	[[nodiscard]] ID::ID_Type Mount(const char* path);
+	void Unmount(ID::ID_Type id);
+	[[nodiscard]] bool Contains(AssetID id);
+	// Reads and decompresses an asset from the mounted packages on the calling thread. Only the lookup
+	// is serialized, so several threads can decompress at once.
+	// NOTE: Unmount() waits for the reads of the package to finish.
+	[[nodiscard]] bool Read(AssetID id, std::unique_ptr<u8[]>& data, u64& size);
+}
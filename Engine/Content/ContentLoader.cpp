@@ -1,4 +1,5 @@
 #include "ContentLoader.h"
+#include "AssetPackage.h"
 
 #include "Components/Entity.h"
 #include "Components/Transform.h"
@@ -8,61 +9,138 @@
 #if !defined(SHIPPING) && defined(_WIN64)
 #include <fstream>
 #include <filesystem>
+#include <thread>
 #include <Windows.h>
 
 namespace Zetta::Content {
 	namespace {
-		enum ComponentType {
-			Transform,
-			Script,
+		// game.bin starts with a SceneHeader, followed by section_count SceneSections and their data.
+		// Each section holds one kind of component for all entities, so it's converted in one go.
+		// NOTE: written by Project.SaveToBinary() in the editor. Bump scene_version when the layout changes.
+		constexpr u32 scene_magic{ 'Z' | ('S' << 8) | ('C' << 16) | ('N' << 24) };
+		constexpr u32 scene_version{ 1 };
+
+		struct SceneHeader {
+			u32 magic;
+			u32 version;
+			u32 entity_count;
+			u32 section_count;
+		};
+
+		struct SceneSectionType {
+			enum Type : u32 {
+				// 9 streams of entity_count f32: position x, y, z, rotation x, y, z (Euler angles in radians)
+				// and scale x, y, z. count is entity_count.
+				Transform,
+				// count script ids (Script::Detail::StringHash of the script name), then count u32 entity indices.
+				Script,
 
-			count
+				count
+			};
 		};
 
+		struct SceneSection {
+			u32 type;
+			u32 count;
+			u64 offset;		// from the start of the file
+			u64 size;
+		};
+
+		// Entities converted per thread, below this it's not worth starting a thread.
+		constexpr u32 min_transforms_per_thread{ 16 * 1024 };
+		constexpr u32 transform_stream_count{ 9 };
+		constexpr const char* game_package_path{ "game.pak" };
+
 		util::vector<GameEntity::Entity> entities;
-		Transform::InitInfo transform_info{};
-		Script::InitInfo script_info{};
+		ID::ID_Type game_package_id{ ID::Invalid_ID };
 
-		bool ReadTransform(const u8*& data, GameEntity::EntityInfo& info) {
+		// Converts transforms [begin, end) four at a time: the scene streams are already laid out
+		// as one entity per SIMD lane, so Euler angles turn into quaternions without any shuffling.
+		void ConvertTransforms(const f32* const streams, u32 entity_count, u32 begin, u32 end, Transform::InitInfo* const infos) {
 			using namespace DirectX;
-			f32 rotation[3];
-
-			assert(!info.transform);
-			memcpy(&transform_info.position[0], data, sizeof(transform_info.position)); data += sizeof(transform_info.position);
-			memcpy(&rotation[0], data, sizeof(rotation)); data += sizeof(rotation);
-			memcpy(&transform_info.scale[0], data, sizeof(transform_info.scale)); data += sizeof(transform_info.scale);
+			for (u32 i{ begin }; i < end; i += 4) {
+				const u32 count{ std::min(end - i, 4u) };
+				XMVECTOR v[transform_stream_count];
+				for (u32 stream{ 0 }; stream < transform_stream_count; stream++) {
+					const f32* const values{ &streams[(u64)stream * entity_count + i] };
+					if (count == 4) {
+						v[stream] = XMLoadFloat4((const XMFLOAT4*)values);
+					}
+					else {
+						XMFLOAT4 tail{};
+						memcpy(&tail, values, count * sizeof(f32));
+						v[stream] = XMLoadFloat4(&tail);
+					}
+				}
+
+				// Same as XMQuaternionRotationRollPitchYaw() with pitch = x, yaw = y and roll = z.
+				XMVECTOR sp, cp, sy, cy, sr, cr;
+				XMVectorSinCos(&sp, &cp, XMVectorScale(v[3], 0.5f));
+				XMVectorSinCos(&sy, &cy, XMVectorScale(v[4], 0.5f));
+				XMVectorSinCos(&sr, &cr, XMVectorScale(v[5], 0.5f));
+				const XMVECTOR sp_cy{ XMVectorMultiply(sp, cy) };
+				const XMVECTOR cp_sy{ XMVectorMultiply(cp, sy) };
+				const XMVECTOR cp_cy{ XMVectorMultiply(cp, cy) };
+				const XMVECTOR sp_sy{ XMVectorMultiply(sp, sy) };
+				const XMMATRIX rotations{ XMMatrixTranspose(XMMATRIX{
+					XMVectorMultiplyAdd(sp_cy, cr, XMVectorMultiply(cp_sy, sr)),
+					XMVectorNegativeMultiplySubtract(sp_cy, sr, XMVectorMultiply(cp_sy, cr)),
+					XMVectorNegativeMultiplySubtract(sp_sy, cr, XMVectorMultiply(cp_cy, sr)),
+					XMVectorMultiplyAdd(sp_sy, sr, XMVectorMultiply(cp_cy, cr)) }) };
+				const XMMATRIX positions{ XMMatrixTranspose(XMMATRIX{ v[0], v[1], v[2], XMVectorZero() }) };
+				const XMMATRIX scales{ XMMatrixTranspose(XMMATRIX{ v[6], v[7], v[8], XMVectorZero() }) };
+
+				for (u32 lane{ 0 }; lane < count; lane++) {
+					Transform::InitInfo& info{ infos[i + lane] };
+					XMStoreFloat3((XMFLOAT3*)&info.position[0], positions.r[lane]);
+					XMStoreFloat4((XMFLOAT4*)&info.rotation[0], rotations.r[lane]);
+					XMStoreFloat3((XMFLOAT3*)&info.scale[0], scales.r[lane]);
+				}
+			}
+		}
 
-			XMFLOAT3A rot{ &rotation[0] };
-			XMVECTOR quat{ XMQuaternionRotationRollPitchYawFromVector(XMLoadFloat3A(&rot)) };
-			XMFLOAT4A rot_quat{};
-			XMStoreFloat4A(&rot_quat, quat);
-			memcpy(&transform_info.rotation[0], &rot_quat.x, sizeof(transform_info.rotation));
+		bool ReadTransforms(const SceneSection& section, const u8* const data, u32 entity_count, util::vector<Transform::InitInfo>& transforms) {
+			if (section.count != entity_count || section.size != (u64)transform_stream_count * entity_count * sizeof(f32)) return false;
 
-			info.transform = &transform_info;
+			const f32* const streams{ (const f32*)data };
+			const u32 thread_count{ std::clamp(entity_count / min_transforms_per_thread, 1u, std::max(std::thread::hardware_concurrency(), 1u)) };
+			const u32 entities_per_thread{ Math::AlignSizeUp<4>((entity_count + thread_count - 1) / thread_count) };
+			util::vector<std::thread> threads;
+			threads.reserve(thread_count);
+			for (u32 begin{ entities_per_thread }; begin < entity_count; begin += entities_per_thread) {
+				threads.emplace_back(ConvertTransforms, streams, entity_count, begin, std::min(begin + entities_per_thread, entity_count), transforms.data());
+			}
 
+			ConvertTransforms(streams, entity_count, 0, std::min(entities_per_thread, entity_count), transforms.data());
+			for (std::thread& thread : threads) thread.join();
 			return true;
 		}
 
-		bool ReadScript(const u8*& data, GameEntity::EntityInfo& info) {
-			assert(!info.script);
-			const u32 name_length{ *data }; data += sizeof(u32);
-			if (!name_length) return false;
-
-			assert(name_length < 256);
-			char script_name[256]{};
-			memcpy(&script_name[0], data, name_length); data += name_length;
-			script_name[name_length] = 0; // Zero-Terminated C-String
-			script_info.script_creator = Script::Detail::GetScriptCreatorInternal(Script::Detail::StringHash()(script_name));
-			info.script = &script_info;
-			return script_info.script_creator != nullptr;
-		}
+		bool ReadScripts(const SceneSection& section, const u8* const data, u32 entity_count,
+			util::vector<Script::InitInfo>& scripts, util::vector<GameEntity::EntityInfo>& infos) {
+			if (section.size != (u64)section.count * (sizeof(u64) + sizeof(u32))) return false;
+
+			const u8* const indices{ data + (u64)section.count * sizeof(u64) };
+			scripts.resize(section.count);
+			for (u32 i{ 0 }; i < section.count; i++) {
+				u64 script_id;
+				u32 entity_index;
+				memcpy(&script_id, data + i * sizeof(u64), sizeof(u64));
+				memcpy(&entity_index, indices + i * sizeof(u32), sizeof(u32));
+				if (entity_index >= entity_count || infos[entity_index].script) return false;
+
+				scripts[i].script_creator = Script::FindScriptCreator((size_t)script_id);
+				if (!scripts[i].script_creator) return false;
+				infos[entity_index].script = &scripts[i];
+			}
 
-		using ComponentReader = bool(*)(const u8*&, GameEntity::EntityInfo&);
-		ComponentReader component_readers[]{ ReadTransform, ReadScript };
-		static_assert(_countof(component_readers) == ComponentType::count);
+			return true;
+		}
 	}
 
+	// Files are read from the mounted packages first and from disk if no package contains them.
 	bool ReadFile(std::filesystem::path path, std::unique_ptr<u8[]>& data, u64& size) {
+		if (Package::Read(Package::AssetIDFromPath(path.string().c_str()), data, size)) return size != 0;
 		if (!std::filesystem::exists(path)) return false;
 
 		size = std::filesystem::file_size(path);
@@ -77,40 +155,67 @@ namespace Zetta::Content {
 	}
 
 	bool LoadGame() {
-		
+		if (std::filesystem::exists(game_package_path)) {
+			game_package_id = Package::Mount(game_package_path);
+			assert(ID::IsValid(game_package_id));
+		}
+
 		std::unique_ptr<u8[]> game_data{};
 		u64 size{ 0 };
-		if (!ReadFile("game.bin", game_data, size)) return false;
+		if (!ReadFile("game.bin", game_data, size) || size < sizeof(SceneHeader)) return false;
 		assert(game_data.get());
-		const u8* at{ game_data.get() };
-		constexpr u32 su32{ sizeof(u32) };
-		const u32 num_entities{ *at }; at += su32;
-		if (!num_entities) return false;
-
-		for (u32 entity_index{ 0 }; entity_index < num_entities; entity_index++) {
-			GameEntity::EntityInfo info{};
-			/* const u32 entity_type{*at}; */ at += su32;
-			const u32 num_components{ *at }; at += su32;
-			if (!num_components) return false;
-
-			for (u32 component_index{ 0 }; component_index < num_components; component_index++) {
-				const u32 component_type{ *at }; at += su32;
-				assert(component_type < ComponentType::count);
-				if (!component_readers[component_type](at, info)) return false;
-			}
 
-			assert(info.transform);
-			GameEntity::Entity entity{ GameEntity::CreateGameEntity(info) };
-			if (!entity.IsValid()) return false;
-			entities.emplace_back(entity);
+		SceneHeader header;
+		memcpy(&header, game_data.get(), sizeof(SceneHeader));
+		assert(header.magic == scene_magic && header.version == scene_version);
+		if (header.magic != scene_magic || header.version != scene_version || !header.entity_count) return false;
+		if (sizeof(SceneHeader) + (u64)header.section_count * sizeof(SceneSection) > size) return false;
+
+		const u32 entity_count{ header.entity_count };
+		util::vector<Transform::InitInfo> transforms(entity_count);
+		util::vector<Script::InitInfo> scripts;
+		util::vector<GameEntity::EntityInfo> infos(entity_count);
+		bool has_transforms{ false };
+		bool has_scripts{ false };
+
+		for (u32 i{ 0 }; i < header.section_count; i++) {
+			SceneSection section;
+			memcpy(&section, game_data.get() + sizeof(SceneHeader) + i * sizeof(SceneSection), sizeof(SceneSection));
+			if (section.offset > size || section.size > size - section.offset) return false;
+
+			const u8* const data{ game_data.get() + section.offset };
+			switch (section.type) {
+			case SceneSectionType::Transform:
+				if (!ReadTransforms(section, data, entity_count, transforms)) return false;
+				has_transforms = true;
+				break;
+			case SceneSectionType::Script:
+				// NOTE: the entity infos point into scripts, so a second section must not resize it.
+				if (has_scripts || !ReadScripts(section, data, entity_count, scripts, infos)) return false;
+				has_scripts = true;
+				break;
+			default: // unknown sections are skipped, so older engines can load scenes with new component types
+				break;
+			}
 		}
 
-		assert(at == game_data.get() + size);
-		return true;
+		// All game entities must have a transform
+		assert(has_transforms);
+		if (!has_transforms) return false;
+		for (u32 i{ 0 }; i < entity_count; i++) infos[i].transform = &transforms[i];
+
+		const u64 first_entity{ entities.size() };
+		entities.resize(first_entity + entity_count);
+		return GameEntity::CreateGameEntities(infos.data(), entity_count, &entities[first_entity]);
 	}
 
 	void UnloadGame() {
-		for (auto entity : entities) GameEntity::RemoveGameEntity(entity.GetID());
+		for (auto entity : entities) if (entity.IsValid()) GameEntity::RemoveGameEntity(entity.GetID());
+		entities.clear();
+		if (ID::IsValid(game_package_id)) {
+			Package::Unmount(game_package_id);
+			game_package_id = ID::Invalid_ID;
+		}
 	}
 
 
@@ -1,6 +1,10 @@
 #include "ContentToEngine.h"
+#include "GeometryCodec.h"
 #include "Graphics/Renderer.h"
 #include "Utilities/IOStream.h"
+#include <thread>
+#include <condition_variable>
+#include <atomic>
 
 namespace Zetta::Content {
 	namespace {
@@ -62,11 +66,240 @@ namespace Zetta::Content {
 
 		constexpr uintptr_t single_mesh_marker{ (uintptr_t)0x01 };
 		util::FreeList<u8*> geometry_hierarchies;
+		// NOTE: indexed by geometry id and laid out as [lod_bounds[lod_count], submesh_bounds[submesh_count]].
+		util::vector<util::vector<GeometryBounds>> geometry_bounds;
 		std::mutex geometry_mutex;
 
 		util::FreeList<NoexceptMap> shader_groups;
 		std::mutex shader_mutex;
 
+		// Submeshes with identical payloads, e.g. the same prop exported into several assets or LODs
+		// that repeat a mesh, are uploaded once and shared through a reference count.
+		struct SubmeshKey {
+			u64 hash[2];
+			u32 size;
+
+			[[nodiscard]] bool operator==(const SubmeshKey& other) const {
+				return hash[0] == other.hash[0] && hash[1] == other.hash[1] && size == other.size;
+			}
+		};
+
+		struct SubmeshKeyHasher {
+			[[nodiscard]] size_t operator()(const SubmeshKey& key) const { return (size_t)key.hash[0]; }
+		};
+
+		struct SharedSubmesh {
+			SubmeshKey key;
+			u32 ref_count;
+		};
+
+		std::unordered_map<SubmeshKey, ID::ID_Type, SubmeshKeyHasher> submesh_gpu_ids;
+		std::unordered_map<ID::ID_Type, SharedSubmesh> shared_submeshes;
+		SubmeshSharingStats submesh_sharing_stats{};
+		std::mutex submesh_mutex;
+
+		// NOTE: must match the buffer alignment used by the graphics backend when uploading submeshes.
+		constexpr u32 submesh_buffer_alignment{ 4 };
+		// element_size, vertex_count, index_count, elements_type, primitive_topology, position_format,
+		// position_scale[3] and position_bias[3]
+		constexpr u32 submesh_header_size{ 12 * sizeof(u32) };
+
+		// Returns the submesh in the uncompressed layout expected by Graphics::AddSubmesh() and its size,
+		// and moves 'at' to the end of the submesh. Compressed submeshes are decoded into 'buffer'.
+		const u8* UnpackSubmesh(const u8*& at, util::vector<u8>& buffer, u32& size) {
+			util::BlobStreamReader blob{ at };
+			const u32 element_size{ blob.read<u32>() };
+			const u32 vertex_count{ blob.read<u32>() };
+			const u32 index_count{ blob.read<u32>() };
+			blob.skip(sizeof(u32) * 2); // elements_type and primitive_topology
+			const PositionFormat::Format position_format{ (PositionFormat::Format)blob.read<u32>() };
+			blob.skip(sizeof(f32) * 6); // position_scale and position_bias
+			const u32 compressed_size{ blob.read<u32>() };
+			const u8* const submesh{ at };
+
+			if (!compressed_size) {
+				const u32 index_size{ (vertex_count < (1 << 16)) ? sizeof(u16) : sizeof(u32) };
+				blob.skip((u32)Math::AlignSizeUp<submesh_buffer_alignment>(PositionFormat::Size(position_format) * vertex_count));
+				blob.skip((u32)Math::AlignSizeUp<submesh_buffer_alignment>(element_size * vertex_count));
+				blob.skip(index_size * index_count);
+				at = blob.Position();
+				size = (u32)(at - submesh);
+				return submesh;
+			}
+
+			const u32 position_stream_size{ blob.read<u32>() };
+			const u32 element_stream_size{ blob.read<u32>() };
+			const u32 index_stream_size{ blob.read<u32>() };
+			const u8* const streams{ blob.Position() };
+			assert(sizeof(u32) * 3 + position_stream_size + element_stream_size + index_stream_size == compressed_size);
+			at = streams + position_stream_size + element_stream_size + index_stream_size;
+
+			const u32 position_size{ PositionFormat::Size(position_format) };
+			const u32 index_size{ (vertex_count < (1 << 16)) ? sizeof(u16) : sizeof(u32) };
+			const u32 aligned_position_buffer_size{ (u32)Math::AlignSizeUp<submesh_buffer_alignment>(position_size * vertex_count) };
+			const u32 aligned_element_buffer_size{ (u32)Math::AlignSizeUp<submesh_buffer_alignment>(element_size * vertex_count) };
+			const u32 total_buffer_size{ aligned_position_buffer_size + aligned_element_buffer_size + index_size * index_count };
+
+			buffer.resize(submesh_header_size + sizeof(u32) + total_buffer_size);
+			memset(buffer.data(), 0, buffer.size());
+			util::BlobStreamWriter writer{ buffer.data(), buffer.size() };
+			writer.write(submesh, submesh_header_size);
+			writer.write(0u); // decoded submeshes aren't compressed anymore
+
+			u8* const positions{ (u8*)writer.Position() };
+			u8* const elements{ positions + aligned_position_buffer_size };
+			u8* const indices{ elements + aligned_element_buffer_size };
+
+			const u8* stream{ streams };
+			[[maybe_unused]] bool result{ Codec::DecodeVertexBuffer(positions, vertex_count, position_size, stream, position_stream_size) };
+			assert(result);
+			stream += position_stream_size;
+			if (element_size) {
+				result = Codec::DecodeVertexBuffer(elements, vertex_count, element_size, stream, element_stream_size);
+				assert(result);
+				stream += element_stream_size;
+			}
+			result = Codec::DecodeIndexBuffer(indices, index_count, index_size, stream, index_stream_size);
+			assert(result);
+
+			size = (u32)buffer.size();
+			return buffer.data();
+		}
+
+		// 128-bit hash of the uncompressed submesh (header included), made of two independently seeded
+		// 64-bit lanes. Submeshes are only shared when both lanes and the size match.
+		SubmeshKey HashSubmesh(const u8* const data, u32 size) {
+			constexpr u64 prime1{ 0x9e3779b185ebca87ull };
+			constexpr u64 prime2{ 0xc2b2ae3d27d4eb4full };
+			constexpr u64 prime3{ 0x165667b19e3779f9ull };
+			const auto rotate{ [](u64 v, u32 bits) { return (v << bits) | (v >> (64 - bits)); } };
+			const auto avalanche{ [](u64 h) {
+				h ^= h >> 33; h *= prime2;
+				h ^= h >> 29; h *= prime3;
+				return h ^ (h >> 32);
+			} };
+
+			u64 h0{ prime1 + size };
+			u64 h1{ prime3 ^ size };
+			u32 i{ 0 };
+			for (; i + sizeof(u64) <= size; i += sizeof(u64)) {
+				u64 v;
+				memcpy(&v, &data[i], sizeof(u64));
+				h0 = rotate(h0 + v * prime2, 31) * prime1;
+				h1 = rotate(h1 ^ (v * prime1), 27) * prime2 + prime3;
+			}
+			for (; i < size; i++) {
+				h0 = rotate(h0 ^ (data[i] * prime3), 11) * prime1;
+				h1 = rotate(h1 + (data[i] * prime1), 17) * prime2;
+			}
+
+			return { { avalanche(h0), avalanche(h1 ^ rotate(h0, 23)) }, size };
+		}
+
+		// A submesh in the uncompressed layout expected by Graphics::AddSubmesh(), either still in the
+		// geometry blob or decoded into 'buffer'.
+		struct UnpackedSubmesh {
+			util::vector<u8> buffer;
+			const u8* data;
+			SubmeshKey key;
+			ID::ID_Type gpu_id;
+		};
+
+		void UnpackSubmesh(const u8*& at, UnpackedSubmesh& submesh) {
+			u32 size{ 0 };
+			submesh.data = UnpackSubmesh(at, submesh.buffer, size);
+			submesh.key = HashSubmesh(submesh.data, size);
+			submesh.gpu_id = ID::Invalid_ID;
+		}
+
+		// NOTE: expects submesh_mutex to be locked and the submesh to be on the GPU already.
+		ID::ID_Type AddSubmeshReference(const SubmeshKey& key) {
+			const ID::ID_Type gpu_id{ submesh_gpu_ids[key] };
+			++shared_submeshes[gpu_id].ref_count;
+			++submesh_sharing_stats.shared_references;
+			submesh_sharing_stats.bytes_saved += key.size;
+			return gpu_id;
+		}
+
+		// Sets the gpu ids of the submeshes. Submeshes that are already on the GPU, or that occur more than
+		// once in the list, are shared. All others are uploaded together with one Graphics::AddSubmeshes().
+		void AcquireSubmeshes(UnpackedSubmesh* const* const submeshes, u32 count) {
+			assert(submeshes && count);
+			util::vector<const u8*> upload_data{};
+			util::vector<u32> upload_indices(count, u32_invalid_id);
+			{
+				std::unordered_map<SubmeshKey, u32, SubmeshKeyHasher> pending_uploads{};
+				std::lock_guard lock{ submesh_mutex };
+				for (u32 i{ 0 }; i < count; i++) {
+					UnpackedSubmesh& submesh{ *submeshes[i] };
+					if (submesh_gpu_ids.count(submesh.key)) {
+						submesh.gpu_id = AddSubmeshReference(submesh.key);
+						continue;
+					}
+
+					const auto [it, inserted] { pending_uploads.try_emplace(submesh.key, (u32)upload_data.size()) };
+					if (inserted) upload_data.emplace_back(submesh.data);
+					upload_indices[i] = it->second;
+				}
+			}
+
+			if (upload_data.empty()) return;
+
+			// NOTE: uploading is done without holding the lock. If another thread uploaded the same
+			//       submesh in the meantime, ours is dropped and theirs is shared instead.
+			util::vector<ID::ID_Type> uploaded_ids(upload_data.size(), ID::Invalid_ID);
+			Graphics::AddSubmeshes(upload_data.data(), (u32)upload_data.size(), uploaded_ids.data());
+
+			std::lock_guard lock{ submesh_mutex };
+			for (u32 i{ 0 }; i < count; i++) {
+				if (upload_indices[i] == u32_invalid_id) continue;
+				UnpackedSubmesh& submesh{ *submeshes[i] };
+				ID::ID_Type& gpu_id{ uploaded_ids[upload_indices[i]] };
+				if (!ID::IsValid(gpu_id)) {
+					// a duplicate of a submesh earlier in the list
+					submesh.gpu_id = AddSubmeshReference(submesh.key);
+					continue;
+				}
+
+				if (submesh_gpu_ids.try_emplace(submesh.key, gpu_id).second) {
+					shared_submeshes[gpu_id] = { submesh.key, 1 };
+					++submesh_sharing_stats.unique_submeshes;
+					submesh_sharing_stats.bytes_uploaded += submesh.key.size;
+					submesh.gpu_id = gpu_id;
+				}
+				else {
+					Graphics::RemoveSubmesh(gpu_id);
+					submesh.gpu_id = AddSubmeshReference(submesh.key);
+				}
+
+				gpu_id = ID::Invalid_ID;
+			}
+		}
+
+		void RemoveSharedSubmesh(ID::ID_Type gpu_id) {
+			std::lock_guard lock{ submesh_mutex };
+			const auto it{ shared_submeshes.find(gpu_id) };
+			assert(it != shared_submeshes.end() && it->second.ref_count);
+			SharedSubmesh& shared{ it->second };
+			if (--shared.ref_count) {
+				--submesh_sharing_stats.shared_references;
+				submesh_sharing_stats.bytes_saved -= shared.key.size;
+				return;
+			}
+
+			--submesh_sharing_stats.unique_submeshes;
+			submesh_sharing_stats.bytes_uploaded -= shared.key.size;
+			submesh_gpu_ids.erase(shared.key);
+			shared_submeshes.erase(it);
+			Graphics::RemoveSubmesh(gpu_id);
+		}
+
+		// NOTE: expects geometry_mutex to be locked.
+		void StoreGeometryBounds(ID::ID_Type id, util::vector<GeometryBounds>& bounds) {
+			if (id >= geometry_bounds.size()) geometry_bounds.resize((u64)id + 1);
+			geometry_bounds[id] = std::move(bounds);
+		}
+
 		u32 GetGeometryHierarchyBufferSize(const void* const data) {
 			assert(data);
 			util::BlobStreamReader blob{ (const u8*)data };
@@ -80,7 +313,10 @@ namespace Zetta::Content {
 				// skip the threshold
 				blob.skip(sizeof(f32));
 				// add size of gpu_ids (sizeof(ID::ID_Type) * submesh_count)
-				size += sizeof(ID::ID_Type) * blob.read<u32>();
+				const u32 submesh_count{ blob.read<u32>() };
+				size += sizeof(ID::ID_Type) * submesh_count;
+				// skip the LOD and submesh bounds
+				blob.skip(sizeof(GeometryBounds) * (1 + submesh_count));
 				// skip submesh data and go to the next LOD
 				blob.skip(blob.read<u32>());
 			}
@@ -88,27 +324,74 @@ namespace Zetta::Content {
 			return size;
 		}
 	
-		ID::ID_Type CreateMeshHierarchy(const void* const data) {
+		bool IsSingleMesh(const void* const data) {
 			assert(data);
-			const u32 size{ GetGeometryHierarchyBufferSize(data) };
-			u8* const hierarchy_buffer{ (u8* const)malloc(size) };
+			util::BlobStreamReader blob{ (const u8*)data };
+			const u32 lod_count{ blob.read<u32>() };
+			assert(lod_count);
+			if (lod_count > 1) return false;
+
+			blob.skip(sizeof(f32));
+			const u32 submesh_count{ blob.read<u32>() };
+			assert(submesh_count);
+			return submesh_count == 1;
+		}
 
+		constexpr ID::ID_Type GPU_IDFromFakePointer(u8* const ptr) {
+			assert((uintptr_t)ptr & single_mesh_marker);
+			static_assert(sizeof(uintptr_t) > sizeof(ID::ID_Type));
+			constexpr u8 shift_bits{ (sizeof(uintptr_t) - sizeof(ID::ID_Type)) << 3 };
+			return (((uintptr_t)ptr) >> shift_bits) & (uintptr_t)ID::Invalid_ID;
+		}
+
+		// A geometry blob that has been unpacked and validated, but not uploaded yet. Preparing is the
+		// expensive CPU side of creating a geometry resource and can run on any thread.
+		struct PreparedGeometry {
+			u8* hierarchy_buffer{ nullptr };	// nullptr for single meshes
+			util::vector<UnpackedSubmesh> submeshes;
+			// laid out as [lod_bounds[lod_count], submesh_bounds[submesh_count]]
+			util::vector<GeometryBounds> bounds;
+		};
+
+		void PrepareGeometry(const void* const data, PreparedGeometry& geometry) {
+			assert(data);
 			util::BlobStreamReader blob{ (const u8*)data };
+
+			if (IsSingleMesh(data)) {
+				blob.skip(sizeof(u32) + sizeof(f32) + sizeof(u32));
+				geometry.hierarchy_buffer = nullptr;
+				// a single mesh has the same bounds for its only LOD and submesh
+				geometry.bounds.resize(2);
+				blob.read((u8*)geometry.bounds.data(), sizeof(GeometryBounds) * 2);
+				blob.skip(sizeof(u32));
+				const u8* at{ blob.Position() };
+				geometry.submeshes.resize(1);
+				UnpackSubmesh(at, geometry.submeshes[0]);
+				return;
+			}
+
 			const u32 lod_count{ blob.read<u32>() };
 			assert(lod_count);
-			GeometryHierarchyStream stream{ hierarchy_buffer, lod_count };
+			geometry.hierarchy_buffer = (u8*)malloc(GetGeometryHierarchyBufferSize(data));
+			GeometryHierarchyStream stream{ geometry.hierarchy_buffer, lod_count };
 			u32 submesh_idx{ 0 };
-			ID::ID_Type* const gpu_ids{ stream.GPU_IDs() };
+			util::vector<GeometryBounds>& lod_bounds{ geometry.bounds };
+			lod_bounds.resize(lod_count);
+			util::vector<GeometryBounds> submesh_bounds{};
 
 			for (u32 i{ 0 }; i < lod_count; i++) {
 				stream.Thresholds()[i] = blob.read<f32>();
 				const u32 id_count{ blob.read<u32>() };
 				assert(id_count < (1 << 16));
 				stream.LODOffsets()[i] = { (u16)submesh_idx, (u16)id_count };
+				blob.read((u8*)&lod_bounds[i], sizeof(GeometryBounds));
+				submesh_bounds.resize(submesh_idx + id_count);
+				blob.read((u8*)&submesh_bounds[submesh_idx], sizeof(GeometryBounds) * id_count);
 				blob.skip(sizeof(u32)); // skip over sizeof(submeshes)
+				geometry.submeshes.resize(submesh_idx + id_count);
 				for (u32 j{ 0 }; j < id_count; j++) {
 					const u8* at{ blob.Position() };
-					gpu_ids[submesh_idx++] = Graphics::AddSubmesh(at);
+					UnpackSubmesh(at, geometry.submeshes[submesh_idx++]);
 					blob.skip((u32)(at - blob.Position()));
 					assert(submesh_idx < (1 << 16));
 				}
@@ -124,43 +407,28 @@ namespace Zetta::Content {
 				return true;
 				}());
 
-			static_assert(alignof(void*) > 2, "At least one significant bit for single mesh marker is required.");
-			std::lock_guard lock{ geometry_mutex };
-			return geometry_hierarchies.Add(hierarchy_buffer);
+			for (const GeometryBounds& bounds : submesh_bounds) lod_bounds.emplace_back(bounds);
 		}
 
-		ID::ID_Type CreateSingleMesh(const void* const data) {
-			assert(data);
-			util::BlobStreamReader blob{ (const u8*)data };
-			blob.skip(sizeof(u32) + sizeof(f32) + sizeof(u32) + sizeof(u32));
-			const u8* at{ blob.Position() };
-			const ID::ID_Type gpu_id{ Graphics::AddSubmesh(at) };
+		// Creates the geometry resource once the gpu ids of all its submeshes are known.
+		ID::ID_Type CommitGeometry(PreparedGeometry& geometry) {
+			u8* pointer{ geometry.hierarchy_buffer };
+			if (pointer) {
+				ID::ID_Type* const gpu_ids{ GeometryHierarchyStream{ pointer }.GPU_IDs() };
+				for (u32 i{ 0 }; i < geometry.submeshes.size(); i++) gpu_ids[i] = geometry.submeshes[i].gpu_id;
+			}
+			else {
+				assert(geometry.submeshes.size() == 1);
+				static_assert(sizeof(uintptr_t) > sizeof(ID::ID_Type));
+				constexpr u8 shift_bits{ (sizeof(uintptr_t) - sizeof(ID::ID_Type)) << 3 };
+				pointer = (u8*)((((uintptr_t)geometry.submeshes[0].gpu_id) << shift_bits) | single_mesh_marker);
+			}
 
-			static_assert(sizeof(uintptr_t) > sizeof(ID::ID_Type));
-			constexpr u8 shift_bits{ (sizeof(uintptr_t) - sizeof(ID::ID_Type)) << 3 };
-			u8* const fake_ptr{ (u8* const)((((uintptr_t)gpu_id) << shift_bits) | single_mesh_marker) };
+			static_assert(alignof(void*) > 2, "At least one significant bit for single mesh marker is required.");
 			std::lock_guard lock{ geometry_mutex };
-			return geometry_hierarchies.Add(fake_ptr);
-		}
-
-		bool IsSingleMesh(const void* const data) {
-			assert(data);
-			util::BlobStreamReader blob{ (const u8*)data };
-			const u32 lod_count{ blob.read<u32>() };
-			assert(lod_count);
-			if (lod_count > 1) return false;
-
-			blob.skip(sizeof(f32));
-			const u32 submesh_count{ blob.read<u32>() };
-			assert(submesh_count);
-			return submesh_count == 1;
-		}
-
-		constexpr ID::ID_Type GPU_IDFromFakePointer(u8* const ptr) {
-			assert((uintptr_t)ptr & single_mesh_marker);
-			static_assert(sizeof(uintptr_t) > sizeof(ID::ID_Type));
-			constexpr u8 shift_bits{ (sizeof(uintptr_t) - sizeof(ID::ID_Type)) << 3 };
-			return (((uintptr_t)ptr) >> shift_bits) & (uintptr_t)ID::Invalid_ID;
+			const ID::ID_Type id{ geometry_hierarchies.Add(pointer) };
+			StoreGeometryBounds(id, geometry.bounds);
+			return id;
 		}
 
 		//
@@ -170,13 +438,23 @@ namespace Zetta::Content {
 		//     struct {
 		//         f32 lod_threshold,
 		//         u32 submesh_count,
+		//         GeometryBounds lod_bounds,
+		//         GeometryBounds submesh_bounds[submesh_count],
 		//         u32 size_of_submeshes,
 		//         struct {
 		//             u32 element_size, u32 vertex_count,
 		//             u32 index_count, u32 elements_type, u32 primitive_toplogy,
-		//             u8 positions[sizeof(f32) * 3 vertex_count],
+		//             u32 position_format, f32 position_scale[3], f32 position_bias[3],
+		//             u32 compressed_size,
+		//             if compressed_size == 0:
+		//             u8 positions[PositionFormat::Size(position_format) * vertex_count],
 		//			   u8 elements[sizeof(element_size) * vertex_count],
 		//             u8 indices[index_size * index_count]
+		//             else (see GeometryCodec.h):
+		//             u32 position_stream_size, u32 element_stream_size, u32 index_stream_size,
+		//             u8 position_stream[position_stream_size],
+		//             u8 element_stream[element_stream_size],
+		//             u8 index_stream[index_stream_size]
 		//         } submeshes[submesh_count]
 		//     } mesh_lods[lod_count]
 		// } geometry;
@@ -199,25 +477,31 @@ namespace Zetta::Content {
 		//
 		ID::ID_Type CreateGeometryResource(const void* const data) {
 			assert(data);
-			return IsSingleMesh(data) ? CreateSingleMesh(data) : CreateMeshHierarchy(data);
+			PreparedGeometry geometry{};
+			PrepareGeometry(data, geometry);
+			util::vector<UnpackedSubmesh*> submeshes(geometry.submeshes.size());
+			for (u32 i{ 0 }; i < submeshes.size(); i++) submeshes[i] = &geometry.submeshes[i];
+			AcquireSubmeshes(submeshes.data(), (u32)submeshes.size());
+			return CommitGeometry(geometry);
 		}
 
 		void DestroyGeometryResource(ID::ID_Type id) {
 			std::lock_guard lock{ geometry_mutex };
 			u8* const pointer{ geometry_hierarchies[id] };
 			if ((uintptr_t)pointer & single_mesh_marker) 
-				Graphics::RemoveSubmesh(GPU_IDFromFakePointer(pointer));
+				RemoveSharedSubmesh(GPU_IDFromFakePointer(pointer));
 			else {
 				GeometryHierarchyStream stream{ pointer };
 				const u32 lod_count{ stream.LODCount() };
 				u32 id_index{ 0 };
 				for (u32 lod{ 0 }; lod < lod_count; lod++)
 					for (u32 i{ 0 }; i < stream.LODOffsets()[lod].count; i++)
-						Graphics::RemoveSubmesh(stream.GPU_IDs()[id_index++]);
+						RemoveSharedSubmesh(stream.GPU_IDs()[id_index++]);
 
 				free(pointer);
 			}
 
+			geometry_bounds[id] = util::vector<GeometryBounds>{};
 			geometry_hierarchies.Remove(id);
 		}
 
@@ -237,6 +521,132 @@ namespace Zetta::Content {
 		void DestroyMaterialResource(ID::ID_Type id) {
 			Graphics::RemoveMaterial(id);
 		}
+
+		// Resources submitted together with CreateResourcesAsync(). Geometries are prepared in parallel
+		// by the resource workers. The worker that finishes last uploads the submeshes of the whole batch
+		// at once and then creates the resources.
+		struct ResourceBatch {
+			util::vector<const void*> data;
+			util::vector<AssetType::Type> types;
+			util::vector<PreparedGeometry> geometries;
+			util::vector<ID::ID_Type> resource_ids;
+			std::atomic<u32> pending_count{ 0 };
+			bool is_ready{ false }; // NOTE: protected by batch_mutex.
+		};
+
+		util::FreeList<std::unique_ptr<ResourceBatch>> resource_batches;
+		// Ids of the batches nobody has waited for yet.
+		util::vector<ID::ID_Type> open_batches;
+		std::mutex batch_mutex;
+		std::condition_variable batch_completed;
+
+		void CompleteBatch(ResourceBatch& batch) {
+			const u32 count{ (u32)batch.data.size() };
+			util::vector<UnpackedSubmesh*> submeshes{};
+			for (u32 i{ 0 }; i < count; i++) {
+				if (batch.types[i] != AssetType::Mesh) continue;
+				for (UnpackedSubmesh& submesh : batch.geometries[i].submeshes) submeshes.emplace_back(&submesh);
+			}
+
+			if (!submeshes.empty()) AcquireSubmeshes(submeshes.data(), (u32)submeshes.size());
+
+			for (u32 i{ 0 }; i < count; i++) {
+				ID::ID_Type id{ ID::Invalid_ID };
+				switch (batch.types[i])
+				{
+				case AssetType::Material: id = CreateMaterialResource(batch.data[i]); break;
+				case AssetType::Mesh: id = CommitGeometry(batch.geometries[i]); break;
+				default: break;
+				}
+
+				assert(ID::IsValid(id));
+				batch.resource_ids[i] = id;
+				batch.geometries[i] = PreparedGeometry{};
+			}
+
+			{
+				std::lock_guard lock{ batch_mutex };
+				batch.is_ready = true;
+			}
+			batch_completed.notify_all();
+		}
+
+		// A small pool of threads that prepare the resources of all submitted batches in submission order.
+		// The threads are started on first use.
+		class ResourceWorkers {
+		public:
+			ResourceWorkers() = default;
+			DISABLE_COPY_AND_MOVE(ResourceWorkers);
+			~ResourceWorkers() { Shutdown(); }
+
+			// Returns once every submitted job has run and the threads have exited. Submit() starts them again.
+			void Shutdown() {
+				{
+					std::lock_guard lock{ _mutex };
+					if (!_thread_count) return;
+					_is_shutting_down = true;
+				}
+				_job_available.notify_all();
+				for (u32 i{ 0 }; i < _thread_count; i++) _threads[i].join();
+
+				std::lock_guard lock{ _mutex };
+				_threads.reset();
+				_thread_count = 0;
+				_is_shutting_down = false;
+			}
+
+			void Submit(ResourceBatch* const batch) {
+				assert(batch);
+				{
+					std::lock_guard lock{ _mutex };
+					if (!_thread_count) Start();
+					for (u32 i{ 0 }; i < batch->data.size(); i++) _jobs.emplace_back(Job{ batch, i });
+				}
+				_job_available.notify_all();
+			}
+
+		private:
+			struct Job {
+				ResourceBatch* batch;
+				u32 index;
+			};
+
+			void Start() {
+				_thread_count = std::max(2u, std::thread::hardware_concurrency()) - 1;
+				_threads = std::make_unique<std::thread[]>(_thread_count);
+				for (u32 i{ 0 }; i < _thread_count; i++) _threads[i] = std::thread{ &ResourceWorkers::Run, this };
+			}
+
+			void Run() {
+				while (true) {
+					Job job{};
+					{
+						std::unique_lock lock{ _mutex };
+						_job_available.wait(lock, [this] { return _next_job < _jobs.size() || _is_shutting_down; });
+						if (_next_job == _jobs.size()) return;
+						job = _jobs[_next_job++];
+						if (_next_job == _jobs.size()) {
+							_jobs.clear();
+							_next_job = 0;
+						}
+					}
+
+					ResourceBatch& batch{ *job.batch };
+					if (batch.types[job.index] == AssetType::Mesh) PrepareGeometry(batch.data[job.index], batch.geometries[job.index]);
+					if (batch.pending_count.fetch_sub(1) == 1) CompleteBatch(batch);
+				}
+			}
+
+			std::unique_ptr<std::thread[]>	_threads;
+			util::vector<Job>				_jobs;
+			std::mutex						_mutex;
+			std::condition_variable			_job_available;
+			u32								_thread_count{ 0 };
+			u32								_next_job{ 0 };
+			bool							_is_shutting_down{ false };
+		};
+
+		ResourceWorkers resource_workers;
 	}
 
 	ID::ID_Type CreateResource(const void* const data, AssetType::Type type) {
@@ -258,6 +668,84 @@ namespace Zetta::Content {
 		return id;
 	}
 
+	ID::ID_Type CreateResourcesAsync(const void* const* const data, const AssetType::Type* const types, u32 count) {
+		assert(data && types && count);
+		std::unique_ptr<ResourceBatch> batch{ std::make_unique<ResourceBatch>() };
+		batch->data.resize(count);
+		batch->types.resize(count);
+		memcpy(batch->data.data(), data, sizeof(const void*) * count);
+		memcpy(batch->types.data(), types, sizeof(AssetType::Type) * count);
+		batch->geometries.resize(count);
+		batch->resource_ids.resize(count, ID::Invalid_ID);
+		batch->pending_count = count;
+
+		for (u32 i{ 0 }; i < count; i++) {
+			assert(data[i]);
+			assert(types[i] == AssetType::Mesh || types[i] == AssetType::Material);
+		}
+
+		ResourceBatch* const pointer{ batch.get() };
+		ID::ID_Type id{ ID::Invalid_ID };
+		{
+			std::lock_guard lock{ batch_mutex };
+			id = resource_batches.Add(std::move(batch));
+			open_batches.emplace_back(id);
+		}
+
+		resource_workers.Submit(pointer);
+		return id;
+	}
+
+	bool IsResourceBatchReady(ID::ID_Type batch_id) {
+		assert(ID::IsValid(batch_id));
+		std::lock_guard lock{ batch_mutex };
+		return resource_batches[batch_id]->is_ready;
+	}
+
+	void WaitForResourceBatch(ID::ID_Type batch_id, ID::ID_Type* const resource_ids) {
+		assert(ID::IsValid(batch_id) && resource_ids);
+		std::unique_ptr<ResourceBatch> batch{};
+		{
+			std::unique_lock lock{ batch_mutex };
+			ResourceBatch* const pointer{ resource_batches[batch_id].get() };
+			batch_completed.wait(lock, [pointer] { return pointer->is_ready; });
+			batch = std::move(resource_batches[batch_id]);
+			resource_batches.Remove(batch_id);
+			for (u32 i{ 0 }; i < open_batches.size(); i++) {
+				if (open_batches[i] == batch_id) {
+					open_batches.EraseUnordered(i);
+					break;
+				}
+			}
+		}
+
+		memcpy(resource_ids, batch->resource_ids.data(), sizeof(ID::ID_Type) * batch->resource_ids.size());
+	}
+
+	void Shutdown() {
+		resource_workers.Shutdown();
+
+		// With the workers gone, every batch is complete. Nobody got the resource ids of the batches that
+		// weren't waited for, so their resources are destroyed here.
+		util::vector<ID::ID_Type> batch_ids{};
+		{
+			std::lock_guard lock{ batch_mutex };
+			batch_ids = open_batches;
+		}
+
+		for (ID::ID_Type batch_id : batch_ids) {
+			util::vector<AssetType::Type> types{};
+			{
+				std::lock_guard lock{ batch_mutex };
+				types = resource_batches[batch_id]->types;
+			}
+
+			util::vector<ID::ID_Type> resource_ids(types.size());
+			WaitForResourceBatch(batch_id, resource_ids.data());
+			for (u32 i{ 0 }; i < types.size(); i++) DestroyResource(resource_ids[i], types[i]);
+		}
+	}
+
 	void DestroyResource(ID::ID_Type id, AssetType::Type type) {
 		assert(ID::IsValid(id));
 		switch (type)
@@ -332,6 +820,33 @@ namespace Zetta::Content {
 
 	}
 
+	SubmeshSharingStats GetSubmeshSharingStats() {
+		std::lock_guard lock{ submesh_mutex };
+		return submesh_sharing_stats;
+	}
+
+	u32 GetLODCount(ID::ID_Type geometry_content_id) {
+		std::lock_guard lock{ geometry_mutex };
+		u8* const ptr{ geometry_hierarchies[geometry_content_id] };
+		return ((uintptr_t)ptr & single_mesh_marker) ? 1 : GeometryHierarchyStream{ ptr }.LODCount();
+	}
+
+	GeometryBounds GetLODBounds(ID::ID_Type geometry_content_id, u32 lod) {
+		std::lock_guard lock{ geometry_mutex };
+		assert(geometry_content_id < geometry_bounds.size());
+		return geometry_bounds[geometry_content_id][lod];
+	}
+
+	void GetSubmeshBounds(ID::ID_Type geometry_content_id, u32 id_count, GeometryBounds* const bounds) {
+		assert(bounds && id_count);
+		std::lock_guard lock{ geometry_mutex };
+		u8* const ptr{ geometry_hierarchies[geometry_content_id] };
+		const u32 lod_count{ ((uintptr_t)ptr & single_mesh_marker) ? 1 : GeometryHierarchyStream{ ptr }.LODCount() };
+		const util::vector<GeometryBounds>& geometry{ geometry_bounds[geometry_content_id] };
+		assert(geometry.size() == lod_count + id_count);
+		memcpy(bounds, &geometry[lod_count], sizeof(GeometryBounds) * id_count);
+	}
+
 	void GetLODOffsets(const ID::ID_Type* const geometry_ids, const f32* const thresholds, u32 id_count, util::vector<LODOffset>& offsets) {
 		assert(geometry_ids && thresholds && id_count);
 		assert(offsets.empty());
@@ -28,6 +28,17 @@ namespace Zetta::Content {
 		};
 	};
 
+	struct PositionFormat {
+		enum Format : u32 {
+			Float3 = 0,		// 3 x f32 (12 bytes per vertex)
+			Unorm16x3,		// 3 x u16 + 2 bytes padding (8 bytes per vertex), normalized to the submesh AABB
+		};
+
+		[[nodiscard]] static constexpr u32 Size(Format format) {
+			return format == Unorm16x3 ? sizeof(u16) * 4 : sizeof(f32) * 3;
+		}
+	};
+
 	typedef struct CompiledShader {
 		static constexpr u32 hash_length{ 16 };
 		constexpr u64 ByteCodeSize() const { return _byte_code_size; };
@@ -46,13 +57,46 @@ namespace Zetta::Content {
 		u16 count;
 	};
 
+	// Bounding volumes of a submesh or of all submeshes of a LOD, in object space.
+	struct GeometryBounds {
+		Math::v3 aabb_min;
+		Math::v3 aabb_max;
+		Math::v3 sphere_center;
+		f32 sphere_radius;
+	};
+
+	// Identical submeshes are uploaded once at load time and shared by all geometries that contain them.
+	struct SubmeshSharingStats {
+		u64 unique_submeshes;	// submeshes on the GPU
+		u64 shared_references;	// additional references to submeshes that were already on the GPU
+		u64 bytes_uploaded;		// uncompressed size of the unique submeshes
+		u64 bytes_saved;		// uncompressed size of the shared references, which weren't uploaded again
+	};
+
 	ID::ID_Type CreateResource(const void* const data, AssetType::Type type);
 	void DestroyResource(ID::ID_Type id, AssetType::Type type);
 
+	// Asynchronous resource creation for meshes and materials. Geometries are unpacked and validated
+	// on worker threads, and the submeshes of the whole batch are uploaded together.
+	// NOTE: 'data' has to stay valid until WaitForResourceBatch() returns.
+	[[nodiscard]] ID::ID_Type CreateResourcesAsync(const void* const* const data, const AssetType::Type* const types, u32 count);
+	[[nodiscard]] bool IsResourceBatchReady(ID::ID_Type batch_id);
+	// Blocks until the batch is complete and writes the resource ids in submission order. The batch id is invalid afterwards.
+	void WaitForResourceBatch(ID::ID_Type batch_id, ID::ID_Type* const resource_ids);
+	// Finishes the batches in flight, destroys the resources of batches nobody waited for and joins the
+	// resource workers. Call before the renderer shuts down.
+	void Shutdown();
+
 	ID::ID_Type AddShaderGroup(const u8** shaders, u32 shader_count, const u32* const keys);
 	void RemoveShaderGroup(ID::ID_Type id);
 	pCompiledShader GetShader(ID::ID_Type id, u32 key);
 
+	// NOTE: geometries that contain identical submeshes get the same gpu ids.
 	void GetSubmeshGPU_IDs(ID::ID_Type geometry_content_id, u32 id_count, ID::ID_Type* const gpu_ids);
+	u32 GetLODCount(ID::ID_Type geometry_content_id);
+	GeometryBounds GetLODBounds(ID::ID_Type geometry_content_id, u32 lod);
+	// Fills bounds in the same order as the gpu ids returned by GetSubmeshGPU_IDs().
+	void GetSubmeshBounds(ID::ID_Type geometry_content_id, u32 id_count, GeometryBounds* const bounds);
+	[[nodiscard]] SubmeshSharingStats GetSubmeshSharingStats();
 	void GetLODOffsets(const ID::ID_Type* const geometry_ids, const f32* const thresholds, u32 id_count, util::vector<LODOffset>& offsets);
 }
\ No newline at end of file
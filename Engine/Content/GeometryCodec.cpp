@@ -0,0 +1,380 @@
+#include "GeometryCodec.h"
+#include <emmintrin.h>
+
+namespace Zetta::Content::Codec {
+	namespace {
+		constexpr u8 index_codec_version{ 0xe1 };
+		constexpr u8 vertex_codec_version{ 0xe2 };
+
+		// NOTE: 16 slots, but slot 15 is used to mark triangles that don't share a cached edge.
+		constexpr u32 edge_cache_size{ 16 };
+		constexpr u32 no_edge{ edge_cache_size - 1 };
+		constexpr u32 vertex_block_size{ 16 };
+		constexpr u32 max_varint_size{ 5 };
+
+		struct Edge {
+			u32 a, b;
+		};
+
+		class EdgeCache {
+		public:
+			EdgeCache() {
+				for (Edge& e : _edges) e = { u32_invalid_id, u32_invalid_id };
+			}
+
+			void Push(u32 a, u32 b) {
+				_head = (_head + 1) & (edge_cache_size - 1);
+				_edges[_head] = { a, b };
+			}
+
+			// Slot 0 is the most recently pushed edge.
+			[[nodiscard]] u32 Find(u32 a, u32 b) const {
+				for (u32 i{ 0 }; i < no_edge; i++) {
+					const Edge& e{ _edges[(_head - i) & (edge_cache_size - 1)] };
+					if (e.a == a && e.b == b) return i;
+				}
+				return no_edge;
+			}
+
+			[[nodiscard]] const Edge& Get(u32 slot) const {
+				assert(slot < no_edge);
+				return _edges[(_head - slot) & (edge_cache_size - 1)];
+			}
+
+			// The triangle's edges are stored reversed, because that's how a neighbour with
+			// the same winding order will reference them.
+			void PushTriangle(u32 a, u32 b, u32 c) {
+				Push(b, a);
+				Push(c, b);
+				Push(a, c);
+			}
+
+		private:
+			Edge _edges[edge_cache_size];
+			u32 _head{ 0 };
+		};
+
+		[[nodiscard]] constexpr u32 ZigZag(u32 delta) {
+			return (delta << 1) ^ (u32)((s32)delta >> 31);
+		}
+
+		[[nodiscard]] constexpr u32 UnZigZag(u32 v) {
+			return (v >> 1) ^ (0 - (v & 1));
+		}
+
+		u8* WriteVarint(u8* at, u32 v) {
+			while (v >= 0x80) {
+				*at++ = (u8)(v | 0x80);
+				v >>= 7;
+			}
+			*at++ = (u8)v;
+			return at;
+		}
+
+		const u8* ReadVarint(const u8* at, const u8* const end, u32& v) {
+			v = 0;
+			for (u32 shift{ 0 }; at < end && shift < 35; shift += 7) {
+				const u8 byte{ *at++ };
+				v |= (u32)(byte & 0x7f) << shift;
+				if (!(byte & 0x80)) return at;
+			}
+			return nullptr;
+		}
+
+		[[nodiscard]] u32 ReadIndex(const void* const indices, u32 index_size, u32 i) {
+			return index_size == sizeof(u16) ? ((const u16*)indices)[i] : ((const u32*)indices)[i];
+		}
+
+		void WriteIndex(void* const indices, u32 index_size, u32 i, u32 v) {
+			if (index_size == sizeof(u16)) ((u16*)indices)[i] = (u16)v;
+			else ((u32*)indices)[i] = v;
+		}
+
+		// Encodes a vertex index and updates the sequential vertex counter. Indices that continue the
+		// sequence of first references only set a bit in the triangle code and have no payload.
+		[[nodiscard]] bool EncodeVertex(u8*& at, u32 v, u32& next, u32& last) {
+			const bool sequential{ v == next };
+			if (sequential) next++;
+			else at = WriteVarint(at, ZigZag(v - last));
+			last = v;
+			return sequential;
+		}
+
+		[[nodiscard]] bool DecodeVertex(const u8*& at, const u8* const end, bool sequential, u32& next, u32& last, u32& v) {
+			if (sequential) {
+				v = next++;
+			}
+			else {
+				u32 zz;
+				at = ReadVarint(at, end, zz);
+				if (!at) return false;
+				v = last + UnZigZag(zz);
+			}
+			last = v;
+			return true;
+		}
+
+		[[nodiscard]] constexpr u32 HeaderSize(u32 vertex_size) {
+			// 2 bits per byte stream
+			return (vertex_size + 3) >> 2;
+		}
+
+		// Packed size of a stream for each of the 4 possible bit widths (0, 2, 4 and 8 bits).
+		constexpr u32 stream_size[4]{ 0, vertex_block_size * 2 / 8, vertex_block_size * 4 / 8, vertex_block_size };
+
+		[[nodiscard]] u32 StreamCode(const u8* const deltas) {
+			u8 max{ 0 };
+			for (u32 i{ 0 }; i < vertex_block_size; i++) max |= deltas[i];
+			return max == 0 ? 0 : max < 0x04 ? 1 : max < 0x10 ? 2 : 3;
+		}
+
+		// Layout of a packed stream is chosen so the decoder can expand it with uniform shifts:
+		// 2 bit: value i lives in byte (i % 4) at bit (i / 4) * 2
+		// 4 bit: value i lives in byte (i % 8) at bit (i / 8) * 4
+		u8* PackStream(u8* at, const u8* const deltas, u32 code) {
+			switch (code) {
+			case 1:
+				for (u32 b{ 0 }; b < 4; b++)
+					*at++ = (u8)(deltas[b] | (deltas[b + 4] << 2) | (deltas[b + 8] << 4) | (deltas[b + 12] << 6));
+				break;
+			case 2:
+				for (u32 b{ 0 }; b < 8; b++)
+					*at++ = (u8)(deltas[b] | (deltas[b + 8] << 4));
+				break;
+			case 3:
+				memcpy(at, deltas, vertex_block_size);
+				at += vertex_block_size;
+				break;
+			}
+			return at;
+		}
+
+		__m128i UnpackStream(const u8* const at, u32 code) {
+			switch (code) {
+			case 1:
+			{
+				u32 packed;
+				memcpy(&packed, at, sizeof(u32));
+				const __m128i v{ _mm_set1_epi32((s32)packed) };
+				const __m128i v01{ _mm_unpacklo_epi32(v, _mm_srli_epi32(v, 2)) };
+				const __m128i v23{ _mm_unpacklo_epi32(_mm_srli_epi32(v, 4), _mm_srli_epi32(v, 6)) };
+				return _mm_and_si128(_mm_unpacklo_epi64(v01, v23), _mm_set1_epi8(0x03));
+			}
+			case 2:
+			{
+				const __m128i v{ _mm_loadl_epi64((const __m128i*)at) };
+				return _mm_and_si128(_mm_unpacklo_epi64(v, _mm_srli_epi64(v, 4)), _mm_set1_epi8(0x0f));
+			}
+			case 3:
+				return _mm_loadu_si128((const __m128i*)at);
+			default:
+				return _mm_setzero_si128();
+			}
+		}
+
+		// Turns 16 zigzag encoded deltas into values by adding the running sum on top of the last value.
+		__m128i DecodeDeltas(__m128i zz, __m128i last) {
+			const __m128i sign{ _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(zz, _mm_set1_epi8(0x01))) };
+			__m128i v{ _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(zz, 1), _mm_set1_epi8(0x7f)), sign) };
+			v = _mm_add_epi8(v, _mm_slli_si128(v, 1));
+			v = _mm_add_epi8(v, _mm_slli_si128(v, 2));
+			v = _mm_add_epi8(v, _mm_slli_si128(v, 4));
+			v = _mm_add_epi8(v, _mm_slli_si128(v, 8));
+			return _mm_add_epi8(v, last);
+		}
+
+		// Interleaves the decoded streams of a block back into vertices, 4 streams at a time.
+		void TransposeBlock(u8* const out, const u8* const block, u32 count, u32 vertex_size) {
+			u32 k{ 0 };
+			for (; k + 4 <= vertex_size; k += 4) {
+				const u8* const streams{ &block[(u64)k * vertex_block_size] };
+				const __m128i s0{ _mm_loadu_si128((const __m128i*)&streams[0]) };
+				const __m128i s1{ _mm_loadu_si128((const __m128i*)&streams[vertex_block_size]) };
+				const __m128i s2{ _mm_loadu_si128((const __m128i*)&streams[vertex_block_size * 2]) };
+				const __m128i s3{ _mm_loadu_si128((const __m128i*)&streams[vertex_block_size * 3]) };
+				const __m128i s01lo{ _mm_unpacklo_epi8(s0, s1) }, s01hi{ _mm_unpackhi_epi8(s0, s1) };
+				const __m128i s23lo{ _mm_unpacklo_epi8(s2, s3) }, s23hi{ _mm_unpackhi_epi8(s2, s3) };
+				// Each register now holds 4 complete vertices worth of 4 bytes.
+				alignas(16) u32 quads[vertex_block_size];
+				_mm_store_si128((__m128i*)&quads[0], _mm_unpacklo_epi16(s01lo, s23lo));
+				_mm_store_si128((__m128i*)&quads[4], _mm_unpackhi_epi16(s01lo, s23lo));
+				_mm_store_si128((__m128i*)&quads[8], _mm_unpacklo_epi16(s01hi, s23hi));
+				_mm_store_si128((__m128i*)&quads[12], _mm_unpackhi_epi16(s01hi, s23hi));
+
+				for (u32 i{ 0 }; i < count; i++)
+					memcpy(&out[(u64)i * vertex_size + k], &quads[i], sizeof(u32));
+			}
+
+			for (; k < vertex_size; k++)
+				for (u32 i{ 0 }; i < count; i++)
+					out[(u64)i * vertex_size + k] = block[(u64)k * vertex_block_size + i];
+		}
+	} // anonymous namespace
+
+	u64 IndexBufferBound(u32 index_count) {
+		const u64 triangle_count{ index_count / 3 };
+		// one code byte and at worst 3 varints per triangle
+		return 1 + triangle_count * (1 + 3 * max_varint_size);
+	}
+
+	u64 EncodeIndexBuffer(u8* const dst, u64 dst_size, const void* const indices, u32 index_count, u32 index_size) {
+		assert(dst && indices);
+		assert(index_size == sizeof(u16) || index_size == sizeof(u32));
+		if (index_count % 3 || dst_size < IndexBufferBound(index_count)) return 0;
+
+		EdgeCache cache{};
+		u32 next{ 0 }, last{ 0 };
+		u8* at{ dst };
+		*at++ = index_codec_version;
+
+		for (u32 i{ 0 }; i < index_count; i += 3) {
+			const u32 tri[3]{ ReadIndex(indices, index_size, i), ReadIndex(indices, index_size, i + 1), ReadIndex(indices, index_size, i + 2) };
+
+			u32 slot{ no_edge }, rotation{ 0 };
+			for (; rotation < 3; rotation++) {
+				slot = cache.Find(tri[rotation], tri[(rotation + 1) % 3]);
+				if (slot != no_edge) break;
+			}
+
+			if (slot != no_edge) {
+				const u32 a{ tri[rotation] }, b{ tri[(rotation + 1) % 3] }, c{ tri[(rotation + 2) % 3] };
+				u8* const code{ at++ };
+				const bool sequential{ EncodeVertex(at, c, next, last) };
+				*code = (u8)((slot << 4) | (rotation << 2) | (sequential ? 1 : 0));
+				cache.PushTriangle(a, b, c);
+			}
+			else {
+				u8* const code{ at++ };
+				u32 mask{ 0 };
+				for (u32 j{ 0 }; j < 3; j++)
+					if (EncodeVertex(at, tri[j], next, last)) mask |= 1 << j;
+				*code = (u8)((no_edge << 4) | mask);
+				cache.PushTriangle(tri[0], tri[1], tri[2]);
+			}
+		}
+
+		assert((u64)(at - dst) <= dst_size);
+		return at - dst;
+	}
+
+	bool DecodeIndexBuffer(void* const indices, u32 index_count, u32 index_size, const u8* const src, u64 src_size) {
+		assert(indices && src);
+		assert(index_size == sizeof(u16) || index_size == sizeof(u32));
+		if (index_count % 3 || !src_size || src[0] != index_codec_version) return false;
+
+		EdgeCache cache{};
+		u32 next{ 0 }, last{ 0 };
+		const u8* at{ src + 1 };
+		const u8* const end{ src + src_size };
+
+		for (u32 i{ 0 }; i < index_count; i += 3) {
+			if (at >= end) return false;
+			const u8 code{ *at++ };
+			const u32 slot{ (u32)code >> 4 };
+			u32 tri[3];
+
+			if (slot != no_edge) {
+				const u32 rotation{ (u32)(code >> 2) & 0x03 };
+				if (rotation > 2) return false;
+				// NOTE: a copy, PushTriangle() overwrites the deepest slots.
+				const Edge edge{ cache.Get(slot) };
+				u32 c;
+				if (!DecodeVertex(at, end, code & 0x01, next, last, c)) return false;
+				cache.PushTriangle(edge.a, edge.b, c);
+				tri[rotation] = edge.a;
+				tri[(rotation + 1) % 3] = edge.b;
+				tri[(rotation + 2) % 3] = c;
+			}
+			else {
+				for (u32 j{ 0 }; j < 3; j++)
+					if (!DecodeVertex(at, end, code & (1 << j), next, last, tri[j])) return false;
+				cache.PushTriangle(tri[0], tri[1], tri[2]);
+			}
+
+			WriteIndex(indices, index_size, i, tri[0]);
+			WriteIndex(indices, index_size, i + 1, tri[1]);
+			WriteIndex(indices, index_size, i + 2, tri[2]);
+		}
+
+		return at == end;
+	}
+
+	u64 VertexBufferBound(u32 vertex_count, u32 vertex_size) {
+		const u64 block_count{ (vertex_count + vertex_block_size - 1) / vertex_block_size };
+		return 1 + block_count * (HeaderSize(vertex_size) + (u64)vertex_size * vertex_block_size);
+	}
+
+	u64 EncodeVertexBuffer(u8* const dst, u64 dst_size, const void* const vertices, u32 vertex_count, u32 vertex_size) {
+		assert(dst && vertices && vertex_size);
+		if (dst_size < VertexBufferBound(vertex_count, vertex_size)) return 0;
+
+		const u8* const src{ (const u8*)vertices };
+		const u32 header_size{ HeaderSize(vertex_size) };
+		std::unique_ptr<u8[]> last{ std::make_unique<u8[]>(vertex_size) };
+		memset(last.get(), 0, vertex_size);
+
+		u8* at{ dst };
+		*at++ = vertex_codec_version;
+
+		for (u32 first{ 0 }; first < vertex_count; first += vertex_block_size) {
+			u8* const header{ at };
+			memset(header, 0, header_size);
+			at += header_size;
+
+			for (u32 k{ 0 }; k < vertex_size; k++) {
+				u8 deltas[vertex_block_size];
+				u8 prev{ last[k] };
+				for (u32 i{ 0 }; i < vertex_block_size; i++) {
+					// NOTE: the last block is padded by repeating the last vertex, which costs nothing.
+					const u32 v{ std::min(first + i, vertex_count - 1) };
+					const u8 value{ src[(u64)v * vertex_size + k] };
+					deltas[i] = (u8)ZigZag((u32)(s32)(s8)(u8)(value - prev));
+					prev = value;
+				}
+				last[k] = prev;
+
+				const u32 code{ StreamCode(deltas) };
+				header[k >> 2] |= (u8)(code << ((k & 0x03) << 1));
+				at = PackStream(at, deltas, code);
+			}
+		}
+
+		assert((u64)(at - dst) <= dst_size);
+		return at - dst;
+	}
+
+	bool DecodeVertexBuffer(void* const vertices, u32 vertex_count, u32 vertex_size, const u8* const src, u64 src_size) {
+		assert(vertices && src && vertex_size);
+		if (!src_size || src[0] != vertex_codec_version) return false;
+
+		u8* const dst{ (u8*)vertices };
+		const u32 header_size{ HeaderSize(vertex_size) };
+		// Decoded streams are kept in SoA layout per block and transposed into vertices afterwards.
+		std::unique_ptr<u8[]> block{ std::make_unique<u8[]>((u64)vertex_size * vertex_block_size) };
+		std::unique_ptr<u8[]> last{ std::make_unique<u8[]>(vertex_size) };
+		memset(last.get(), 0, vertex_size);
+
+		const u8* at{ src + 1 };
+		const u8* const end{ src + src_size };
+
+		for (u32 first{ 0 }; first < vertex_count; first += vertex_block_size) {
+			if ((u64)(end - at) < header_size) return false;
+			const u8* const header{ at };
+			at += header_size;
+
+			for (u32 k{ 0 }; k < vertex_size; k++) {
+				const u32 code{ (u32)(header[k >> 2] >> ((k & 0x03) << 1)) & 0x03 };
+				if ((u64)(end - at) < stream_size[code]) return false;
+				u8* const stream{ &block[(u64)k * vertex_block_size] };
+				_mm_storeu_si128((__m128i*)stream, DecodeDeltas(UnpackStream(at, code), _mm_set1_epi8((char)last[k])));
+				at += stream_size[code];
+				last[k] = stream[vertex_block_size - 1];
+			}
+
+			const u32 count{ std::min(vertex_block_size, vertex_count - first) };
+			TransposeBlock(&dst[(u64)first * vertex_size], block.get(), count, vertex_size);
+		}
+
+		return at == end;
+	}
+}
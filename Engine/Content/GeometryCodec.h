@@ -0,0 +1,24 @@
+#pragma once
+#include "CommonHeaders.h"
+
+// Lossless byte-oriented codecs for packed geometry buffers.
+//
+// Index buffers (triangle lists only) are coded per triangle. A triangle that shares an edge
+// with a recently seen triangle is stored as an edge cache slot plus its third vertex. Vertex
+// indices themselves are coded as zigzag deltas to the previous index, and vertices that are
+// referenced for the first time in order cost no payload at all.
+//
+// Vertex buffers are coded in blocks of 16 vertices. Every byte of the vertex is treated as a
+// separate stream that stores the zigzag encoded delta to the same byte of the previous vertex,
+// bit packed with a width of 0, 2, 4 or 8 bits chosen per block and stream.
+namespace Zetta::Content::Codec {
+	[[nodiscard]] u64 IndexBufferBound(u32 index_count);
+	// Returns the encoded size or 0 if the indices can't be encoded (not a triangle list or dst too small).
+	[[nodiscard]] u64 EncodeIndexBuffer(u8* const dst, u64 dst_size, const void* const indices, u32 index_count, u32 index_size);
+	[[nodiscard]] bool DecodeIndexBuffer(void* const indices, u32 index_count, u32 index_size, const u8* const src, u64 src_size);
+
+	[[nodiscard]] u64 VertexBufferBound(u32 vertex_count, u32 vertex_size);
+	// Returns the encoded size or 0 if dst is too small.
+	[[nodiscard]] u64 EncodeVertexBuffer(u8* const dst, u64 dst_size, const void* const vertices, u32 vertex_count, u32 vertex_size);
+	[[nodiscard]] bool DecodeVertexBuffer(void* const vertices, u32 vertex_count, u32 vertex_size, const u8* const src, u64 src_size);
+}
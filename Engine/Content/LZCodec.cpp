@@ -0,0 +1,168 @@
+#include "LZCodec.h"
+
+namespace Zetta::Content::LZ {
+	namespace {
+		constexpr u32 min_match{ 4 };
+		constexpr u32 hash_log{ 14 };
+		// The last match has to start this many bytes before the end of the block and the last
+		// literals have to be at least end_literals long. This lets the decoder copy 8 bytes at a time.
+		constexpr u32 match_start_limit{ 12 };
+		constexpr u32 end_literals{ 5 };
+		constexpr u32 max_offset{ 0xffff };
+		constexpr u32 skip_trigger{ 6 };
+
+		[[nodiscard]] u32 Read32(const u8* const at) {
+			u32 v;
+			memcpy(&v, at, sizeof(u32));
+			return v;
+		}
+
+		[[nodiscard]] constexpr u32 Hash(u32 sequence) {
+			return (sequence * 2654435761u) >> (32 - hash_log);
+		}
+
+		u8* WriteLength(u8* at, u64 length) {
+			for (; length >= 255; length -= 255) *at++ = 255;
+			*at++ = (u8)length;
+			return at;
+		}
+
+		[[nodiscard]] bool ReadLength(const u8*& at, const u8* const end, u64& length) {
+			u8 byte;
+			do {
+				if (at >= end) return false;
+				byte = *at++;
+				length += byte;
+			} while (byte == 255);
+			return true;
+		}
+
+		// Writes literals [anchor, literal_end) followed by a match, or only the literals if match_length is 0.
+		[[nodiscard]] u8* WriteRecord(u8* at, const u8* const end, const u8* const anchor, const u8* const literal_end, u32 offset, u64 match_length) {
+			const u64 literal_length{ (u64)(literal_end - anchor) };
+			const u64 worst_size{ 1 + literal_length / 255 + 1 + literal_length + 2 + match_length / 255 + 1 };
+			if ((u64)(end - at) < worst_size) return nullptr;
+
+			u8* const token{ at++ };
+			*token = (u8)(std::min<u64>(literal_length, 15) << 4);
+			if (literal_length >= 15) at = WriteLength(at, literal_length - 15);
+			memcpy(at, anchor, literal_length);
+			at += literal_length;
+
+			if (match_length) {
+				*at++ = (u8)offset;
+				*at++ = (u8)(offset >> 8);
+				const u64 length{ match_length - min_match };
+				*token |= (u8)std::min<u64>(length, 15);
+				if (length >= 15) at = WriteLength(at, length - 15);
+			}
+
+			return at;
+		}
+	} // anonymous namespace
+
+	u64 Compress(u8* const dst, u64 dst_size, const u8* const src, u64 src_size) {
+		assert(dst && src && src_size <= max_block_size);
+		u8* at{ dst };
+		const u8* const dst_end{ dst + dst_size };
+		const u8* anchor{ src };
+
+		if (src_size > match_start_limit) {
+			u32 table[1 << hash_log];
+			memset(table, 0xff, sizeof(table));
+			const u8* const match_limit{ src + src_size - match_start_limit };
+			const u8* const match_end{ src + src_size - end_literals };
+			const u8* ip{ src };
+
+			while (ip < match_limit) {
+				const u32 sequence{ Read32(ip) };
+				const u32 h{ Hash(sequence) };
+				const u32 candidate{ table[h] };
+				const u32 position{ (u32)(ip - src) };
+				table[h] = position;
+
+				if (candidate == u32_invalid_id || position - candidate > max_offset || Read32(src + candidate) != sequence) {
+					// skip faster through data that doesn't compress
+					ip += 1 + ((ip - anchor) >> skip_trigger);
+					continue;
+				}
+
+				const u8* match{ src + candidate };
+				while (ip > anchor && match > src && ip[-1] == match[-1]) {
+					ip--;
+					match--;
+				}
+
+				const u8* end{ ip + min_match };
+				const u8* ref{ match + min_match };
+				while (end < match_end && *end == *ref) {
+					end++;
+					ref++;
+				}
+
+				at = WriteRecord(at, dst_end, anchor, ip, (u32)(ip - match), (u64)(end - ip));
+				if (!at) return 0;
+
+				ip = anchor = end;
+				if (ip < match_limit) table[Hash(Read32(ip - 2))] = (u32)(ip - 2 - src);
+			}
+		}
+
+		at = WriteRecord(at, dst_end, anchor, src + src_size, 0, 0);
+		if (!at) return 0;
+		const u64 size{ (u64)(at - dst) };
+		return size < src_size ? size : 0;
+	}
+
+	bool Decompress(u8* const dst, u64 dst_size, const u8* const src, u64 src_size) {
+		assert(dst && src);
+		const u8* at{ src };
+		const u8* const src_end{ src + src_size };
+		u8* op{ dst };
+		u8* const dst_end{ dst + dst_size };
+
+		while (at < src_end) {
+			const u8 token{ *at++ };
+			u64 literal_length{ (u64)(token >> 4) };
+			if (literal_length == 15 && !ReadLength(at, src_end, literal_length)) return false;
+			if (literal_length > (u64)(src_end - at) || literal_length > (u64)(dst_end - op)) return false;
+			if (literal_length <= 16 && src_end - at >= 16 && dst_end - op >= 16) {
+				// short literals are copied with a fixed size, which is a lot faster than a variable memcpy
+				memcpy(op, at, 16);
+			}
+			else {
+				memcpy(op, at, literal_length);
+			}
+			op += literal_length;
+			at += literal_length;
+
+			if (at == src_end) break; // the last record has no match
+
+			if (src_end - at < 2) return false;
+			const u32 offset{ (u32)at[0] | ((u32)at[1] << 8) };
+			at += 2;
+			if (!offset || offset > (u64)(op - dst)) return false;
+
+			u64 match_length{ (u64)(token & 15) };
+			if (match_length == 15 && !ReadLength(at, src_end, match_length)) return false;
+			match_length += min_match;
+			if (match_length > (u64)(dst_end - op)) return false;
+
+			const u8* match{ op - offset };
+			u8* const end{ op + match_length };
+			if (offset >= 16 && match_length <= 16 && dst_end - op >= 16) {
+				memcpy(op, match, 16);
+			}
+			else if (offset >= sizeof(u64) && (u64)(dst_end - end) >= sizeof(u64)) {
+				// NOTE: may write up to 7 bytes past the match, which the next record overwrites.
+				for (; op < end; op += sizeof(u64), match += sizeof(u64)) memcpy(op, match, sizeof(u64));
+			}
+			else {
+				for (; op < end; op++, match++) *op = *match;
+			}
+			op = end;
+		}
+
+		return op == dst_end;
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include "CommonHeaders.h"
+
+// Byte-oriented LZ77 codec for package blocks, in the spirit of LZ4: greedy matching with a hash
+// table on compression and only copies on decompression.
+//
+// A block is a sequence of [token, literal length, literals, match offset, match length] records.
+// The token holds 4 bits of literal length and 4 bits of match length (minus 4), both extended with
+// 255-terminated bytes. Offsets are 16 bit, so blocks must not exceed 64KB. The last record has
+// literals only.
+namespace Zetta::Content::LZ {
+	constexpr u32 max_block_size{ 64 * 1024 };
+
+	[[nodiscard]] constexpr u64 CompressBound(u64 size) { return size + size / 255 + 16; }
+	// Returns the compressed size, or 0 if dst is too small or the data doesn't compress.
+	[[nodiscard]] u64 Compress(u8* const dst, u64 dst_size, const u8* const src, u64 src_size);
+	// Returns true only if src decodes to exactly dst_size bytes.
+	[[nodiscard]] bool Decompress(u8* const dst, u64 dst_size, const u8* const src, u64 src_size);
+}
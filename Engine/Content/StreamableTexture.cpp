@@ -0,0 +1,187 @@
+#include "StreamableTexture.h"
+#include "ContentToEngine.h"
+#include "LZCodec.h"
+
+namespace Zetta::Content::StreamableTexture {
+	namespace {
+		[[nodiscard]] u32 BlockCount(u32 size) {
+			return (size + LZ::max_block_size - 1) / LZ::max_block_size;
+		}
+
+		void Append(util::vector<u8>& output, const void* const data, u64 size) {
+			const u64 offset{ output.size() };
+			output.resize(offset + size);
+			memcpy(&output[offset], data, size);
+		}
+
+		void Align(util::vector<u8>& output, u64 alignment) {
+			output.resize((output.size() + alignment - 1) & ~(alignment - 1));
+		}
+
+		// Appends the chunk LZ compressed, or as is if compression doesn't make it smaller.
+		[[nodiscard]] ChunkEntry AppendChunk(util::vector<u8>& output, const util::vector<u8>& chunk) {
+			const u32 size{ (u32)chunk.size() };
+			const u32 block_count{ BlockCount(size) };
+			util::vector<u8> encoded(block_count * sizeof(u32) + LZ::CompressBound(size));
+			u64 encoded_size{ block_count * sizeof(u32) };
+
+			for (u32 i{ 0 }; i < block_count; i++) {
+				const u32 offset{ i * LZ::max_block_size };
+				const u32 block_size{ std::min(size - offset, LZ::max_block_size) };
+				u8* const dst{ &encoded[encoded_size] };
+				u64 stored_size{ LZ::Compress(dst, encoded.size() - encoded_size, &chunk[offset], block_size) };
+				if (!stored_size || stored_size >= block_size) {
+					memcpy(dst, &chunk[offset], block_size);
+					stored_size = block_size;
+				}
+
+				const u32 stored{ (u32)stored_size };
+				memcpy(&encoded[i * sizeof(u32)], &stored, sizeof(u32));
+				encoded_size += stored_size;
+			}
+
+			ChunkEntry entry{ output.size(), size, size };
+			if (encoded_size < size) {
+				entry.stored_size = (u32)encoded_size;
+				Append(output, encoded.data(), encoded_size);
+			}
+			else {
+				Append(output, chunk.data(), size);
+			}
+
+			return entry;
+		}
+	} // anonymous namespace
+
+	bool Pack(const Description& description, const u8* const subresources, u64 subresources_size,
+		u32 max_tail_size, util::vector<u8>& output) {
+		assert(subresources && subresources_size);
+		if (!description.mip_count || description.mip_count > max_mips || !description.array_size) return false;
+
+		const bool is_volume{ (description.flags & TextureFlags::IS_VOLUME_MAP) != 0 };
+		const u32 item_count{ is_volume ? 1 : description.array_size };
+		MipEntry mips[max_mips]{};
+		util::vector<const u8*> slices[max_mips];
+
+		u64 offset{ 0 };
+		for (u32 item{ 0 }; item < item_count; item++) {
+			u32 depth{ description.array_size };
+			for (u32 mip{ 0 }; mip < description.mip_count; mip++) {
+				const u32 slice_count{ is_volume ? depth : 1 };
+				for (u32 slice{ 0 }; slice < slice_count; slice++) {
+					if (offset + sizeof(u32) * 4 > subresources_size) return false;
+					u32 image[4];
+					memcpy(image, &subresources[offset], sizeof(image));
+					offset += sizeof(image);
+					if (offset + image[3] > subresources_size) return false;
+
+					MipEntry& entry{ mips[mip] };
+					if (!entry.slice_pitch) entry = { image[0], image[1], image[2], image[3], is_volume ? depth : description.array_size };
+					else if (entry.width != image[0] || entry.height != image[1] || entry.row_pitch != image[2] || entry.slice_pitch != image[3]) return false;
+
+					slices[mip].emplace_back(&subresources[offset]);
+					offset += image[3];
+				}
+				depth = std::max(depth >> 1, 1u);
+			}
+		}
+
+		// The tail takes the smallest mips that fit, and at least the last mip.
+		u32 tail_mip{ description.mip_count - 1 };
+		u64 tail_size{ MipSize(mips[tail_mip]) };
+		while (tail_mip && tail_size + MipSize(mips[tail_mip - 1]) <= max_tail_size) tail_size += MipSize(mips[--tail_mip]);
+		for (u32 mip{ 0 }; mip < description.mip_count; mip++) {
+			if (!mips[mip].slice_pitch || MipSize(mips[mip]) > ~0u) return false;
+		}
+		if (tail_size > ~0u) return false;
+
+		auto gather_chunk = [&](u32 first_mip, u32 last_mip) {
+			util::vector<u8> chunk;
+			for (u32 mip{ first_mip }; mip <= last_mip; mip++) {
+				for (const u8* const slice : slices[mip]) Append(chunk, slice, mips[mip].slice_pitch);
+			}
+			return chunk;
+		};
+
+		Header header{};
+		header.magic = texture_magic;
+		header.version = texture_version;
+		header.width = description.width;
+		header.height = description.height;
+		header.array_size = description.array_size;
+		header.mip_count = description.mip_count;
+		header.format = description.format;
+		header.flags = description.flags;
+		header.tail_mip = tail_mip;
+
+		ChunkEntry chunks[max_mips]{};
+		const u64 chunk_table_offset{ sizeof(Header) + sizeof(MipEntry) * (u64)description.mip_count };
+		output.clear();
+		output.resize(chunk_table_offset + sizeof(ChunkEntry) * (u64)(tail_mip + 1));
+		memcpy(&output[sizeof(Header)], mips, sizeof(MipEntry) * description.mip_count);
+
+		chunks[tail_mip] = AppendChunk(output, gather_chunk(tail_mip, description.mip_count - 1));
+		header.resident_size = (u32)output.size();
+
+		// Streamed chunks go smallest first, which is the order they're usually loaded in.
+		for (u32 mip{ tail_mip }; mip-- > 0;) {
+			Align(output, chunk_alignment);
+			chunks[mip] = AppendChunk(output, gather_chunk(mip, mip));
+		}
+
+		memcpy(output.data(), &header, sizeof(Header));
+		memcpy(&output[chunk_table_offset], chunks, sizeof(ChunkEntry) * (tail_mip + 1));
+		return true;
+	}
+
+	bool Validate(const u8* const data, u64 size) {
+		assert(data);
+		if (size < sizeof(Header)) return false;
+
+		const Header& header{ GetHeader(data) };
+		if (header.magic != texture_magic || header.version != texture_version ||
+			!header.mip_count || header.mip_count > max_mips || header.tail_mip >= header.mip_count ||
+			header.resident_size > size) return false;
+
+		const u64 tables_size{ sizeof(Header) + sizeof(MipEntry) * (u64)header.mip_count + sizeof(ChunkEntry) * (u64)(header.tail_mip + 1) };
+		if (tables_size > header.resident_size) return false;
+
+		const MipEntry* const mips{ GetMips(data) };
+		const ChunkEntry* const chunks{ GetChunks(data) };
+		u64 tail_size{ 0 };
+		for (u32 mip{ 0 }; mip < header.mip_count; mip++) {
+			if (!mips[mip].slice_pitch || !mips[mip].slice_count) return false;
+			if (mip < header.tail_mip && chunks[mip].size != MipSize(mips[mip])) return false;
+			if (mip >= header.tail_mip) tail_size += MipSize(mips[mip]);
+		}
+
+		const ChunkEntry& tail{ chunks[header.tail_mip] };
+		return tail.size == tail_size && tail.offset >= tables_size && tail.offset + tail.stored_size <= header.resident_size;
+	}
+
+	bool DecodeChunk(const u8* const stored, u32 stored_size, u8* const output, u32 size) {
+		assert(stored && output);
+		if (stored_size == size) {
+			memcpy(output, stored, size);
+			return true;
+		}
+
+		const u32 block_count{ BlockCount(size) };
+		u64 offset{ block_count * sizeof(u32) };
+		if (offset > stored_size) return false;
+
+		for (u32 i{ 0 }; i < block_count; i++) {
+			u32 block_stored_size;
+			memcpy(&block_stored_size, &stored[i * sizeof(u32)], sizeof(u32));
+			const u32 block_offset{ i * LZ::max_block_size };
+			const u32 block_size{ std::min(size - block_offset, LZ::max_block_size) };
+			if (offset + block_stored_size > stored_size) return false;
+
+			if (block_stored_size == block_size) memcpy(&output[block_offset], &stored[offset], block_size);
+			else if (!LZ::Decompress(&output[block_offset], block_size, &stored[offset], block_stored_size)) return false;
+			offset += block_stored_size;
+		}
+
+		return offset == stored_size;
+	}
+}
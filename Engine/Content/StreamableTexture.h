@@ -0,0 +1,82 @@
+#pragma once
+#include "CommonHeaders.h"
+
+// Streamable texture layout. Every mip above the mip tail is a chunk of its own that can be read and
+// decoded independently, so a texture only needs the mips it's seen at. The smallest mips are packed into
+// one tail chunk that is stored right after the tables and is always resident: one read of resident_size
+// bytes from the start of the file gives a texture that can be rendered at low detail.
+//
+// Chunks are LZ compressed in 64KB blocks (see LZCodec.h), unless that doesn't make them smaller. The data of
+// a chunk is the slices of its mips, one after another, each slice_pitch bytes.
+//
+// File layout:
+//     Header header
+//     MipEntry mips[mip_count]
+//     ChunkEntry chunks[tail_mip + 1]      (chunk i holds mip i, chunk tail_mip holds mips tail_mip and up)
+//     tail chunk
+//     streamed chunks, each at a chunk_alignment boundary
+//
+// Encoded chunks start with the stored size of each of their blocks as u32. A block stored with its
+// decoded size isn't compressed. A chunk whose stored size equals its size isn't encoded at all.
+namespace Zetta::Content::StreamableTexture {
+	constexpr u32 texture_magic{ 'Z' | ('T' << 8) | ('E' << 16) | ('X' << 24) };
+	constexpr u32 texture_version{ 1 };
+	constexpr u32 chunk_alignment{ 4096 };
+	constexpr u32 max_mips{ 14 };
+	constexpr u32 default_max_tail_size{ 64 * 1024 };
+
+	struct Header {
+		u32 magic;
+		u32 version;
+		u32 width;
+		u32 height;
+		u32 array_size;		// depth of volume textures
+		u32 mip_count;
+		u32 format;			// DXGI_FORMAT
+		u32 flags;			// TextureFlags
+		u32 tail_mip;		// first mip of the tail chunk
+		u32 resident_size;	// bytes from the start of the file to the end of the tail chunk
+	};
+
+	struct MipEntry {
+		u32 width;
+		u32 height;
+		u32 row_pitch;
+		u32 slice_pitch;
+		u32 slice_count;	// array size, or the depth of the mip in volume textures
+	};
+
+	struct ChunkEntry {
+		u64 offset;			// file offset
+		u32 stored_size;	// bytes in the file
+		u32 size;			// bytes once decoded
+	};
+
+	struct Description {
+		u32 width;
+		u32 height;
+		u32 array_size;
+		u32 mip_count;
+		u32 format;
+		u32 flags;
+	};
+
+	[[nodiscard]] inline const Header& GetHeader(const u8* const data) { return *(const Header*)data; }
+	[[nodiscard]] inline const MipEntry* GetMips(const u8* const data) { return (const MipEntry*)(data + sizeof(Header)); }
+	[[nodiscard]] inline const ChunkEntry* GetChunks(const u8* const data) {
+		return (const ChunkEntry*)(data + sizeof(Header) + sizeof(MipEntry) * (u64)GetHeader(data).mip_count);
+	}
+	[[nodiscard]] constexpr u64 MipSize(const MipEntry& mip) { return (u64)mip.slice_pitch * mip.slice_count; }
+
+	// Builds a streamable texture from the importer's subresource data: [u32 width, height, row pitch,
+	// slice pitch, pixels] per image, all mips of one array item after the other, or all depth slices of one
+	// mip after the other in volume textures. Mips are added to the tail while it stays within max_tail_size.
+	[[nodiscard]] bool Pack(const Description& description, const u8* const subresources, u64 subresources_size,
+		u32 max_tail_size, util::vector<u8>& output);
+
+	// Checks the header, the tables and the tail chunk. 'size' is at least the resident size, or the whole file.
+	[[nodiscard]] bool Validate(const u8* const data, u64 size);
+
+	// Decodes a chunk as it's stored in the file. Returns false if the chunk doesn't decode to exactly 'size' bytes.
+	[[nodiscard]] bool DecodeChunk(const u8* const stored, u32 stored_size, u8* const output, u32 size);
+}
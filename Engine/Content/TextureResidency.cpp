@@ -0,0 +1,368 @@
+#include "TextureResidency.h"
+#include "Platform/AsyncIO.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Zetta::Content::Residency {
+	namespace {
+		using namespace StreamableTexture;
+
+		// Priority factor of mips that are already resident. Keeps textures near a mip boundary from
+		// loading and evicting the same mip every other frame.
+		constexpr f32 resident_bonus{ 1.5f };
+
+		struct StreamedTexture {
+			ID::ID_Type		file{ ID::Invalid_ID };
+			u32				max_dimension{ 0 };
+			u32				tail_mip{ 0 };
+			ChunkEntry		chunks[max_mips]{};
+			f32				screen_pixels{ 0.f };
+			f32				frame_pixels{ 0.f };	// largest demand reported since the last update
+			u64				demand_frame{ 0 };		// frame of the last reported demand
+			u32				target_mip{ 0 };
+			u32				loaded_mask{ 0 };		// streamed mips
+			u32				pending_mask{ 0 };
+			u32				failed_mask{ 0 };		// mips that failed to read or decode aren't requested again
+		};
+
+		struct PendingRead {
+			ID::ID_Type		texture;
+			ID::ID_Type		request;
+			u32				mip;
+		};
+
+		struct Candidate {
+			f32				priority;
+			u32				index;
+			u32				mip;
+		};
+
+		util::FreeList<StreamedTexture> textures;
+		// Ids of the added textures, so they can be iterated.
+		util::vector<ID::ID_Type> texture_ids;
+		util::vector<PendingRead> pending_reads;
+		util::vector<u8> decode_buffer;
+		Settings settings{};
+		LoadedCallback on_loaded{ nullptr };
+		EvictedCallback on_evicted{ nullptr };
+		void* callback_user{ nullptr };
+		Stats stats{};
+		u64 frame{ 0 };
+		bool is_initialized{ false };
+		std::mutex residency_mutex;
+
+		[[nodiscard]] constexpr bool IsSet(u32 mask, u32 mip) { return (mask >> mip) & 1; }
+
+		[[nodiscard]] u32 GetResidentMip(const StreamedTexture& texture) {
+			u32 mip{ texture.tail_mip };
+			while (mip && IsSet(texture.loaded_mask, mip - 1)) mip--;
+			return mip;
+		}
+
+		[[nodiscard]] f32 Priority(f32 screen_pixels, u32 max_dimension, u32 mip) {
+			return screen_pixels / (f32)std::max(max_dimension >> mip, 1u);
+		}
+
+		// NOTE: expects residency_mutex to be locked.
+		void Evict(ID::ID_Type id, StreamedTexture& texture, u32 mip) {
+			texture.loaded_mask &= ~(1u << mip);
+			stats.resident_bytes -= texture.chunks[mip].size;
+			stats.evicted_mips++;
+			on_evicted(id, mip, callback_user);
+		}
+
+		// Decodes a chunk into the decode buffer and hands it to the loaded callback.
+		// NOTE: expects residency_mutex to be locked.
+		[[nodiscard]] bool Deliver(ID::ID_Type id, u32 mip, const u8* const stored, const ChunkEntry& chunk) {
+			decode_buffer.resize(chunk.size);
+			if (!DecodeChunk(stored, chunk.stored_size, decode_buffer.data(), chunk.size)) return false;
+			on_loaded(id, mip, decode_buffer.data(), chunk.size, callback_user);
+			return true;
+		}
+
+		// Finishes the read, which has to be completed, failed or cancelled, and loads the mip if it's still wanted.
+		// NOTE: expects residency_mutex to be locked.
+		void Finish(const PendingRead& read) {
+			StreamedTexture& texture{ textures[read.texture] };
+			const ChunkEntry& chunk{ texture.chunks[read.mip] };
+			const IO::ReadResult result{ IO::Wait(read.request) };
+			texture.pending_mask &= ~(1u << read.mip);
+			stats.in_flight_bytes -= chunk.size;
+			stats.reads_in_flight--;
+
+			if (result.status == IO::Status::Failed) texture.failed_mask |= 1u << read.mip;
+			if (result.status == IO::Status::Completed && read.mip >= texture.target_mip) {
+				if (result.bytes_read == chunk.stored_size && Deliver(read.texture, read.mip, result.buffer, chunk)) {
+					texture.loaded_mask |= 1u << read.mip;
+					stats.resident_bytes += chunk.size;
+					stats.loaded_mips++;
+				}
+				else {
+					texture.failed_mask |= 1u << read.mip;
+				}
+			}
+
+			if (result.buffer) IO::ReleaseBuffer(result.buffer);
+		}
+
+		// Cancels the read if it's still queued and finishes it, or waits for it if 'wait' is set.
+		// Returns false if the read is still in flight.
+		// NOTE: expects residency_mutex to be locked.
+		[[nodiscard]] bool CancelRead(const PendingRead& read, bool wait) {
+			if (!IO::Cancel(read.request) && !wait && IO::GetStatus(read.request) == IO::Status::InFlight) return false;
+			Finish(read);
+			return true;
+		}
+
+		// NOTE: expects residency_mutex to be locked.
+		void UpdateTargets() {
+			const u32 count{ (u32)texture_ids.size() };
+			util::vector<TextureDemand> demands(count);
+			util::vector<u32> targets(count);
+			for (u32 i{ 0 }; i < count; i++) {
+				StreamedTexture& texture{ textures[texture_ids[i]] };
+				if (texture.frame_pixels > 0.f) {
+					texture.screen_pixels = texture.frame_pixels;
+					texture.demand_frame = frame;
+				}
+				else if (frame - texture.demand_frame >= settings.demand_frames) {
+					texture.screen_pixels = 0.f;
+				}
+				texture.frame_pixels = 0.f;
+
+				TextureDemand& demand{ demands[i] };
+				demand.screen_pixels = texture.screen_pixels;
+				demand.max_dimension = texture.max_dimension;
+				demand.tail_mip = texture.tail_mip;
+				demand.resident_mip = GetResidentMip(texture);
+				for (u32 mip{ 0 }; mip < texture.tail_mip; mip++) demand.mip_sizes[mip] = texture.chunks[mip].size;
+			}
+
+			ChooseTargetMips(demands.data(), count, settings.budget, settings.mip_bias, targets.data());
+			for (u32 i{ 0 }; i < count; i++) textures[texture_ids[i]].target_mip = targets[i];
+		}
+
+		// Evicts the mips finer than the target and cancels their reads. Reads that can't be cancelled
+		// are discarded when they complete.
+		// NOTE: expects residency_mutex to be locked.
+		void EvictUnwanted() {
+			for (const ID::ID_Type id : texture_ids) {
+				StreamedTexture& texture{ textures[id] };
+				for (u32 mip{ 0 }; mip < texture.target_mip; mip++) {
+					if (IsSet(texture.loaded_mask, mip)) Evict(id, texture, mip);
+				}
+			}
+
+			for (u32 i{ (u32)pending_reads.size() }; i-- > 0;) {
+				const PendingRead read{ pending_reads[i] };
+				if (read.mip < textures[read.texture].target_mip && CancelRead(read, false)) pending_reads.erase(i);
+			}
+		}
+
+		// NOTE: expects residency_mutex to be locked.
+		void FinishCompletedReads() {
+			for (u32 i{ 0 }; i < pending_reads.size();) {
+				const IO::Status::Type status{ IO::GetStatus(pending_reads[i].request) };
+				if (status == IO::Status::Queued || status == IO::Status::InFlight) {
+					i++;
+					continue;
+				}
+
+				Finish(pending_reads[i]);
+				pending_reads.erase(i);
+			}
+		}
+
+		// Requests the missing mips down to the target, highest priority first, as long as the budget and the
+		// number of reads in flight allow. The coarsest missing mip of a visible texture is read with high
+		// I/O priority, because until it arrives the texture is shown at tail detail.
+		// NOTE: expects residency_mutex to be locked.
+		void IssueReads() {
+			if (stats.reads_in_flight >= settings.max_reads_in_flight) return;
+
+			util::vector<Candidate> candidates;
+			for (u32 i{ 0 }; i < texture_ids.size(); i++) {
+				const StreamedTexture& texture{ textures[texture_ids[i]] };
+				for (u32 mip{ texture.tail_mip }; mip-- > texture.target_mip;) {
+					if (IsSet(texture.loaded_mask | texture.pending_mask | texture.failed_mask, mip)) continue;
+					candidates.emplace_back(Priority(texture.screen_pixels, texture.max_dimension, mip), i, mip);
+				}
+			}
+
+			std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+				return a.priority != b.priority ? a.priority > b.priority : a.mip > b.mip;
+			});
+
+			util::vector<IO::ReadRequest> requests;
+			for (const Candidate& candidate : candidates) {
+				if (stats.reads_in_flight >= settings.max_reads_in_flight) break;
+				const ID::ID_Type id{ texture_ids[candidate.index] };
+				StreamedTexture& texture{ textures[id] };
+				const ChunkEntry& chunk{ texture.chunks[candidate.mip] };
+				if (stats.resident_bytes + stats.in_flight_bytes + chunk.size > settings.budget) continue;
+
+				const bool is_first_missing{ GetResidentMip(texture) == candidate.mip + 1 && !texture.pending_mask };
+				const IO::Priority::Type priority{ is_first_missing && texture.screen_pixels > 0.f ? IO::Priority::High : IO::Priority::Normal };
+				requests.emplace_back(texture.file, chunk.offset, chunk.stored_size, nullptr, priority);
+				pending_reads.emplace_back(id, ID::Invalid_ID, candidate.mip);
+				texture.pending_mask |= 1u << candidate.mip;
+				stats.in_flight_bytes += chunk.size;
+				stats.reads_in_flight++;
+			}
+
+			if (requests.empty()) return;
+			util::vector<ID::ID_Type> request_ids(requests.size());
+			IO::SubmitReads(requests.data(), (u32)requests.size(), request_ids.data());
+			const u64 first{ pending_reads.size() - requests.size() };
+			for (u64 i{ 0 }; i < requests.size(); i++) pending_reads[first + i].request = request_ids[i];
+		}
+	} // anonymous namespace
+
+	void ChooseTargetMips(const TextureDemand* const demands, u32 count, u64 budget, f32 mip_bias, u32* const target_mips) {
+		assert((demands && target_mips) || !count);
+		util::vector<Candidate> candidates;
+		for (u32 i{ 0 }; i < count; i++) {
+			const TextureDemand& demand{ demands[i] };
+			assert(demand.tail_mip < max_mips && demand.max_dimension);
+			target_mips[i] = demand.tail_mip;
+			if (demand.screen_pixels <= 0.f || !demand.tail_mip) continue;
+
+			const f32 level{ std::log2((f32)demand.max_dimension / demand.screen_pixels) + mip_bias };
+			const u32 desired_mip{ level <= 0.f ? 0 : std::min((u32)level, demand.tail_mip) };
+			for (u32 mip{ desired_mip }; mip < demand.tail_mip; mip++) {
+				f32 priority{ Priority(demand.screen_pixels, demand.max_dimension, mip) };
+				if (mip >= demand.resident_mip) priority *= resident_bonus;
+				candidates.emplace_back(priority, i, mip);
+			}
+		}
+
+		// Within a texture, coarser mips always come first, so taking a mip only if the next coarser
+		// one was taken keeps the resident chain contiguous.
+		std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+			return a.priority != b.priority ? a.priority > b.priority : a.mip > b.mip;
+		});
+
+		u64 remaining{ budget };
+		for (const Candidate& candidate : candidates) {
+			const u64 size{ demands[candidate.index].mip_sizes[candidate.mip] };
+			u32& target_mip{ target_mips[candidate.index] };
+			if (target_mip != candidate.mip + 1 || size > remaining) continue;
+			target_mip = candidate.mip;
+			remaining -= size;
+		}
+	}
+
+	bool Initialize(const Settings& init_settings, LoadedCallback loaded, EvictedCallback evicted, void* user) {
+		assert(loaded && evicted && init_settings.max_reads_in_flight);
+		std::lock_guard lock{ residency_mutex };
+		assert(!is_initialized);
+		settings = init_settings;
+		on_loaded = loaded;
+		on_evicted = evicted;
+		callback_user = user;
+		stats = {};
+		frame = 0;
+		is_initialized = true;
+		return true;
+	}
+
+	void Shutdown() {
+		std::lock_guard lock{ residency_mutex };
+		assert(is_initialized);
+		// Reads that complete anyway are discarded.
+		for (const ID::ID_Type id : texture_ids) textures[id].target_mip = textures[id].tail_mip;
+		for (const PendingRead& read : pending_reads) (void)CancelRead(read, true);
+		pending_reads.clear();
+		for (const ID::ID_Type id : texture_ids) textures.Remove(id);
+		texture_ids.clear();
+		decode_buffer.clear();
+		is_initialized = false;
+	}
+
+	ID::ID_Type Add(ID::ID_Type file_id, const u8* const resident, u64 size) {
+		assert(ID::IsValid(file_id) && resident);
+		if (!Validate(resident, size)) return ID::Invalid_ID;
+
+		const Header& header{ GetHeader(resident) };
+		StreamedTexture texture{};
+		texture.file = file_id;
+		texture.max_dimension = std::max({ header.width, header.height, 1u });
+		texture.tail_mip = header.tail_mip;
+		texture.target_mip = header.tail_mip;
+		memcpy(texture.chunks, GetChunks(resident), sizeof(ChunkEntry) * (header.tail_mip + 1));
+
+		std::lock_guard lock{ residency_mutex };
+		assert(is_initialized);
+		const ID::ID_Type id{ textures.Add(texture) };
+		const ChunkEntry& tail{ texture.chunks[texture.tail_mip] };
+		if (!Deliver(id, texture.tail_mip, resident + tail.offset, tail)) {
+			textures.Remove(id);
+			return ID::Invalid_ID;
+		}
+
+		texture_ids.emplace_back(id);
+		stats.tail_bytes += tail.size;
+		stats.texture_count++;
+		return id;
+	}
+
+	void Remove(ID::ID_Type id) {
+		assert(ID::IsValid(id));
+		std::lock_guard lock{ residency_mutex };
+		StreamedTexture& texture{ textures[id] };
+		texture.target_mip = texture.tail_mip;
+		for (u32 i{ (u32)pending_reads.size() }; i-- > 0;) {
+			if (pending_reads[i].texture != id) continue;
+			(void)CancelRead(pending_reads[i], true);
+			pending_reads.erase(i);
+		}
+
+		for (u32 mip{ 0 }; mip < texture.tail_mip; mip++) {
+			if (IsSet(texture.loaded_mask, mip)) stats.resident_bytes -= texture.chunks[mip].size;
+		}
+		stats.tail_bytes -= texture.chunks[texture.tail_mip].size;
+		stats.texture_count--;
+
+		for (u32 i{ 0 }; i < texture_ids.size(); i++) {
+			if (texture_ids[i] == id) {
+				texture_ids.erase(i);
+				break;
+			}
+		}
+		textures.Remove(id);
+	}
+
+	void ReportDemand(ID::ID_Type id, f32 screen_pixels) {
+		assert(ID::IsValid(id));
+		std::lock_guard lock{ residency_mutex };
+		StreamedTexture& texture{ textures[id] };
+		texture.frame_pixels = std::max(texture.frame_pixels, screen_pixels);
+	}
+
+	void Update() {
+		std::lock_guard lock{ residency_mutex };
+		assert(is_initialized);
+		frame++;
+		UpdateTargets();
+		EvictUnwanted();
+		FinishCompletedReads();
+		IssueReads();
+	}
+
+	u32 ResidentMip(ID::ID_Type id) {
+		assert(ID::IsValid(id));
+		std::lock_guard lock{ residency_mutex };
+		return GetResidentMip(textures[id]);
+	}
+
+	u32 TargetMip(ID::ID_Type id) {
+		assert(ID::IsValid(id));
+		std::lock_guard lock{ residency_mutex };
+		return textures[id].target_mip;
+	}
+
+	Stats GetStats() {
+		std::lock_guard lock{ residency_mutex };
+		return stats;
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "CommonHeaders.h"
+#include "StreamableTexture.h"
+
+// CPU side of texture streaming. Keeps the mips of streamable textures (see StreamableTexture.h) resident
+// within a memory budget, according to how large the textures were on screen in the last frames.
+//
+// Every Update() picks a target mip per texture with ChooseTargetMips(), evicts the mips finer than that,
+// finishes completed reads and issues reads for missing mips through the async I/O module. Loaded and
+// evicted mips are handed to callbacks, which is where the renderer would upload or drop them, so the
+// policy and the I/O scheduling don't need a GPU.
+namespace Zetta::Content::Residency {
+	struct Settings {
+		u64 budget{ 256ull * 1024 * 1024 };		// bytes of streamed mips, resident or being read. Tails don't count.
+		u32 max_reads_in_flight{ 16 };
+		u32 demand_frames{ 4 };					// frames a texture keeps its last demand without new reports
+		f32 mip_bias{ 0.f };					// added to the desired mip level, positive values load less detail
+	};
+
+	// 'data' is only valid during the call. Mips can arrive in any order, the tail mip always arrives first.
+	// NOTE: callbacks are called with the residency lock taken and must not call back into this module.
+	using LoadedCallback = void(*)(ID::ID_Type texture_id, u32 mip, const u8* const data, u32 size, void* user);
+	using EvictedCallback = void(*)(ID::ID_Type texture_id, u32 mip, void* user);
+
+	struct TextureDemand {
+		f32 screen_pixels;						// largest on-screen size along one axis, 0 if not visible
+		u32 max_dimension;						// largest of width and height of mip 0
+		u32 tail_mip;
+		u32 resident_mip;						// finest mip of the resident chain
+		u64 mip_sizes[StreamableTexture::max_mips];
+	};
+
+	struct Stats {
+		u64 resident_bytes;						// streamed mips only
+		u64 in_flight_bytes;
+		u64 tail_bytes;
+		u32 texture_count;
+		u32 reads_in_flight;
+		u32 loaded_mips;						// since Initialize()
+		u32 evicted_mips;
+	};
+
+	// Picks the finest mip to keep for each texture, so that the streamed mips of all textures fit in 'budget'.
+	// A texture asks for the mip whose size is closest to its screen size. Mips are granted in order of screen
+	// pixels per texel, coarsest first within a texture, and resident mips are preferred to avoid thrashing.
+	void ChooseTargetMips(const TextureDemand* const textures, u32 count, u64 budget, f32 mip_bias, u32* const target_mips);
+
+	bool Initialize(const Settings& settings, LoadedCallback loaded, EvictedCallback evicted, void* user = nullptr);
+	// NOTE: waits for reads that can't be cancelled.
+	void Shutdown();
+
+	// Adds a texture from the file opened with IO::OpenFile() and its first resident_size bytes, and delivers
+	// its tail mips. Returns ID::Invalid_ID if the data isn't a valid streamable texture.
+	[[nodiscard]] ID::ID_Type Add(ID::ID_Type file_id, const u8* const resident, u64 size);
+	// Drops the texture without calling the evicted callback.
+	void Remove(ID::ID_Type id);
+
+	// Can be called several times per frame, the largest size is kept.
+	void ReportDemand(ID::ID_Type id, f32 screen_pixels);
+	void Update();
+
+	[[nodiscard]] u32 ResidentMip(ID::ID_Type id);
+	[[nodiscard]] u32 TargetMip(ID::ID_Type id);
+	[[nodiscard]] Stats GetStats();
+}
@@ -1,8 +1,10 @@
 #if !defined(SHIPPING) && defined(_WIN64)
 #include "Content/ContentLoader.h"
+#include "Content/ContentToEngine.h"
 #include "Components/Script.h"	
 #include "Platform/PlatformTypes.h"
 #include "Platform/Platform.h"
+#include "Platform/AsyncIO.h"
 #include "Graphics/Renderer.h"
 #include <thread>
 
@@ -35,14 +37,24 @@ namespace {
 }
 
 bool engine_initialize() {
-	if (!Content::LoadGame()) return false;
+	if (!IO::Initialize()) return false;
+	if (!Content::LoadGame()) {
+		// NOTE: a failed load can leave the game package mounted and some of the entities created.
+		Content::UnloadGame();
+		IO::Shutdown();
+		return false;
+	}
 
 	Platform::WindowInitInfo info{
 		&WinProc, nullptr, L"Zetta Game" // TODO: Get game name from binary 
 	};
 
 	game_window.window = Platform::CreateWindow(&info);
-	if (!game_window.window.IsValid()) return false;
+	if (!game_window.window.IsValid()) {
+		Content::UnloadGame();
+		IO::Shutdown();
+		return false;
+	}
 
 	return true;
 }
@@ -53,7 +65,10 @@ void engine_update() {
 }
 
 void engine_shutdown() {
+	// NOTE: resource batches still in flight call into the renderer, so they finish before anything is torn down.
+	Zetta::Content::Shutdown();
 	Platform::RemoveWindow(game_window.window.GetID());
 	Zetta::Content::UnloadGame();
+	IO::Shutdown();
 }
 #endif
\ No newline at end of file
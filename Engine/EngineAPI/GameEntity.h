@@ -52,7 +52,18 @@ namespace Zetta{
 		namespace Detail {
 			using ScriptPtr = std::unique_ptr<EntityScript>;
 			using ScriptCreator = ScriptPtr(*)(GameEntity::Entity entity);
-			using StringHash = std::hash<std::string>;
+			// 64-bit FNV-1a of the script's class name. Unlike std::hash it's the same for every compiler,
+			// so the editor writes script ids to the scene file and the engine doesn't hash names at load time.
+			struct StringHash {
+				[[nodiscard]] constexpr size_t operator()(const char* name) const {
+					u64 hash{ 0xcbf29ce484222325ull };
+					while (*name) {
+						hash ^= (u8)*name++;
+						hash *= 0x100000001b3ull;
+					}
+					return (size_t)hash;
+				}
+			};
 
 			u8 RegisterScript(size_t, ScriptCreator);
 
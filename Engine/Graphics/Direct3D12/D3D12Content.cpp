@@ -1,6 +1,7 @@
 #include "D3D12Content.h"
 #include "D3D12Core.h"
 #include "D3D12Helpers.h"
+#include "D3D12Upload.h"
 #include "Utilities//IOStream.h"
 #include "Content/ContentToEngine.h"
 #include "D3D12GPass.h"
@@ -19,6 +20,7 @@ namespace Zetta::Graphics::D3D12::Content {
 			D3D12_INDEX_BUFFER_VIEW						index_buffer_view{};
 			u32											elements_type{};
 			D3D_PRIMITIVE_TOPOLOGY						primitive_topology{};
+			Submesh::PositionDequantization				position_dequantization{};
 		};
 
 		struct D3D12RenderItem {
@@ -374,52 +376,133 @@ namespace Zetta::Graphics::D3D12::Content {
 	}
 
 	namespace Submesh {
-		ID::ID_Type Add(const u8*& data) {
-			util::BlobStreamReader blob{ (const u8*)data };
-			const u32 element_size{ blob.read<u32>() };
-			const u32 vertex_count{ blob.read<u32>() };
-			const u32 index_count{ blob.read<u32>() };
-			const u32 elements_type{ blob.read<u32>() };
-			const u32 primitive_topology{ blob.read<u32>() };
-			const u32 index_size{ (vertex_count < (1 << 16)) ? sizeof(u16) : sizeof(u32) };
-
-			const u32 position_buffer_size{ sizeof(Math::v3) * vertex_count };
-			const u32 element_buffer_size{ element_size * vertex_count };
-			const u32 index_buffer_size{ index_size * index_count };
-
+		namespace {
 			constexpr u32 alignment{ D3D12_STANDARD_MAXIMUM_ELEMENT_ALIGNMENT_BYTE_MULTIPLE };
-			const u32 aligned_position_buffer_size{ (u32)Math::AlignSizeUp<alignment>(position_buffer_size) };
-			const u32 aligned_element_buffer_size{ (u32)Math::AlignSizeUp<alignment>(element_buffer_size) };
-			const u32 total_buffer_size{ aligned_position_buffer_size + aligned_element_buffer_size + index_buffer_size };
+			// Upper bound for the upload buffer of a batch. Larger batches are split over several upload contexts.
+			constexpr u32 max_batch_upload_size{ 64 * 1024 * 1024 };
+
+			struct SubmeshLayout {
+				PositionDequantization dequantization{};
+				u32 element_size;
+				u32 elements_type;
+				u32 primitive_topology;
+				u32 position_size;
+				u32 index_size;
+				u32 position_buffer_size;
+				u32 element_buffer_size;
+				u32 index_buffer_size;
+				u32 aligned_position_buffer_size;
+				u32 aligned_element_buffer_size;
+				u32 total_buffer_size;
+			};
 
-			ID3D12Resource* resource{ D3DX::CreateBuffer(blob.Position(), total_buffer_size) };
+			// Reads the submesh header and moves 'data' to the start of the submesh buffers.
+			SubmeshLayout ReadLayout(const u8*& data) {
+				util::BlobStreamReader blob{ (const u8*)data };
+				SubmeshLayout layout{};
+				layout.element_size = blob.read<u32>();
+				const u32 vertex_count{ blob.read<u32>() };
+				const u32 index_count{ blob.read<u32>() };
+				layout.elements_type = blob.read<u32>();
+				layout.primitive_topology = blob.read<u32>();
+				layout.dequantization.format = blob.read<u32>();
+				layout.dequantization.scale = { blob.read<f32>(), blob.read<f32>(), blob.read<f32>() };
+				layout.dequantization.bias = { blob.read<f32>(), blob.read<f32>(), blob.read<f32>() };
+				[[maybe_unused]] const u32 compressed_size{ blob.read<u32>() };
+				assert(!compressed_size); // NOTE: compressed submeshes are decoded by the content layer.
+				layout.index_size = (vertex_count < (1 << 16)) ? sizeof(u16) : sizeof(u32);
+
+				using Zetta::Content::PositionFormat;
+				layout.position_size = PositionFormat::Size((PositionFormat::Format)layout.dequantization.format);
+				layout.position_buffer_size = layout.position_size * vertex_count;
+				layout.element_buffer_size = layout.element_size * vertex_count;
+				layout.index_buffer_size = layout.index_size * index_count;
+
+				layout.aligned_position_buffer_size = (u32)Math::AlignSizeUp<alignment>(layout.position_buffer_size);
+				layout.aligned_element_buffer_size = (u32)Math::AlignSizeUp<alignment>(layout.element_buffer_size);
+				layout.total_buffer_size = layout.aligned_position_buffer_size + layout.aligned_element_buffer_size + layout.index_buffer_size;
+
+				data = blob.Position();
+				return layout;
+			}
 
-			blob.skip(total_buffer_size);
-			data = blob.Position();
+			SubmeshView CreateView(const SubmeshLayout& layout, ID3D12Resource* const resource) {
+				SubmeshView view{};
+				view.position_buffer_view.BufferLocation = resource->GetGPUVirtualAddress();
+				view.position_buffer_view.SizeInBytes = layout.position_buffer_size;
+				view.position_buffer_view.StrideInBytes = layout.position_size;
 
-			SubmeshView view{};
-			view.position_buffer_view.BufferLocation = resource->GetGPUVirtualAddress();
-			view.position_buffer_view.SizeInBytes = position_buffer_size;
-			view.position_buffer_view.StrideInBytes = sizeof(Math::v3);
+				if (layout.element_size) {
+					view.element_buffer_view.BufferLocation = resource->GetGPUVirtualAddress() + layout.aligned_position_buffer_size;
+					view.element_buffer_view.SizeInBytes = layout.element_buffer_size;
+					view.element_buffer_view.StrideInBytes = sizeof(Math::v3);
+				}
 
-			if (element_size) {
-				view.element_buffer_view.BufferLocation = resource->GetGPUVirtualAddress() + aligned_position_buffer_size;
-				view.element_buffer_view.SizeInBytes = element_buffer_size;
-				view.element_buffer_view.StrideInBytes = sizeof(Math::v3);
-			}
+				view.index_buffer_view.BufferLocation = resource->GetGPUVirtualAddress() + layout.aligned_position_buffer_size + layout.aligned_element_buffer_size;
+				view.index_buffer_view.SizeInBytes = layout.index_buffer_size;
+				view.index_buffer_view.Format = (layout.index_size == sizeof(u16)) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
 
-			view.index_buffer_view.BufferLocation = resource->GetGPUVirtualAddress() + aligned_position_buffer_size + aligned_element_buffer_size;
-			view.index_buffer_view.SizeInBytes = index_buffer_size;
-			view.index_buffer_view.Format = (index_size == sizeof(u16)) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+				view.elements_type = layout.elements_type;
+				view.primitive_topology = GetD3DPrimitiveTopology((PrimitiveTopology::Type)layout.primitive_topology);
+				view.position_dequantization = layout.dequantization;
+				return view;
+			}
+		} // anonymous namespace
 
-			view.elements_type = elements_type;
-			view.primitive_topology = GetD3DPrimitiveTopology((PrimitiveTopology::Type)primitive_topology);
+		ID::ID_Type Add(const u8*& data) {
+			const SubmeshLayout layout{ ReadLayout(data) };
+			ID3D12Resource* resource{ D3DX::CreateBuffer(data, layout.total_buffer_size) };
+			data += layout.total_buffer_size;
 
+			const SubmeshView view{ CreateView(layout, resource) };
 			std::lock_guard lock{ submesh_mutex };
 			submesh_buffers.Add(resource);
 			return submesh_views.Add(view);
 		}
 
+		void AddBatch(const u8* const* const data, u32 count, ID::ID_Type* const ids) {
+			assert(data && count && ids);
+			util::vector<SubmeshLayout> layouts(count);
+			util::vector<const u8*> buffers(count);
+			util::vector<ID3D12Resource*> resources(count);
+
+			for (u32 i{ 0 }; i < count; i++) {
+				const u8* at{ data[i] };
+				layouts[i] = ReadLayout(at);
+				buffers[i] = at;
+				resources[i] = D3DX::CreateBuffer(nullptr, layouts[i].total_buffer_size);
+			}
+
+			// Copy the submeshes through as few upload contexts as possible, instead of waiting for one per submesh.
+			u32 first{ 0 };
+			while (first < count) {
+				u32 upload_size{ (u32)Math::AlignSizeUp<alignment>(layouts[first].total_buffer_size) };
+				u32 last{ first + 1 };
+				for (; last < count; last++) {
+					const u32 size{ (u32)Math::AlignSizeUp<alignment>(layouts[last].total_buffer_size) };
+					if (upload_size + size > max_batch_upload_size) break;
+					upload_size += size;
+				}
+
+				Upload::D3D12UploadContext context{ upload_size };
+				u32 offset{ 0 };
+				for (u32 i{ first }; i < last; i++) {
+					const u32 size{ layouts[i].total_buffer_size };
+					memcpy((u8*)context.CPUAddress() + offset, buffers[i], size);
+					context.CommandList()->CopyBufferRegion(resources[i], 0, context.UploadBuffer(), offset, size);
+					offset += (u32)Math::AlignSizeUp<alignment>(size);
+				}
+				context.EndUpload();
+				first = last;
+			}
+
+			std::lock_guard lock{ submesh_mutex };
+			for (u32 i{ 0 }; i < count; i++) {
+				submesh_buffers.Add(resources[i]);
+				ids[i] = submesh_views.Add(CreateView(layouts[i], resources[i]));
+			}
+		}
+
 		void Remove(ID::ID_Type id) {
 			std::lock_guard lock{ submesh_mutex };
 			submesh_views.Remove(id);
@@ -431,7 +514,7 @@ namespace Zetta::Graphics::D3D12::Content {
 		void GetViews(const ID::ID_Type* const gpu_ids, u32 id_count, const ViewsCache& cache) {
 			assert(gpu_ids&& id_count);
 			assert(cache.position_buffers && cache.element_buffers && cache.index_buffer_views &&
-				cache.primitive_topologies && cache.element_types);
+				cache.primitive_topologies && cache.element_types && cache.position_dequantizations);
 
 			std::lock_guard lock{ submesh_mutex };
 			for (u32 i{ 0 }; i < id_count; i++) {
@@ -441,6 +524,7 @@ namespace Zetta::Graphics::D3D12::Content {
 				cache.index_buffer_views[i] = view.index_buffer_view;
 				cache.primitive_topologies[i] = view.primitive_topology;
 				cache.element_types[i] = view.elements_type;
+				cache.position_dequantizations[i] = view.position_dequantization;
 			}
 		}
 	}
@@ -516,6 +600,7 @@ namespace Zetta::Graphics::D3D12::Content {
 				(D3D12_INDEX_BUFFER_VIEW* const)alloca(mat_count * sizeof(D3D12_INDEX_BUFFER_VIEW)),
 				(D3D_PRIMITIVE_TOPOLOGY* const)alloca(mat_count * sizeof(D3D_PRIMITIVE_TOPOLOGY)),
 				(u32* const)alloca(mat_count * sizeof(u32)),
+				(Submesh::PositionDequantization* const)alloca(mat_count * sizeof(Submesh::PositionDequantization)),
 			};
 
 			Submesh::GetViews(gpu_ids, mat_count, views_cache);
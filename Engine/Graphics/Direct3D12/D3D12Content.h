@@ -7,15 +7,24 @@ namespace Zetta::Graphics::D3D12::Content {
 	void Shutdown();
 
 	namespace Submesh{
+		struct PositionDequantization {
+			Math::v3	scale{ 1.f, 1.f, 1.f };
+			u32			format{ 0 };
+			Math::v3	bias{};
+		};
+
 		struct ViewsCache {
 			D3D12_GPU_VIRTUAL_ADDRESS* const	position_buffers;
 			D3D12_GPU_VIRTUAL_ADDRESS* const	element_buffers;
 			D3D12_INDEX_BUFFER_VIEW* const		index_buffer_views;
 			D3D_PRIMITIVE_TOPOLOGY* const		primitive_topologies;
 			u32* const							element_types;
+			PositionDequantization* const		position_dequantizations;
 		};
 
 		ID::ID_Type Add(const u8*& data);
+		// Uploads 'count' submeshes with a single copy and writes their ids to 'ids'.
+		void AddBatch(const u8* const* const data, u32 count, ID::ID_Type* const ids);
 		void Remove(ID::ID_Type id);
 
 		void GetViews(const ID::ID_Type* const gpu_ids, u32 id_count, const ViewsCache& cache);
@@ -39,6 +39,7 @@ namespace Zetta::Graphics::D3D12::GPass {
 			D3D12_INDEX_BUFFER_VIEW*	index_buffer_views{ nullptr };
 			D3D_PRIMITIVE_TOPOLOGY*		primitive_topologies{ nullptr };
 			u32*						elements_types{ nullptr };
+			Content::Submesh::PositionDequantization* position_dequantizations{ nullptr };
 			D3D12_GPU_VIRTUAL_ADDRESS*	per_object_data{ nullptr };
 			
 			constexpr Content::RenderItem::ItemsCache ItemsCache() const {
@@ -57,7 +58,8 @@ namespace Zetta::Graphics::D3D12::GPass {
 					element_buffers,
 					index_buffer_views,
 					primitive_topologies,
-					elements_types
+					elements_types,
+					position_dequantizations
 				};
 			}
 
@@ -96,7 +98,8 @@ namespace Zetta::Graphics::D3D12::GPass {
 					index_buffer_views = (D3D12_INDEX_BUFFER_VIEW*)(&element_buffers[items_count]);
 					primitive_topologies = (D3D_PRIMITIVE_TOPOLOGY*)(&index_buffer_views[items_count]);
 					elements_types = (u32*)(&primitive_topologies[items_count]);
-					per_object_data = (D3D12_GPU_VIRTUAL_ADDRESS*)(&elements_types[items_count]);
+					position_dequantizations = (Content::Submesh::PositionDequantization*)(&elements_types[items_count]);
+					per_object_data = (D3D12_GPU_VIRTUAL_ADDRESS*)(&position_dequantizations[items_count]);
 				}
 			}
 
@@ -114,6 +117,7 @@ namespace Zetta::Graphics::D3D12::GPass {
 				sizeof(D3D12_INDEX_BUFFER_VIEW) +		// index_buffer_views
 				sizeof(D3D_PRIMITIVE_TOPOLOGY) +		// primitive_topologies
 				sizeof(u32) +							// elements_types
+				sizeof(Content::Submesh::PositionDequantization) + // position_dequantizations
 				sizeof(D3D12_GPU_VIRTUAL_ADDRESS)		// per_object_data
 			};
 
@@ -174,18 +178,31 @@ namespace Zetta::Graphics::D3D12::GPass {
 			const GPassCache& cache{ frame_cache };
 			const u32 render_items_count{ (u32)cache.Size() };
 			ID::ID_Type current_entity_id{ ID::Invalid_ID };
+			const Content::Submesh::PositionDequantization* current_dequantization{ nullptr };
 			HLSL::PerObjectData* current_data_ptr{ nullptr };
+			HLSL::PerObjectData data{};
 			ConstantBuffer& cbuffer{ Core::CBuffer() };
 
 			using namespace DirectX;
 			for (u32 i{ 0 }; i < render_items_count; i++) {
-				if (current_entity_id != cache.entity_ids[i]) {
+				const Content::Submesh::PositionDequantization& dequantization{ cache.position_dequantizations[i] };
+				const bool new_entity{ current_entity_id != cache.entity_ids[i] };
+
+				if (new_entity) {
 					current_entity_id = cache.entity_ids[i];
-					HLSL::PerObjectData data{};
 					Transform::GetTransformMatrices(GameEntity::EntityID{ current_entity_id }, data.World, data.InvWorld);
 					XMMATRIX world{ XMLoadFloat4x4(&data.World) };
 					XMMATRIX wvp{ XMMatrixMultiply(world, d3d12_info.camera->ViewProjection()) };
 					XMStoreFloat4x4(&data.WorldViewProjection, wvp);
+				}
+
+				// NOTE: Submeshes of the same entity share per-object data unless their positions
+				//       are quantized to different bounds.
+				if (new_entity || memcmp(current_dequantization, &dequantization, sizeof(dequantization))) {
+					current_dequantization = &dequantization;
+					data.PositionScale = dequantization.scale;
+					data.PositionFormat = dequantization.format;
+					data.PositionBias = dequantization.bias;
 
 					current_data_ptr = cbuffer.alloc<HLSL::PerObjectData>();
 					memcpy(current_data_ptr, &data, sizeof(HLSL::PerObjectData));
@@ -32,6 +32,7 @@ namespace Zetta::Graphics::D3D12 {
 		pi.Light.GetParameter = Light::GetParameter;
 
 		pi.Resources.AddSubmesh = Content::Submesh::Add;
+		pi.Resources.AddSubmeshes = Content::Submesh::AddBatch;
 		pi.Resources.RemoveSubmesh = Content::Submesh::Remove;
 		pi.Resources.AddMaterial = Content::Material::Add;
 		pi.Resources.RemoveMaterial = Content::Material::Remove;
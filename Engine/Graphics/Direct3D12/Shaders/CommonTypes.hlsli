@@ -27,6 +27,11 @@ struct PerObjectData
     float4x4 World;
     float4x4 InvWorld;
     float4x4 WorldViewProjection;
+    
+    float3 PositionScale;   // Dequantization: position = PositionBias + PositionScale * quantized position
+    uint PositionFormat;    // 0: float3, 1: unorm16x3 (see Content::PositionFormat)
+    float3 PositionBias;
+    float _padding;
 };
 
 struct Plane
@@ -34,6 +34,7 @@ namespace Zetta::Graphics {
 
 		struct {
 			ID::ID_Type(*AddSubmesh)(const u8*&);
+			void(*AddSubmeshes)(const u8* const* const, u32, ID::ID_Type* const);
 			void(*RemoveSubmesh)(ID::ID_Type);
 			ID::ID_Type(*AddMaterial)(const MaterialInitInfo);
 			void(*RemoveMaterial)(ID::ID_Type);
@@ -328,6 +328,10 @@ namespace Zetta::Graphics {
 		return gfx.Resources.AddSubmesh(data);
 	}
 
+	void AddSubmeshes(const u8* const* const data, u32 count, ID::ID_Type* const ids) {
+		gfx.Resources.AddSubmeshes(data, count, ids);
+	}
+
 	void RemoveSubmesh(ID::ID_Type id) {
 		gfx.Resources.RemoveSubmesh(id);
 	}
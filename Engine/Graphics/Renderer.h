@@ -229,6 +229,8 @@ namespace Zetta::Graphics {
 	void RemoveCamera(CameraID id);
 
 	ID::ID_Type AddSubmesh(const u8*& data);
+	// Uploads several submeshes at once. Cheaper than calling AddSubmesh() for each of them.
+	void AddSubmeshes(const u8* const* const data, u32 count, ID::ID_Type* const ids);
 	void RemoveSubmesh(ID::ID_Type id);
 
 	ID::ID_Type AddMaterial(MaterialInitInfo info);
@@ -0,0 +1,405 @@
+#include "AsyncIO.h"
+#include <thread>
+#include <condition_variable>
+
+#if defined(_WIN64)
+#include <Windows.h>
+#else
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // O_DIRECT
+#endif
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Zetta::IO {
+	namespace {
+		// Pooled buffers come in power of 2 size classes from 64KB to 64MB. Larger ones aren't pooled.
+		constexpr u32 min_buffer_size_log2{ 16 };
+		constexpr u32 buffer_class_count{ 11 };
+		constexpr u32 sector_size{ 4096 };
+		constexpr std::align_val_t buffer_alignment{ sector_size };
+
+		struct File {
+#if defined(_WIN64)
+			HANDLE handle{ INVALID_HANDLE_VALUE };
+#else
+			s32 fd{ -1 };
+#endif
+			// NOTE: FreeList items have to be larger than a u32.
+			u32 is_unbuffered{ 0 };
+		};
+
+		struct Request {
+#if defined(_WIN64)
+			// NOTE: must be the first member, completions only give us a pointer to it.
+			OVERLAPPED		overlapped{};
+#endif
+			ID::ID_Type		file;
+			u64				offset;
+			u32				size;			// rounded up to the sector size for unbuffered files
+			u32				requested_size;
+			u32				bytes_read;
+			u8*				buffer;
+			bool			is_pooled;
+			Priority::Type	priority;
+			Status::Type	status;
+		};
+
+		// NOTE: requests are heap allocated, so their OVERLAPPED doesn't move while a read is in flight.
+		util::FreeList<std::unique_ptr<Request>>	requests;
+		util::vector<ID::ID_Type>					queues[Priority::count];
+		u32											queue_heads[Priority::count]{};
+		util::FreeList<File>						files;
+		std::mutex									io_mutex;
+		std::condition_variable						request_finished;
+		std::condition_variable						request_queued;
+		util::vector<std::thread>					threads;
+		Backend::Type								io_backend{ Backend::ThreadPool };
+		u32											queue_depth{ 0 };
+		u32											in_flight{ 0 };
+		bool										is_initialized{ false };
+		bool										is_shutting_down{ false };
+
+		util::vector<u8*>							free_buffers[buffer_class_count];
+		std::unordered_map<u8*, u32>				buffer_sizes;
+		std::mutex									buffer_mutex;
+
+#if defined(_WIN64)
+		HANDLE										completion_port{ nullptr };
+		constexpr ULONG_PTR							shutdown_key{ 1 };
+#endif
+
+		[[nodiscard]] u32 BufferClass(u32 size) {
+			u32 size_class{ 0 };
+			while (size_class < buffer_class_count && (1u << (min_buffer_size_log2 + size_class)) < size) size_class++;
+			return size_class;
+		}
+
+		// Returns the next queued request, highest priority first.
+		// NOTE: expects io_mutex to be locked.
+		[[nodiscard]] bool PopQueued(ID::ID_Type& id) {
+			for (u32 priority{ 0 }; priority < Priority::count; priority++) {
+				util::vector<ID::ID_Type>& queue{ queues[priority] };
+				u32& head{ queue_heads[priority] };
+				while (head < queue.size()) {
+					id = queue[head++];
+					if (head == queue.size()) {
+						queue.clear();
+						head = 0;
+					}
+					// cancelled requests leave an invalid id behind, see Cancel()
+					if (ID::IsValid(id)) return true;
+				}
+			}
+			return false;
+		}
+
+		// NOTE: expects io_mutex to be locked.
+		void Finish(Request& request, Status::Type status, u32 bytes_read) {
+			request.status = status;
+			request.bytes_read = std::min(bytes_read, request.requested_size);
+			assert(in_flight);
+			in_flight--;
+		}
+
+		// Blocking read at an absolute file offset. Safe to call from several threads on the same file.
+		[[nodiscard]] bool PositionedRead(const File& file, u64 offset, u32 size, u8* const buffer, u32& bytes_read) {
+#if defined(_WIN64)
+			OVERLAPPED overlapped{};
+			overlapped.Offset = (DWORD)offset;
+			overlapped.OffsetHigh = (DWORD)(offset >> 32);
+			DWORD count{ 0 };
+			const bool result{ ::ReadFile(file.handle, buffer, size, &count, &overlapped) != FALSE };
+			bytes_read = count;
+			return result;
+#else
+			bytes_read = 0;
+			while (bytes_read < size) {
+				const ssize_t count{ pread(file.fd, buffer + bytes_read, size - bytes_read, (off_t)(offset + bytes_read)) };
+				if (count < 0) return false;
+				if (!count) break;
+				bytes_read += (u32)count;
+			}
+			return true;
+#endif
+		}
+
+		void ThreadPoolWorker() {
+			std::unique_lock lock{ io_mutex };
+			while (true) {
+				ID::ID_Type id{ ID::Invalid_ID };
+				request_queued.wait(lock, [&id] { return is_shutting_down || PopQueued(id); });
+				if (is_shutting_down && !ID::IsValid(id)) return;
+
+				Request& request{ *requests[id] };
+				request.status = Status::InFlight;
+				in_flight++;
+				const File file{ files[request.file] };
+				lock.unlock();
+
+				u32 bytes_read{ 0 };
+				const bool result{ PositionedRead(file, request.offset, request.size, request.buffer, bytes_read) };
+
+				lock.lock();
+				Finish(request, result ? Status::Completed : Status::Failed, bytes_read);
+				request_finished.notify_all();
+			}
+		}
+
+#if defined(_WIN64)
+		// Issues queued requests until the queue depth is reached.
+		// NOTE: expects io_mutex to be locked.
+		void DispatchOverlapped() {
+			ID::ID_Type id{ ID::Invalid_ID };
+			while (in_flight < queue_depth && PopQueued(id)) {
+				Request& request{ *requests[id] };
+				request.status = Status::InFlight;
+				request.overlapped = {};
+				request.overlapped.Offset = (DWORD)request.offset;
+				request.overlapped.OffsetHigh = (DWORD)(request.offset >> 32);
+				in_flight++;
+
+				if (!::ReadFile(files[request.file].handle, request.buffer, request.size, nullptr, &request.overlapped) &&
+					GetLastError() != ERROR_IO_PENDING) {
+					Finish(request, Status::Failed, 0);
+					request_finished.notify_all();
+				}
+			}
+		}
+
+		void CompletionWorker() {
+			while (true) {
+				DWORD bytes_read{ 0 };
+				ULONG_PTR key{ 0 };
+				OVERLAPPED* overlapped{ nullptr };
+				const BOOL result{ GetQueuedCompletionStatus(completion_port, &bytes_read, &key, &overlapped, INFINITE) };
+				if (!overlapped) {
+					if (key == shutdown_key) return;
+					continue;
+				}
+
+				const DWORD error{ result ? ERROR_SUCCESS : GetLastError() };
+				Request& request{ *(Request*)overlapped };
+				std::lock_guard lock{ io_mutex };
+				Finish(request, result ? Status::Completed : error == ERROR_OPERATION_ABORTED ? Status::Cancelled : Status::Failed, bytes_read);
+				DispatchOverlapped();
+				request_finished.notify_all();
+			}
+		}
+#endif
+	} // anonymous namespace
+
+	bool Initialize(Backend::Type backend, u32 max_queue_depth) {
+		assert(!is_initialized && max_queue_depth);
+		std::lock_guard lock{ io_mutex };
+		queue_depth = max_queue_depth;
+		is_shutting_down = false;
+		io_backend = Backend::ThreadPool;
+
+#if defined(_WIN64)
+		if (backend == Backend::Overlapped) {
+			completion_port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+			if (completion_port) {
+				io_backend = Backend::Overlapped;
+				threads.emplace_back(CompletionWorker);
+			}
+		}
+#endif
+
+		if (io_backend == Backend::ThreadPool) {
+			threads.reserve(queue_depth);
+			for (u32 i{ 0 }; i < queue_depth; i++) threads.emplace_back(ThreadPoolWorker);
+		}
+
+		is_initialized = true;
+		return true;
+	}
+
+	void Shutdown() {
+		assert(is_initialized);
+		{
+			std::lock_guard lock{ io_mutex };
+			assert(!in_flight && !requests.size());
+			is_shutting_down = true;
+		}
+
+		request_queued.notify_all();
+#if defined(_WIN64)
+		if (completion_port) PostQueuedCompletionStatus(completion_port, 0, shutdown_key, nullptr);
+#endif
+		for (std::thread& thread : threads) thread.join();
+		threads.clear();
+
+#if defined(_WIN64)
+		if (completion_port) {
+			CloseHandle(completion_port);
+			completion_port = nullptr;
+		}
+#endif
+
+		std::lock_guard lock{ buffer_mutex };
+		for (util::vector<u8*>& buffers : free_buffers) {
+			for (u8* buffer : buffers) {
+				buffer_sizes.erase(buffer);
+				::operator delete[](buffer, buffer_alignment);
+			}
+			buffers.clear();
+		}
+		assert(buffer_sizes.empty()); // NOTE: all pooled buffers should have been released.
+		is_initialized = false;
+	}
+
+	Backend::Type GetBackend() {
+		return io_backend;
+	}
+
+	ID::ID_Type OpenFile(const char* path, bool unbuffered) {
+		assert(is_initialized && path);
+		File file{};
+		file.is_unbuffered = unbuffered;
+#if defined(_WIN64)
+		DWORD flags{ io_backend == Backend::Overlapped ? (DWORD)(FILE_FLAG_OVERLAPPED | FILE_FLAG_RANDOM_ACCESS) : (DWORD)FILE_FLAG_RANDOM_ACCESS };
+		if (unbuffered) flags |= FILE_FLAG_NO_BUFFERING;
+		file.handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+		if (file.handle == INVALID_HANDLE_VALUE) return ID::Invalid_ID;
+		if (io_backend == Backend::Overlapped && CreateIoCompletionPort(file.handle, completion_port, 0, 0) != completion_port) {
+			CloseHandle(file.handle);
+			return ID::Invalid_ID;
+		}
+#else
+		file.fd = open(path, unbuffered ? O_RDONLY | O_DIRECT : O_RDONLY);
+		if (file.fd < 0) return ID::Invalid_ID;
+#endif
+
+		std::lock_guard lock{ io_mutex };
+		return files.Add(file);
+	}
+
+	void CloseFile(ID::ID_Type id) {
+		assert(ID::IsValid(id));
+		std::lock_guard lock{ io_mutex };
+#if defined(_WIN64)
+		CloseHandle(files[id].handle);
+#else
+		close(files[id].fd);
+#endif
+		files.Remove(id);
+	}
+
+	void SubmitReads(const ReadRequest* const read_requests, u32 count, ID::ID_Type* const request_ids) {
+		assert(is_initialized && read_requests && count && request_ids);
+		{
+			std::lock_guard lock{ io_mutex };
+			for (u32 i{ 0 }; i < count; i++) {
+				const ReadRequest& info{ read_requests[i] };
+				assert(ID::IsValid(info.file) && info.size && info.priority < Priority::count);
+				const bool is_unbuffered{ files[info.file].is_unbuffered != 0 };
+				assert(!is_unbuffered || (!(info.offset % sector_size) && !((uintptr_t)info.buffer % sector_size)));
+				std::unique_ptr<Request> request{ std::make_unique<Request>() };
+				request->file = info.file;
+				request->offset = info.offset;
+				request->size = is_unbuffered ? (u32)Math::AlignSizeUp<sector_size>(info.size) : info.size;
+				request->requested_size = info.size;
+				request->is_pooled = !info.buffer;
+				request->buffer = info.buffer ? info.buffer : AcquireBuffer(request->size);
+				request->priority = info.priority;
+				request->status = Status::Queued;
+				request_ids[i] = requests.Add(std::move(request));
+				queues[info.priority].emplace_back(request_ids[i]);
+			}
+
+#if defined(_WIN64)
+			if (io_backend == Backend::Overlapped) DispatchOverlapped();
+#endif
+		}
+
+		if (io_backend == Backend::ThreadPool) request_queued.notify_all();
+	}
+
+	bool Cancel(ID::ID_Type request_id) {
+		assert(ID::IsValid(request_id));
+		std::lock_guard lock{ io_mutex };
+		Request& request{ *requests[request_id] };
+		if (request.status == Status::Queued) {
+			// Take it out of its queue, so no worker pops the id once Wait() has freed it for another request.
+			util::vector<ID::ID_Type>& queue{ queues[request.priority] };
+			for (u32 i{ queue_heads[request.priority] }; i < queue.size(); i++) {
+				if (queue[i] == request_id) {
+					queue[i] = ID::Invalid_ID;
+					break;
+				}
+			}
+
+			request.status = Status::Cancelled;
+			request_finished.notify_all();
+			return true;
+		}
+
+#if defined(_WIN64)
+		if (request.status == Status::InFlight && io_backend == Backend::Overlapped)
+			return CancelIoEx(files[request.file].handle, &request.overlapped) != FALSE;
+#endif
+
+		return false;
+	}
+
+	Status::Type GetStatus(ID::ID_Type request_id) {
+		assert(ID::IsValid(request_id));
+		std::lock_guard lock{ io_mutex };
+		return requests[request_id]->status;
+	}
+
+	ReadResult Wait(ID::ID_Type request_id) {
+		assert(ID::IsValid(request_id));
+		std::unique_lock lock{ io_mutex };
+		Request* const request{ requests[request_id].get() };
+		request_finished.wait(lock, [request] { return request->status != Status::Queued && request->status != Status::InFlight; });
+
+		ReadResult result{ request->buffer, request->bytes_read, request->status };
+		const bool is_pooled{ request->is_pooled };
+		requests.Remove(request_id);
+		lock.unlock();
+
+		if (result.status != Status::Completed) {
+			result.bytes_read = 0;
+			if (is_pooled) {
+				ReleaseBuffer(result.buffer);
+				result.buffer = nullptr;
+			}
+		}
+
+		return result;
+	}
+
+	u8* AcquireBuffer(u32 size) {
+		assert(size);
+		const u32 size_class{ BufferClass(size) };
+		std::lock_guard lock{ buffer_mutex };
+		if (size_class < buffer_class_count && !free_buffers[size_class].empty()) {
+			u8* const buffer{ free_buffers[size_class].back() };
+			free_buffers[size_class].resize(free_buffers[size_class].size() - 1);
+			return buffer;
+		}
+
+		const u32 buffer_size{ size_class < buffer_class_count ? 1u << (min_buffer_size_log2 + size_class) : size };
+		u8* const buffer{ (u8*)::operator new[](buffer_size, buffer_alignment) };
+		buffer_sizes[buffer] = buffer_size;
+		return buffer;
+	}
+
+	void ReleaseBuffer(u8* const buffer) {
+		assert(buffer);
+		std::lock_guard lock{ buffer_mutex };
+		const auto it{ buffer_sizes.find(buffer) };
+		assert(it != buffer_sizes.end());
+		const u32 size_class{ BufferClass(it->second) };
+		if (size_class < buffer_class_count && (1u << (min_buffer_size_log2 + size_class)) == it->second) {
+			free_buffers[size_class].emplace_back(buffer);
+			return;
+		}
+
+		buffer_sizes.erase(it);
+		::operator delete[](buffer, buffer_alignment);
+	}
+}
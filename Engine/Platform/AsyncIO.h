@@ -0,0 +1,75 @@
+#pragma once
+#include "Common/CommonHeaders.h"
+
+// Asynchronous file reads for content streaming.
+//
+// Requests wait in one queue per priority and are issued highest priority first, with at most
+// max_queue_depth reads in flight. The overlapped backend (Windows) issues all of them at once and
+// collects completions on an I/O completion port. The thread pool backend issues blocking positioned
+// reads from max_queue_depth worker threads and is available on every platform.
+namespace Zetta::IO {
+	struct Backend {
+		enum Type : u32 {
+			Overlapped,
+			ThreadPool,
+		};
+	};
+
+	struct Priority {
+		enum Type : u32 {
+			High,
+			Normal,
+			Low,
+
+			count
+		};
+	};
+
+	struct Status {
+		enum Type : u32 {
+			Queued,
+			InFlight,
+			Completed,
+			Failed,
+			Cancelled,
+		};
+	};
+
+	struct ReadRequest {
+		ID::ID_Type		file{ ID::Invalid_ID };
+		u64				offset{ 0 };
+		u32				size{ 0 };
+		// Destination of the read. If nullptr, a 4KB aligned buffer is taken from the buffer pool
+		// and has to be given back with ReleaseBuffer().
+		u8*				buffer{ nullptr };
+		Priority::Type	priority{ Priority::Normal };
+	};
+
+	struct ReadResult {
+		u8*				buffer;		// nullptr if a pooled read didn't complete
+		u32				bytes_read;
+		Status::Type	status;
+	};
+
+	// NOTE: falls back to the thread pool backend where overlapped I/O isn't available.
+	bool Initialize(Backend::Type backend = Backend::Overlapped, u32 max_queue_depth = 32);
+	void Shutdown();
+	[[nodiscard]] Backend::Type GetBackend();
+
+	// Unbuffered files bypass the OS file cache. Their reads have to start at a multiple of 4KB, and caller
+	// buffers have to be 4KB aligned and hold the size rounded up to 4KB.
+	[[nodiscard]] ID::ID_Type OpenFile(const char* path, bool unbuffered = false);
+	// NOTE: all requests for the file have to be finished.
+	void CloseFile(ID::ID_Type id);
+
+	void SubmitReads(const ReadRequest* const requests, u32 count, ID::ID_Type* const request_ids);
+	// Queued requests are always cancelled. Overlapped reads in flight are cancelled if the OS
+	// still can, blocking reads in flight can't be. Returns false if the request can't be cancelled.
+	bool Cancel(ID::ID_Type request_id);
+	[[nodiscard]] Status::Type GetStatus(ID::ID_Type request_id);
+	// Blocks until the request is finished. The request id is invalid afterwards.
+	ReadResult Wait(ID::ID_Type request_id);
+
+	[[nodiscard]] u8* AcquireBuffer(u32 size);
+	void ReleaseBuffer(u8* const buffer);
+}
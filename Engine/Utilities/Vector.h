@@ -116,7 +116,7 @@ namespace Zetta::util {
 			if constexpr (destruct) item->~T();
 			_size--;
 			if (item < std::addressof(_data[_size]))
-				memcpy(item, item + 1, (std::addressof(_data[_size]) - item) * sizeof(T));
+				memmove(item, item + 1, (std::addressof(_data[_size]) - item) * sizeof(T));
 
 			return item;
 		}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "Test.h"
+#include "../Engine/Platform/AsyncIO.h"
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <random>
+
+using namespace Zetta;
+
+// Measures read throughput of both async I/O backends at increasing queue depths, using random 64KB reads.
+// The file is opened unbuffered, so the reads go to the drive even though the file was just written.
+// Before that, checks that reads cancelled while queued can be waited on and that their ids are safely reused.
+class EngineTest : public Test {
+public:
+	bool Initialize() override {
+		if (!std::filesystem::exists(_file)) {
+			std::ofstream stream{ _file, std::ios::out | std::ios::binary };
+			if (!stream) return false;
+			util::vector<u8> block(_read_size);
+			std::mt19937 random{ 0 };
+			for (u64 written{ 0 }; written < _file_size; written += _read_size) {
+				for (u8& value : block) value = (u8)random();
+				stream.write((const char*)block.data(), _read_size);
+			}
+		}
+
+		std::mt19937_64 random{ 0 };
+		const u64 block_count{ std::filesystem::file_size(_file) / _read_size };
+		_offsets.resize(_reads_per_run);
+		for (u64& offset : _offsets) offset = (random() % block_count) * _read_size;
+		return block_count != 0;
+	}
+
+	void Run() override {
+		for (const IO::Backend::Type backend : { IO::Backend::Overlapped, IO::Backend::ThreadPool }) {
+			IO::Initialize(backend, 2);
+			std::cout << (IO::GetBackend() == IO::Backend::Overlapped ? "Overlapped" : "Thread pool") << ", cancel then wait: "
+				<< (CancelThenWait() ? "passed\n" : "FAILED\n");
+			IO::Shutdown();
+		}
+
+		do {
+			for (const IO::Backend::Type backend : { IO::Backend::Overlapped, IO::Backend::ThreadPool }) {
+				for (u32 queue_depth{ 1 }; queue_depth <= _max_queue_depth; queue_depth *= 2) {
+					IO::Initialize(backend, queue_depth);
+					const double seconds{ ReadAll() };
+					PrintResults(IO::GetBackend(), queue_depth, seconds);
+					IO::Shutdown();
+				}
+			}
+		} while (getchar() != 'q');
+	}
+
+	void Shutdown() override { }
+
+private:
+	// Cancels every other read right after submitting them, so most of them are still queued, then waits on all
+	// of them and compares what was read with the file.
+	bool CancelThenWait() {
+		const ID::ID_Type file{ IO::OpenFile(_file) };
+		if (!ID::IsValid(file)) return false;
+
+		std::ifstream stream{ _file, std::ios::in | std::ios::binary };
+		util::vector<u8> expected(_read_size);
+		bool passed{ true };
+		constexpr u32 request_count{ 64 };
+		for (u32 round{ 0 }; round < 100 && passed; round++) {
+			IO::ReadRequest requests[request_count];
+			ID::ID_Type ids[request_count];
+			for (u32 i{ 0 }; i < request_count; i++) {
+				requests[i] = { file, _offsets[(round * request_count + i) % _reads_per_run], _read_size, nullptr, (IO::Priority::Type)(i % IO::Priority::count) };
+			}
+
+			IO::SubmitReads(requests, request_count, ids);
+			for (u32 i{ 0 }; i < request_count; i += 2) IO::Cancel(ids[i]);
+
+			for (u32 i{ 0 }; i < request_count; i++) {
+				const IO::ReadResult result{ IO::Wait(ids[i]) };
+				if (result.status == IO::Status::Completed) {
+					stream.seekg(requests[i].offset);
+					stream.read((char*)expected.data(), _read_size);
+					passed &= result.bytes_read == _read_size && !memcmp(result.buffer, expected.data(), _read_size);
+				}
+				else {
+					passed &= result.status == IO::Status::Cancelled && !result.buffer;
+				}
+
+				if (result.buffer) IO::ReleaseBuffer(result.buffer);
+			}
+		}
+
+		IO::CloseFile(file);
+		return passed;
+	}
+
+	double ReadAll() {
+		const ID::ID_Type file{ IO::OpenFile(_file, true) };
+		if (!ID::IsValid(file)) return 0.0;
+
+		util::vector<IO::ReadRequest> requests(_reads_per_run);
+		util::vector<ID::ID_Type> ids(_reads_per_run);
+		for (u32 i{ 0 }; i < _reads_per_run; i++) {
+			requests[i] = { file, _offsets[i], _read_size, nullptr, IO::Priority::Normal };
+		}
+
+		const auto start{ std::chrono::high_resolution_clock::now() };
+		IO::SubmitReads(requests.data(), _reads_per_run, ids.data());
+		for (const ID::ID_Type id : ids) {
+			const IO::ReadResult result{ IO::Wait(id) };
+			if (result.buffer) IO::ReleaseBuffer(result.buffer);
+		}
+		const double seconds{ std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count() };
+
+		IO::CloseFile(file);
+		return seconds;
+	}
+
+	void PrintResults(IO::Backend::Type backend, u32 queue_depth, double seconds) {
+		std::cout << (backend == IO::Backend::Overlapped ? "Overlapped" : "Thread pool") << ", queue depth " << queue_depth << ": ";
+		if (seconds <= 0.0) {
+			std::cout << "failed to open " << _file << "\n";
+			return;
+		}
+
+		std::cout << (double)_read_size * _reads_per_run / seconds / (1024.0 * 1024.0) << " MB/s, "
+			<< _reads_per_run / seconds << " reads/s\n";
+	}
+
+	static constexpr const char* _file{ "async_io_test.bin" };
+	static constexpr u64 _file_size{ 1024ull * 1024 * 1024 };
+	static constexpr u32 _read_size{ 64 * 1024 };
+	static constexpr u32 _reads_per_run{ 4096 };
+	static constexpr u32 _max_queue_depth{ 64 };
+	util::vector<u64> _offsets;
+};
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "Test.h"
+#include "../ContentToolsDLL/BlockCompression.h"
+
+#include <DirectXTex.h>
+#include <DirectXPackedVector.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+using namespace Zetta;
+
+// Compares the CPU block encoder with DirectXTex: PSNR of the decoded result and encode throughput,
+// for every format and quality preset. Both encoders use all hardware threads. BC6H encodes the same
+// images converted to half precision.
+class EngineTest : public Test {
+public:
+	bool Initialize() override {
+		if (FAILED(CoInitializeEx(nullptr, COINIT_MULTITHREADED))) return false;
+
+		for (const wchar_t* file : _files) {
+			DirectX::ScratchImage loaded, converted;
+			if (FAILED(DirectX::LoadFromWICFile(file, DirectX::WIC_FLAGS_IGNORE_SRGB, nullptr, loaded))) continue;
+			if (FAILED(DirectX::Convert(*loaded.GetImage(0, 0, 0), DXGI_FORMAT_R8G8B8A8_UNORM,
+				DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, converted))) continue;
+			DirectX::ScratchImage half;
+			if (FAILED(DirectX::Convert(*converted.GetImage(0, 0, 0), DXGI_FORMAT_R16G16B16A16_FLOAT,
+				DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, half))) continue;
+			_images.emplace_back(std::move(converted));
+			_half_images.emplace_back(std::move(half));
+		}
+
+		return !_images.empty();
+	}
+
+	void Run() override {
+		do {
+			for (u32 format{ 0 }; format < Tools::BC::Format::count; format++) {
+				for (u32 quality{ 0 }; quality < Tools::BC::Quality::count; quality++) {
+					Measure((Tools::BC::Format::Type)format, (Tools::BC::Quality::Level)quality);
+				}
+				MeasureReference((Tools::BC::Format::Type)format);
+			}
+			for (u32 quality{ 0 }; quality < Tools::BC::Quality::count; quality++) MeasureBC6H((Tools::BC::Quality::Level)quality);
+			MeasureBC6HReference();
+		} while (getchar() != 'q');
+	}
+
+	void Shutdown() override {
+		_images.clear();
+		_half_images.clear();
+		CoUninitialize();
+	}
+
+private:
+	void Measure(Tools::BC::Format::Type format, Tools::BC::Quality::Level quality) {
+		f64 seconds{ 0.0 }, squared_error{ 0.0 };
+		u64 pixel_count{ 0 }, sample_count{ 0 };
+		for (const DirectX::ScratchImage& scratch : _images) {
+			const DirectX::Image& image{ *scratch.GetImage(0, 0, 0) };
+			const u32 width{ (u32)image.width }, height{ (u32)image.height };
+			const u32 block_row_pitch{ (width + 3) / 4 * Tools::BC::BlockSize(format) };
+			util::vector<u8> blocks((u64)block_row_pitch * ((height + 3) / 4));
+			util::vector<u8> decoded((u64)width * height * 4);
+
+			const auto start{ std::chrono::high_resolution_clock::now() };
+			Tools::BC::Compress(image.pixels, width, height, (u32)image.rowPitch, format, quality, 0.5f, blocks.data(), block_row_pitch);
+			seconds += std::chrono::duration<f64>(std::chrono::high_resolution_clock::now() - start).count();
+
+			Tools::BC::Decompress(blocks.data(), block_row_pitch, width, height, format, decoded.data(), width * 4);
+			AddError(image, decoded.data(), width * 4, format, squared_error, sample_count);
+			pixel_count += (u64)width * height;
+		}
+
+		PrintResults(format, _quality_names[quality], squared_error, sample_count, pixel_count, seconds);
+	}
+
+	void MeasureReference(Tools::BC::Format::Type format) {
+		constexpr DXGI_FORMAT formats[]{ DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC3_UNORM, DXGI_FORMAT_BC4_UNORM, DXGI_FORMAT_BC5_UNORM, DXGI_FORMAT_BC7_UNORM };
+		f64 seconds{ 0.0 }, squared_error{ 0.0 };
+		u64 pixel_count{ 0 }, sample_count{ 0 };
+		for (const DirectX::ScratchImage& scratch : _images) {
+			const DirectX::Image& image{ *scratch.GetImage(0, 0, 0) };
+			DirectX::ScratchImage compressed, decompressed;
+
+			const auto start{ std::chrono::high_resolution_clock::now() };
+			if (FAILED(DirectX::Compress(image, formats[format], DirectX::TEX_COMPRESS_PARALLEL | DirectX::TEX_COMPRESS_UNIFORM, 0.5f, compressed))) return;
+			seconds += std::chrono::duration<f64>(std::chrono::high_resolution_clock::now() - start).count();
+
+			if (FAILED(DirectX::Decompress(*compressed.GetImage(0, 0, 0), DXGI_FORMAT_R8G8B8A8_UNORM, decompressed))) return;
+			const DirectX::Image& decoded{ *decompressed.GetImage(0, 0, 0) };
+			AddError(image, decoded.pixels, (u32)decoded.rowPitch, format, squared_error, sample_count);
+			pixel_count += (u64)image.width * image.height;
+		}
+
+		PrintResults(format, "DirectXTex", squared_error, sample_count, pixel_count, seconds);
+	}
+
+	void MeasureBC6H(Tools::BC::Quality::Level quality) {
+		f64 seconds{ 0.0 }, squared_error{ 0.0 };
+		u64 pixel_count{ 0 };
+		for (const DirectX::ScratchImage& scratch : _half_images) {
+			const DirectX::Image& image{ *scratch.GetImage(0, 0, 0) };
+			const u32 width{ (u32)image.width }, height{ (u32)image.height };
+			const u32 block_row_pitch{ (width + 3) / 4 * 16 };
+			util::vector<u8> blocks((u64)block_row_pitch * ((height + 3) / 4));
+			util::vector<u16> decoded((u64)width * height * 4);
+
+			const auto start{ std::chrono::high_resolution_clock::now() };
+			Tools::BC::CompressBC6H((const u16*)image.pixels, width, height, (u32)image.rowPitch, false, quality, blocks.data(), block_row_pitch);
+			seconds += std::chrono::duration<f64>(std::chrono::high_resolution_clock::now() - start).count();
+
+			Tools::BC::DecompressBC6H(blocks.data(), block_row_pitch, width, height, false, decoded.data(), width * 8);
+			AddHalfError(image, (const u8*)decoded.data(), width * 8, squared_error);
+			pixel_count += (u64)width * height;
+		}
+
+		PrintHalfResults(_quality_names[quality], squared_error, pixel_count, seconds);
+	}
+
+	void MeasureBC6HReference() {
+		f64 seconds{ 0.0 }, squared_error{ 0.0 };
+		u64 pixel_count{ 0 };
+		for (const DirectX::ScratchImage& scratch : _half_images) {
+			const DirectX::Image& image{ *scratch.GetImage(0, 0, 0) };
+			DirectX::ScratchImage compressed, decompressed;
+
+			const auto start{ std::chrono::high_resolution_clock::now() };
+			if (FAILED(DirectX::Compress(image, DXGI_FORMAT_BC6H_UF16, DirectX::TEX_COMPRESS_PARALLEL, 1.f, compressed))) return;
+			seconds += std::chrono::duration<f64>(std::chrono::high_resolution_clock::now() - start).count();
+
+			if (FAILED(DirectX::Decompress(*compressed.GetImage(0, 0, 0), DXGI_FORMAT_R16G16B16A16_FLOAT, decompressed))) return;
+			const DirectX::Image& decoded{ *decompressed.GetImage(0, 0, 0) };
+			AddHalfError(image, decoded.pixels, (u32)decoded.rowPitch, squared_error);
+			pixel_count += (u64)image.width * image.height;
+		}
+
+		PrintHalfResults("DirectXTex", squared_error, pixel_count, seconds);
+	}
+
+	// Only the channels the format stores count. Transparent BC1 pixels don't count at all.
+	void AddError(const DirectX::Image& image, const u8* const decoded, u32 row_pitch, Tools::BC::Format::Type format, f64& squared_error, u64& sample_count) {
+		constexpr u32 channel_counts[]{ 3, 4, 1, 2, 4 };
+		for (u32 y{ 0 }; y < image.height; y++) {
+			const u8* const source_row{ image.pixels + y * image.rowPitch };
+			const u8* const decoded_row{ decoded + y * row_pitch };
+			for (u32 x{ 0 }; x < image.width; x++) {
+				if (format == Tools::BC::Format::BC1 && source_row[x * 4 + 3] < 128) continue;
+				for (u32 c{ 0 }; c < channel_counts[format]; c++) {
+					const f64 difference{ (f64)source_row[x * 4 + c] - (f64)decoded_row[x * 4 + c] };
+					squared_error += difference * difference;
+				}
+				sample_count += channel_counts[format];
+			}
+		}
+	}
+
+	void PrintResults(Tools::BC::Format::Type format, const char* encoder, f64 squared_error, u64 sample_count, u64 pixel_count, f64 seconds) {
+		constexpr const char* format_names[]{ "BC1", "BC3", "BC4", "BC5", "BC7" };
+		const f64 mse{ squared_error / (f64)std::max(sample_count, 1ull) };
+		std::cout << format_names[format] << " " << std::setw(10) << std::left << encoder << std::right << std::fixed << std::setprecision(2)
+			<< " PSNR: " << (mse > 0.0 ? 10.0 * log10(255.0 * 255.0 / mse) : 99.0) << " dB, "
+			<< (f64)pixel_count / seconds / 1e6 << " MPixels/s\n";
+	}
+
+	// Red, green and blue of half precision RGBA.
+	void AddHalfError(const DirectX::Image& image, const u8* const decoded, u32 row_pitch, f64& squared_error) {
+		using namespace DirectX::PackedVector;
+		for (u32 y{ 0 }; y < image.height; y++) {
+			const HALF* const source_row{ (const HALF*)(image.pixels + y * image.rowPitch) };
+			const HALF* const decoded_row{ (const HALF*)(decoded + y * row_pitch) };
+			for (u32 x{ 0 }; x < image.width; x++) {
+				for (u32 c{ 0 }; c < 3; c++) {
+					const f64 difference{ (f64)XMConvertHalfToFloat(source_row[x * 4 + c]) - (f64)XMConvertHalfToFloat(decoded_row[x * 4 + c]) };
+					squared_error += difference * difference;
+				}
+			}
+		}
+	}
+
+	// The images come from 8-bit ones, so the peak value is 1.
+	void PrintHalfResults(const char* encoder, f64 squared_error, u64 pixel_count, f64 seconds) {
+		const f64 mse{ squared_error / (f64)std::max(pixel_count * 3, 1ull) };
+		std::cout << "BC6H " << std::setw(10) << std::left << encoder << std::right << std::fixed << std::setprecision(2)
+			<< " PSNR: " << (mse > 0.0 ? 10.0 * log10(1.0 / mse) : 99.0) << " dB, "
+			<< (f64)pixel_count / seconds / 1e6 << " MPixels/s\n";
+	}
+
+	static constexpr const wchar_t* _files[]{
+		L"..\\..\\Editor\\ProjectTemplates\\FirstPersonProject\\screenshot.png",
+		L"..\\..\\Editor\\ProjectTemplates\\ThirdPersonProject\\screenshot.png",
+		L"..\\..\\Editor\\ProjectTemplates\\TopDownProject\\screenshot.png",
+		L"..\\..\\Editor\\Resources\\PrimitiveMeshView\\PlaneTexture.png",
+	};
+	static constexpr const char* _quality_names[]{ "Fast", "Normal", "High" };
+	std::vector<DirectX::ScratchImage> _images;
+	std::vector<DirectX::ScratchImage> _half_images;
+};
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "Test.h"
+#include "../Engine/Content/ContentToEngine.h"
+#include "../Engine/Content/GeometryCodec.h"
+#include "../Engine/Utilities/IOStream.h"
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+
+using namespace Zetta;
+
+// Measures compression ratio and decode throughput of the geometry codec on the packed test models, after
+// checking that triangles coded against the deepest edge cache slots round-trip.
+class EngineTest : public Test {
+public:
+	bool Initialize() override {
+		for (const char* file : _files) {
+			std::ifstream stream{ file, std::ios::in | std::ios::binary };
+			if (!stream) continue;
+			const u64 size{ std::filesystem::file_size(file) };
+			util::vector<u8> data(size);
+			stream.read((char*)data.data(), size);
+			CollectSubmeshes(data);
+		}
+
+		return !_submeshes.empty();
+	}
+
+	void Run() override {
+		std::cout << "Deep edge cache slots: " << (RoundTripDeepEdges() ? "lossless\n" : "MISMATCH\n");
+
+		do {
+			u64 raw_size{ 0 }, encoded_size{ 0 };
+			double decode_seconds{ 0.0 };
+			bool succeeded{ true };
+
+			for (const Submesh& submesh : _submeshes) {
+				for (const Stream& stream : submesh.streams) {
+					raw_size += stream.raw.size();
+					util::vector<u8> encoded(stream.is_index_buffer
+						? Content::Codec::IndexBufferBound(stream.count)
+						: Content::Codec::VertexBufferBound(stream.count, stream.stride));
+					const u64 size{ stream.is_index_buffer
+						? Content::Codec::EncodeIndexBuffer(encoded.data(), encoded.size(), stream.raw.data(), stream.count, stream.stride)
+						: Content::Codec::EncodeVertexBuffer(encoded.data(), encoded.size(), stream.raw.data(), stream.count, stream.stride) };
+					encoded_size += size ? size : stream.raw.size();
+					if (!size) continue;
+
+					util::vector<u8> decoded(stream.raw.size());
+					const auto start{ std::chrono::high_resolution_clock::now() };
+					for (u32 i{ 0 }; i < _iterations; i++) {
+						succeeded &= stream.is_index_buffer
+							? Content::Codec::DecodeIndexBuffer(decoded.data(), stream.count, stream.stride, encoded.data(), size)
+							: Content::Codec::DecodeVertexBuffer(decoded.data(), stream.count, stream.stride, encoded.data(), size);
+					}
+					decode_seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+					succeeded &= memcmp(decoded.data(), stream.raw.data(), stream.raw.size()) == 0;
+				}
+			}
+
+			PrintResults(raw_size, encoded_size, decode_seconds, succeeded);
+		} while (getchar() != 'q');
+	}
+
+	void Shutdown() override { }
+
+private:
+	struct Stream {
+		util::vector<u8> raw;
+		u32 count;
+		u32 stride;
+		bool is_index_buffer;
+	};
+
+	struct Submesh {
+		util::vector<Stream> streams;
+	};
+
+	// Every fifth triangle shares an edge with the triangle 5 before it. By then 4 triangles have pushed 12 more
+	// edges, so the shared edge is in slot 13 or 14, the deepest ones.
+	bool RoundTripDeepEdges() {
+		constexpr u32 group_count{ 1000 };
+		util::vector<u32> indices;
+		u32 next{ 0 };
+		for (u32 group{ 0 }; group < group_count; group++) {
+			const u32 a{ next++ }, b{ next++ }, c{ next++ };
+			indices.emplace_back(a);
+			indices.emplace_back(b);
+			indices.emplace_back(c);
+			for (u32 i{ 0 }; i < 12; i++) indices.emplace_back(next++);
+
+			// (b, a) ends up in slot 14 and (c, b) in slot 13
+			indices.emplace_back(group & 1 ? c : b);
+			indices.emplace_back(group & 1 ? b : a);
+			indices.emplace_back(next++);
+		}
+
+		const u32 index_count{ (u32)indices.size() };
+		util::vector<u8> encoded(Content::Codec::IndexBufferBound(index_count));
+		const u64 size{ Content::Codec::EncodeIndexBuffer(encoded.data(), encoded.size(), indices.data(), index_count, sizeof(u32)) };
+		util::vector<u32> decoded(index_count);
+		return size && Content::Codec::DecodeIndexBuffer(decoded.data(), index_count, sizeof(u32), encoded.data(), size) &&
+			!memcmp(decoded.data(), indices.data(), index_count * sizeof(u32));
+	}
+
+	// Compressed submeshes, which is how the models are packed, are decoded first, so every stream is encoded
+	// from its raw buffer.
+	void CollectSubmeshes(const util::vector<u8>& data) {
+		util::BlobStreamReader blob{ data.data() };
+		const u32 lod_count{ blob.read<u32>() };
+		for (u32 lod{ 0 }; lod < lod_count; lod++) {
+			blob.skip(sizeof(f32)); // threshold
+			const u32 submesh_count{ blob.read<u32>() };
+			blob.skip(sizeof(Content::GeometryBounds) * (1 + submesh_count));
+			const u32 submeshes_size{ blob.read<u32>() };
+			const u8* const end{ blob.Position() + submeshes_size };
+
+			for (u32 i{ 0 }; i < submesh_count; i++) {
+				const u32 element_size{ blob.read<u32>() };
+				const u32 vertex_count{ blob.read<u32>() };
+				const u32 index_count{ blob.read<u32>() };
+				blob.skip(sizeof(u32) * 2); // elements_type and primitive_topology
+				const u32 position_format{ blob.read<u32>() };
+				blob.skip(sizeof(f32) * 6); // position_scale and position_bias
+				const u32 compressed_size{ blob.read<u32>() };
+
+				const u32 position_size{ Content::PositionFormat::Size((Content::PositionFormat::Format)position_format) };
+				const u32 index_size{ (vertex_count < (1 << 16)) ? sizeof(u16) : sizeof(u32) };
+				Submesh submesh{};
+				bool succeeded{ true };
+				if (!compressed_size) {
+					AddStream(submesh, blob, vertex_count, position_size, false);
+					AddStream(submesh, blob, vertex_count, element_size, false);
+					AddStream(submesh, blob, index_count, index_size, true);
+				}
+				else {
+					const u32 position_stream_size{ blob.read<u32>() };
+					const u32 element_stream_size{ blob.read<u32>() };
+					const u32 index_stream_size{ blob.read<u32>() };
+					succeeded &= AddDecodedStream(submesh, blob, position_stream_size, vertex_count, position_size, false);
+					succeeded &= AddDecodedStream(submesh, blob, element_stream_size, vertex_count, element_size, false);
+					succeeded &= AddDecodedStream(submesh, blob, index_stream_size, index_count, index_size, true);
+				}
+
+				if (succeeded) _submeshes.emplace_back(std::move(submesh));
+			}
+
+			blob.skip(end - blob.Position());
+		}
+	}
+
+	void AddStream(Submesh& submesh, util::BlobStreamReader& blob, u32 count, u32 stride, bool is_index_buffer) {
+		const u32 size{ count * stride };
+		if (size) {
+			Stream& stream{ submesh.streams.emplace_back() };
+			stream.raw.resize(size);
+			blob.read(stream.raw.data(), size);
+			stream.count = count;
+			stream.stride = stride;
+			stream.is_index_buffer = is_index_buffer;
+		}
+
+		// vertex buffers are 4 byte aligned in the blob
+		if (!is_index_buffer) blob.skip(Math::AlignSizeUp<4>(size) - size);
+	}
+
+	bool AddDecodedStream(Submesh& submesh, util::BlobStreamReader& blob, u32 stream_size, u32 count, u32 stride, bool is_index_buffer) {
+		const u8* const encoded{ blob.Position() };
+		blob.skip(stream_size);
+		if (!count || !stride) return true;
+
+		Stream& stream{ submesh.streams.emplace_back() };
+		stream.raw.resize((u64)count * stride);
+		stream.count = count;
+		stream.stride = stride;
+		stream.is_index_buffer = is_index_buffer;
+		return is_index_buffer
+			? Content::Codec::DecodeIndexBuffer(stream.raw.data(), count, stride, encoded, stream_size)
+			: Content::Codec::DecodeVertexBuffer(stream.raw.data(), count, stride, encoded, stream_size);
+	}
+
+	void PrintResults(u64 raw_size, u64 encoded_size, double decode_seconds, bool succeeded) {
+		std::cout << "Submeshes: " << _submeshes.size() << (succeeded ? " (lossless)\n" : " (MISMATCH)\n");
+		std::cout << "Raw size: " << raw_size << " bytes, encoded size: " << encoded_size << " bytes\n";
+		std::cout << "Compression ratio: " << (double)raw_size / (double)encoded_size << "\n";
+		std::cout << "Decode throughput: " << (double)raw_size * _iterations / decode_seconds / (1024.0 * 1024.0 * 1024.0) << " GB/s\n";
+	}
+
+	static constexpr const char* _files[]{ "..\\..\\x64\\lab_model.model", "..\\..\\x64\\fan_model.model", "..\\..\\x64\\ship_model.model" };
+	static constexpr u32 _iterations{ 16 };
+	util::vector<Submesh> _submeshes;
+};
@@ -33,14 +33,10 @@ namespace {
 
 	std::unordered_map<ID::ID_Type, GameEntity::EntityID> render_item_entity_map;
 
-	[[nodiscard]] ID::ID_Type LoadModel(const char* path) {
-		std::unique_ptr<u8[]> model;
+	void ReadModel(const char* path, std::unique_ptr<u8[]>& model) {
 		u64 size{ 0 };
 		ReadFile(path, model, size);
-
-		const ID::ID_Type model_id{ Content::CreateResource(model.get(), Content::AssetType::Mesh) };
-		assert(ID::IsValid(model_id));
-		return model_id;
+		assert(model.get());
 	}
 
 	void LoadShaders() {
@@ -103,23 +99,40 @@ namespace {
 }
 
 void CreateRenderItems() {
-	// Load a model and pretend it belongs to an entity
-	auto _1 = std::thread{ [] { lab_model_id = LoadModel("..\\..\\x64\\lab_model.model"); } };
-	auto _2 = std::thread{ [] { fan_model_id = LoadModel("..\\..\\x64\\fan_model.model"); } };
-	auto _3 = std::thread{ [] { ship_model_id = LoadModel("..\\..\\x64\\ship_model.model"); } };
+	// Load the models and pretend they belong to entities. The models are read while the shaders compile and
+	// created in one batch, which is unpacked on the resource workers while the entities and the material are made.
+	std::unique_ptr<u8[]> models[3];
+	auto _1 = std::thread{ [&models] { ReadModel("..\\..\\x64\\lab_model.model", models[0]); } };
+	auto _2 = std::thread{ [&models] { ReadModel("..\\..\\x64\\fan_model.model", models[1]); } };
+	auto _3 = std::thread{ [&models] { ReadModel("..\\..\\x64\\ship_model.model", models[2]); } };
 	auto _4 = std::thread{ [] {LoadShaders(); } };
 
+	_1.join();
+	_2.join();
+	_3.join();
+
+	const void* model_data[_countof(models)]{};
+	Content::AssetType::Type model_types[_countof(models)]{};
+	for (u32 i{ 0 }; i < _countof(models); i++) {
+		model_data[i] = models[i].get();
+		model_types[i] = Content::AssetType::Mesh;
+	}
+	const ID::ID_Type batch_id{ Content::CreateResourcesAsync(model_data, model_types, _countof(models)) };
+
 	lab_entity_id = CreateGameEntity({}, {}, nullptr).GetID();
 	fan_entity_id = CreateGameEntity({ -10.47f, 5.93f, -6.7f }, {}, "FanScript").GetID();
 	ship_entity_id = CreateGameEntity({ 0.f, 1.3f, -6.6f }, {}, "ShipScript").GetID();
 
-	_1.join();
-	_2.join();
-	_3.join();
 	_4.join();
+	CreateMaterial();
+
+	ID::ID_Type model_ids[_countof(models)]{};
+	Content::WaitForResourceBatch(batch_id, model_ids);
+	lab_model_id = model_ids[0];
+	fan_model_id = model_ids[1];
+	ship_model_id = model_ids[2];
 
 	// add render item using the model and its material(s).
-	CreateMaterial();
 	ID::ID_Type materials[]{ mat_id };
 
 	lab_item_id = Graphics::AddRenderItem(lab_entity_id, lab_model_id, _countof(materials), &materials[0]);
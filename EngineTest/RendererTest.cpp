@@ -284,6 +284,7 @@ void TestShutdown() {
 	for (u32 i{ 0 }; i < _countof(_surfaces); i++)
 		DestroyCameraSurface(_surfaces[i]);
 
+	Content::Shutdown();
 	Graphics::Shutdown();
 }
 
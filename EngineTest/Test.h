@@ -6,6 +6,10 @@
 #define TEST_ENTITY_COMPONENTS 0
 #define TEST_WINDOW 0
 #define TEST_RENDERER 1
+#define TEST_GEOMETRY_CODEC 0
+#define TEST_ASYNC_IO 0
+#define TEST_BLOCK_COMPRESSION 0
+#define TEST_TEXTURE_STREAMING 0
 
 class Test {
 public:
@@ -53,7 +53,7 @@ const static float InvIntervals = 2.f / ((1 << 16) - 1);
 
 ConstantBuffer<GlobalShaderData>                GlobalData          : register(b0, space0);
 ConstantBuffer<PerObjectData>                   PerObjectBuffer     : register(b1, space0);
-StructuredBuffer<float3>                        VertexPositions     : register(t0, space0);
+ByteAddressBuffer                               VertexPositions     : register(t0, space0);
 StructuredBuffer<VertexElement>                 Elements            : register(t1, space0);
 
 StructuredBuffer<DirectionalLightParameters>    DirectionalLights   : register(t3, space0);
@@ -61,11 +61,24 @@ StructuredBuffer<LightParameters>               CullableLights      : register(t
 StructuredBuffer<uint2>                         LightGrid           : register(t5, space0);
 StructuredBuffer<uint>                          LightIndexList      : register(t6, space0);
 
+float3 LoadPosition(uint vertexIdx)
+{
+    if (PerObjectBuffer.PositionFormat == 1)
+    {
+        // unorm16x3 + 16 bits padding, relative to the submesh bounds.
+        uint2 packed = VertexPositions.Load2(vertexIdx * 8);
+        float3 q = float3(packed.x & 0xffff, packed.x >> 16, packed.y & 0xffff);
+        return PerObjectBuffer.PositionBias + PerObjectBuffer.PositionScale * q;
+    }
+    
+    return asfloat(VertexPositions.Load3(vertexIdx * 12));
+}
+
 VertexOut TestShaderVS(in uint VertexIdx : SV_VertexID)
 {
     VertexOut vsOut;
     
-    float4 position = float4(VertexPositions[VertexIdx], 1.f);
+    float4 position = float4(LoadPosition(VertexIdx), 1.f);
     float4 worldPosition = mul(PerObjectBuffer.World, position);
     
 #if ELEMENTS_TYPE == ElementsTypeStaticNormal              
@@ -90,11 +103,15 @@ VertexOut TestShaderVS(in uint VertexIdx : SV_VertexID)
     float nSign = float(signs & 0x02) - 1;
     float3 normal = float3(nXY, sqrt(saturate(1.f - dot(nXY, nXY))) * nSign);
     
+    float2 tXY = element.Tangent * InvIntervals - 1.f;
+    float tSign = float(signs & 0x01) * 2.f - 1.f;
+    float3 tangent = float3(tXY, sqrt(saturate(1.f - dot(tXY, tXY))) * tSign);
+    
     vsOut.HomogeneousPosition = mul(PerObjectBuffer.WorldViewProjection, position);
     vsOut.WorldPosition = worldPosition.xyz;
     vsOut.WorldNormal = mul(float4(normal, 0.f), PerObjectBuffer.InvWorld).xyz;
-    vsOut.WorldTangent = 0.f;
-    vsOut.WorldUV = 0.f;
+    vsOut.WorldTangent = mul(PerObjectBuffer.World, float4(tangent, 0.f)).xyz;
+    vsOut.WorldUV = element.UV;
     
 #else 
 #undef ELEMENTS_TYPE
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "Test.h"
+#include "../Engine/Content/StreamableTexture.h"
+#include "../Engine/Content/TextureResidency.h"
+#include "../Engine/Platform/AsyncIO.h"
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <random>
+#include <cmath>
+
+using namespace Zetta;
+
+// Streams synthetic textures through the residency manager while their screen sizes change every frame.
+// Checks that streamed memory never exceeds the budget, that every loaded mip matches the source data and
+// that each texture ends up at its target mip once the demand stops changing. Demand that jumps between
+// full size and almost nothing evicts textures while their reads are still queued, which the I/O module
+// has to cancel. Doesn't need a GPU.
+class EngineTest : public Test {
+public:
+	bool Initialize() override {
+		std::filesystem::create_directories(_directory);
+		std::mt19937 random{ 0 };
+		for (u32 i{ 0 }; i < _texture_count; i++) {
+			SourceTexture& texture{ _textures.emplace_back() };
+			if (!CreateTexture(texture, Path(i), 1024u >> (i % 4), random)) return false;
+		}
+
+		return true;
+	}
+
+	void Run() override {
+		do {
+			// More reads than I/O threads, so some of them wait in the queue.
+			IO::Initialize(IO::Backend::ThreadPool, 2);
+			Content::Residency::Settings settings{};
+			settings.budget = _budget;
+			settings.max_reads_in_flight = 16;
+			Content::Residency::Initialize(settings, OnLoaded, OnEvicted, this);
+
+			bool succeeded{ AddTextures() };
+			u64 peak_bytes{ 0 };
+			for (u32 frame{ 0 }; frame < _frame_count && succeeded; frame++) {
+				// Textures drift towards and away from the camera and some leave the screen for a while.
+				for (u32 i{ 0 }; i < _texture_count; i++) {
+					const f32 phase{ (f32)frame * 0.02f + (f32)i };
+					const f32 pixels{ 600.f * (0.5f + 0.5f * std::sin(phase)) };
+					if (pixels > 40.f) Content::Residency::ReportDemand(_textures[i].id, pixels);
+				}
+				Content::Residency::Update();
+
+				const Content::Residency::Stats stats{ Content::Residency::GetStats() };
+				peak_bytes = std::max(peak_bytes, stats.resident_bytes + stats.in_flight_bytes);
+				succeeded &= stats.resident_bytes + stats.in_flight_bytes <= _budget;
+				std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+			}
+
+			// Every other frame evicts what the frame before asked for, while most of those reads are still queued.
+			for (u32 frame{ 0 }; frame < _frame_count && succeeded; frame++) {
+				const f32 pixels{ frame & 1 ? 2.f : 1024.f };
+				for (u32 i{ 0 }; i < _texture_count; i++) Content::Residency::ReportDemand(_textures[i].id, pixels);
+				Content::Residency::Update();
+
+				const Content::Residency::Stats stats{ Content::Residency::GetStats() };
+				peak_bytes = std::max(peak_bytes, stats.resident_bytes + stats.in_flight_bytes);
+				succeeded &= stats.resident_bytes + stats.in_flight_bytes <= _budget;
+			}
+
+			// With steady demand, every texture should settle at its target.
+			u32 settle_frames{ 0 };
+			for (; settle_frames < _frame_count && succeeded; settle_frames++) {
+				for (u32 i{ 0 }; i < _texture_count; i++) Content::Residency::ReportDemand(_textures[i].id, 64.f + 32.f * (f32)i);
+				Content::Residency::Update();
+				if (IsSettled()) break;
+				std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+			}
+			succeeded &= IsSettled() && !_mismatches;
+
+			const Content::Residency::Stats stats{ Content::Residency::GetStats() };
+			std::cout << (succeeded ? "Succeeded" : "FAILED") << ": peak " << peak_bytes / 1024 << "KB of "
+				<< _budget / 1024 << "KB budget, " << stats.loaded_mips << " mips loaded, " << stats.evicted_mips
+				<< " evicted, " << stats.tail_bytes / 1024 << "KB in tails, settled in " << settle_frames << " frames, "
+				<< _mismatches << " mismatches\n";
+
+			for (SourceTexture& texture : _textures) {
+				Content::Residency::Remove(texture.id);
+				IO::CloseFile(texture.file);
+			}
+			Content::Residency::Shutdown();
+			IO::Shutdown();
+			_mismatches = 0;
+		} while (getchar() != 'q');
+	}
+
+	void Shutdown() override {
+		std::filesystem::remove_all(_directory);
+	}
+
+private:
+	struct SourceTexture {
+		util::vector<util::vector<u8>> mips;	// tail mips are concatenated in the tail mip
+		ID::ID_Type file{ ID::Invalid_ID };
+		ID::ID_Type id{ ID::Invalid_ID };
+		u32 loaded_mask{ 0 };
+	};
+
+	// Writes a square RGBA8 texture with a full mip chain as a streamable texture. The pixels are a gradient
+	// with a bit of noise, so chunks compress somewhat.
+	bool CreateTexture(SourceTexture& texture, const std::string& path, u32 size, std::mt19937& random) {
+		util::vector<u8> subresources;
+		util::vector<util::vector<u8>> mips;
+		u32 mip_count{ 0 };
+		for (u32 mip_size{ size }; mip_size; mip_size >>= 1, mip_count++) {
+			const u32 row_pitch{ mip_size * 4 };
+			const u32 image[4]{ mip_size, mip_size, row_pitch, row_pitch * mip_size };
+			util::vector<u8>& pixels{ mips.emplace_back(image[3]) };
+			for (u32 j{ 0 }; j < image[3]; j++) pixels[j] = (u8)((j / 4 % mip_size) + (random() & 7));
+
+			const u64 offset{ subresources.size() };
+			subresources.resize(offset + sizeof(image) + image[3]);
+			memcpy(&subresources[offset], image, sizeof(image));
+			memcpy(&subresources[offset + sizeof(image)], pixels.data(), image[3]);
+		}
+
+		const Content::StreamableTexture::Description description{ size, size, 1, mip_count, 28 /* DXGI_FORMAT_R8G8B8A8_UNORM */, 0 };
+		util::vector<u8> packed;
+		if (!Content::StreamableTexture::Pack(description, subresources.data(), subresources.size(),
+			Content::StreamableTexture::default_max_tail_size, packed)) return false;
+
+		const u32 tail_mip{ Content::StreamableTexture::GetHeader(packed.data()).tail_mip };
+		for (u32 mip{ 0 }; mip < mip_count; mip++) {
+			if (mip <= tail_mip) texture.mips.emplace_back(mips[mip]);
+			else for (const u8 value : mips[mip]) texture.mips[tail_mip].emplace_back(value);
+		}
+
+		std::ofstream stream{ path, std::ios::out | std::ios::binary };
+		stream.write((const char*)packed.data(), packed.size());
+		return (bool)stream;
+	}
+
+	bool AddTextures() {
+		// The tail arrives before Add() returns, OnLoaded() matches it to the first texture without an id.
+		for (SourceTexture& texture : _textures) {
+			texture.id = ID::Invalid_ID;
+			texture.loaded_mask = 0;
+		}
+
+		for (u32 i{ 0 }; i < _texture_count; i++) {
+			SourceTexture& texture{ _textures[i] };
+			const std::string path{ Path(i) };
+			std::ifstream stream{ path, std::ios::in | std::ios::binary };
+			Content::StreamableTexture::Header header{};
+			if (!stream.read((char*)&header, sizeof(header))) return false;
+
+			util::vector<u8> resident(header.resident_size);
+			stream.seekg(0);
+			if (!stream.read((char*)resident.data(), resident.size())) return false;
+
+			texture.file = IO::OpenFile(path.c_str());
+			texture.id = Content::Residency::Add(texture.file, resident.data(), resident.size());
+			if (!ID::IsValid(texture.id)) return false;
+		}
+		return true;
+	}
+
+	static std::string Path(u32 index) {
+		return std::string{ _directory } + "/" + std::to_string(index) + ".ztex";
+	}
+
+	bool IsSettled() {
+		for (const SourceTexture& texture : _textures) {
+			if (Content::Residency::ResidentMip(texture.id) != Content::Residency::TargetMip(texture.id)) return false;
+		}
+		return true;
+	}
+
+	static void OnLoaded(ID::ID_Type texture_id, u32 mip, const u8* const data, u32 size, void* user) {
+		EngineTest& test{ *(EngineTest*)user };
+		for (SourceTexture& texture : test._textures) {
+			if (texture.id != texture_id && ID::IsValid(texture.id)) continue;
+			const util::vector<u8>& expected{ texture.mips[mip] };
+			if ((texture.loaded_mask >> mip) & 1 || size != expected.size() || memcmp(data, expected.data(), size)) test._mismatches++;
+			texture.loaded_mask |= 1u << mip;
+			return;
+		}
+		test._mismatches++;
+	}
+
+	static void OnEvicted(ID::ID_Type texture_id, u32 mip, void* user) {
+		EngineTest& test{ *(EngineTest*)user };
+		for (SourceTexture& texture : test._textures) {
+			if (texture.id != texture_id) continue;
+			if (!((texture.loaded_mask >> mip) & 1)) test._mismatches++;
+			texture.loaded_mask &= ~(1u << mip);
+			return;
+		}
+		test._mismatches++;
+	}
+
+	static constexpr const char* _directory{ "texture_streaming_test" };
+	static constexpr u32 _texture_count{ 32 };
+	static constexpr u64 _budget{ 8ull * 1024 * 1024 };
+	static constexpr u32 _frame_count{ 600 };
+	util::vector<SourceTexture> _textures;
+	u32 _mismatches{ 0 };
+};
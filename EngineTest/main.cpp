@@ -8,6 +8,14 @@
 #include "WindowTest.h"
 #elif TEST_RENDERER
 #include "RendererTest.h"
+#elif TEST_GEOMETRY_CODEC
+#include "GeometryCodecTest.h"
+#elif TEST_ASYNC_IO
+#include "AsyncIOTest.h"
+#elif TEST_BLOCK_COMPRESSION
+#include "BlockCompressionTest.h"
+#elif TEST_TEXTURE_STREAMING
+#include "TextureStreamingTest.h"
 #else
 #error At least one test must be enabled
 #endif